@@ -0,0 +1,271 @@
+#ifndef CAN_SHM_HPP
+#define CAN_SHM_HPP
+
+/*
+ * C++ラッパー（ヘッダオンリー、C++17）
+ * ===================================
+ *
+ * - Segment: 共有メモリの初期化・終了をRAIIで管理（プロセス内で参照カウント）
+ * - Slot:    CAN IDの格納バケット（ホームバケット）を事前に解決したハンドル
+ *            読み取りはseqlockをインライン展開し、関数呼び出し・PLT経由の呼び出しがない
+ * - Signal<T>: データ部をトリビアルコピー可能な型 T として読み書きする型付きビュー
+ *
+ * 書き込みはC APIを呼び出す（On-change判定・通知・ジャーナル等の処理を共有するため）。
+ *
+ * 使用例:
+ *   can_shm::Segment seg;
+ *   auto speed = seg.signal<WheelSpeed>(0x1A0);
+ *   if (auto v = speed.load()) { use(v->fl); }
+ */
+
+#include "can_shm_api.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace can_shm {
+
+// C APIのエラーコードを保持する例外
+class Error : public std::runtime_error {
+public:
+    Error(CANShmResult code, const char* what) : std::runtime_error(what), code_(code) {}
+    CANShmResult code() const noexcept { return code_; }
+
+private:
+    CANShmResult code_;
+};
+
+namespace detail {
+
+// プロセス内のSegment参照カウント（Cの g_is_initialized はプロセスで1つのため）
+struct InitState {
+    std::mutex mutex;
+    int count = 0;
+    bool owns_init = false;  // Segmentが can_shm_init を呼んだ場合のみ終了処理を行う
+};
+
+inline InitState& init_state() {
+    static InitState state;
+    return state;
+}
+
+// seqlock読み取り（can_shm_get と同じ手順、CAN IDが一致しなければfalse）
+inline bool seqlock_read(const CANBucket* bucket, uint32_t can_id, CANData& out) noexcept {
+    uint32_t seq1, seq2;
+    uint32_t attempts = 0;
+    do {
+        attempts++;
+        seq1 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+        if (seq1 & 1) continue;  // 書き込み中
+
+        std::memcpy(&out, &bucket->can_data, sizeof(CANData));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        seq2 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_RELAXED);
+    } while ((seq1 & 1) || seq1 != seq2);
+
+    // 診断カウンタ（共有メモリ上の可変領域）
+    if (attempts > 1) {
+        __atomic_add_fetch(const_cast<uint32_t*>(&bucket->read_retries), attempts - 1, __ATOMIC_RELAXED);
+    }
+
+    return bucket->is_valid && out.can_id == can_id;
+}
+
+// データ部として扱える型か
+template <typename T>
+constexpr bool is_payload_type_v = std::is_trivially_copyable_v<T> && sizeof(T) <= 64;
+
+}  // namespace detail
+
+// 事前解決済みのCAN IDハンドル
+class Slot {
+public:
+    Slot() = default;
+
+    uint32_t can_id() const noexcept { return can_id_; }
+    uint32_t bus() const noexcept { return bus_; }
+    explicit operator bool() const noexcept { return bucket_ != nullptr; }
+
+    /**
+     * 最新データの読み取り（ロックフリー）
+     * @return 格納済みならtrue
+     */
+    bool read(CANData& out) const noexcept {
+        return detail::seqlock_read(bucket_, can_id_, out);
+    }
+
+    /**
+     * データ部を型 T として読み取り（DLCが sizeof(T) 未満なら不足分は0）
+     */
+    template <typename T>
+    std::optional<T> load() const noexcept {
+        static_assert(detail::is_payload_type_v<T>, "payload type must be trivially copyable and <= 64 bytes");
+        CANData data;
+        if (!read(data)) {
+            return std::nullopt;
+        }
+        T value;
+        std::memcpy(&value, data.data, sizeof(T));
+        return value;
+    }
+
+    /**
+     * データ部が変化した更新の回数（On-changeモードで省略された更新は含まない）
+     */
+    uint32_t change_sequence() const noexcept {
+        return __atomic_load_n(&bucket_->change_sequence, __ATOMIC_ACQUIRE);
+    }
+
+    /**
+     * データ部の書き込み
+     * @return CAN_SHM_SUCCESS on success, error code on failure
+     */
+    CANShmResult store(const void* data, uint16_t dlc) const noexcept {
+        return can_shm_bus_set(bus_, can_id_, dlc, static_cast<const uint8_t*>(data));
+    }
+
+    /**
+     * 型 T の値をデータ部として書き込み（DLC = sizeof(T)）
+     * @return CAN_SHM_SUCCESS on success, error code on failure
+     */
+    template <typename T>
+    CANShmResult store(const T& value) const noexcept {
+        static_assert(detail::is_payload_type_v<T>, "payload type must be trivially copyable and <= 64 bytes");
+        return store(&value, static_cast<uint16_t>(sizeof(T)));
+    }
+
+private:
+    friend class Segment;
+    Slot(const CANBucket* bucket, uint32_t bus, uint32_t can_id) noexcept
+        : bucket_(bucket), bus_(bus), can_id_(can_id) {}
+
+    const CANBucket* bucket_ = nullptr;
+    uint32_t bus_ = 0;
+    uint32_t can_id_ = 0;
+};
+
+// 型付きビュー
+template <typename T>
+class Signal {
+    static_assert(detail::is_payload_type_v<T>, "payload type must be trivially copyable and <= 64 bytes");
+
+public:
+    Signal() = default;
+    explicit Signal(Slot slot) noexcept : slot_(slot) {}
+
+    std::optional<T> load() const noexcept { return slot_.template load<T>(); }
+    CANShmResult store(const T& value) const noexcept { return slot_.store(value); }
+    const Slot& slot() const noexcept { return slot_; }
+
+private:
+    Slot slot_;
+};
+
+// 共有メモリセグメント（RAII）
+class Segment {
+public:
+    /**
+     * セグメントのオープン（プロセス内の最初のSegmentで can_shm_init を呼ぶ）
+     * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+     * @throws Error 初期化・オープンに失敗した場合
+     */
+    explicit Segment(uint32_t bus = 0) : bus_(bus) {
+        detail::InitState& state = detail::init_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.count == 0 && !g_is_initialized) {
+            CANShmResult result = can_shm_init();
+            if (result != CAN_SHM_SUCCESS) {
+                throw Error(result, "can_shm_init failed");
+            }
+            state.owns_init = true;
+        }
+        shm_ = can_shm_bus_segment(bus);
+        if (shm_ == nullptr) {
+            release_locked(state);
+            throw Error(CAN_SHM_ERROR_INVALID_PARAM, "cannot open bus segment");
+        }
+        state.count++;
+    }
+
+    ~Segment() {
+        if (shm_ != nullptr) {
+            detail::InitState& state = detail::init_state();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.count--;
+            release_locked(state);
+        }
+    }
+
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+
+    Segment(Segment&& other) noexcept : shm_(other.shm_), bus_(other.bus_) {
+        other.shm_ = nullptr;
+    }
+
+    Segment& operator=(Segment&& other) noexcept {
+        if (this != &other) {
+            Segment moved(std::move(other));
+            std::swap(shm_, moved.shm_);
+            std::swap(bus_, moved.bus_);
+        }
+        return *this;
+    }
+
+    uint32_t bus() const noexcept { return bus_; }
+    SharedMemoryLayout* layout() const noexcept { return shm_; }
+
+    /**
+     * CAN IDの格納バケット（ホームバケット）を解決
+     * store() が使う can_shm_bus_set と同じく直接ハッシュのバケットのみを対象とし、
+     * リニアプロービングで格納したIDは扱わない（C APIの can_shm_get と同じ範囲）
+     * @throws Error CAN IDが不正な場合
+     */
+    Slot slot(uint32_t can_id) const {
+        if (!is_valid_can_id(can_id)) {
+            throw Error(CAN_SHM_ERROR_INVALID_ID, "invalid CAN ID");
+        }
+        return Slot(&shm_->buckets[can_id_hash(can_id)], bus_, can_id);
+    }
+
+    template <typename T>
+    Signal<T> signal(uint32_t can_id) const {
+        return Signal<T>(slot(can_id));
+    }
+
+    /**
+     * 単発の読み取り（繰り返し読む場合は slot() で解決したハンドルを使う）
+     */
+    std::optional<CANData> get(uint32_t can_id) const {
+        CANData data;
+        if (!slot(can_id).read(data)) {
+            return std::nullopt;
+        }
+        return data;
+    }
+
+    CANShmResult set(uint32_t can_id, const void* data, uint16_t dlc) const noexcept {
+        return can_shm_bus_set(bus_, can_id, dlc, static_cast<const uint8_t*>(data));
+    }
+
+private:
+    static void release_locked(detail::InitState& state) noexcept {
+        if (state.count == 0 && state.owns_init) {
+            can_shm_cleanup();
+            state.owns_init = false;
+        }
+    }
+
+    SharedMemoryLayout* shm_ = nullptr;
+    uint32_t bus_ = 0;
+};
+
+}  // namespace can_shm
+
+#endif  // CAN_SHM_HPP
@@ -1,4 +1,15 @@
 #include "can_shm_api.h"
+#include "can_shm_journal.h"
+#include "can_shm_queue.h"
+#include "can_shm_payload.h"
+#include "can_shm_futex.h"
+#include "can_shm_trace.h"
+#include "can_shm_hist.h"
+#include "can_shm_clock.h"
+#include "can_shm_snapshot.h"
+#include "can_shm_presence.h"
+#include "can_shm_read_cache.h"
+#include "can_shm_ext.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,6 +17,9 @@
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
+#include <linux/magic.h>
+#include <limits.h>
 #include <errno.h>
 #include <time.h>
 #include <pthread.h>
@@ -15,6 +29,11 @@ SharedMemoryLayout* g_shm_ptr = NULL;
 static int g_shm_fd = -1;
 int g_is_initialized = 0;
 
+// セグメントの配置（空文字列なら /dev/shm）とマップサイズ
+static char g_backing_path[PATH_MAX];
+static size_t g_map_size = sizeof(SharedMemoryLayout);
+static uint32_t g_sync_policy = CAN_SHM_SYNC_NONE;
+
 // タイムスタンプ取得（ナノ秒）
 static uint64_t get_timestamp_ns(void) {
     struct timespec ts;
@@ -22,85 +41,442 @@ static uint64_t get_timestamp_ns(void) {
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-// 共有メモリ初期化
-CANShmResult can_shm_init(void) {
-    if (g_is_initialized) {
-        return CAN_SHM_SUCCESS;
+// バス別セグメント（バス0は g_shm_ptr、それ以外は初回使用時にマップ）
+static SharedMemoryLayout* g_bus_shm[CAN_SHM_MAX_BUSES];
+static int g_bus_fd[CAN_SHM_MAX_BUSES] = {-1, -1, -1, -1, -1, -1, -1, -1};
+static pthread_mutex_t g_bus_open_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// CLOCK_REALTIME - CLOCK_MONOTONIC（再起動をまたいだタイムスタンプの換算用）
+static int64_t get_realtime_offset_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int64_t realtime = (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+    return realtime - (int64_t)get_timestamp_ns();
+}
+
+// 現在のブートID（取得できなければ空文字列）
+static void read_boot_id(char* buf, size_t len) {
+    memset(buf, 0, len);
+    FILE* fp = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (fp == NULL) {
+        return;
+    }
+    if (fgets(buf, (int)len, fp) != NULL) {
+        buf[strcspn(buf, "\n")] = '\0';
+    }
+    fclose(fp);
+}
+
+// セグメント内の同期オブジェクトの初期化
+static void init_sync_objects(SharedMemoryLayout* shm) {
+    // グローバルミューテックス初期化
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&shm->global_mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    
+    // 条件変数初期化
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&shm->update_condition, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    
+    // 各バケットのミューテックス初期化
+    pthread_mutexattr_t bucket_mutex_attr;
+    pthread_mutexattr_init(&bucket_mutex_attr);
+    pthread_mutexattr_setpshared(&bucket_mutex_attr, PTHREAD_PROCESS_SHARED);
+    
+    for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
+        pthread_mutex_init(&shm->buckets[i].mutex, &bucket_mutex_attr);
+    }
+    
+    pthread_mutexattr_destroy(&bucket_mutex_attr);
+    
+    // 失効監視のミューテックス・条件変数初期化
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&shm->stale_monitor.mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&shm->stale_monitor.event_condition, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    
+    // 拡張領域の世代切り替え用ミューテックス初期化
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&shm->ext.resize_mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    
+    // 完全ハッシュのIDセット公開用ミューテックス初期化
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&shm->phash.publish_mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+}
+
+// 拡張領域のセグメントと照合する識別子（同じ名前で作り直したセグメントとも区別する）
+static uint64_t new_instance_id(void) {
+    return (get_timestamp_ns() * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)getpid();
+}
+
+// セグメント内の同期オブジェクト・管理情報の初期化
+static void init_layout(SharedMemoryLayout* shm, uint32_t bus) {
+    memset(shm, 0, sizeof(SharedMemoryLayout));
+    shm->magic_number = MAGIC_NUMBER;
+    shm->version = CAN_SHM_LAYOUT_VERSION;
+    shm->global_sequence = 0;
+    shm->bus = bus;
+    
+    // タイムスタンプの換算パラメータは全バス共通（バス0で校正）
+    if (bus == 0) {
+        can_shm_clock_calibrate(&shm->clock);
     }
     
-    // 共有メモリセグメント作成または開く
-    g_shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-    if (g_shm_fd == -1) {
-        perror("shm_open");
+    init_sync_objects(shm);
+    read_boot_id(shm->boot_id, sizeof(shm->boot_id));
+    shm->realtime_offset_ns = get_realtime_offset_ns();
+    
+    // 再作成前のセグメントで解決したハンドルと一致しないよう時刻から決める
+    shm->table_generation = (uint32_t)get_timestamp_ns() | 1;
+    shm->ext.instance_id = new_instance_id();
+}
+
+// 前回ブートのタイムスタンプを現在の時刻系へ換算（0=未設定はそのまま）
+static uint64_t rebase_timestamp(uint64_t timestamp, int64_t delta) {
+    if (timestamp == 0) {
+        return 0;
+    }
+    int64_t rebased = (int64_t)timestamp + delta;
+    return rebased > 0 ? (uint64_t)rebased : 1;
+}
+
+// 前回ブートで作成されたセグメントの復旧（ファイル配置時のみ発生）
+// データ・設定は残し、同期オブジェクト・プロセスに紐づく登録・時刻の基準を作り直す
+static void recover_after_reboot(SharedMemoryLayout* shm, uint32_t bus) {
+    int64_t offset = get_realtime_offset_ns();
+    int64_t delta = shm->realtime_offset_ns - offset;
+    
+    // 保持していたプロセスは存在しないため、ロック状態は破棄して作り直す
+    init_sync_objects(shm);
+    if (bus == 0) {
+        can_shm_clock_calibrate(&shm->clock);
+    }
+    
+    for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
+        CANBucket* bucket = &shm->buckets[i];
+        // 書き込み途中で停止したseqlockを閉じる（そのままでは読み取りが完了しない）
+        if (bucket->can_data.sequence & 1) {
+            bucket->can_data.sequence++;
+        }
+        bucket->can_data.timestamp = rebase_timestamp(bucket->can_data.timestamp, delta);
+        bucket->waiters = 0;
+        bucket->wake_at = 0;
+        bucket->queue_mask = 0;
+    }
+    
+    // 完全ハッシュのスロット（公開の途中で停止した場合は旧版の全スロットが書き込み中のまま）
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < CAN_SHM_PHASH_MAX_SLOTS; i++) {
+            CANData* slot = &shm->phash.tables[t].slots[i].can_data;
+            if (slot->sequence & 1) {
+                slot->sequence++;
+            }
+            slot->timestamp = rebase_timestamp(slot->timestamp, delta);
+        }
+    }
+    
+    // レコーダ・購読キュー・購読者別ヒストグラムの登録を解除
+    shm->journal.active = 0;
+    for (int i = 0; i < CAN_SHM_MAX_QUEUES; i++) {
+        shm->queues[i].in_use = 0;
+        shm->queues[i].waiting = 0;
+    }
+    for (int i = 0; i < CAN_SHM_HIST_MAX_SUBSCRIBERS; i++) {
+        shm->subscriber_histograms[i].in_use = 0;
+    }
+    
+    // 拡張領域のセグメント（/dev/shm）は再起動で失われている
+    shm->ext.current = 0;
+    shm->ext.previous = 0;
+    shm->ext.migrated = 0;
+    shm->ext.entries = 0;
+    shm->ext.migrate_cursor = 0;
+    shm->ext.instance_id = new_instance_id();
+    shm->ext.epoch++;
+    
+    // 失効監視のtick基準と受信時刻
+    CANStaleMonitor* monitor = &shm->stale_monitor;
+    monitor->base_ns = rebase_timestamp(monitor->base_ns, delta);
+    for (int i = 0; i < CAN_SHM_STALE_MAX_IDS; i++) {
+        monitor->entries[i].armed_at = rebase_timestamp(monitor->entries[i].armed_at, delta);
+        monitor->entries[i].last_timestamp = rebase_timestamp(monitor->entries[i].last_timestamp, delta);
+    }
+    
+    read_boot_id(shm->boot_id, sizeof(shm->boot_id));
+    shm->realtime_offset_ns = offset;
+}
+
+// マップサイズ（hugetlbfs上ではヒュージページ境界へ切り上げ）
+static size_t segment_map_size(int fd) {
+    struct statfs fs;
+    if (fstatfs(fd, &fs) == 0 && (uint32_t)fs.f_type == HUGETLBFS_MAGIC && fs.f_bsize > 0) {
+        size_t page = (size_t)fs.f_bsize;
+        return (sizeof(SharedMemoryLayout) + page - 1) / page * page;
+    }
+    return sizeof(SharedMemoryLayout);
+}
+
+// 共有メモリセグメントの作成またはオープンとマップ
+// backing_path 指定時はファイル（バス1以降は "<path>.bus<N>"）、それ以外は /dev/shm
+static CANShmResult map_segment(uint32_t bus, int* fd_out, SharedMemoryLayout** shm_out) {
+    char name[PATH_MAX + 16];
+    int fd;
+    if (g_backing_path[0] != '\0') {
+        if (bus == 0) {
+            snprintf(name, sizeof(name), "%s", g_backing_path);
+        } else {
+            snprintf(name, sizeof(name), "%s.bus%u", g_backing_path, bus);
+        }
+        fd = open(name, O_CREAT | O_RDWR, 0666);
+    } else {
+        if (bus == 0) {
+            snprintf(name, sizeof(name), "%s", SHM_NAME);
+        } else {
+            snprintf(name, sizeof(name), SHM_BUS_NAME_FORMAT, bus);
+        }
+        fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+    }
+    if (fd == -1) {
+        perror(name);
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
     // ファイルサイズを確認して設定
+    size_t map_size = segment_map_size(fd);
     struct stat shm_stat;
-    if (fstat(g_shm_fd, &shm_stat) == 0 && shm_stat.st_size < (off_t)sizeof(SharedMemoryLayout)) {
-        if (ftruncate(g_shm_fd, sizeof(SharedMemoryLayout)) == -1) {
+    if (fstat(fd, &shm_stat) == 0 && shm_stat.st_size < (off_t)map_size) {
+        if (ftruncate(fd, (off_t)map_size) == -1) {
             perror("ftruncate");
-            close(g_shm_fd);
+            close(fd);
             return CAN_SHM_ERROR_INIT_FAILED;
         }
     }
     
     // メモリマップ
-    g_shm_ptr = (SharedMemoryLayout*)mmap(NULL, sizeof(SharedMemoryLayout),
-                                         PROT_READ | PROT_WRITE, MAP_SHARED, g_shm_fd, 0);
-    if (g_shm_ptr == MAP_FAILED) {
+    SharedMemoryLayout* shm = (SharedMemoryLayout*)mmap(NULL, map_size,
+                                                        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm == MAP_FAILED) {
         perror("mmap");
-        close(g_shm_fd);
+        close(fd);
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
-    // 初期化チェック（マジックナンバー）
-    if (g_shm_ptr->magic_number != MAGIC_NUMBER) {
+    // 初期化チェック（マジックナンバー・レイアウトバージョン）
+    if (shm->magic_number != MAGIC_NUMBER || shm->version != CAN_SHM_LAYOUT_VERSION) {
         // 初回初期化
-        memset(g_shm_ptr, 0, sizeof(SharedMemoryLayout));
-        g_shm_ptr->magic_number = MAGIC_NUMBER;
-        g_shm_ptr->version = 1;
-        g_shm_ptr->global_sequence = 0;
-        
-        // グローバルミューテックス初期化
-        pthread_mutexattr_t mutex_attr;
-        pthread_mutexattr_init(&mutex_attr);
-        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
-        pthread_mutex_init(&g_shm_ptr->global_mutex, &mutex_attr);
-        pthread_mutexattr_destroy(&mutex_attr);
-        
-        // 条件変数初期化
-        pthread_condattr_t cond_attr;
-        pthread_condattr_init(&cond_attr);
-        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
-        pthread_cond_init(&g_shm_ptr->update_condition, &cond_attr);
-        pthread_condattr_destroy(&cond_attr);
-        
-        // 各バケットのミューテックス初期化
-        pthread_mutexattr_t bucket_mutex_attr;
-        pthread_mutexattr_init(&bucket_mutex_attr);
-        pthread_mutexattr_setpshared(&bucket_mutex_attr, PTHREAD_PROCESS_SHARED);
+        init_layout(shm, bus);
+    } else {
+        // ファイル上のセグメントが再起動をまたいで残っていた場合
+        char boot_id[sizeof(shm->boot_id)];
+        read_boot_id(boot_id, sizeof(boot_id));
+        if (strcmp(boot_id, shm->boot_id) != 0) {
+            recover_after_reboot(shm, bus);
+        }
+    }
+    
+    g_map_size = map_size;
+    *fd_out = fd;
+    *shm_out = shm;
+    return CAN_SHM_SUCCESS;
+}
+
+// 共有メモリ初期化
+CANShmResult can_shm_init(void) {
+    if (g_is_initialized) {
+        return CAN_SHM_SUCCESS;
+    }
+    
+    // 配置の指定がなければ環境変数（テスト・複数インスタンスを本番セグメントから分離する）
+    if (g_backing_path[0] == '\0') {
+        const char* env = getenv("CAN_SHM_BACKING_PATH");
+        if (env != NULL && env[0] != '\0' && strlen(env) < sizeof(g_backing_path)) {
+            snprintf(g_backing_path, sizeof(g_backing_path), "%s", env);
+        }
+    }
+    
+    CANShmResult result = map_segment(0, &g_shm_fd, &g_shm_ptr);
+    if (result != CAN_SHM_SUCCESS) {
+        g_shm_ptr = NULL;
+        g_backing_path[0] = '\0';
+        return result;
+    }
+    
+    g_can_shm_clock = &g_shm_ptr->clock;
+    can_shm_ext_attach(g_shm_fd);
+    g_is_initialized = 1;
+    return CAN_SHM_SUCCESS;
+}
+
+// 定期msync
+static pthread_mutex_t g_sync_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_sync_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_sync_thread;
+static int g_sync_running = 0;
+static int g_sync_stop = 0;
+static uint32_t g_sync_interval_ms = 0;
+
+static void* sync_thread_func(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_sync_mutex);
+    while (!g_sync_stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += g_sync_interval_ms / 1000;
+        deadline.tv_nsec += (long)(g_sync_interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!g_sync_stop &&
+               pthread_cond_timedwait(&g_sync_cond, &g_sync_mutex, &deadline) != ETIMEDOUT) {
+        }
+        if (g_sync_stop) {
+            break;
+        }
         
-        for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
-            pthread_mutex_init(&g_shm_ptr->buckets[i].mutex, &bucket_mutex_attr);
-            g_shm_ptr->buckets[i].is_valid = 0;
+        pthread_mutex_unlock(&g_sync_mutex);
+        can_shm_sync();
+        pthread_mutex_lock(&g_sync_mutex);
+    }
+    pthread_mutex_unlock(&g_sync_mutex);
+    return NULL;
+}
+
+static void stop_sync_thread(void) {
+    pthread_mutex_lock(&g_sync_mutex);
+    if (!g_sync_running) {
+        pthread_mutex_unlock(&g_sync_mutex);
+        return;
+    }
+    g_sync_stop = 1;
+    pthread_cond_signal(&g_sync_cond);
+    pthread_mutex_unlock(&g_sync_mutex);
+    
+    pthread_join(g_sync_thread, NULL);
+    g_sync_running = 0;
+}
+
+// 共有メモリ初期化（オプション指定版）
+CANShmResult can_shm_init_ex(const CANShmInitOptions* options) {
+    if (options == NULL) {
+        return can_shm_init();
+    }
+    
+    // パラメータ検証
+    if (options->sync_policy > CAN_SHM_SYNC_PERIODIC ||
+        (options->sync_policy == CAN_SHM_SYNC_PERIODIC && options->sync_interval_ms == 0) ||
+        (options->backing_path != NULL &&
+         (options->backing_path[0] == '\0' || strlen(options->backing_path) >= sizeof(g_backing_path)))) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    // セグメントの配置と書き戻しポリシーは初回の初期化時のみ適用
+    CANShmResult result;
+    if (!g_is_initialized) {
+        snprintf(g_backing_path, sizeof(g_backing_path), "%s",
+                 options->backing_path != NULL ? options->backing_path : "");
+        result = can_shm_init();
+        if (result != CAN_SHM_SUCCESS) {
+            g_backing_path[0] = '\0';
+            return result;
         }
         
-        pthread_mutexattr_destroy(&bucket_mutex_attr);
+        g_sync_policy = options->sync_policy;
+        if (g_sync_policy == CAN_SHM_SYNC_PERIODIC) {
+            pthread_mutex_lock(&g_sync_mutex);
+            g_sync_interval_ms = options->sync_interval_ms;
+            g_sync_stop = 0;
+            g_sync_running = pthread_create(&g_sync_thread, NULL, sync_thread_func, NULL) == 0;
+            pthread_mutex_unlock(&g_sync_mutex);
+            if (!g_sync_running) {
+                can_shm_cleanup();
+                return CAN_SHM_ERROR_INIT_FAILED;
+            }
+        }
     }
     
-    g_is_initialized = 1;
+    if (options->snapshot_path == NULL) {
+        return CAN_SHM_SUCCESS;
+    }
+    
+    // ウォームリスタート（スナップショットがなければ空のテーブルで開始）
+    result = can_shm_snapshot_load(0, options->snapshot_path, NULL);
+    if (result == CAN_SHM_ERROR_INVALID_PARAM) {
+        fprintf(stderr, "can_shm: ignoring invalid snapshot %s\n", options->snapshot_path);
+    }
+    
+    if (options->snapshot_interval_ms > 0) {
+        return can_shm_snapshot_autosave_start(0, options->snapshot_path, options->snapshot_interval_ms);
+    }
     return CAN_SHM_SUCCESS;
 }
 
+// マップ中の全セグメントを書き戻し
+CANShmResult can_shm_sync(void) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    int failed = msync(g_shm_ptr, g_map_size, MS_SYNC) != 0;
+    pthread_mutex_lock(&g_bus_open_mutex);
+    for (uint32_t bus = 1; bus < CAN_SHM_MAX_BUSES; bus++) {
+        if (g_bus_shm[bus] != NULL && msync(g_bus_shm[bus], g_map_size, MS_SYNC) != 0) {
+            failed = 1;
+        }
+    }
+    pthread_mutex_unlock(&g_bus_open_mutex);
+    return failed ? CAN_SHM_ERROR_INIT_FAILED : CAN_SHM_SUCCESS;
+}
+
 // 共有メモリ終了処理
 CANShmResult can_shm_cleanup(void) {
     if (!g_is_initialized) {
         return CAN_SHM_SUCCESS;
     }
     
+    // 定期保存中なら最終値を保存して停止
+    can_shm_snapshot_autosave_stop();
+    
+    // ファイル配置時の書き戻し
+    stop_sync_thread();
+    if (g_sync_policy != CAN_SHM_SYNC_NONE) {
+        can_shm_sync();
+    }
+    
+    // バス別セグメントの解放
+    pthread_mutex_lock(&g_bus_open_mutex);
+    for (uint32_t bus = 1; bus < CAN_SHM_MAX_BUSES; bus++) {
+        if (g_bus_shm[bus] != NULL) {
+            munmap(g_bus_shm[bus], g_map_size);
+            close(g_bus_fd[bus]);
+            __atomic_store_n(&g_bus_shm[bus], NULL, __ATOMIC_RELEASE);
+            g_bus_fd[bus] = -1;
+        }
+    }
+    pthread_mutex_unlock(&g_bus_open_mutex);
+    
+    // アンマップ後に同じアドレスへ別のセグメントがマップされても古い値を返さない
+    can_shm_read_cache_invalidate_all();
+    
+    can_shm_ext_cleanup();
+    
+    g_can_shm_clock = NULL;
     if (g_shm_ptr != NULL) {
-        munmap(g_shm_ptr, sizeof(SharedMemoryLayout));
+        munmap(g_shm_ptr, g_map_size);
         g_shm_ptr = NULL;
     }
     
@@ -109,21 +485,61 @@ CANShmResult can_shm_cleanup(void) {
         g_shm_fd = -1;
     }
     
+    g_backing_path[0] = '\0';
+    g_sync_policy = CAN_SHM_SYNC_NONE;
+    
     g_is_initialized = 0;
     return CAN_SHM_SUCCESS;
 }
 
-// Set関数実装
-CANShmResult can_shm_set(uint32_t can_id, uint16_t dlc, const uint8_t* data) {
-    if (!g_is_initialized) {
-        return CAN_SHM_ERROR_INIT_FAILED;
+// バス番号に対応するセグメント（初回使用時にマップ、失敗時はNULL）
+static SharedMemoryLayout* bus_layout(uint32_t bus) {
+    if (bus == 0) {
+        return g_shm_ptr;
+    }
+    if (bus >= CAN_SHM_MAX_BUSES) {
+        return NULL;
     }
     
-    // パラメータ検証
-    if (!is_valid_can_id(can_id)) {
-        return CAN_SHM_ERROR_INVALID_ID;
+    SharedMemoryLayout* shm = __atomic_load_n(&g_bus_shm[bus], __ATOMIC_ACQUIRE);
+    if (shm != NULL) {
+        return shm;
     }
     
+    pthread_mutex_lock(&g_bus_open_mutex);
+    shm = g_bus_shm[bus];
+    if (shm == NULL) {
+        int fd;
+        if (map_segment(bus, &fd, &shm) == CAN_SHM_SUCCESS) {
+            g_bus_fd[bus] = fd;
+            __atomic_store_n(&g_bus_shm[bus], shm, __ATOMIC_RELEASE);
+        } else {
+            shm = NULL;
+        }
+    }
+    pthread_mutex_unlock(&g_bus_open_mutex);
+    return shm;
+}
+
+// バス番号の検証とセグメント取得
+static CANShmResult resolve_bus(uint32_t bus, SharedMemoryLayout** shm_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (bus >= CAN_SHM_MAX_BUSES) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    *shm_out = bus_layout(bus);
+    return *shm_out != NULL ? CAN_SHM_SUCCESS : CAN_SHM_ERROR_INIT_FAILED;
+}
+
+// バケットへのデータ書き込み（seqlock、グローバル通知は呼び出し元で実施）
+// notify_out: 購読者への通知が必要な更新なら1（On-changeモードでデータ部が不変なら0）
+// generation: ハンドル経由の書き込みなら解決時の table_generation。ロック取得後に
+//             テーブルが再編成されていた・バケットを別IDが使用していた場合は書き込まない
+static CANShmResult write_bucket_at(SharedMemoryLayout* shm, CANBucket* bucket, uint32_t can_id,
+                                    uint16_t dlc, const uint8_t* data, uint64_t timestamp,
+                                    const uint32_t* generation, int* notify_out) {
     if (dlc > 64) {
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
@@ -132,87 +548,385 @@ CANShmResult can_shm_set(uint32_t can_id, uint16_t dlc, const uint8_t* data) {
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
     
-    // ハッシュ計算
-    uint32_t bucket_index = can_id_hash(can_id);
-    CANBucket* bucket = &g_shm_ptr->buckets[bucket_index];
+    // 比較・格納用にデータ部を64byteへ整形（パディング部分は0）
+    uint8_t incoming[64];
+    if (dlc > 0) {
+        memcpy(incoming, data, dlc);
+    }
+    if (dlc < 64) {
+        memset(&incoming[dlc], 0, 64 - dlc);
+    }
+    
+    CAN_SHM_TRACE_SET_BEGIN(can_id, dlc);
     
     // バケットロック
     if (pthread_mutex_lock(&bucket->mutex) != 0) {
+        CAN_SHM_TRACE_SET_END(can_id, 0);
         return CAN_SHM_ERROR_MUTEX_FAILED;
     }
     
+    if (generation != NULL &&
+        (*generation != __atomic_load_n(&shm->table_generation, __ATOMIC_ACQUIRE) ||
+         (bucket->is_valid && bucket->can_data.can_id != can_id))) {
+        pthread_mutex_unlock(&bucket->mutex);
+        CAN_SHM_TRACE_SET_END(can_id, 0);
+        return CAN_SHM_ERROR_STALE;
+    }
+    
+    // On-changeモード：同一ID・同一DLCでデータ部（無視マスク以外）が不変なら通知しない
+    int notify = 1;
+    uint64_t ignore_mask;
+    if (can_bucket_publish_mode(shm, bucket, can_id, &ignore_mask) == CAN_SHM_PUBLISH_ON_CHANGE &&
+        bucket->is_valid && bucket->can_data.can_id == can_id && bucket->can_data.dlc == dlc) {
+        uint64_t diff = can_payload_diff_mask(bucket->can_data.data, incoming);
+        notify = (diff & can_payload_dlc_mask(dlc) & ~ignore_mask) != 0;
+    }
+    
+    // 存在フィルタへの登録（バケットを有効にする前）
+    can_shm_presence_add(shm, can_id);
+    
     // seqlock書き込み開始（奇数にする）
     uint32_t seq = bucket->can_data.sequence + 1;
     __atomic_store_n(&bucket->can_data.sequence, seq, __ATOMIC_RELEASE);
     
-    // データ設定
+    // データ設定（タイムスタンプは通知有無に関わらず更新）
     bucket->can_data.can_id = can_id;
     bucket->can_data.dlc = dlc;
-    bucket->can_data.timestamp = get_timestamp_ns();
-    
-    if (dlc > 0 && data != NULL) {
-        memcpy(bucket->can_data.data, data, dlc);
-    }
-    
-    // パディング部分をクリア
-    if (dlc < 64) {
-        memset(&bucket->can_data.data[dlc], 0, 64 - dlc);
-    }
+    bucket->can_data.timestamp = timestamp;
+    memcpy(bucket->can_data.data, incoming, 64);
     
     bucket->is_valid = 1;
     
     // seqlock書き込み完了（偶数にする）
     __atomic_store_n(&bucket->can_data.sequence, seq + 1, __ATOMIC_RELEASE);
     
+    if (notify) {
+        can_shm_bucket_publish_change(shm, bucket);
+    }
+    
+    // レコーダ接続中のみジャーナルへ追記
+    if (can_shm_journal_active(shm)) {
+        can_shm_journal_append(shm, &bucket->can_data);
+    }
+    
+    // 購読キューへの配信（購読状態はホームバケットに登録されている）
+    uint32_t queue_mask = can_shm_queue_mask(shm, can_id);
+    if (notify && queue_mask != 0) {
+        can_shm_queue_push(shm, queue_mask, &bucket->can_data);
+    }
+    
     pthread_mutex_unlock(&bucket->mutex);
     
+    CAN_SHM_TRACE_SET_END(can_id, notify);
+    
+    *notify_out = notify;
+    return CAN_SHM_SUCCESS;
+}
+
+// ハッシュ位置のバケットへの書き込み
+static CANShmResult write_bucket(SharedMemoryLayout* shm, uint32_t can_id, uint16_t dlc, const uint8_t* data,
+                                 uint64_t timestamp, int* notify_out) {
+    // パラメータ検証
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+    
+    return write_bucket_at(shm, &shm->buckets[can_id_hash(can_id)], can_id, dlc, data, timestamp,
+                           NULL, notify_out);
+}
+
+// グローバル更新通知（notified件分、suppressed件は統計のみ更新）
+static void notify_update(SharedMemoryLayout* shm, uint32_t notified, uint32_t suppressed) {
+    pthread_mutex_lock(&shm->global_mutex);
+    shm->global_sequence += notified;
+    shm->total_sets += notified + suppressed;
+    shm->total_suppressed += suppressed;
+    if (notified > 0) {
+        pthread_cond_broadcast(&shm->update_condition);
+    }
+    pthread_mutex_unlock(&shm->global_mutex);
+}
+
+// 単一フレームの格納と通知（timestamp=0なら現在時刻）
+// handle: ハンドル経由なら解決済みのバケットへ書き込む（NULLならハッシュ位置）
+static CANShmResult set_one(SharedMemoryLayout* shm, const CANShmHandle* handle, uint32_t can_id,
+                            uint16_t dlc, const uint8_t* data, uint64_t timestamp) {
+    int notify;
+    int timed = (__atomic_load_n(&shm->hist_enabled, __ATOMIC_RELAXED) & (1u << CAN_SHM_HIST_SET_DURATION)) != 0;
+    uint64_t start = (timestamp == 0 || timed) ? can_shm_clock_now_ns() : 0;
+    if (timestamp == 0) {
+        timestamp = start;
+    }
+    CANShmResult result = handle != NULL
+        ? write_bucket_at(shm, &shm->buckets[handle->index], can_id, dlc, data, timestamp,
+                          &handle->generation, &notify)
+        : write_bucket(shm, can_id, dlc, data, timestamp, &notify);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
     // グローバル更新通知
-    pthread_mutex_lock(&g_shm_ptr->global_mutex);
-    g_shm_ptr->global_sequence++;
-    g_shm_ptr->total_sets++;
-    pthread_cond_broadcast(&g_shm_ptr->update_condition);
-    pthread_mutex_unlock(&g_shm_ptr->global_mutex);
+    notify_update(shm, notify ? 1 : 0, notify ? 0 : 1);
+    
+    // 所要時間（格納開始から通知完了まで）の記録
+    if (timed) {
+        can_shm_hist_record(&shm->histograms[CAN_SHM_HIST_SET_DURATION], can_shm_clock_now_ns() - start);
+    }
     
     return CAN_SHM_SUCCESS;
 }
 
-// Get関数実装
-CANShmResult can_shm_get(uint32_t can_id, CANData* data_out) {
+// Set関数実装
+CANShmResult can_shm_set(uint32_t can_id, uint16_t dlc, const uint8_t* data) {
     if (!g_is_initialized) {
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
-    if (!is_valid_can_id(can_id) || data_out == NULL) {
+    return set_one(g_shm_ptr, NULL, can_id, dlc, data, 0);
+}
+
+// Set関数（受信時刻指定版）実装
+CANShmResult can_shm_set_timestamped(uint32_t can_id, uint16_t dlc, const uint8_t* data,
+                                     uint64_t timestamp) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    return set_one(g_shm_ptr, NULL, can_id, dlc, data, timestamp);
+}
+
+// バッチ書き込み共通処理（use_frame_timestamp=1ならframes[].timestampを優先）
+static CANShmResult set_batch_common(SharedMemoryLayout* shm, const CANData* frames,
+                                     uint32_t count, uint32_t* stored_out,
+                                     int use_frame_timestamp) {
+    if (stored_out != NULL) {
+        *stored_out = 0;
+    }
+    
+    if (frames == NULL && count > 0) {
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
     
-    uint32_t bucket_index = can_id_hash(can_id);
-    CANBucket* bucket = &g_shm_ptr->buckets[bucket_index];
+    // バッチ内のフレームは同時に受信されたものとして1回だけ時刻取得
+    uint64_t timestamp = can_shm_clock_now_ns();
+    CANShmResult first_error = CAN_SHM_SUCCESS;
+    uint32_t stored = 0;
+    uint32_t notified = 0;
     
-    // データが有効かチェック
-    if (!bucket->is_valid || bucket->can_data.can_id != can_id) {
-        pthread_mutex_lock(&g_shm_ptr->global_mutex);
-        g_shm_ptr->total_gets++;
-        pthread_mutex_unlock(&g_shm_ptr->global_mutex);
-        return CAN_SHM_ERROR_NOT_FOUND;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t frame_timestamp = timestamp;
+        if (use_frame_timestamp && frames[i].timestamp != 0) {
+            frame_timestamp = frames[i].timestamp;
+        }
+        
+        int notify;
+        CANShmResult result = write_bucket(shm, frames[i].can_id, frames[i].dlc,
+                                           frames[i].data, frame_timestamp, &notify);
+        if (result == CAN_SHM_SUCCESS) {
+            stored++;
+            notified += notify;
+        } else if (first_error == CAN_SHM_SUCCESS) {
+            first_error = result;
+        }
+    }
+    
+    // グローバル更新通知はバッチ全体で1回
+    if (stored > 0) {
+        notify_update(shm, notified, stored - notified);
+    }
+    
+    if (stored_out != NULL) {
+        *stored_out = stored;
     }
     
-    // seqlock読み取り（ロックフリー）
+    return first_error;
+}
+
+// Set関数（バッチ版）実装
+CANShmResult can_shm_set_batch(const CANData* frames, uint32_t count, uint32_t* stored_out) {
+    if (stored_out != NULL) {
+        *stored_out = 0;
+    }
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    return set_batch_common(g_shm_ptr, frames, count, stored_out, 0);
+}
+
+// Set関数（受信時刻指定バッチ版）実装
+CANShmResult can_shm_set_batch_timestamped(const CANData* frames, uint32_t count,
+                                           uint32_t* stored_out) {
+    if (stored_out != NULL) {
+        *stored_out = 0;
+    }
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    return set_batch_common(g_shm_ptr, frames, count, stored_out, 1);
+}
+
+// セグメントからの取得
+// バケットからのseqlock読み取り（CAN IDが一致しなければ0）
+static int read_bucket(SharedMemoryLayout* shm, CANBucket* bucket, uint32_t can_id, CANData* data_out) {
     uint32_t seq1, seq2;
+    uint32_t attempts = 0;
     do {
+        attempts++;
         seq1 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
         if (seq1 & 1) continue; // 書き込み中
         
-        // データコピー
         *data_out = bucket->can_data;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
         
         seq2 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_RELAXED);
-    } while (seq1 != seq2);
+    } while ((seq1 & 1) || seq1 != seq2);
     
-    pthread_mutex_lock(&g_shm_ptr->global_mutex);
-    g_shm_ptr->total_gets++;
-    pthread_mutex_unlock(&g_shm_ptr->global_mutex);
+    if (attempts > 1) {
+        __atomic_add_fetch(&bucket->read_retries, attempts - 1, __ATOMIC_RELAXED);
+        CAN_SHM_TRACE_SEQLOCK_RETRY(can_id, attempts - 1);
+    }
+    can_shm_hist_record_kind(shm, CAN_SHM_HIST_READ_RETRIES, attempts - 1);
+    
+    return bucket->is_valid && data_out->can_id == can_id;
+}
+
+static CANShmResult get_one(SharedMemoryLayout* shm, uint32_t can_id, CANData* data_out) {
+    if (!is_valid_can_id(can_id) || data_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    // 存在フィルタで未登録と分かればバケットに触れずに返す（統計にも数えない）
+    if (!can_shm_presence_maybe(shm, can_id)) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+    
+    // 読み取りキャッシュ：シーケンスが変わっていなければ保持している値を返す
+    int use_cache = can_shm_read_cache_enabled();
+    if (use_cache && can_shm_read_cache_lookup(shm, can_id, data_out)) {
+        return CAN_SHM_SUCCESS;
+    }
+    
+    uint32_t bucket_index = can_id_hash(can_id);
+    CANBucket* bucket = &shm->buckets[bucket_index];
+    
+    // データが有効かチェック
+    int found = bucket->is_valid && bucket->can_data.can_id == can_id;
+    
+    // seqlock読み取り（ロックフリー）。キャッシュには検証済みの一貫したコピーだけを登録する
+    if (found) {
+        found = read_bucket(shm, bucket, can_id, data_out);
+        if (found && use_cache) {
+            can_shm_read_cache_store(shm, bucket, data_out);
+        }
+    }
+    
+    pthread_mutex_lock(&shm->global_mutex);
+    shm->total_gets++;
+    pthread_mutex_unlock(&shm->global_mutex);
     
+    return found ? CAN_SHM_SUCCESS : CAN_SHM_ERROR_NOT_FOUND;
+}
+
+// Get関数実装
+CANShmResult can_shm_get(uint32_t can_id, CANData* data_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    return get_one(g_shm_ptr, can_id, data_out);
+}
+
+// スロットの解決（格納済みならそのバケット、未格納なら探査チェーン上の最初の空きバケット）
+CANShmResult can_shm_bus_resolve(uint32_t bus, uint32_t can_id, CANShmHandle* handle_out) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+    if (handle_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    // 世代は探索前に読む（探索中の再編成はハンドル使用時に検出される）
+    uint32_t generation = __atomic_load_n(&shm->table_generation, __ATOMIC_ACQUIRE);
+    uint32_t initial_hash = can_id_hash(can_id);
+    for (uint32_t i = 0; i < CAN_SHM_MAX_PROBE; i++) {
+        uint32_t index = (initial_hash + i) % MAX_CAN_ENTRIES;
+        const CANBucket* bucket = &shm->buckets[index];
+        if (!bucket->is_valid || bucket->can_data.can_id == can_id) {
+            // 拡張領域に格納済みのIDはメインテーブルのバケットを指せない
+            CANData stored;
+            if (!bucket->is_valid && bus == 0 && can_shm_ext_active(shm) &&
+                can_shm_ext_get(can_id, &stored) == CAN_SHM_SUCCESS) {
+                return CAN_SHM_ERROR_NOT_FOUND;
+            }
+            handle_out->can_id = can_id;
+            handle_out->index = index;
+            handle_out->generation = generation;
+            handle_out->bus = bus;
+            return CAN_SHM_SUCCESS;
+        }
+    }
+    
+    // 探査範囲が満杯（リニアプロービングでは拡張領域に格納される）
+    return CAN_SHM_ERROR_NOT_FOUND;
+}
+
+CANShmResult can_shm_resolve(uint32_t can_id, CANShmHandle* handle_out) {
+    return can_shm_bus_resolve(0, can_id, handle_out);
+}
+
+// ハンドルの検証とセグメント取得
+static CANShmResult resolve_handle(const CANShmHandle* handle, SharedMemoryLayout** shm_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (handle == NULL || handle->index >= MAX_CAN_ENTRIES) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    CANShmResult result = resolve_bus(handle->bus, shm_out);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    if (handle->generation != __atomic_load_n(&(*shm_out)->table_generation, __ATOMIC_ACQUIRE)) {
+        return CAN_SHM_ERROR_STALE;
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+// ハンドル経由のSet（ハッシュ計算・探査を行わない）
+CANShmResult can_shm_set_h(const CANShmHandle* handle, uint16_t dlc, const uint8_t* data) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_handle(handle, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    return set_one(shm, handle, handle->can_id, dlc, data, 0);
+}
+
+// ハンドル経由のGet（ハッシュ計算・探査を行わない）
+CANShmResult can_shm_get_h(const CANShmHandle* handle, CANData* data_out) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_handle(handle, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    if (data_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    CANBucket* bucket = &shm->buckets[handle->index];
+    if (!read_bucket(shm, bucket, handle->can_id, data_out)) {
+        // 未格納なら NOT_FOUND、別IDが使用中ならハンドルの解決し直しが必要
+        return bucket->is_valid ? CAN_SHM_ERROR_STALE : CAN_SHM_ERROR_NOT_FOUND;
+    }
+    
+    pthread_mutex_lock(&shm->global_mutex);
+    shm->total_gets++;
+    pthread_mutex_unlock(&shm->global_mutex);
     return CAN_SHM_SUCCESS;
 }
 
@@ -238,13 +952,16 @@ CANShmResult can_shm_subscribe(uint32_t can_id,
     
     // 現在のシーケンス番号を取得
     if (bucket->is_valid && bucket->can_data.can_id == can_id) {
-        last_sequence = bucket->can_data.sequence;
+        last_sequence = __atomic_load_n(&bucket->change_sequence, __ATOMIC_ACQUIRE);
     }
     
     pthread_mutex_lock(&g_shm_ptr->global_mutex);
     g_shm_ptr->total_subscribes++;
     pthread_mutex_unlock(&g_shm_ptr->global_mutex);
     
+    CANLatencyHistogram* delivery_hist = can_shm_hist_subscriber_acquire(g_shm_ptr, can_id);
+    CANShmResult result = CAN_SHM_SUCCESS;
+    
     while (subscribe_count == 0 || received_count < subscribe_count) {
         pthread_mutex_lock(&g_shm_ptr->global_mutex);
         
@@ -275,25 +992,233 @@ CANShmResult can_shm_subscribe(uint32_t can_id,
         pthread_mutex_unlock(&g_shm_ptr->global_mutex);
         
         if (wait_result == ETIMEDOUT) {
-            return CAN_SHM_ERROR_TIMEOUT;
+            result = CAN_SHM_ERROR_TIMEOUT;
+            break;
         }
         
         // データチェック
         if (bucket->is_valid && bucket->can_data.can_id == can_id) {
-            uint32_t current_sequence = bucket->can_data.sequence;
-            if (current_sequence != last_sequence) {
-                // 新しいデータを受信
-                CANData data_copy = bucket->can_data;
+            // データ部が変化した更新のみ配信（On-changeモードで省略された更新は除く）
+            uint32_t current_sequence = __atomic_load_n(&bucket->change_sequence, __ATOMIC_ACQUIRE);
+            CANData data_copy;
+            if (current_sequence != last_sequence && read_bucket(g_shm_ptr, bucket, can_id, &data_copy)) {
+                // 新しいデータを受信（seqlockで一貫したコピーを取得）
+                __atomic_add_fetch(&bucket->wakeups, 1, __ATOMIC_RELAXED);
+                CAN_SHM_TRACE_WAKEUP(can_id, current_sequence);
+                can_shm_hist_record_delivery(g_shm_ptr, delivery_hist, &data_copy);
+                CAN_SHM_TRACE_CALLBACK_BEGIN(can_id, user_data);
                 callback(can_id, &data_copy, user_data);
+                CAN_SHM_TRACE_CALLBACK_END(can_id, user_data);
                 received_count++;
                 last_sequence = current_sequence;
             }
         }
     }
     
+    can_shm_hist_subscriber_release(g_shm_ptr, delivery_hist);
+    return result;
+}
+
+// 起床条件の登録（既に登録済みの閾値の方が早ければそのまま）
+static void arm_wake_at(CANBucket* bucket, uint32_t target) {
+    uint32_t current = __atomic_load_n(&bucket->wake_at, __ATOMIC_RELAXED);
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&bucket->change_sequence, __ATOMIC_RELAXED);
+        int expired = (int32_t)(seq - current) >= 0;
+        if (!expired && (int32_t)(target - current) >= 0) {
+            return;
+        }
+        if (__atomic_compare_exchange_n(&bucket->wake_at, &current, target, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+}
+
+/**
+ * change_sequenceがtargetに達するまでfutexで待機
+ * @param deadline_ns 待機期限（CLOCK_MONOTONIC、0=無期限）
+ * @return 0=到達, -1=タイムアウト
+ */
+static int wait_for_change(CANBucket* bucket, uint32_t target, uint64_t deadline_ns) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&bucket->change_sequence, __ATOMIC_ACQUIRE);
+        if ((int32_t)(seq - target) >= 0) {
+            return 0;
+        }
+        
+        struct timespec rel;
+        struct timespec* rel_ptr = NULL;
+        if (deadline_ns != 0) {
+            uint64_t now = get_timestamp_ns();
+            if (now >= deadline_ns) {
+                return -1;
+            }
+            rel.tv_sec = (time_t)((deadline_ns - now) / 1000000000ULL);
+            rel.tv_nsec = (long)((deadline_ns - now) % 1000000000ULL);
+            rel_ptr = &rel;
+        }
+        
+        // 待機者登録後にシーケンスを再確認してからスリープ（Set側の公開処理と対になる）
+        __atomic_add_fetch(&bucket->waiters, 1, __ATOMIC_SEQ_CST);
+        arm_wake_at(bucket, target);
+        seq = __atomic_load_n(&bucket->change_sequence, __ATOMIC_SEQ_CST);
+        if ((int32_t)(seq - target) < 0) {
+            can_shm_futex_wait(&bucket->change_sequence, seq, rel_ptr);
+        }
+        __atomic_sub_fetch(&bucket->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+// 絶対時刻（CLOCK_MONOTONIC）までスリープ
+static void sleep_until_ns(uint64_t wake_ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(wake_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(wake_ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// オプション指定Subscribeの待機・配信ループ
+static CANShmResult subscribe_ex_loop(SharedMemoryLayout* shm,
+                                      CANBucket* bucket,
+                                      uint32_t can_id,
+                                      uint32_t subscribe_count,
+                                      int32_t timeout_ms,
+                                      CANSubscribeOptions opt,
+                                      CANDataCallback callback,
+                                      void* user_data,
+                                      CANLatencyHistogram* delivery_hist) {
+    const uint64_t interval_ns = (uint64_t)opt.interval_ms * 1000000ULL;
+    const uint64_t timeout_ns = timeout_ms >= 0 ? (uint64_t)timeout_ms * 1000000ULL : 0;
+    uint32_t last_sequence = __atomic_load_n(&bucket->change_sequence, __ATOMIC_ACQUIRE);
+    uint32_t received_count = 0;
+    uint64_t last_delivery = get_timestamp_ns();
+    uint64_t next_sample = last_delivery + interval_ns;
+    
+    while (subscribe_count == 0 || received_count < subscribe_count) {
+        // タイムアウトは最後の配信（開始）からの経過時間で判定
+        uint64_t deadline = timeout_ms >= 0 ? last_delivery + timeout_ns : 0;
+        
+        switch (opt.mode) {
+            case CAN_SHM_SUBSCRIBE_MIN_INTERVAL:
+                // 最小間隔が経過するまではスリープ（更新があっても起きない）
+                if (received_count > 0) {
+                    sleep_until_ns(last_delivery + interval_ns);
+                }
+                if (wait_for_change(bucket, last_sequence + 1, deadline) != 0) {
+                    return CAN_SHM_ERROR_TIMEOUT;
+                }
+                break;
+            
+            case CAN_SHM_SUBSCRIBE_EVERY_NTH:
+                if (wait_for_change(bucket, last_sequence + opt.every_n, deadline) != 0) {
+                    return CAN_SHM_ERROR_TIMEOUT;
+                }
+                break;
+            
+            case CAN_SHM_SUBSCRIBE_SAMPLE: {
+                // 周期境界でのみ起床し、その時点の最新値を確認
+                sleep_until_ns(next_sample);
+                uint64_t now = get_timestamp_ns();
+                next_sample += interval_ns;
+                if (next_sample <= now) {
+                    next_sample = now + interval_ns;  // 遅れた周期は読み飛ばす
+                }
+                if (__atomic_load_n(&bucket->change_sequence, __ATOMIC_ACQUIRE) == last_sequence) {
+                    if (deadline != 0 && now >= deadline) {
+                        return CAN_SHM_ERROR_TIMEOUT;
+                    }
+                    continue;
+                }
+                break;
+            }
+            
+            case CAN_SHM_SUBSCRIBE_EVERY:
+            default:
+                if (wait_for_change(bucket, last_sequence + 1, deadline) != 0) {
+                    return CAN_SHM_ERROR_TIMEOUT;
+                }
+                break;
+        }
+        
+        // 最新値を取得して配信
+        last_sequence = __atomic_load_n(&bucket->change_sequence, __ATOMIC_ACQUIRE);
+        CANData data_copy;
+        if (!read_bucket(shm, bucket, can_id, &data_copy)) {
+            continue;  // 同一バケットの別IDによる更新
+        }
+        __atomic_add_fetch(&bucket->wakeups, 1, __ATOMIC_RELAXED);
+        CAN_SHM_TRACE_WAKEUP(can_id, last_sequence);
+        can_shm_hist_record_delivery(shm, delivery_hist, &data_copy);
+        
+        CAN_SHM_TRACE_CALLBACK_BEGIN(can_id, user_data);
+        callback(can_id, &data_copy, user_data);
+        CAN_SHM_TRACE_CALLBACK_END(can_id, user_data);
+        received_count++;
+        last_delivery = get_timestamp_ns();
+    }
+    
     return CAN_SHM_SUCCESS;
 }
 
+// オプション指定Subscribeの本体
+static CANShmResult subscribe_ex_on(SharedMemoryLayout* shm,
+                                    uint32_t can_id,
+                                    uint32_t subscribe_count,
+                                    int32_t timeout_ms,
+                                    const CANSubscribeOptions* options,
+                                    CANDataCallback callback,
+                                    void* user_data) {
+    if (!is_valid_can_id(can_id) || callback == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    CANSubscribeOptions opt = {CAN_SHM_SUBSCRIBE_EVERY, 0, 0};
+    if (options != NULL) {
+        opt = *options;
+    }
+    if ((opt.mode == CAN_SHM_SUBSCRIBE_MIN_INTERVAL || opt.mode == CAN_SHM_SUBSCRIBE_SAMPLE) &&
+        opt.interval_ms == 0) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    if (opt.mode == CAN_SHM_SUBSCRIBE_EVERY_NTH && opt.every_n == 0) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    if (opt.mode > CAN_SHM_SUBSCRIBE_SAMPLE) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t bucket_index = can_id_hash(can_id);
+    CANBucket* bucket = &shm->buckets[bucket_index];
+    
+    pthread_mutex_lock(&shm->global_mutex);
+    shm->total_subscribes++;
+    pthread_mutex_unlock(&shm->global_mutex);
+    
+    // 購読者別の配信遅延ヒストグラム（確保できなければ全体のみ記録）
+    CANLatencyHistogram* delivery_hist = can_shm_hist_subscriber_acquire(shm, can_id);
+    CANShmResult result = subscribe_ex_loop(shm, bucket, can_id, subscribe_count, timeout_ms, opt,
+                                            callback, user_data, delivery_hist);
+    can_shm_hist_subscriber_release(shm, delivery_hist);
+    return result;
+}
+
+// Subscribe関数（オプション指定版）実装
+CANShmResult can_shm_subscribe_ex(uint32_t can_id,
+                                  uint32_t subscribe_count,
+                                  int32_t timeout_ms,
+                                  const CANSubscribeOptions* options,
+                                  CANDataCallback callback,
+                                  void* user_data) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    return subscribe_ex_on(g_shm_ptr, can_id, subscribe_count, timeout_ms, options,
+                           callback, user_data);
+}
+
 // Subscribe単発版用のヘルパー構造体
 typedef struct {
     CANData* output;
@@ -345,6 +1270,230 @@ CANShmResult can_shm_get_stats(uint64_t* total_sets,
     return CAN_SHM_SUCCESS;
 }
 
+// バス指定Set関数実装
+CANShmResult can_shm_bus_set(uint32_t bus, uint32_t can_id, uint16_t dlc, const uint8_t* data) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    return set_one(shm, NULL, can_id, dlc, data, 0);
+}
+
+CANShmResult can_shm_bus_set_timestamped(uint32_t bus, uint32_t can_id, uint16_t dlc,
+                                         const uint8_t* data, uint64_t timestamp) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    return set_one(shm, NULL, can_id, dlc, data, timestamp);
+}
+
+// バス指定Set関数（バッチ版）実装
+CANShmResult can_shm_bus_set_batch(uint32_t bus, const CANData* frames, uint32_t count,
+                                   uint32_t* stored_out) {
+    if (stored_out != NULL) {
+        *stored_out = 0;
+    }
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    return set_batch_common(shm, frames, count, stored_out, 0);
+}
+
+// バス指定Set関数（受信時刻指定バッチ版）実装
+CANShmResult can_shm_bus_set_batch_timestamped(uint32_t bus, const CANData* frames,
+                                               uint32_t count, uint32_t* stored_out) {
+    if (stored_out != NULL) {
+        *stored_out = 0;
+    }
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    return set_batch_common(shm, frames, count, stored_out, 1);
+}
+
+// バス指定Get関数実装
+CANShmResult can_shm_bus_get(uint32_t bus, uint32_t can_id, CANData* data_out) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    return get_one(shm, can_id, data_out);
+}
+
+// バス指定Subscribe関数実装
+CANShmResult can_shm_bus_subscribe_ex(uint32_t bus,
+                                      uint32_t can_id,
+                                      uint32_t subscribe_count,
+                                      int32_t timeout_ms,
+                                      const CANSubscribeOptions* options,
+                                      CANDataCallback callback,
+                                      void* user_data) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    return subscribe_ex_on(shm, can_id, subscribe_count, timeout_ms, options, callback, user_data);
+}
+
+// バスのセグメント取得
+SharedMemoryLayout* can_shm_bus_segment(uint32_t bus) {
+    SharedMemoryLayout* shm;
+    return resolve_bus(bus, &shm) == CAN_SHM_SUCCESS ? shm : NULL;
+}
+
+// バス別統計情報取得
+CANShmResult can_shm_bus_get_stats(uint32_t bus, uint64_t* total_sets, uint64_t* global_sequence) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    if (total_sets == NULL || global_sequence == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    pthread_mutex_lock(&shm->global_mutex);
+    *total_sets = shm->total_sets;
+    *global_sequence = shm->global_sequence;
+    pthread_mutex_unlock(&shm->global_mutex);
+    
+    return CAN_SHM_SUCCESS;
+}
+
+// CAN IDごとの診断カウンタ取得
+CANShmResult can_shm_bus_get_id_stats(uint32_t bus, CANIdStats* stats_out, uint32_t max,
+                                      uint32_t* count_out) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_bus(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    
+    if (stats_out == NULL || count_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < MAX_CAN_ENTRIES && count < max; i++) {
+        CANBucket* bucket = &shm->buckets[i];
+        if (!bucket->is_valid) {
+            continue;
+        }
+        
+        // ID・DLC・タイムスタンプは一貫したコピーから取得（カウンタは参照用のためリトライを計上しない）
+        CANData data;
+        uint32_t seq1, seq2;
+        do {
+            seq1 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+            data = bucket->can_data;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            seq2 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_RELAXED);
+        } while ((seq1 & 1) || seq1 != seq2);
+        
+        CANIdStats* stats = &stats_out[count++];
+        memset(stats, 0, sizeof(*stats));
+        stats->can_id = data.can_id;
+        stats->bucket = i;
+        stats->updates = seq1 / 2;
+        stats->change_sequence = __atomic_load_n(&bucket->change_sequence, __ATOMIC_RELAXED);
+        stats->read_retries = __atomic_load_n(&bucket->read_retries, __ATOMIC_RELAXED);
+        stats->wakeups = __atomic_load_n(&bucket->wakeups, __ATOMIC_RELAXED);
+        stats->timestamp = data.timestamp;
+        stats->dlc = data.dlc;
+    }
+    
+    *count_out = count;
+    return CAN_SHM_SUCCESS;
+}
+
+// 通知モード設定（全体）
+CANShmResult can_shm_set_publish_mode(CANShmPublishMode mode) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    if (mode != CAN_SHM_PUBLISH_ALWAYS && mode != CAN_SHM_PUBLISH_ON_CHANGE) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    __atomic_store_n(&g_shm_ptr->publish_mode, (uint32_t)mode, __ATOMIC_RELEASE);
+    return CAN_SHM_SUCCESS;
+}
+
+// 通知モード設定（CAN ID個別）
+CANShmResult can_shm_set_publish_mode_id(uint32_t can_id, CANShmPublishMode mode,
+                                         uint64_t ignore_mask) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+    
+    if (mode != CAN_SHM_PUBLISH_DEFAULT && mode != CAN_SHM_PUBLISH_ALWAYS &&
+        mode != CAN_SHM_PUBLISH_ON_CHANGE) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    // 格納先バケット：リニアプロービングで別バケットに格納済みならそのバケット
+    uint32_t initial_hash = can_id_hash(can_id);
+    CANBucket* bucket = &g_shm_ptr->buckets[initial_hash];
+    for (int i = 0; i < CAN_SHM_MAX_PROBE; i++) {
+        CANBucket* probe = &g_shm_ptr->buckets[(initial_hash + i) % MAX_CAN_ENTRIES];
+        if (!probe->is_valid) {
+            break;
+        }
+        if (probe->can_data.can_id == can_id) {
+            bucket = probe;
+            break;
+        }
+    }
+    
+    if (pthread_mutex_lock(&bucket->mutex) != 0) {
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+    bucket->publish_mode = (uint8_t)mode;
+    bucket->ignore_mask = ignore_mask;
+    bucket->mode_can_id = can_id;
+    pthread_mutex_unlock(&bucket->mutex);
+    
+    return CAN_SHM_SUCCESS;
+}
+
+// 通知省略回数取得
+CANShmResult can_shm_get_suppressed_count(uint64_t* total_suppressed) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    
+    if (total_suppressed == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    
+    pthread_mutex_lock(&g_shm_ptr->global_mutex);
+    *total_suppressed = g_shm_ptr->total_suppressed;
+    pthread_mutex_unlock(&g_shm_ptr->global_mutex);
+    
+    return CAN_SHM_SUCCESS;
+}
+
 // デバッグ出力
 void can_shm_debug_print(void) {
     if (!g_is_initialized) {
@@ -357,6 +1506,9 @@ void can_shm_debug_print(void) {
     printf("Global Sequence: %llu\n", g_shm_ptr->global_sequence);
     printf("Stats - Sets: %llu, Gets: %llu, Subscribes: %llu\n",
            g_shm_ptr->total_sets, g_shm_ptr->total_gets, g_shm_ptr->total_subscribes);
+    printf("Publish mode: %s, Suppressed notifications: %llu\n",
+           g_shm_ptr->publish_mode == CAN_SHM_PUBLISH_ON_CHANGE ? "on-change" : "always",
+           (unsigned long long)g_shm_ptr->total_suppressed);
     
     int valid_entries = 0;
     for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
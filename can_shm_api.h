@@ -18,6 +18,24 @@ extern int g_is_initialized;
  */
 CANShmResult can_shm_init(void);
 
+/**
+ * 共有メモリシステム初期化（オプション指定版）
+ * backing_path 指定時は /dev/shm の代わりにそのファイルへセグメントを置く（tmpfs・hugetlbfs・
+ * 永続ファイルシステム上のファイル。同じテーブルを使う全プロセスで同じパスを指定する）。
+ * 再起動をまたいで残ったセグメントはデータを保持したまま同期オブジェクトと時刻の基準を作り直す。
+ * snapshot_path のスナップショットから無効なバケットを復元し（ファイルがない・
+ * 破損している場合は復元せずに初期化を続行）、snapshot_interval_ms > 0 なら定期保存を開始する
+ * @param options 初期化オプション (NULLの場合は can_shm_init と同じ)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_init_ex(const CANShmInitOptions* options);
+
+/**
+ * マップ中の全セグメントをファイルへ書き戻し（msync）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_sync(void);
+
 /**
  * 共有メモリシステム終了処理
  * @return CAN_SHM_SUCCESS on success, error code on failure
@@ -33,6 +51,39 @@ CANShmResult can_shm_cleanup(void);
  */
 CANShmResult can_shm_set(uint32_t can_id, uint16_t dlc, const uint8_t* data);
 
+/**
+ * Set関数（受信時刻指定版） - ハードウェアの受信タイムスタンプ付きで格納
+ * @param can_id CAN ID (29bit有効値)
+ * @param dlc データ長 (0~64)
+ * @param data データ部へのポインタ (dlc=0の場合NULLも可)
+ * @param timestamp 受信時刻（CLOCK_MONOTONIC基準[ns]、0の場合は現在時刻）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_set_timestamped(uint32_t can_id, uint16_t dlc, const uint8_t* data,
+                                     uint64_t timestamp);
+
+/**
+ * Set関数（バッチ版） - 複数のCANデータをまとめて共有メモリに格納
+ * 各フレームはバケット単位のseqlockで書き込み、更新通知はバッチ全体で1回のみ行う
+ * タイムスタンプはバッチ単位で付与する（frames[].timestamp/sequenceは無視）
+ * @param frames 格納するCANデータ配列 (can_id, dlc, dataを使用)
+ * @param count 配列の要素数
+ * @param stored_out 格納できたフレーム数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS if all frames stored, first error code otherwise
+ */
+CANShmResult can_shm_set_batch(const CANData* frames, uint32_t count, uint32_t* stored_out);
+
+/**
+ * Set関数（受信時刻指定バッチ版） - 受信時刻付きのCANデータをまとめて格納
+ * frames[].timestamp（CLOCK_MONOTONIC基準[ns]）をそのまま格納する（0の場合は現在時刻）
+ * @param frames 格納するCANデータ配列 (can_id, dlc, data, timestampを使用)
+ * @param count 配列の要素数
+ * @param stored_out 格納できたフレーム数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS if all frames stored, first error code otherwise
+ */
+CANShmResult can_shm_set_batch_timestamped(const CANData* frames, uint32_t count,
+                                           uint32_t* stored_out);
+
 /**
  * Get関数 - CAN IDを元に共有メモリからCANデータを取得
  * @param can_id CAN ID (29bit有効値)
@@ -56,6 +107,25 @@ CANShmResult can_shm_subscribe(uint32_t can_id,
                                CANDataCallback callback,
                                void* user_data);
 
+/**
+ * Subscribe関数（オプション指定版） - 配信レートを制限してCAN IDの更新を購読
+ * 購読者はバケット単位のfutexで待機し、配信条件を満たすまで起床しない
+ * （最小間隔・周期サンプリングは間隔が経過するまでスリープ、N回ごとはN回目の更新で起床）
+ * @param can_id CAN ID (29bit有効値)
+ * @param subscribe_count 配信回数 (0=無限回)
+ * @param timeout_ms 前回配信から次の配信までのタイムアウト[ミリ秒] (<0=タイムアウト無効)
+ * @param options 配信オプション (NULL=全ての更新を配信)
+ * @param callback データ受信時のコールバック関数
+ * @param user_data コールバック関数に渡すユーザーデータ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_subscribe_ex(uint32_t can_id,
+                                  uint32_t subscribe_count,
+                                  int32_t timeout_ms,
+                                  const CANSubscribeOptions* options,
+                                  CANDataCallback callback,
+                                  void* user_data);
+
 /**
  * Subscribe関数（簡易版） - 単発でデータを取得
  * @param can_id CAN ID (29bit有効値) 
@@ -78,6 +148,189 @@ CANShmResult can_shm_get_stats(uint64_t* total_sets,
                                uint64_t* total_gets,
                                uint64_t* total_subscribes);
 
+/*
+ * バス指定API
+ * ===========
+ *
+ * 同じCAN IDでもバスごとに意味が異なるため、バス単位で独立したセグメントを持つ。
+ * バス0は SHM_NAME のセグメント（バス指定なしのAPIと同一）、バス1以降は
+ * SHM_BUS_NAME_FORMAT のセグメントを初回使用時に作成またはオープンする。
+ * セグメントごとにバケット・グローバルミューテックス・シーケンスが独立しているため、
+ * 異なるバスへの書き込み同士は競合しない。
+ */
+
+/**
+ * バス指定Set関数
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param can_id CAN ID (29bit有効値)
+ * @param dlc データ長 (0~64)
+ * @param data データ部へのポインタ (dlc=0の場合NULLも可)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_set(uint32_t bus, uint32_t can_id, uint16_t dlc, const uint8_t* data);
+
+/**
+ * バス指定Set関数（受信時刻指定版）
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param can_id CAN ID (29bit有効値)
+ * @param dlc データ長 (0~64)
+ * @param data データ部へのポインタ (dlc=0の場合NULLも可)
+ * @param timestamp 受信時刻（CLOCK_MONOTONIC基準[ns]、0の場合は現在時刻）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_set_timestamped(uint32_t bus, uint32_t can_id, uint16_t dlc,
+                                         const uint8_t* data, uint64_t timestamp);
+
+/**
+ * バス指定Set関数（バッチ版）
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param frames 格納するCANデータ配列 (can_id, dlc, dataを使用)
+ * @param count 配列の要素数
+ * @param stored_out 格納できたフレーム数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS if all frames stored, first error code otherwise
+ */
+CANShmResult can_shm_bus_set_batch(uint32_t bus, const CANData* frames, uint32_t count,
+                                   uint32_t* stored_out);
+
+/**
+ * バス指定Set関数（受信時刻指定バッチ版）
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param frames 格納するCANデータ配列 (can_id, dlc, data, timestampを使用)
+ * @param count 配列の要素数
+ * @param stored_out 格納できたフレーム数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS if all frames stored, first error code otherwise
+ */
+CANShmResult can_shm_bus_set_batch_timestamped(uint32_t bus, const CANData* frames,
+                                               uint32_t count, uint32_t* stored_out);
+
+/**
+ * バス指定Get関数
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param can_id CAN ID (29bit有効値)
+ * @param data_out 取得したCANデータの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_get(uint32_t bus, uint32_t can_id, CANData* data_out);
+
+/**
+ * CAN IDのスロット解決（Set/Getごとのハッシュ計算・探査を省くためのハンドル取得）
+ * 格納済みならそのバケット、未格納ならリニアプロービングで格納されるバケットを指す。
+ * 配置は can_shm_set_linear_probing と同じ（ハッシュ位置以外に格納された場合、
+ * can_shm_get では参照できない）。探査範囲（CAN_SHM_MAX_PROBE）に空きがなく
+ * 拡張領域に格納されるIDにはハンドルを使えない。
+ * 同じIDを can_shm_set（ハッシュ位置）とハンドル・リニアプロービング（探査先）の両方で
+ * 書き込まないこと（書き込みが別のバケットロックで行われ、購読キューの書き込み側が1つに限られなくなる）
+ * @param can_id CAN ID (29bit有効値)
+ * @param handle_out ハンドルの格納先
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the ID belongs to the extension table
+ */
+CANShmResult can_shm_resolve(uint32_t can_id, CANShmHandle* handle_out);
+
+/**
+ * バス指定のスロット解決
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param can_id CAN ID (29bit有効値)
+ * @param handle_out ハンドルの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_resolve(uint32_t bus, uint32_t can_id, CANShmHandle* handle_out);
+
+/**
+ * ハンドル経由のSet（ID検証・ハッシュ計算・探査を行わない）
+ * @param handle can_shm_resolve で取得したハンドル
+ * @param dlc データ長 (0~64)
+ * @param data データ
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_STALE if the handle must be resolved again
+ */
+CANShmResult can_shm_set_h(const CANShmHandle* handle, uint16_t dlc, const uint8_t* data);
+
+/**
+ * ハンドル経由のGet（ID検証・ハッシュ計算・探査を行わない）
+ * @param handle can_shm_resolve で取得したハンドル
+ * @param data_out 取得したCANデータの格納先
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if not stored yet,
+ *         CAN_SHM_ERROR_STALE if the handle must be resolved again
+ */
+CANShmResult can_shm_get_h(const CANShmHandle* handle, CANData* data_out);
+
+/**
+ * バス指定Subscribe関数（can_shm_subscribe_ex のバス指定版）
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param can_id CAN ID (29bit有効値)
+ * @param subscribe_count 配信回数 (0=無限回)
+ * @param timeout_ms 前回配信から次の配信までのタイムアウト[ミリ秒] (<0=タイムアウト無効)
+ * @param options 配信オプション (NULL=全ての更新を配信)
+ * @param callback データ受信時のコールバック関数
+ * @param user_data コールバック関数に渡すユーザーデータ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_subscribe_ex(uint32_t bus,
+                                      uint32_t can_id,
+                                      uint32_t subscribe_count,
+                                      int32_t timeout_ms,
+                                      const CANSubscribeOptions* options,
+                                      CANDataCallback callback,
+                                      void* user_data);
+
+/**
+ * バスのセグメント取得（未オープンなら作成またはオープン）
+ * C++ラッパーなど、seqlock読み取りをインライン展開する呼び出し側向け
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @return セグメントの先頭アドレス (未初期化・範囲外・失敗時はNULL)
+ */
+SharedMemoryLayout* can_shm_bus_segment(uint32_t bus);
+
+/**
+ * バス別統計情報取得
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param total_sets Set操作回数の格納先
+ * @param global_sequence 更新シーケンスの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_get_stats(uint32_t bus, uint64_t* total_sets, uint64_t* global_sequence);
+
+/**
+ * CAN IDごとの診断カウンタ取得（格納済みの全IDをバケット順に列挙）
+ * 更新回数・最終更新時刻・seqlockリトライ回数・購読者の起床回数を返す。
+ * カウンタはSet/Get/Subscribeの処理中にリラックスドアトミックで更新される
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param stats_out 診断カウンタの格納先配列
+ * @param max 配列の要素数
+ * @param count_out 格納件数の格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_bus_get_id_stats(uint32_t bus, CANIdStats* stats_out, uint32_t max,
+                                      uint32_t* count_out);
+
+/**
+ * 更新通知モードの設定（全体）
+ * On-changeモードでは、格納済みデータとDLC・データ部が同一のSetはタイムスタンプのみ更新し、
+ * 購読者への通知（global_sequence更新・ブロードキャスト）を行わない
+ * @param mode CAN_SHM_PUBLISH_ALWAYS または CAN_SHM_PUBLISH_ON_CHANGE
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_set_publish_mode(CANShmPublishMode mode);
+
+/**
+ * 更新通知モードの設定（CAN ID個別）
+ * 設定は格納先バケットに1つで、設定したIDのSetにのみ適用する。ホーム位置を共有する別IDは
+ * 全体設定に従い（無視マスクなし）、同じバケットに別IDを設定すると前の設定は置き換わる。
+ * リニアプロービングの削除で設定は消える。拡張領域のIDは全体設定のみ
+ * @param can_id CAN ID (29bit有効値)
+ * @param mode 通知モード (CAN_SHM_PUBLISH_DEFAULT=全体設定に従う)
+ * @param ignore_mask On-change比較で無視するbyte（bit i = data[i]、アライブカウンタ等）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_set_publish_mode_id(uint32_t can_id, CANShmPublishMode mode,
+                                         uint64_t ignore_mask);
+
+/**
+ * On-changeモードで通知を省略したSet回数の取得
+ * @param total_suppressed 省略回数の格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_get_suppressed_count(uint64_t* total_suppressed);
+
 /**
  * デバッグ用：共有メモリの状態を出力
  */
@@ -0,0 +1,112 @@
+#include "can_shm_clock.h"
+#include "can_shm_api.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#if CAN_SHM_CLOCK_HAVE_TSC
+#include <cpuid.h>
+#endif
+
+// 外部変数（can_shm_api.cで定義）
+extern SharedMemoryLayout* g_shm_ptr;
+extern int g_is_initialized;
+
+const CANClockCalibration* g_can_shm_clock = NULL;
+
+// 校正の測定間隔[ns]（校正誤差はおよそ clock_gettime の揺らぎ / 測定間隔）
+#define CLOCK_CALIBRATION_NS 20000000ULL
+
+// 1回の対応付けで読み直す回数（rdtscに挟まれた時間が最短のものを採用）
+#define CLOCK_SAMPLE_TRIES 8
+
+#if CAN_SHM_CLOCK_HAVE_TSC
+// 不変TSC（CPUID 0x80000007 EDX bit8）の確認
+static int has_invariant_tsc(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return 0;
+    }
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (edx & (1u << 8)) != 0;
+}
+
+// TSCとCLOCK_MONOTONICの同時刻の組を取得
+static void sample_pair(uint64_t* tsc_out, uint64_t* ns_out) {
+    uint64_t best_width = UINT64_MAX;
+    for (int i = 0; i < CLOCK_SAMPLE_TRIES; i++) {
+        uint64_t before = __rdtsc();
+        uint64_t ns = can_shm_clock_monotonic_ns();
+        uint64_t after = __rdtsc();
+        if (after - before < best_width) {
+            best_width = after - before;
+            *tsc_out = before + (after - before) / 2;
+            *ns_out = ns;
+        }
+    }
+}
+#endif
+
+void can_shm_clock_calibrate(CANClockCalibration* clock) {
+    memset(clock, 0, sizeof(CANClockCalibration));
+    clock->source = CAN_SHM_CLOCK_MONOTONIC;
+
+#if CAN_SHM_CLOCK_HAVE_TSC
+    if (!has_invariant_tsc()) {
+        return;
+    }
+
+    uint64_t tsc0, ns0, tsc1, ns1;
+    sample_pair(&tsc0, &ns0);
+    struct timespec wait = {0, (long)CLOCK_CALIBRATION_NS};
+    nanosleep(&wait, NULL);
+    sample_pair(&tsc1, &ns1);
+    if (tsc1 <= tsc0 || ns1 <= ns0) {
+        return;
+    }
+
+    clock->tsc_base = tsc1;
+    clock->ns_base = ns1;
+    clock->tsc_mult = (uint64_t)(((unsigned __int128)(ns1 - ns0) << 32) / (tsc1 - tsc0));
+    clock->tsc_calibrated = 1;
+
+    const char* env = getenv("CAN_SHM_CLOCK");
+    if (env == NULL || strcasecmp(env, "monotonic") != 0) {
+        clock->source = CAN_SHM_CLOCK_TSC;
+    }
+#endif
+}
+
+CANShmResult can_shm_clock_set_source(CANShmClockSource source) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (source != CAN_SHM_CLOCK_MONOTONIC && source != CAN_SHM_CLOCK_TSC) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    if (source == CAN_SHM_CLOCK_TSC && !g_shm_ptr->clock.tsc_calibrated) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    __atomic_store_n(&g_shm_ptr->clock.source, (uint32_t)source, __ATOMIC_RELEASE);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmClockSource can_shm_clock_get_source(void) {
+    const CANClockCalibration* clock = g_can_shm_clock;
+    if (clock == NULL) {
+        return CAN_SHM_CLOCK_MONOTONIC;
+    }
+    return (CANShmClockSource)__atomic_load_n(&clock->source, __ATOMIC_ACQUIRE);
+}
+
+uint64_t can_shm_clock_tsc_hz(void) {
+    const CANClockCalibration* clock = g_can_shm_clock;
+    if (clock == NULL || !clock->tsc_calibrated || clock->tsc_mult == 0) {
+        return 0;
+    }
+    return (uint64_t)((1000000000ULL << 32) / clock->tsc_mult);
+}
@@ -0,0 +1,105 @@
+#ifndef CAN_SHM_CLOCK_H
+#define CAN_SHM_CLOCK_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CAN_SHM_CLOCK_HAVE_TSC 1
+#else
+#define CAN_SHM_CLOCK_HAVE_TSC 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * フレームのタイムスタンプ用時刻源
+ * ================================
+ *
+ * Setの度に clock_gettime(CLOCK_MONOTONIC) を呼ぶ代わりに、不変TSC（rdtsc）を
+ * ナノ秒へ換算して使用する。換算パラメータはバス0のセグメント作成時に
+ * CLOCK_MONOTONIC を基準に1回だけ校正してセグメント内に置くため、
+ * 全プロセスが同じ換算を行い、タイムスタンプはプロセス間で比較できる。
+ *
+ * - CAN_SHM_CLOCK_TSC: 不変TSC（CPUIDで確認できた場合の既定）
+ * - CAN_SHM_CLOCK_MONOTONIC: clock_gettime(CLOCK_MONOTONIC)（vDSO経由、TSCが使えない場合の既定）
+ * - ハードウェアのタイムスタンプは can_shm_set_timestamped / can_shm_set_batch_timestamped で指定する
+ *
+ * TSC換算値は校正時点で CLOCK_MONOTONIC と一致し、以後は校正誤差（数ppm）分だけ
+ * 乖離しうる。時刻源はセグメント作成時に環境変数 CAN_SHM_CLOCK=monotonic で
+ * 固定することもできる。
+ */
+
+typedef enum {
+    CAN_SHM_CLOCK_MONOTONIC = 0,
+    CAN_SHM_CLOCK_TSC = 1
+} CANShmClockSource;
+
+// 現在プロセスの参照先（can_shm_init で設定、未初期化ならNULL）
+extern const CANClockCalibration* g_can_shm_clock;
+
+/**
+ * CLOCK_MONOTONIC の現在時刻[ns]
+ */
+static inline uint64_t can_shm_clock_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * TSC値のナノ秒換算
+ */
+static inline uint64_t can_shm_clock_tsc_to_ns(const CANClockCalibration* clock, uint64_t tsc) {
+    if (tsc < clock->tsc_base) {
+        return clock->ns_base;
+    }
+    return clock->ns_base + (uint64_t)(((unsigned __int128)(tsc - clock->tsc_base) * clock->tsc_mult) >> 32);
+}
+
+/**
+ * フレームのタイムスタンプ用の現在時刻[ns]
+ */
+static inline uint64_t can_shm_clock_now_ns(void) {
+#if CAN_SHM_CLOCK_HAVE_TSC
+    const CANClockCalibration* clock = g_can_shm_clock;
+    if (clock != NULL && __atomic_load_n(&clock->source, __ATOMIC_ACQUIRE) == CAN_SHM_CLOCK_TSC) {
+        return can_shm_clock_tsc_to_ns(clock, __rdtsc());
+    }
+#endif
+    return can_shm_clock_monotonic_ns();
+}
+
+/**
+ * 時刻源の切り替え（全プロセスに反映）
+ * @param source 時刻源
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_INVALID_PARAM if TSC is not available
+ */
+CANShmResult can_shm_clock_set_source(CANShmClockSource source);
+
+/**
+ * 現在の時刻源
+ */
+CANShmClockSource can_shm_clock_get_source(void);
+
+/**
+ * 校正済みTSC周波数[Hz]（TSCが使えなければ0）
+ */
+uint64_t can_shm_clock_tsc_hz(void);
+
+// 以下は can_shm_api.c から使用する内部関数
+
+/**
+ * TSCの校正と既定の時刻源の設定（セグメント作成時）
+ */
+void can_shm_clock_calibrate(CANClockCalibration* clock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_CLOCK_H
@@ -0,0 +1,410 @@
+#include "can_shm_compact.h"
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static CANCompactLayout* g_compact = NULL;
+static int g_compact_fd = -1;
+
+// 書き込み中スロットでのスピン回数上限（超えたらyield）
+#define COMPACT_SPIN_LIMIT 64
+
+// クラス別のデータ部サイズ・スロットサイズ・容量・プール内オフセット
+static const uint32_t k_payload_size[CAN_SHM_COMPACT_CLASSES] = {8, 16, 32, 64};
+static const uint32_t k_slot_size[CAN_SHM_COMPACT_CLASSES] = {
+    CAN_SHM_COMPACT_STRIDE(8), CAN_SHM_COMPACT_STRIDE(16),
+    CAN_SHM_COMPACT_STRIDE(32), CAN_SHM_COMPACT_STRIDE(64)
+};
+static const uint32_t k_capacity[CAN_SHM_COMPACT_CLASSES] = {
+    CAN_SHM_COMPACT_SLOTS_8, CAN_SHM_COMPACT_SLOTS_16,
+    CAN_SHM_COMPACT_SLOTS_32, CAN_SHM_COMPACT_SLOTS_64
+};
+static const uint32_t k_pool_offset[CAN_SHM_COMPACT_CLASSES] = {
+    0,
+    CAN_SHM_COMPACT_SLOTS_8 * CAN_SHM_COMPACT_STRIDE(8),
+    CAN_SHM_COMPACT_SLOTS_8 * CAN_SHM_COMPACT_STRIDE(8) +
+        CAN_SHM_COMPACT_SLOTS_16 * CAN_SHM_COMPACT_STRIDE(16),
+    CAN_SHM_COMPACT_SLOTS_8 * CAN_SHM_COMPACT_STRIDE(8) +
+        CAN_SHM_COMPACT_SLOTS_16 * CAN_SHM_COMPACT_STRIDE(16) +
+        CAN_SHM_COMPACT_SLOTS_32 * CAN_SHM_COMPACT_STRIDE(32)
+};
+
+// DLCを格納できる最小のクラス
+static uint32_t class_for_dlc(uint16_t dlc) {
+    uint32_t cls = 0;
+    while (cls + 1 < CAN_SHM_COMPACT_CLASSES && dlc > k_payload_size[cls]) {
+        cls++;
+    }
+    return cls;
+}
+
+static CANCompactSlotHeader* slot_at(uint32_t slot_ref) {
+    uint32_t cls = slot_ref >> 24;
+    uint32_t index = (slot_ref & 0xFFFFFF) - 1;
+    return (CANCompactSlotHeader*)(g_compact->pools + k_pool_offset[cls] + (size_t)index * k_slot_size[cls]);
+}
+
+static uint8_t* slot_payload(CANCompactSlotHeader* slot) {
+    return (uint8_t*)slot + CAN_SHM_COMPACT_HEADER_SIZE;
+}
+
+// 索引の検索（未登録ならNULL）
+static CANCompactIndexEntry* lookup(uint32_t can_id) {
+    uint32_t home = can_id_hash(can_id) & (CAN_SHM_COMPACT_INDEX_SIZE - 1);
+    for (uint32_t i = 0; i < CAN_SHM_COMPACT_INDEX_SIZE; i++) {
+        CANCompactIndexEntry* entry = &g_compact->index[(home + i) & (CAN_SHM_COMPACT_INDEX_SIZE - 1)];
+        if (__atomic_load_n(&entry->slot_ref, __ATOMIC_ACQUIRE) == 0) {
+            return NULL;
+        }
+        if (entry->can_id == can_id) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// プールからのスロット割り当て（alloc_mutex保持中、空きがなければ0）
+static uint32_t allocate_slot(uint32_t can_id, uint32_t cls) {
+    if (g_compact->pool_used[cls] >= k_capacity[cls]) {
+        return 0;
+    }
+    uint32_t slot_ref = (cls << 24) | (g_compact->pool_used[cls] + 1);
+    g_compact->pool_used[cls]++;
+
+    CANCompactSlotHeader* slot = slot_at(slot_ref);
+    slot->can_id = can_id;
+    slot->size_class = (uint8_t)cls;
+    return slot_ref;
+}
+
+// 書き手同士の排他を兼ねたseqlock書き込み開始（開始前のシーケンスを返す）
+static uint32_t lock_slot(CANCompactSlotHeader* slot) {
+    uint32_t spins = 0;
+    uint32_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    for (;;) {
+        if (!(seq & 1) &&
+            __atomic_compare_exchange_n(&slot->sequence, &seq, seq + 1, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            // 奇数シーケンスをデータ部より先に見せる
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return seq;
+        }
+        if (++spins >= COMPACT_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+        seq = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    }
+}
+
+static void unlock_slot(CANCompactSlotHeader* slot, uint32_t seq) {
+    __atomic_store_n(&slot->sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * IDの登録（登録済みならその索引エントリ）
+ */
+static CANShmResult register_id(uint32_t can_id, uint32_t cls, CANCompactIndexEntry** entry_out) {
+    pthread_mutex_lock(&g_compact->alloc_mutex);
+
+    CANShmResult result = CAN_SHM_ERROR_NOT_FOUND;
+    uint32_t home = can_id_hash(can_id) & (CAN_SHM_COMPACT_INDEX_SIZE - 1);
+    for (uint32_t i = 0; i < CAN_SHM_COMPACT_INDEX_SIZE; i++) {
+        CANCompactIndexEntry* entry = &g_compact->index[(home + i) & (CAN_SHM_COMPACT_INDEX_SIZE - 1)];
+        if (entry->slot_ref != 0) {
+            if (entry->can_id == can_id) {
+                *entry_out = entry;
+                result = CAN_SHM_SUCCESS;
+                break;
+            }
+            continue;
+        }
+
+        uint32_t slot_ref = allocate_slot(can_id, cls);
+        if (slot_ref == 0) {
+            break;
+        }
+        entry->can_id = can_id;
+        __atomic_store_n(&entry->slot_ref, slot_ref, __ATOMIC_RELEASE);
+        g_compact->entries++;
+        *entry_out = entry;
+        result = CAN_SHM_SUCCESS;
+        break;
+    }
+
+    pthread_mutex_unlock(&g_compact->alloc_mutex);
+    return result;
+}
+
+/**
+ * 上位クラスへの移動（旧スロットには移動済みの印を付ける）
+ */
+static CANShmResult move_to_class(CANCompactIndexEntry* entry, uint32_t cls) {
+    pthread_mutex_lock(&g_compact->alloc_mutex);
+
+    uint32_t old_ref = entry->slot_ref;
+    if ((old_ref >> 24) >= cls) {
+        pthread_mutex_unlock(&g_compact->alloc_mutex);
+        return CAN_SHM_SUCCESS;  // 他の書き手が移動済み
+    }
+
+    uint32_t new_ref = allocate_slot(entry->can_id, cls);
+    if (new_ref == 0) {
+        pthread_mutex_unlock(&g_compact->alloc_mutex);
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    CANCompactSlotHeader* old_slot = slot_at(old_ref);
+    CANCompactSlotHeader* new_slot = slot_at(new_ref);
+    uint32_t seq = lock_slot(old_slot);
+
+    new_slot->timestamp = old_slot->timestamp;
+    new_slot->dlc = old_slot->dlc;
+    memcpy(slot_payload(new_slot), slot_payload(old_slot), old_slot->dlc);
+    __atomic_store_n(&new_slot->sequence, seq == 0 ? 0 : seq + 2, __ATOMIC_RELEASE);  // 未書き込みなら0のまま
+    __atomic_store_n(&entry->slot_ref, new_ref, __ATOMIC_RELEASE);
+
+    old_slot->size_class |= CAN_SHM_COMPACT_MOVED;
+    unlock_slot(old_slot, seq);
+    g_compact->moves++;
+
+    pthread_mutex_unlock(&g_compact->alloc_mutex);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_compact_init(void) {
+    return can_shm_compact_init_named(NULL);
+}
+
+CANShmResult can_shm_compact_init_named(const char* shm_name) {
+    if (g_compact != NULL) {
+        return CAN_SHM_SUCCESS;
+    }
+
+    int fd = shm_open(shm_name != NULL ? shm_name : SHM_COMPACT_NAME, O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        perror("shm_open");
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    struct stat shm_stat;
+    if (fstat(fd, &shm_stat) == 0 && shm_stat.st_size < (off_t)sizeof(CANCompactLayout)) {
+        if (ftruncate(fd, sizeof(CANCompactLayout)) == -1) {
+            perror("ftruncate");
+            close(fd);
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+    }
+
+    CANCompactLayout* layout = (CANCompactLayout*)mmap(NULL, sizeof(CANCompactLayout),
+                                                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (layout == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    // 初期化チェック（マジックナンバー・レイアウトバージョン）
+    if (layout->magic_number != MAGIC_NUMBER || layout->version != CAN_SHM_COMPACT_LAYOUT_VERSION) {
+        memset(layout, 0, sizeof(CANCompactLayout));
+
+        pthread_mutexattr_t mutex_attr;
+        pthread_mutexattr_init(&mutex_attr);
+        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutex_init(&layout->alloc_mutex, &mutex_attr);
+        pthread_mutexattr_destroy(&mutex_attr);
+
+        layout->version = CAN_SHM_COMPACT_LAYOUT_VERSION;
+        __atomic_store_n(&layout->magic_number, MAGIC_NUMBER, __ATOMIC_RELEASE);
+    }
+
+    g_compact_fd = fd;
+    g_compact = layout;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_compact_cleanup(void) {
+    if (g_compact == NULL) {
+        return CAN_SHM_SUCCESS;
+    }
+
+    munmap(g_compact, sizeof(CANCompactLayout));
+    close(g_compact_fd);
+    g_compact = NULL;
+    g_compact_fd = -1;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_compact_reserve(uint32_t can_id, uint16_t max_dlc) {
+    if (g_compact == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+
+    if (max_dlc > 64) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t cls = class_for_dlc(max_dlc);
+    CANCompactIndexEntry* entry;
+    CANShmResult result = register_id(can_id, cls, &entry);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    if ((__atomic_load_n(&entry->slot_ref, __ATOMIC_ACQUIRE) >> 24) < cls) {
+        return move_to_class(entry, cls);
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_compact_set(uint32_t can_id, uint16_t dlc, const uint8_t* data) {
+    if (g_compact == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    // パラメータ検証
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+
+    if (dlc > 64) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    if (dlc > 0 && data == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    uint64_t timestamp = can_shm_clock_now_ns();
+    uint32_t cls = class_for_dlc(dlc);
+
+    for (;;) {
+        CANCompactIndexEntry* entry = lookup(can_id);
+        if (entry == NULL) {
+            CANShmResult result = register_id(can_id, cls, &entry);
+            if (result != CAN_SHM_SUCCESS) {
+                return result;
+            }
+        }
+
+        uint32_t slot_ref = __atomic_load_n(&entry->slot_ref, __ATOMIC_ACQUIRE);
+        if ((slot_ref >> 24) < cls) {
+            CANShmResult result = move_to_class(entry, cls);
+            if (result != CAN_SHM_SUCCESS) {
+                return result;
+            }
+            continue;
+        }
+
+        CANCompactSlotHeader* slot = slot_at(slot_ref);
+        uint32_t seq = lock_slot(slot);
+        if (slot->size_class & CAN_SHM_COMPACT_MOVED) {
+            unlock_slot(slot, seq);
+            continue;  // 書き込み待ちの間に移動された
+        }
+
+        // データ部はDLC分のみ書き込み、前回より短ければ差分だけ0にする
+        uint8_t* payload = slot_payload(slot);
+        if (dlc > 0) {
+            memcpy(payload, data, dlc);
+        }
+        if (slot->dlc > dlc) {
+            memset(payload + dlc, 0, slot->dlc - dlc);
+        }
+        slot->dlc = dlc;
+        slot->timestamp = timestamp;
+
+        unlock_slot(slot, seq);
+        return CAN_SHM_SUCCESS;
+    }
+}
+
+CANShmResult can_shm_compact_get(uint32_t can_id, CANData* data_out) {
+    if (g_compact == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (!is_valid_can_id(can_id) || data_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    for (;;) {
+        CANCompactIndexEntry* entry = lookup(can_id);
+        if (entry == NULL) {
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+
+        uint32_t slot_ref = __atomic_load_n(&entry->slot_ref, __ATOMIC_ACQUIRE);
+        CANCompactSlotHeader* slot = slot_at(slot_ref);
+        uint32_t payload_size = k_payload_size[slot_ref >> 24];
+
+        // seqlock読み取り（ロックフリー）
+        uint32_t seq1, seq2;
+        uint16_t dlc = 0;
+        uint8_t size_class = 0;
+        do {
+            seq1 = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+            if (seq1 & 1) continue; // 書き込み中
+
+            dlc = slot->dlc;
+            if (dlc > payload_size) {
+                dlc = (uint16_t)payload_size;  // 書き込み途中の値（リトライで破棄される）
+            }
+            size_class = slot->size_class;
+            data_out->timestamp = slot->timestamp;
+            memcpy(data_out->data, slot_payload(slot), dlc);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            seq2 = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+        } while ((seq1 & 1) || seq1 != seq2);
+
+        if (size_class & CAN_SHM_COMPACT_MOVED) {
+            continue;  // 索引から移動先を引き直す
+        }
+        if (seq1 == 0) {
+            return CAN_SHM_ERROR_NOT_FOUND;  // 登録のみで未書き込み
+        }
+
+        data_out->sequence = seq1;
+        data_out->can_id = can_id;
+        data_out->dlc = dlc;
+        if (dlc < 64) {
+            memset(&data_out->data[dlc], 0, 64 - dlc);
+        }
+        return CAN_SHM_SUCCESS;
+    }
+}
+
+CANShmResult can_shm_compact_get_info(CANCompactInfo* info_out) {
+    if (g_compact == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (info_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    memset(info_out, 0, sizeof(CANCompactInfo));
+    pthread_mutex_lock(&g_compact->alloc_mutex);
+    info_out->segment_size = sizeof(CANCompactLayout);
+    info_out->entries = g_compact->entries;
+    info_out->moves = g_compact->moves;
+    for (uint32_t cls = 0; cls < CAN_SHM_COMPACT_CLASSES; cls++) {
+        info_out->payload_size[cls] = k_payload_size[cls];
+        info_out->slot_size[cls] = k_slot_size[cls];
+        info_out->used[cls] = g_compact->pool_used[cls];
+        info_out->capacity[cls] = k_capacity[cls];
+    }
+    pthread_mutex_unlock(&g_compact->alloc_mutex);
+    return CAN_SHM_SUCCESS;
+}
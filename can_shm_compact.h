@@ -0,0 +1,95 @@
+#ifndef CAN_SHM_COMPACT_H
+#define CAN_SHM_COMPACT_H
+
+#include "can_shm_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * サイズクラス別スロットの省メモリテーブル
+ * ========================================
+ *
+ * 通常のテーブル（CANBucket）は全IDに64byteのデータ部とミューテックスを持つが、
+ * 大半のIDはclassic CANの8byteフレームである。本テーブルはデータ部を
+ * 8/16/32/64byteのクラス別プールから割り当て、IDごとに必要なクラスだけを使う。
+ *
+ * - 8byteクラスのスロットはヘッダ込み32byteで、1キャッシュラインに収まる
+ * - クラスは登録時（can_shm_compact_reserve、または初回Set時のDLC）に決まる。
+ *   より大きいDLCのSetが来た場合は上位クラスへ移動する（旧スロットは再利用しない）
+ * - Set/Getはスロット単位のseqlockのみで、データ部のコピーはDLC分だけ
+ * - 別セグメント（SHM_COMPACT_NAME）で、can_shm_init とは独立に使用できる
+ * - 更新通知（Subscribe）は行わない。購読が必要なIDは通常のテーブルを使用する
+ */
+
+// 使用状況
+typedef struct {
+    size_t   segment_size;                          // セグメントのサイズ[byte]
+    uint32_t entries;                               // 登録済みID数
+    uint32_t moves;                                 // 上位クラスへの移動回数
+    uint32_t payload_size[CAN_SHM_COMPACT_CLASSES]; // クラスのデータ部サイズ
+    uint32_t slot_size[CAN_SHM_COMPACT_CLASSES];    // ヘッダ込みのスロットサイズ
+    uint32_t used[CAN_SHM_COMPACT_CLASSES];
+    uint32_t capacity[CAN_SHM_COMPACT_CLASSES];
+} CANCompactInfo;
+
+/**
+ * 省メモリテーブルの初期化（セグメントの作成またはマップ）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_compact_init(void);
+
+/**
+ * 省メモリテーブルの初期化（セグメント名指定版、テストなど本番と別のテーブルを使う場合）
+ * @param shm_name セグメント名（NULL=SHM_COMPACT_NAME）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_compact_init_named(const char* shm_name);
+
+/**
+ * 省メモリテーブルの終了処理（アンマップのみ、データは保持される）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_compact_cleanup(void);
+
+/**
+ * CAN IDの事前登録（データ部の最大長からクラスを決定）
+ * CAN FDでDLCが変化するIDは最大長で登録しておくと上位クラスへの移動が起きない
+ * @param can_id CAN ID (29bit有効値)
+ * @param max_dlc データ部の最大長 (0~64)
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the index or pool is full
+ */
+CANShmResult can_shm_compact_reserve(uint32_t can_id, uint16_t max_dlc);
+
+/**
+ * Set関数（未登録のIDはDLCに合うクラスで登録）
+ * @param can_id CAN ID (29bit有効値)
+ * @param dlc データ長 (0~64)
+ * @param data データ部へのポインタ (dlc=0の場合NULLも可)
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the index or pool is full
+ */
+CANShmResult can_shm_compact_set(uint32_t can_id, uint16_t dlc, const uint8_t* data);
+
+/**
+ * Get関数（data_out->data のDLC以降は0）
+ * @param can_id CAN ID (29bit有効値)
+ * @param data_out 取得したCANデータの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_compact_get(uint32_t can_id, CANData* data_out);
+
+/**
+ * 使用状況の取得
+ * @param info_out 格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_compact_get_info(CANCompactInfo* info_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_COMPACT_H
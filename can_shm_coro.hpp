@@ -0,0 +1,332 @@
+#ifndef CAN_SHM_CORO_HPP
+#define CAN_SHM_CORO_HPP
+
+/*
+ * コルーチン対応の購読（ヘッダオンリー、C++20）
+ * =============================================
+ *
+ * can_shm_subscribe は購読1件ごとにOSスレッドを1つ待機させるため、
+ * プロセス内の同時購読数がスレッド数で制限される。
+ * ここでは購読をコルーチンの co_await として表現し、1つの Executor が
+ * 全ての待機中の購読をまとめて扱う。
+ *
+ * - Executor はセグメントの update_condition（更新通知）で待機し、起床するたびに
+ *   待機中の購読のバケット change_sequence を確認して到達したものだけ再開する
+ * - 待機開始前に global_sequence を記録し、その値が変わっていない場合のみ待機するため
+ *   確認と待機の間の更新を取りこぼさない
+ * - Executor は単一スレッドで run() を呼び出すこと（スレッドセーフではない）
+ *
+ * 使用例:
+ *   can_shm::Segment seg;
+ *   can_shm::Executor ex(seg);
+ *   ex.spawn([](can_shm::Executor& ex) -> can_shm::Task {
+ *       auto sub = ex.subscribe(0x123);
+ *       while (auto data = co_await sub.next()) { use(*data); }
+ *   }(ex));
+ *   ex.run();
+ */
+
+#include "can_shm.hpp"
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cerrno>
+#include <ctime>
+#include <exception>
+#include <optional>
+#include <vector>
+
+namespace can_shm {
+
+class Executor;
+
+// Executorで実行するコルーチン（spawn されるまで開始しない）
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() noexcept {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }  // 破棄はExecutorが行う
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+private:
+    friend class Executor;
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 次の更新を待つ awaiter（co_await の結果はタイムアウト時 std::nullopt）
+class NextAwaiter {
+public:
+    bool await_ready() noexcept { return try_complete(); }
+    void await_suspend(std::coroutine_handle<> handle);
+    std::optional<CANData> await_resume() noexcept { return result_; }
+
+private:
+    friend class Executor;
+    friend class Subscription;
+
+    NextAwaiter(Executor* executor, Slot slot, uint32_t target, uint32_t* last_sequence,
+                uint64_t deadline_ns) noexcept
+        : executor_(executor), slot_(slot), target_(target), last_sequence_(last_sequence),
+          deadline_ns_(deadline_ns) {}
+
+    // change_sequence が target に達していれば最新値を取得（1=完了）
+    bool try_complete() noexcept {
+        uint32_t seq = slot_.change_sequence();
+        if (static_cast<int32_t>(seq - target_) < 0) {
+            return false;
+        }
+        CANData data;
+        if (!slot_.read(data)) {
+            target_ = seq + 1;  // 同一バケットの別IDによる更新
+            return false;
+        }
+        result_ = data;
+        if (last_sequence_ != nullptr) {
+            *last_sequence_ = seq;
+        }
+        return true;
+    }
+
+    Executor* executor_;
+    Slot slot_;
+    uint32_t target_;
+    uint32_t* last_sequence_;
+    uint64_t deadline_ns_;  // CLOCK_MONOTONIC[ns]、0=無期限
+    std::optional<CANData> result_;
+    std::coroutine_handle<> handle_;
+};
+
+// CAN IDの更新列（前回受け取った更新以降の変化を順に待つ）
+class Subscription {
+public:
+    /**
+     * 次の更新（前回の next() 以降に更新済みなら即座に最新値）
+     * @param timeout 待機上限（負値=無期限）
+     */
+    NextAwaiter next(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1)) noexcept;
+
+    uint32_t can_id() const noexcept { return slot_.can_id(); }
+
+private:
+    friend class Executor;
+    Subscription(Executor* executor, Slot slot) noexcept
+        : executor_(executor), slot_(slot), last_sequence_(slot.change_sequence()) {}
+
+    Executor* executor_;
+    Slot slot_;
+    uint32_t last_sequence_;
+};
+
+// 待機中の購読を多重化して再開する実行器
+class Executor {
+public:
+    explicit Executor(const Segment& segment) noexcept : segment_(segment) {}
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    ~Executor() {
+        for (auto handle : tasks_) {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * コルーチンの登録（run() 内で開始される）
+     */
+    void spawn(Task task) {
+        auto handle = task.handle_;
+        task.handle_ = nullptr;
+        tasks_.push_back(handle);
+        ready_.push_back(handle);
+    }
+
+    /**
+     * CAN IDの次の更新（呼び出し時点以降の変化）
+     * @param timeout 待機上限（負値=無期限）
+     */
+    NextAwaiter next(uint32_t can_id,
+                     std::chrono::milliseconds timeout = std::chrono::milliseconds(-1)) {
+        Slot slot = segment_.slot(can_id);
+        return NextAwaiter(this, slot, slot.change_sequence() + 1, nullptr, deadline_after(timeout));
+    }
+
+    /**
+     * CAN IDの更新列の作成
+     */
+    Subscription subscribe(uint32_t can_id) {
+        return Subscription(this, segment_.slot(can_id));
+    }
+
+    /**
+     * 全てのコルーチンが完了するか stop() されるまで実行
+     */
+    void run() {
+        stopped_ = false;
+        while (!tasks_.empty() && !stopped_) {
+            run_once(0);
+        }
+    }
+
+    /**
+     * 指定時間だけ実行
+     */
+    void run_for(std::chrono::milliseconds duration) {
+        stopped_ = false;
+        uint64_t until = now_ns() + static_cast<uint64_t>(duration.count()) * 1000000ULL;
+        while (!tasks_.empty() && !stopped_ && now_ns() < until) {
+            run_once(until);
+        }
+    }
+
+    // 実行中のコルーチンから呼び出して run() を終了させる
+    void stop() noexcept { stopped_ = true; }
+
+    size_t task_count() const noexcept { return tasks_.size(); }
+    size_t pending_count() const noexcept { return pending_.size(); }
+
+private:
+    friend class NextAwaiter;
+    friend class Subscription;
+
+    static uint64_t now_ns() noexcept {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    static uint64_t deadline_after(std::chrono::milliseconds timeout) noexcept {
+        if (timeout.count() < 0) {
+            return 0;
+        }
+        return now_ns() + static_cast<uint64_t>(timeout.count()) * 1000000ULL;
+    }
+
+    void enqueue(NextAwaiter* awaiter) { pending_.push_back(awaiter); }
+
+    uint64_t global_sequence() const noexcept {
+        SharedMemoryLayout* shm = segment_.layout();
+        pthread_mutex_lock(&shm->global_mutex);
+        uint64_t seq = shm->global_sequence;
+        pthread_mutex_unlock(&shm->global_mutex);
+        return seq;
+    }
+
+    // 実行可能なコルーチンを再開し、なければ更新通知を待つ
+    void run_once(uint64_t run_until_ns) {
+        uint64_t seen = global_sequence();
+
+        resume_ready();
+        if (tasks_.empty() || stopped_) {
+            return;
+        }
+
+        // 到達・期限切れの購読を再開対象へ
+        uint64_t now = now_ns();
+        uint64_t wake_ns = run_until_ns;
+        for (size_t i = 0; i < pending_.size();) {
+            NextAwaiter* awaiter = pending_[i];
+            bool expired = awaiter->deadline_ns_ != 0 && now >= awaiter->deadline_ns_;
+            if (awaiter->try_complete() || expired) {
+                ready_.push_back(awaiter->handle_);
+                pending_[i] = pending_.back();
+                pending_.pop_back();
+                continue;
+            }
+            if (awaiter->deadline_ns_ != 0 && (wake_ns == 0 || awaiter->deadline_ns_ < wake_ns)) {
+                wake_ns = awaiter->deadline_ns_;
+            }
+            i++;
+        }
+
+        if (ready_.empty()) {
+            wait_for_update(seen, wake_ns);
+        }
+    }
+
+    void resume_ready() {
+        while (!ready_.empty()) {
+            std::vector<std::coroutine_handle<>> batch;
+            batch.swap(ready_);
+            for (auto handle : batch) {
+                handle.resume();
+                if (handle.done()) {
+                    release(handle);
+                }
+            }
+        }
+    }
+
+    void release(std::coroutine_handle<> handle) {
+        for (size_t i = 0; i < tasks_.size(); i++) {
+            if (tasks_[i] == handle) {
+                tasks_[i] = tasks_.back();
+                tasks_.pop_back();
+                break;
+            }
+        }
+        handle.destroy();
+    }
+
+    // global_sequence が seen から進むか wake_ns（0=無期限）まで待機
+    void wait_for_update(uint64_t seen, uint64_t wake_ns) {
+        SharedMemoryLayout* shm = segment_.layout();
+        struct timespec abs;
+        clock_gettime(CLOCK_REALTIME, &abs);
+        // 停止要求の確認のため待機は最大100ms
+        uint64_t wait_ns = 100000000ULL;
+        if (wake_ns != 0) {
+            uint64_t now = now_ns();
+            wait_ns = wake_ns > now ? std::min<uint64_t>(wake_ns - now, wait_ns) : 0;
+        }
+        uint64_t nsec = static_cast<uint64_t>(abs.tv_nsec) + wait_ns;
+        abs.tv_sec += static_cast<time_t>(nsec / 1000000000ULL);
+        abs.tv_nsec = static_cast<long>(nsec % 1000000000ULL);
+
+        pthread_mutex_lock(&shm->global_mutex);
+        while (shm->global_sequence == seen) {
+            if (pthread_cond_timedwait(&shm->update_condition, &shm->global_mutex, &abs) == ETIMEDOUT) {
+                break;
+            }
+        }
+        pthread_mutex_unlock(&shm->global_mutex);
+    }
+
+    const Segment& segment_;
+    std::vector<std::coroutine_handle<>> tasks_;   // 生存中のコルーチン
+    std::vector<std::coroutine_handle<>> ready_;   // 再開待ち
+    std::vector<NextAwaiter*> pending_;            // 更新待ち
+    bool stopped_ = false;
+};
+
+inline void NextAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    executor_->enqueue(this);
+}
+
+inline NextAwaiter Subscription::next(std::chrono::milliseconds timeout) noexcept {
+    return NextAwaiter(executor_, slot_, last_sequence_ + 1, &last_sequence_,
+                       Executor::deadline_after(timeout));
+}
+
+}  // namespace can_shm
+
+#endif  // CAN_SHM_CORO_HPP
@@ -0,0 +1,484 @@
+#include "can_shm_dispatch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// 既定値
+#define DISPATCH_DEFAULT_QUEUE_DEPTH 64
+#define DISPATCH_DEFAULT_MAX_IDS 1024
+
+// ストランドを連続実行する最大フレーム数（超えたら実行キューへ戻して他のストランドに譲る）
+#define DISPATCH_STRAND_BATCH 16
+
+// 未実行のフレーム
+typedef struct {
+    CANData data;
+    CANDataCallback callback;
+    void* user_data;
+} DispatchItem;
+
+// CAN IDごとの実行単位（同時に1つのワーカーだけが実行する）
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t space;       // BLOCK時の空き待ち
+    uint32_t can_id;
+    uint32_t in_use;
+    uint32_t head;
+    uint32_t count;
+    uint32_t scheduled;         // 実行キューに積まれているか実行中
+    DispatchItem* items;        // queue_depth 要素のリング
+} DispatchStrand;
+
+// ワーカーごとの実行キュー（ストランド番号のリング、容量 max_ids）
+typedef struct {
+    pthread_mutex_t mutex;
+    uint32_t* ring;
+    uint32_t head;
+    uint32_t count;
+    pthread_t thread;
+    CANDispatcher* owner;
+    uint32_t index;
+} DispatchWorker;
+
+struct CANDispatcher {
+    uint32_t worker_count;
+    uint32_t queue_depth;       // 2のべき乗
+    uint32_t max_ids;
+    uint32_t table_size;        // ストランド表のサイズ（2のべき乗、max_idsの2倍以上）
+    uint32_t strand_count;
+    CANDispatchPolicy policy;
+
+    DispatchStrand* strands;
+    pthread_mutex_t table_mutex;    // ストランドの割り当て
+    DispatchWorker* workers;
+    uint32_t workers_started;
+
+    pthread_mutex_t idle_mutex;
+    pthread_cond_t work_cond;       // 実行待ちストランドの到着
+    pthread_cond_t drained_cond;    // 未実行フレームが0になった
+    uint32_t ready;                 // 実行キュー上のストランド数（idle_mutexで保護）
+    int stopping;
+
+    uint64_t in_flight;             // 未実行のフレーム数
+    uint32_t next_worker;           // 投入先ワーカー（ラウンドロビン）
+    CANDispatcherStats stats;
+};
+
+static uint32_t round_up_pow2(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static void stat_add(uint64_t* counter, uint64_t n) {
+    __atomic_add_fetch(counter, n, __ATOMIC_RELAXED);
+}
+
+// CAN IDのストランド番号（未割り当てなら割り当て、満杯なら-1）
+static int32_t find_strand(CANDispatcher* dispatcher, uint32_t can_id) {
+    uint32_t mask = dispatcher->table_size - 1;
+    uint32_t home = can_id_hash(can_id) & mask;
+
+    // 割り当て済みストランドは削除されないためロックなしで探索できる
+    for (uint32_t i = 0; i < dispatcher->table_size; i++) {
+        DispatchStrand* strand = &dispatcher->strands[(home + i) & mask];
+        if (!__atomic_load_n(&strand->in_use, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        if (strand->can_id == can_id) {
+            return (int32_t)((home + i) & mask);
+        }
+    }
+
+    int32_t found = -1;
+    pthread_mutex_lock(&dispatcher->table_mutex);
+    for (uint32_t i = 0; i < dispatcher->table_size; i++) {
+        uint32_t index = (home + i) & mask;
+        DispatchStrand* strand = &dispatcher->strands[index];
+        if (strand->in_use) {
+            if (strand->can_id == can_id) {
+                found = (int32_t)index;
+                break;
+            }
+            continue;
+        }
+        if (dispatcher->strand_count < dispatcher->max_ids) {
+            strand->can_id = can_id;
+            __atomic_store_n(&strand->in_use, 1, __ATOMIC_RELEASE);
+            dispatcher->strand_count++;
+            found = (int32_t)index;
+        }
+        break;
+    }
+    pthread_mutex_unlock(&dispatcher->table_mutex);
+    return found;
+}
+
+// ストランドをワーカーの実行キューへ積んで待機中のワーカーを起こす
+static void schedule_strand(CANDispatcher* dispatcher, uint32_t strand_index, uint32_t worker_index) {
+    DispatchWorker* worker = &dispatcher->workers[worker_index];
+    pthread_mutex_lock(&worker->mutex);
+    worker->ring[(worker->head + worker->count) % dispatcher->max_ids] = strand_index;
+    worker->count++;
+    pthread_mutex_unlock(&worker->mutex);
+
+    pthread_mutex_lock(&dispatcher->idle_mutex);
+    dispatcher->ready++;
+    pthread_cond_signal(&dispatcher->work_cond);
+    pthread_mutex_unlock(&dispatcher->idle_mutex);
+}
+
+// 自分のキューの先頭から取り出す（1=取得）
+static int pop_own(DispatchWorker* worker, uint32_t capacity, uint32_t* strand_out) {
+    int found = 0;
+    pthread_mutex_lock(&worker->mutex);
+    if (worker->count > 0) {
+        *strand_out = worker->ring[worker->head];
+        worker->head = (worker->head + 1) % capacity;
+        worker->count--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&worker->mutex);
+    return found;
+}
+
+// 他のワーカーのキューの末尾から盗む（1=取得）
+static int steal(DispatchWorker* victim, uint32_t capacity, uint32_t* strand_out) {
+    int found = 0;
+    pthread_mutex_lock(&victim->mutex);
+    if (victim->count > 0) {
+        victim->count--;
+        *strand_out = victim->ring[(victim->head + victim->count) % capacity];
+        found = 1;
+    }
+    pthread_mutex_unlock(&victim->mutex);
+    return found;
+}
+
+// フレーム1件の完了（未実行数が0になったら drain を起こす）
+static void finish_items(CANDispatcher* dispatcher, uint64_t n) {
+    if (__atomic_sub_fetch(&dispatcher->in_flight, n, __ATOMIC_ACQ_REL) == 0) {
+        pthread_mutex_lock(&dispatcher->idle_mutex);
+        pthread_cond_broadcast(&dispatcher->drained_cond);
+        pthread_mutex_unlock(&dispatcher->idle_mutex);
+    }
+}
+
+// ストランドのフレームを投入順に実行
+static void run_strand(CANDispatcher* dispatcher, DispatchWorker* worker, uint32_t strand_index) {
+    DispatchStrand* strand = &dispatcher->strands[strand_index];
+    uint32_t mask = dispatcher->queue_depth - 1;
+
+    for (uint32_t n = 0;; n++) {
+        pthread_mutex_lock(&strand->mutex);
+        if (strand->count == 0) {
+            strand->scheduled = 0;
+            pthread_mutex_unlock(&strand->mutex);
+            return;
+        }
+        if (n == DISPATCH_STRAND_BATCH) {
+            // scheduled のまま自分のキューの末尾へ戻す
+            pthread_mutex_unlock(&strand->mutex);
+            schedule_strand(dispatcher, strand_index, worker->index);
+            return;
+        }
+        DispatchItem item = strand->items[strand->head];
+        strand->head = (strand->head + 1) & mask;
+        strand->count--;
+        if (dispatcher->policy == CAN_DISPATCH_BLOCK) {
+            pthread_cond_signal(&strand->space);
+        }
+        pthread_mutex_unlock(&strand->mutex);
+
+        item.callback(strand->can_id, &item.data, item.user_data);
+        stat_add(&dispatcher->stats.executed, 1);
+        finish_items(dispatcher, 1);
+    }
+}
+
+static void* worker_thread(void* arg) {
+    DispatchWorker* worker = (DispatchWorker*)arg;
+    CANDispatcher* dispatcher = worker->owner;
+
+    for (;;) {
+        pthread_mutex_lock(&dispatcher->idle_mutex);
+        while (dispatcher->ready == 0 && !dispatcher->stopping) {
+            pthread_cond_wait(&dispatcher->work_cond, &dispatcher->idle_mutex);
+        }
+        if (dispatcher->stopping) {
+            pthread_mutex_unlock(&dispatcher->idle_mutex);
+            break;
+        }
+        dispatcher->ready--;  // 実行キュー上のストランドを1つ予約
+        pthread_mutex_unlock(&dispatcher->idle_mutex);
+
+        // 予約したストランドはいずれかのキューに必ず存在する
+        uint32_t strand_index = 0;
+        int found = pop_own(worker, dispatcher->max_ids, &strand_index);
+        while (!found) {
+            for (uint32_t i = 1; i <= dispatcher->worker_count && !found; i++) {
+                DispatchWorker* victim = &dispatcher->workers[(worker->index + i) % dispatcher->worker_count];
+                found = victim == worker ? pop_own(worker, dispatcher->max_ids, &strand_index)
+                                         : steal(victim, dispatcher->max_ids, &strand_index);
+                if (found && victim != worker) {
+                    stat_add(&dispatcher->stats.stolen, 1);
+                }
+            }
+        }
+
+        run_strand(dispatcher, worker, strand_index);
+    }
+    return NULL;
+}
+
+CANShmResult can_shm_dispatcher_create(const CANDispatcherConfig* config, CANDispatcher** dispatcher_out) {
+    if (dispatcher_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANDispatcherConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    if (config != NULL) {
+        cfg = *config;
+    }
+    if (cfg.policy != CAN_DISPATCH_DROP_NEWEST && cfg.policy != CAN_DISPATCH_DROP_OLDEST &&
+        cfg.policy != CAN_DISPATCH_BLOCK) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    if (cfg.worker_count == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cfg.worker_count = cpus > 0 ? (uint32_t)cpus : 1;
+    }
+    if (cfg.queue_depth == 0) {
+        cfg.queue_depth = DISPATCH_DEFAULT_QUEUE_DEPTH;
+    }
+    if (cfg.max_ids == 0) {
+        cfg.max_ids = DISPATCH_DEFAULT_MAX_IDS;
+    }
+
+    CANDispatcher* dispatcher = (CANDispatcher*)calloc(1, sizeof(CANDispatcher));
+    if (dispatcher == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    dispatcher->worker_count = cfg.worker_count;
+    dispatcher->queue_depth = round_up_pow2(cfg.queue_depth);
+    dispatcher->max_ids = cfg.max_ids;
+    dispatcher->table_size = round_up_pow2(cfg.max_ids * 2);
+    dispatcher->policy = cfg.policy;
+
+    pthread_mutex_init(&dispatcher->table_mutex, NULL);
+    pthread_mutex_init(&dispatcher->idle_mutex, NULL);
+    pthread_cond_init(&dispatcher->work_cond, NULL);
+    pthread_cond_init(&dispatcher->drained_cond, NULL);
+
+    dispatcher->strands = (DispatchStrand*)calloc(dispatcher->table_size, sizeof(DispatchStrand));
+    dispatcher->workers = (DispatchWorker*)calloc(dispatcher->worker_count, sizeof(DispatchWorker));
+    if (dispatcher->strands == NULL || dispatcher->workers == NULL) {
+        can_shm_dispatcher_destroy(dispatcher);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    for (uint32_t i = 0; i < dispatcher->table_size; i++) {
+        DispatchStrand* strand = &dispatcher->strands[i];
+        pthread_mutex_init(&strand->mutex, NULL);
+        pthread_cond_init(&strand->space, NULL);
+    }
+
+    for (uint32_t i = 0; i < dispatcher->worker_count; i++) {
+        DispatchWorker* worker = &dispatcher->workers[i];
+        pthread_mutex_init(&worker->mutex, NULL);
+        worker->owner = dispatcher;
+        worker->index = i;
+        worker->ring = (uint32_t*)malloc(dispatcher->max_ids * sizeof(uint32_t));
+        if (worker->ring == NULL) {
+            can_shm_dispatcher_destroy(dispatcher);
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+    }
+
+    for (uint32_t i = 0; i < dispatcher->worker_count; i++) {
+        DispatchWorker* worker = &dispatcher->workers[i];
+        if (pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+            can_shm_dispatcher_destroy(dispatcher);
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+        dispatcher->workers_started++;
+    }
+
+    *dispatcher_out = dispatcher;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_dispatcher_destroy(CANDispatcher* dispatcher) {
+    if (dispatcher == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&dispatcher->idle_mutex);
+    __atomic_store_n(&dispatcher->stopping, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&dispatcher->work_cond);
+    pthread_mutex_unlock(&dispatcher->idle_mutex);
+
+    // BLOCKで待機中の投入側を解放
+    if (dispatcher->strands != NULL) {
+        for (uint32_t i = 0; i < dispatcher->table_size; i++) {
+            DispatchStrand* strand = &dispatcher->strands[i];
+            pthread_mutex_lock(&strand->mutex);
+            pthread_cond_broadcast(&strand->space);
+            pthread_mutex_unlock(&strand->mutex);
+        }
+    }
+
+    for (uint32_t i = 0; i < dispatcher->workers_started; i++) {
+        pthread_join(dispatcher->workers[i].thread, NULL);
+    }
+
+    if (dispatcher->workers != NULL) {
+        for (uint32_t i = 0; i < dispatcher->worker_count; i++) {
+            free(dispatcher->workers[i].ring);
+            pthread_mutex_destroy(&dispatcher->workers[i].mutex);
+        }
+        free(dispatcher->workers);
+    }
+    if (dispatcher->strands != NULL) {
+        for (uint32_t i = 0; i < dispatcher->table_size; i++) {
+            free(dispatcher->strands[i].items);
+            pthread_mutex_destroy(&dispatcher->strands[i].mutex);
+            pthread_cond_destroy(&dispatcher->strands[i].space);
+        }
+        free(dispatcher->strands);
+    }
+
+    pthread_cond_destroy(&dispatcher->drained_cond);
+    pthread_cond_destroy(&dispatcher->work_cond);
+    pthread_mutex_destroy(&dispatcher->idle_mutex);
+    pthread_mutex_destroy(&dispatcher->table_mutex);
+    free(dispatcher);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_dispatcher_post(CANDispatcher* dispatcher, uint32_t can_id, const CANData* data,
+                                     CANDataCallback callback, void* user_data) {
+    if (dispatcher == NULL || data == NULL || callback == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    int32_t strand_index = find_strand(dispatcher, can_id);
+    if (strand_index < 0) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+    DispatchStrand* strand = &dispatcher->strands[strand_index];
+    uint32_t mask = dispatcher->queue_depth - 1;
+    int evicted = 0;
+
+    pthread_mutex_lock(&strand->mutex);
+    if (strand->items == NULL) {
+        strand->items = (DispatchItem*)malloc(dispatcher->queue_depth * sizeof(DispatchItem));
+        if (strand->items == NULL) {
+            pthread_mutex_unlock(&strand->mutex);
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+    }
+
+    if (strand->count == dispatcher->queue_depth) {
+        switch (dispatcher->policy) {
+        case CAN_DISPATCH_DROP_NEWEST:
+            pthread_mutex_unlock(&strand->mutex);
+            stat_add(&dispatcher->stats.posted, 1);
+            stat_add(&dispatcher->stats.dropped, 1);
+            return CAN_SHM_SUCCESS;
+        case CAN_DISPATCH_DROP_OLDEST:
+            strand->head = (strand->head + 1) & mask;
+            strand->count--;
+            evicted = 1;
+            stat_add(&dispatcher->stats.dropped, 1);
+            break;
+        case CAN_DISPATCH_BLOCK:
+            stat_add(&dispatcher->stats.blocked, 1);
+            while (strand->count == dispatcher->queue_depth &&
+                   !__atomic_load_n(&dispatcher->stopping, __ATOMIC_ACQUIRE)) {
+                pthread_cond_wait(&strand->space, &strand->mutex);
+            }
+            if (strand->count == dispatcher->queue_depth) {
+                pthread_mutex_unlock(&strand->mutex);
+                return CAN_SHM_ERROR_INIT_FAILED;  // 破棄中
+            }
+            break;
+        }
+    }
+
+    DispatchItem* item = &strand->items[(strand->head + strand->count) & mask];
+    item->data = *data;
+    item->callback = callback;
+    item->user_data = user_data;
+    strand->count++;
+    if (!evicted) {
+        __atomic_add_fetch(&dispatcher->in_flight, 1, __ATOMIC_ACQ_REL);
+    }
+
+    int need_schedule = !strand->scheduled;
+    strand->scheduled = 1;
+    pthread_mutex_unlock(&strand->mutex);
+
+    stat_add(&dispatcher->stats.posted, 1);
+    if (need_schedule) {
+        uint32_t worker_index = __atomic_fetch_add(&dispatcher->next_worker, 1, __ATOMIC_RELAXED) %
+                                dispatcher->worker_count;
+        schedule_strand(dispatcher, (uint32_t)strand_index, worker_index);
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_dispatcher_drain(CANDispatcher* dispatcher, int32_t timeout_ms) {
+    if (dispatcher == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    struct timespec abs;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &abs);
+        uint64_t nsec = (uint64_t)abs.tv_nsec + (uint64_t)timeout_ms * 1000000ULL;
+        abs.tv_sec += (time_t)(nsec / 1000000000ULL);
+        abs.tv_nsec = (long)(nsec % 1000000000ULL);
+    }
+
+    CANShmResult result = CAN_SHM_SUCCESS;
+    pthread_mutex_lock(&dispatcher->idle_mutex);
+    while (__atomic_load_n(&dispatcher->in_flight, __ATOMIC_ACQUIRE) != 0) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&dispatcher->drained_cond, &dispatcher->idle_mutex);
+        } else if (pthread_cond_timedwait(&dispatcher->drained_cond, &dispatcher->idle_mutex, &abs) == ETIMEDOUT) {
+            if (__atomic_load_n(&dispatcher->in_flight, __ATOMIC_ACQUIRE) != 0) {
+                result = CAN_SHM_ERROR_TIMEOUT;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&dispatcher->idle_mutex);
+    return result;
+}
+
+CANShmResult can_shm_dispatcher_get_stats(CANDispatcher* dispatcher, CANDispatcherStats* stats_out) {
+    if (dispatcher == NULL || stats_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    stats_out->posted = __atomic_load_n(&dispatcher->stats.posted, __ATOMIC_RELAXED);
+    stats_out->executed = __atomic_load_n(&dispatcher->stats.executed, __ATOMIC_RELAXED);
+    stats_out->dropped = __atomic_load_n(&dispatcher->stats.dropped, __ATOMIC_RELAXED);
+    stats_out->blocked = __atomic_load_n(&dispatcher->stats.blocked, __ATOMIC_RELAXED);
+    stats_out->stolen = __atomic_load_n(&dispatcher->stats.stolen, __ATOMIC_RELAXED);
+    return CAN_SHM_SUCCESS;
+}
+
+void can_shm_dispatch_callback(uint32_t can_id, const CANData* data, void* user_data) {
+    CANDispatchTarget* target = (CANDispatchTarget*)user_data;
+    if (target == NULL) {
+        return;
+    }
+    can_shm_dispatcher_post(target->dispatcher, can_id, data, target->callback, target->user_data);
+}
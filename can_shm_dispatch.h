@@ -0,0 +1,119 @@
+#ifndef CAN_SHM_DISPATCH_H
+#define CAN_SHM_DISPATCH_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * コールバックのスレッドプール配信
+ * ================================
+ *
+ * can_shm_subscribe はコールバックを購読スレッド上で直接呼ぶため、重い処理が
+ * 次の更新の検出を遅らせ、その間の更新を取りこぼす。ディスパッチャは
+ * コールバックをワーカースレッドへ渡し、購読スレッドは投入後すぐ次の待機に戻る。
+ *
+ * - CAN IDごとのストランド（有界FIFO）に投入し、同一IDのコールバックは
+ *   投入順に1つずつ実行される（異なるIDは並列に実行される）
+ * - 実行待ちのストランドはワーカーごとの実行キューに積まれ、自分のキューが空の
+ *   ワーカーは他のワーカーのキューの末尾から盗んで実行する（ワークスティーリング）
+ * - ストランドのFIFOが満杯の場合の動作は policy で選択する
+ *     DROP_NEWEST: 投入するフレームを捨てる
+ *     DROP_OLDEST: 最も古い未実行のフレームを捨てて投入する
+ *     BLOCK:       空きができるまで投入側を待たせる（バックプレッシャー）
+ *
+ * 購読APIとの接続は can_shm_dispatch_callback をコールバック、CANDispatchTarget を
+ * ユーザーデータとして渡す（can_shm_subscribe / can_shm_subscribe_ex / リアクタで共通）。
+ */
+
+typedef struct CANDispatcher CANDispatcher;
+
+// 満杯時の動作
+typedef enum {
+    CAN_DISPATCH_DROP_NEWEST = 0,
+    CAN_DISPATCH_DROP_OLDEST = 1,
+    CAN_DISPATCH_BLOCK = 2
+} CANDispatchPolicy;
+
+// ディスパッチャ設定（0の項目は既定値）
+typedef struct {
+    uint32_t worker_count;      // ワーカースレッド数（0=オンラインCPU数）
+    uint32_t queue_depth;       // CAN IDごとの未実行フレーム上限（0=64、2のべき乗に切り上げ）
+    uint32_t max_ids;           // ストランド数の上限（0=1024）
+    CANDispatchPolicy policy;   // 満杯時の動作
+} CANDispatcherConfig;
+
+// ディスパッチャの統計
+typedef struct {
+    uint64_t posted;            // 投入されたフレーム数
+    uint64_t executed;          // 実行したコールバック数
+    uint64_t dropped;           // 満杯で捨てたフレーム数
+    uint64_t blocked;           // BLOCK で投入側が待った回数
+    uint64_t stolen;            // 他ワーカーから盗んだストランド数
+} CANDispatcherStats;
+
+// 購読コールバックの配信先（can_shm_dispatch_callback のユーザーデータ）
+typedef struct {
+    CANDispatcher* dispatcher;
+    CANDataCallback callback;   // ワーカー上で呼ぶコールバック
+    void* user_data;
+} CANDispatchTarget;
+
+/**
+ * ディスパッチャ作成とワーカースレッド起動
+ * @param config 設定 (NULL=全て既定値)
+ * @param dispatcher_out 作成したディスパッチャの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_dispatcher_create(const CANDispatcherConfig* config, CANDispatcher** dispatcher_out);
+
+/**
+ * ワーカースレッド停止と破棄（未実行のフレームは破棄される）
+ * @param dispatcher ディスパッチャ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_dispatcher_destroy(CANDispatcher* dispatcher);
+
+/**
+ * フレームの投入
+ * @param dispatcher ディスパッチャ
+ * @param can_id 実行順序を保証する単位のCAN ID
+ * @param data CANデータ（コピーされる）
+ * @param callback ワーカー上で呼ぶコールバック
+ * @param user_data コールバック関数に渡すユーザーデータ
+ * @return CAN_SHM_SUCCESS on success (満杯で捨てた場合も含む),
+ *         CAN_SHM_ERROR_NOT_FOUND if no free strand, error code on failure
+ */
+CANShmResult can_shm_dispatcher_post(CANDispatcher* dispatcher, uint32_t can_id, const CANData* data,
+                                     CANDataCallback callback, void* user_data);
+
+/**
+ * 投入済みのフレームが全て実行されるまで待機
+ * @param dispatcher ディスパッチャ
+ * @param timeout_ms タイムアウト時間[ミリ秒] (<0=無期限)
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_TIMEOUT on timeout
+ */
+CANShmResult can_shm_dispatcher_drain(CANDispatcher* dispatcher, int32_t timeout_ms);
+
+/**
+ * 統計取得
+ * @param dispatcher ディスパッチャ
+ * @param stats_out 統計の格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_dispatcher_get_stats(CANDispatcher* dispatcher, CANDispatcherStats* stats_out);
+
+/**
+ * 購読コールバック用アダプタ（user_data に CANDispatchTarget* を渡す）
+ * 例: can_shm_subscribe(id, 0, -1, can_shm_dispatch_callback, &target);
+ */
+void can_shm_dispatch_callback(uint32_t can_id, const CANData* data, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_DISPATCH_H
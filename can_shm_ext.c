@@ -0,0 +1,636 @@
+#include "can_shm_ext.h"
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include "can_shm_presence.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern SharedMemoryLayout* g_shm_ptr;
+
+// 書き込み中バケットでのスピン回数上限（超えたらyield）
+#define EXT_SPIN_LIMIT 64
+
+// 移行の完了待ちの上限（移行中のプロセスが停止した場合など、進まなければSetを失敗させる）
+#define EXT_MIGRATE_WAIT_LIMIT 10000
+
+// 探索結果
+enum {
+    EXT_ABSENT = 0,
+    EXT_FOUND,
+    EXT_RETRY,     // 移行済みバケットを見た（世代を引き直す）
+    EXT_FULL
+};
+
+// プロセス内のマップ（世代番号で添字、旧世代は can_shm_ext_cleanup までマップしたまま）
+static CANExtLayout* g_ext_map[CAN_SHM_EXT_MAX_LEVELS + 1];
+static pthread_mutex_t g_ext_map_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 所有するメインセグメントの識別子（セグメント名に含める）
+static uint64_t g_ext_owner;
+
+static uint32_t level_bits(uint32_t level) {
+    return CAN_SHM_EXT_BASE_BITS + level - 1;
+}
+
+static size_t level_size(uint32_t level) {
+    return sizeof(CANExtLayout) + ((size_t)1 << level_bits(level)) * sizeof(CANExtBucket);
+}
+
+static void level_name(uint32_t level, char* name, size_t len) {
+    snprintf(name, len, SHM_EXT_NAME_FORMAT, level, (unsigned long long)g_ext_owner);
+}
+
+// メインテーブルで衝突したID同士が同じ位置に集まらないよう、can_id_hash とは別のハッシュを使う
+static uint32_t ext_hash(uint32_t can_id, uint32_t bits) {
+    return (uint32_t)(((uint64_t)(can_id ^ 0x5BD1E995u) * 0xD6E8FEB86659FD93ULL) >> (64 - bits));
+}
+
+/**
+ * 世代のセグメントのマップ（create=1なら0ページで作り直す）
+ */
+static CANExtLayout* map_level(uint32_t level, int create) {
+    CANExtLayout* table = __atomic_load_n(&g_ext_map[level], __ATOMIC_ACQUIRE);
+    if (table != NULL && !create) {
+        return table;
+    }
+
+    pthread_mutex_lock(&g_ext_map_mutex);
+    table = g_ext_map[level];
+    if (table != NULL && !create) {
+        pthread_mutex_unlock(&g_ext_map_mutex);
+        return table;
+    }
+
+    char name[64];
+    level_name(level, name, sizeof(name));
+    size_t size = level_size(level);
+    int fd = shm_open(name, create ? (O_CREAT | O_RDWR) : O_RDWR, 0666);
+    if (fd == -1) {
+        pthread_mutex_unlock(&g_ext_map_mutex);
+        return NULL;
+    }
+
+    struct stat st;
+    int ok;
+    if (create) {
+        // 前回の内容は切り詰めで破棄（初期化パスなしで全バケットが EMPTY になる）
+        ok = ftruncate(fd, 0) == 0 && ftruncate(fd, (off_t)size) == 0;
+    } else {
+        ok = fstat(fd, &st) == 0 && (size_t)st.st_size >= size;
+    }
+    void* addr = ok ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (addr == MAP_FAILED) {
+        pthread_mutex_unlock(&g_ext_map_mutex);
+        return NULL;
+    }
+
+    CANExtLayout* mapped = (CANExtLayout*)addr;
+    uint64_t instance_id = g_shm_ptr->ext.instance_id;
+    if (create) {
+        mapped->magic_number = CAN_SHM_EXT_MAGIC;
+        mapped->level = level;
+        mapped->bits = level_bits(level);
+        mapped->instance_id = instance_id;
+    } else if (mapped->magic_number != CAN_SHM_EXT_MAGIC || mapped->level != level ||
+               mapped->instance_id != instance_id) {
+        // 作り直す前のメインセグメントが作成した世代
+        munmap(addr, size);
+        pthread_mutex_unlock(&g_ext_map_mutex);
+        return NULL;
+    }
+
+    // 作り直した場合の旧マップは参照中のスレッドがありうるため解放しない（同じオブジェクトを指す）
+    __atomic_store_n(&g_ext_map[level], mapped, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_ext_map_mutex);
+    return mapped;
+}
+
+// 書き手同士の排他を兼ねたseqlock書き込み開始（開始前のシーケンスを返す）
+static uint32_t lock_slot(CANExtBucket* slot) {
+    uint32_t spins = 0;
+    uint32_t seq = __atomic_load_n(&slot->can_data.sequence, __ATOMIC_RELAXED);
+    for (;;) {
+        if (!(seq & 1) &&
+            __atomic_compare_exchange_n(&slot->can_data.sequence, &seq, seq + 1, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            // 奇数シーケンスをデータ部より先に見せる
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return seq;
+        }
+        if (++spins >= EXT_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+        seq = __atomic_load_n(&slot->can_data.sequence, __ATOMIC_RELAXED);
+    }
+}
+
+static void unlock_slot(CANExtBucket* slot, uint32_t seq) {
+    __atomic_store_n(&slot->can_data.sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+// seqlockによる読み取り（データと状態を一貫した組で取得）
+static void read_slot(const CANExtBucket* slot, CANData* data_out, uint8_t* state_out) {
+    uint32_t spins = 0;
+    for (;;) {
+        uint32_t seq1 = __atomic_load_n(&slot->can_data.sequence, __ATOMIC_ACQUIRE);
+        if (!(seq1 & 1)) {
+            *data_out = slot->can_data;
+            *state_out = slot->state;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->can_data.sequence, __ATOMIC_RELAXED) == seq1) {
+                data_out->sequence = seq1;
+                return;
+            }
+        }
+        if (++spins >= EXT_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+}
+
+/**
+ * 世代内の検索（読み取り側）
+ * バケットのIDは使用開始後に変わらず、IDごとのバケットは世代内で1つ
+ */
+static int find_in(const CANExtLayout* table, uint32_t can_id, CANData* data_out) {
+    uint32_t mask = (1u << table->bits) - 1;
+    uint32_t home = ext_hash(can_id, table->bits);
+    for (uint32_t i = 0; i <= mask; i++) {
+        const CANExtBucket* slot = &table->buckets[(home + i) & mask];
+        uint8_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state == CAN_SHM_EXT_EMPTY) {
+            return EXT_ABSENT;
+        }
+        if (slot->can_data.can_id != can_id) {
+            continue;
+        }
+        CANData copy;
+        read_slot(slot, &copy, &state);
+        if (state == CAN_SHM_EXT_USED) {
+            *data_out = copy;
+            return EXT_FOUND;
+        }
+        return state == CAN_SHM_EXT_MOVED ? EXT_RETRY : EXT_ABSENT;
+    }
+    return EXT_ABSENT;
+}
+
+/**
+ * 使用中バケットの検索とロック（見つからなければNULL）
+ */
+static CANExtBucket* lock_find(CANExtLayout* table, uint32_t can_id, uint32_t* seq_out) {
+    uint32_t mask = (1u << table->bits) - 1;
+    uint32_t home = ext_hash(can_id, table->bits);
+    for (uint32_t i = 0; i <= mask; i++) {
+        CANExtBucket* slot = &table->buckets[(home + i) & mask];
+        uint8_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state == CAN_SHM_EXT_EMPTY) {
+            return NULL;
+        }
+        if (slot->can_data.can_id != can_id) {
+            continue;
+        }
+        uint32_t seq = lock_slot(slot);
+        if (slot->state == CAN_SHM_EXT_USED) {
+            *seq_out = seq;
+            return slot;
+        }
+        unlock_slot(slot, seq);
+        return NULL;
+    }
+    return NULL;
+}
+
+/**
+ * 世代への格納（既存バケットの更新、削除済みバケットの再使用、または空きバケットの使用開始）
+ * @param claimed_out 空き・削除済みバケットを使用した場合1
+ * @param previous 旧世代に残っている値（ロック保持中、なければNULL）
+ * @param changed_out DLC・データ部が格納前の値から変化した（新規を含む）場合1（NULL可）
+ */
+static int upsert(CANExtLayout* table, const CANData* incoming, int* claimed_out, CANData* stored_out,
+                  const CANData* previous, int* changed_out) {
+    uint32_t mask = (1u << table->bits) - 1;
+    uint32_t home = ext_hash(incoming->can_id, table->bits);
+    *claimed_out = 0;
+    for (uint32_t i = 0; i <= mask; i++) {
+        CANExtBucket* slot = &table->buckets[(home + i) & mask];
+        uint8_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state != CAN_SHM_EXT_EMPTY && slot->can_data.can_id != incoming->can_id) {
+            continue;
+        }
+
+        uint32_t seq = lock_slot(slot);
+        state = slot->state;
+        if (state == CAN_SHM_EXT_EMPTY || slot->can_data.can_id == incoming->can_id) {
+            if (state == CAN_SHM_EXT_MOVED) {
+                // 旧世代になったテーブルへの書き込み
+                unlock_slot(slot, seq);
+                return EXT_RETRY;
+            }
+            if (changed_out != NULL) {
+                const CANData* before = state == CAN_SHM_EXT_USED ? &slot->can_data : previous;
+                *changed_out = before == NULL || before->dlc != incoming->dlc ||
+                               memcmp(before->data, incoming->data, sizeof(incoming->data)) != 0;
+            }
+            // 存在フィルタへの登録はバケットを使用開始する前（削除との順序はスロットロックで保証）
+            can_shm_presence_add(g_shm_ptr, incoming->can_id);
+            slot->can_data.can_id = incoming->can_id;
+            slot->can_data.dlc = incoming->dlc;
+            memcpy(slot->can_data.data, incoming->data, sizeof(incoming->data));
+            slot->can_data.timestamp = incoming->timestamp;
+            if (state != CAN_SHM_EXT_USED) {
+                __atomic_store_n(&slot->state, CAN_SHM_EXT_USED, __ATOMIC_RELEASE);
+                *claimed_out = 1;
+            }
+            if (state == CAN_SHM_EXT_EMPTY) {
+                __atomic_add_fetch(&table->occupied, 1, __ATOMIC_RELAXED);
+            }
+            if (stored_out != NULL) {
+                *stored_out = slot->can_data;
+                stored_out->sequence = seq + 2;
+            }
+            unlock_slot(slot, seq);
+            return EXT_FOUND;
+        }
+        // ロック待ちの間に別IDが使用開始した
+        unlock_slot(slot, seq);
+        i--;
+    }
+    return EXT_FULL;
+}
+
+/**
+ * 移行の完了（旧世代の切り離し）
+ */
+static void finish_migration(uint32_t level) {
+    CANExtControl* control = &g_shm_ptr->ext;
+    pthread_mutex_lock(&control->resize_mutex);
+    if (control->previous == level) {
+        __atomic_store_n(&control->previous, 0, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&control->epoch, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&control->resize_mutex);
+
+    // マップ済みのプロセスは can_shm_ext_cleanup まで参照できる
+    char name[64];
+    level_name(level, name, sizeof(name));
+    shm_unlink(name);
+}
+
+/**
+ * 旧世代のバケットを最大count個移行
+ * カーソルに世代を含めるため、完了後に別の移行が始まっていれば何もしない
+ */
+static void migrate_step(uint32_t level, uint32_t count) {
+    CANExtControl* control = &g_shm_ptr->ext;
+    CANExtLayout* old = map_level(level, 0);
+    CANExtLayout* table = level < CAN_SHM_EXT_MAX_LEVELS ? map_level(level + 1, 0) : NULL;
+    if (old == NULL || table == NULL) {
+        return;
+    }
+    uint32_t capacity = 1u << old->bits;
+
+    for (uint32_t n = 0; n < count; n++) {
+        uint64_t cursor = __atomic_load_n(&control->migrate_cursor, __ATOMIC_RELAXED);
+        uint32_t index;
+        do {
+            index = (uint32_t)cursor;
+            if ((uint32_t)(cursor >> 32) != level || index >= capacity) {
+                return;
+            }
+        } while (!__atomic_compare_exchange_n(&control->migrate_cursor, &cursor, cursor + 1, 1,
+                                              __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+        CANExtBucket* slot = &old->buckets[index];
+        uint32_t seq = lock_slot(slot);
+        if (slot->state == CAN_SHM_EXT_USED) {
+            // 新世代には MOVED のバケットがなく、使用率も1/2以下のため必ず格納できる
+            CANData moving = slot->can_data;
+            int claimed;
+            upsert(table, &moving, &claimed, NULL, NULL, NULL);
+            __atomic_store_n(&slot->state, CAN_SHM_EXT_MOVED, __ATOMIC_RELEASE);
+        }
+        unlock_slot(slot, seq);
+
+        if (__atomic_add_fetch(&control->migrated, 1, __ATOMIC_ACQ_REL) == capacity) {
+            finish_migration(level);
+        }
+    }
+}
+
+/**
+ * 次世代の作成と切り替え（seen は呼び出し側が見た現在の世代）
+ */
+static CANShmResult grow(uint32_t seen) {
+    CANExtControl* control = &g_shm_ptr->ext;
+    CANShmResult result = CAN_SHM_SUCCESS;
+
+    pthread_mutex_lock(&control->resize_mutex);
+    if (control->current == seen && control->previous == 0) {
+        uint32_t next = seen + 1;
+        if (next > CAN_SHM_EXT_MAX_LEVELS) {
+            result = CAN_SHM_ERROR_NOT_FOUND;
+        } else if (map_level(next, 1) == NULL) {
+            result = CAN_SHM_ERROR_INIT_FAILED;
+        } else {
+            control->migrated = 0;
+            __atomic_store_n(&control->migrate_cursor, (uint64_t)seen << 32, __ATOMIC_RELAXED);
+            // 読み取り側は current → previous の順に読むため、previous を先に公開する
+            if (seen != 0) {
+                __atomic_store_n(&control->previous, seen, __ATOMIC_RELEASE);
+            }
+            __atomic_store_n(&control->current, next, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&control->epoch, 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&control->resize_mutex);
+    return result;
+}
+
+/**
+ * 値の格納（必要なら拡張・移行を進める、can_shm_ext_set / can_shm_ext_restore の共通部）
+ */
+static CANShmResult store(const CANData* incoming, CANData* stored_out, int* changed_out) {
+    CANExtControl* control = &g_shm_ptr->ext;
+    uint32_t can_id = incoming->can_id;
+
+    int created = 0;
+    int changed = -1;
+    uint32_t waits = 0;
+    for (;;) {
+        uint32_t previous = __atomic_load_n(&control->previous, __ATOMIC_ACQUIRE);
+        if (previous != 0) {
+            migrate_step(previous, CAN_SHM_EXT_MIGRATE_STEP);
+        }
+
+        uint32_t epoch = __atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE);
+        uint32_t current = __atomic_load_n(&control->current, __ATOMIC_ACQUIRE);
+        previous = __atomic_load_n(&control->previous, __ATOMIC_ACQUIRE);
+
+        CANExtLayout* table = current != 0 ? map_level(current, 0) : NULL;
+        CANExtLayout* old = previous != 0 ? map_level(previous, 0) : NULL;
+        if ((current != 0 && table == NULL) || (previous != 0 && old == NULL)) {
+            // 世代の切り替えで unlink された
+            if (__atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE) != epoch) {
+                continue;
+            }
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+
+        if (table == NULL ||
+            __atomic_load_n(&table->occupied, __ATOMIC_RELAXED) + 1 > (1u << table->bits) / 2) {
+            if (previous != 0) {
+                // 移行中に次の拡張が必要になった（1回あたりの移行数からは通常起きない）
+                if (++waits > EXT_MIGRATE_WAIT_LIMIT) {
+                    return CAN_SHM_ERROR_TIMEOUT;
+                }
+                migrate_step(previous, UINT32_MAX);
+                sched_yield();
+                continue;
+            }
+            CANShmResult result = grow(current);
+            if (result != CAN_SHM_SUCCESS) {
+                return result;
+            }
+            continue;
+        }
+
+        // 旧世代に残っている値は新世代へ書いてから MOVED にする（その間は旧バケットをロック）
+        uint32_t old_seq = 0;
+        CANExtBucket* old_slot = old != NULL ? lock_find(old, can_id, &old_seq) : NULL;
+        int claimed = 0;
+        int changed_now = 0;
+        int result = upsert(table, incoming, &claimed, stored_out,
+                            old_slot != NULL ? &old_slot->can_data : NULL, &changed_now);
+        if (old_slot != NULL) {
+            if (result == EXT_FOUND) {
+                __atomic_store_n(&old_slot->state, CAN_SHM_EXT_MOVED, __ATOMIC_RELEASE);
+            }
+            unlock_slot(old_slot, old_seq);
+        }
+
+        if (result == EXT_FULL) {
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+        if (result == EXT_FOUND) {
+            if (claimed && old_slot == NULL) {
+                created = 1;
+            }
+            // 書き直しでは自身の値と比較することになるため、最初の格納の判定を使う
+            if (changed < 0) {
+                changed = changed_now;
+            }
+            // 書き込み中に世代が切り替わった場合は、旧世代に書いた可能性があるため書き直す
+            if (__atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE) == epoch) {
+                break;
+            }
+        }
+    }
+
+    if (created) {
+        __atomic_add_fetch(&control->entries, 1, __ATOMIC_RELAXED);
+    }
+    if (changed_out != NULL) {
+        *changed_out = changed != 0;
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_ext_set(uint32_t can_id, uint16_t dlc, const uint8_t* data, CANData* stored_out,
+                             int* changed_out) {
+    CANData incoming;
+    memset(&incoming, 0, sizeof(incoming));
+    incoming.can_id = can_id;
+    incoming.dlc = dlc;
+    if (dlc > 0) {
+        memcpy(incoming.data, data, dlc);
+    }
+    incoming.timestamp = can_shm_clock_now_ns();
+    return store(&incoming, stored_out, changed_out);
+}
+
+CANShmResult can_shm_ext_restore(const CANData* data) {
+    if (g_shm_ptr == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (data == NULL || data->dlc > 64) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANData incoming;
+    memset(&incoming, 0, sizeof(incoming));
+    incoming.can_id = data->can_id;
+    incoming.dlc = data->dlc;
+    memcpy(incoming.data, data->data, sizeof(incoming.data));
+    incoming.timestamp = data->timestamp;
+    return store(&incoming, NULL, NULL);
+}
+
+CANShmResult can_shm_ext_get(uint32_t can_id, CANData* data_out) {
+    CANExtControl* control = &g_shm_ptr->ext;
+    for (;;) {
+        uint32_t epoch = __atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE);
+        uint32_t current = __atomic_load_n(&control->current, __ATOMIC_ACQUIRE);
+        uint32_t previous = __atomic_load_n(&control->previous, __ATOMIC_ACQUIRE);
+        if (current == 0) {
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+
+        CANExtLayout* table = map_level(current, 0);
+        CANExtLayout* old = previous != 0 ? map_level(previous, 0) : NULL;
+        if (table == NULL || (previous != 0 && old == NULL)) {
+            if (__atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE) != epoch) {
+                continue;
+            }
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+
+        int result = find_in(table, can_id, data_out);
+        if (result == EXT_ABSENT && old != NULL) {
+            result = find_in(old, can_id, data_out);
+        }
+        if (result == EXT_FOUND) {
+            return CAN_SHM_SUCCESS;
+        }
+        if (result == EXT_ABSENT && __atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE) == epoch) {
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+    }
+}
+
+CANShmResult can_shm_ext_delete(uint32_t can_id) {
+    CANExtControl* control = &g_shm_ptr->ext;
+    for (;;) {
+        uint32_t epoch = __atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE);
+        uint32_t current = __atomic_load_n(&control->current, __ATOMIC_ACQUIRE);
+        uint32_t previous = __atomic_load_n(&control->previous, __ATOMIC_ACQUIRE);
+        if (current == 0) {
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+
+        // 移行途中の値を取りこぼさないよう旧世代を先に探す（MOVED なら新世代へ格納済み）
+        uint32_t levels[2] = {previous, current};
+        int found = 0;
+        for (int i = 0; i < 2; i++) {
+            CANExtLayout* table = levels[i] != 0 ? map_level(levels[i], 0) : NULL;
+            uint32_t seq;
+            CANExtBucket* slot = table != NULL ? lock_find(table, can_id, &seq) : NULL;
+            if (slot != NULL) {
+                __atomic_store_n(&slot->state, CAN_SHM_EXT_DELETED, __ATOMIC_RELEASE);
+                // 同じIDのSetが登録し直す前に落とす（スロットロック保持中）
+                can_shm_presence_remove(g_shm_ptr, can_id);
+                unlock_slot(slot, seq);
+                found = 1;
+            }
+        }
+
+        if (found) {
+            __atomic_sub_fetch(&control->entries, 1, __ATOMIC_RELAXED);
+            return CAN_SHM_SUCCESS;
+        }
+        if (__atomic_load_n(&control->epoch, __ATOMIC_ACQUIRE) == epoch) {
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+    }
+}
+
+void can_shm_ext_foreach(CANExtVisitor visit, void* user_data) {
+    if (g_shm_ptr == NULL || visit == NULL || !can_shm_ext_active(g_shm_ptr)) {
+        return;
+    }
+
+    // 旧世代を先に走査する（走査済みでない旧バケットから移ったIDは、後で走査する現在の世代にある）
+    CANExtControl* control = &g_shm_ptr->ext;
+    uint32_t current = __atomic_load_n(&control->current, __ATOMIC_ACQUIRE);
+    uint32_t previous = __atomic_load_n(&control->previous, __ATOMIC_ACQUIRE);
+    uint32_t levels[2] = {previous, current};
+    for (int i = 0; i < 2; i++) {
+        CANExtLayout* table = levels[i] != 0 ? map_level(levels[i], 0) : NULL;
+        if (table == NULL) {
+            continue;
+        }
+        uint32_t capacity = 1u << table->bits;
+        for (uint32_t index = 0; index < capacity; index++) {
+            const CANExtBucket* slot = &table->buckets[index];
+            if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != CAN_SHM_EXT_USED) {
+                continue;
+            }
+            CANData copy;
+            uint8_t state;
+            read_slot(slot, &copy, &state);
+            if (state == CAN_SHM_EXT_USED) {
+                visit(&copy, user_data);
+            }
+        }
+    }
+}
+
+CANShmResult can_shm_ext_get_info(CANExtInfo* info_out) {
+    if (g_shm_ptr == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (info_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANExtControl* control = &g_shm_ptr->ext;
+    memset(info_out, 0, sizeof(*info_out));
+    pthread_mutex_lock(&control->resize_mutex);
+    info_out->level = control->current;
+    info_out->migrating_level = control->previous;
+    info_out->epoch = control->epoch;
+    info_out->entries = __atomic_load_n(&control->entries, __ATOMIC_RELAXED);
+    if (control->previous != 0) {
+        uint32_t capacity = 1u << level_bits(control->previous);
+        info_out->migrate_remaining = capacity - __atomic_load_n(&control->migrated, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&control->resize_mutex);
+
+    if (info_out->level != 0) {
+        info_out->capacity = 1u << level_bits(info_out->level);
+        CANExtLayout* table = map_level(info_out->level, 0);
+        if (table != NULL) {
+            info_out->occupied = __atomic_load_n(&table->occupied, __ATOMIC_RELAXED);
+        }
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+void can_shm_ext_attach(int segment_fd) {
+    // 作り直したファイルは inode が変わる（同じ inode が再利用されても instance_id で区別できる）
+    struct stat st;
+    if (fstat(segment_fd, &st) == 0) {
+        g_ext_owner = ((uint64_t)st.st_dev * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)st.st_ino;
+    } else {
+        g_ext_owner = 0;
+    }
+}
+
+void can_shm_ext_unlink(void) {
+    for (uint32_t level = 1; level <= CAN_SHM_EXT_MAX_LEVELS; level++) {
+        char name[64];
+        level_name(level, name, sizeof(name));
+        shm_unlink(name);
+    }
+}
+
+void can_shm_ext_cleanup(void) {
+    pthread_mutex_lock(&g_ext_map_mutex);
+    for (uint32_t level = 1; level <= CAN_SHM_EXT_MAX_LEVELS; level++) {
+        if (g_ext_map[level] != NULL) {
+            munmap(g_ext_map[level], level_size(level));
+            __atomic_store_n(&g_ext_map[level], NULL, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&g_ext_map_mutex);
+}
@@ -0,0 +1,124 @@
+#ifndef CAN_SHM_EXT_H
+#define CAN_SHM_EXT_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * リニアプロービングの拡張領域（オンライン拡張）
+ * ==============================================
+ *
+ * メインテーブル（MAX_CAN_ENTRIES 固定、各モジュールが buckets[] を直接参照する）で
+ * ホーム位置から CAN_SHM_MAX_PROBE 以内に空きがないIDは、別セグメントの拡張領域に格納する。
+ *
+ * - 拡張領域は世代ごとの別セグメント（SHM_EXT_NAME_FORMAT）。名前にはメインセグメントのファイル
+ *   （デバイス・inode）から決めた所有者の識別子を含め、配置（backing_path）の異なるテーブル同士では
+ *   共有しない。セグメントには作成したメインセグメントの instance_id を記録し、同じ名前で作り直された
+ *   メインセグメントとは照合に失敗する（旧テーブルの世代はマップせず、次の拡張で作り直す）
+ * - 第1世代は 2^CAN_SHM_EXT_BASE_BITS バケットで、使用率が1/2を超えるSetで倍の容量の次世代を作成する
+ * - 作成はセグメントの切り詰め（0ページ）のみで初期化パスはなく、テーブルサイズに比例する停止はない
+ * - 旧世代のバケットは、以後のSetごとに CAN_SHM_EXT_MIGRATE_STEP 個ずつ新世代へ移す。
+ *   移し終えたバケットは MOVED となり、旧世代は全バケット移行後に unlink される
+ * - Getは現在の世代、移行中なら旧世代の順に探す。MOVED を見た場合、または探索中に
+ *   世代が切り替わった（epoch が変化した）場合は最初から探し直す
+ * - バケットの書き込みは can_data.sequence のseqlockで、書き手同士の排他を兼ねる
+ * - 対象はバス0のリニアプロービング（can_shm_set/get/delete_linear_probing）のみ。
+ *   拡張領域のIDは固有のバケットを持たないため、更新はホームバケットの change_sequence と
+ *   購読キューで通知する（リアクタ・購読キュー・停止監視は拡張領域も参照する）。
+ *   On-changeの判定はセグメント全体の通知モードのみで行い、IDごとの設定・無視マスクは使わない。
+ *   ハンドル・ハッシュ位置を参照する can_shm_subscribe 系は使えない。スナップショットは
+ *   can_shm_ext_foreach / can_shm_ext_restore で拡張領域のIDも保存・復元する
+ * - セグメントは /dev/shm に置くため、ファイル配置（backing_path）でも再起動後には残らない
+ */
+
+// 拡張領域の状態
+typedef struct {
+    uint32_t level;              // 現在の世代（0=未作成）
+    uint32_t capacity;           // 現在の世代のバケット数
+    uint32_t occupied;           // 現在の世代の使用済みバケット数（削除済みを含む）
+    uint32_t entries;            // 拡張領域に格納中のID数
+    uint32_t migrating_level;    // 移行中の旧世代（0=移行なし）
+    uint32_t migrate_remaining;  // 旧世代の未移行バケット数
+    uint32_t epoch;              // 世代切り替えの回数
+} CANExtInfo;
+
+/**
+ * 拡張領域の状態取得
+ * @param info_out 格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_ext_get_info(CANExtInfo* info_out);
+
+// 以下は can_shm_linear_probing.c / can_shm_api.c から使用
+
+static inline int can_shm_ext_active(const SharedMemoryLayout* shm) {
+    return __atomic_load_n(&shm->ext.current, __ATOMIC_ACQUIRE) != 0;
+}
+
+/**
+ * 拡張領域へのSet（未作成なら作成、必要なら拡張・移行を進める）
+ * @param stored_out 格納した値（ジャーナル追記・購読キュー用）
+ * @param changed_out DLC・データ部が変化した（新規を含む）場合1（On-change判定用、NULL可）
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the last level is full,
+ *         CAN_SHM_ERROR_TIMEOUT if the pending migration makes no progress
+ */
+CANShmResult can_shm_ext_set(uint32_t can_id, uint16_t dlc, const uint8_t* data, CANData* stored_out,
+                             int* changed_out);
+
+/**
+ * 拡張領域からのGet
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the ID is not stored
+ */
+CANShmResult can_shm_ext_get(uint32_t can_id, CANData* data_out);
+
+/**
+ * 拡張領域からの削除
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the ID is not stored
+ */
+CANShmResult can_shm_ext_delete(uint32_t can_id);
+
+/**
+ * 拡張領域への値の復元（スナップショット読み込み用、受信時刻は data->timestamp を使う）
+ * 通知・ジャーナル追記は行わない
+ * @param data 復元する値
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the last level is full,
+ *         CAN_SHM_ERROR_TIMEOUT if the pending migration makes no progress
+ */
+CANShmResult can_shm_ext_restore(const CANData* data);
+
+// 拡張領域の走査で格納中のIDごとに呼び出す関数
+typedef void (*CANExtVisitor)(const CANData* data, void* user_data);
+
+/**
+ * 拡張領域に格納中の全IDの走査（スナップショット保存用、書き込み側は止めない）
+ * 移行中は旧世代→現在の世代の順に走査し、走査中に移行したIDは2回渡ることがある
+ * @param visit 呼び出す関数
+ * @param user_data visit に渡すユーザーデータ
+ */
+void can_shm_ext_foreach(CANExtVisitor visit, void* user_data);
+
+/**
+ * 拡張領域の所有者の設定（can_shm_init から呼ぶ）
+ * @param segment_fd バス0のメインセグメントのファイル記述子
+ */
+void can_shm_ext_attach(int segment_fd);
+
+/**
+ * 拡張領域の全世代のセグメントを削除（テーブルを破棄する場合にメインセグメントの削除前に呼ぶ）
+ */
+void can_shm_ext_unlink(void);
+
+/**
+ * 拡張領域のアンマップ（can_shm_cleanup から呼ぶ、セグメントは残る）
+ */
+void can_shm_ext_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_EXT_H
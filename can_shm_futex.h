@@ -0,0 +1,68 @@
+#ifndef CAN_SHM_FUTEX_H
+#define CAN_SHM_FUTEX_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * バケット単位の更新待機（futex）
+ * ===============================
+ *
+ * 購読者はバケットの change_sequence をfutexで待機し、起こしてほしい
+ * シーケンス値を wake_at に登録する。Set側は change_sequence を進めた後、
+ * 待機者がいて wake_at に到達した場合のみ FUTEX_WAKE を発行する。
+ * 待機者がいない場合のSet側コストはアトミック加算2回（グループ・バケット）と読み込み1回。
+ * プロセス間で共有するため FUTEX_PRIVATE_FLAG は使用しない。
+ */
+
+/**
+ * futex待機（値が expected のままならスリープ）
+ * @param addr 待機対象
+ * @param expected 期待値
+ * @param timeout 相対タイムアウト (NULL=無期限)
+ */
+static inline void can_shm_futex_wait(uint32_t* addr, uint32_t expected,
+                                      const struct timespec* timeout) {
+    syscall(SYS_futex, addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+/**
+ * futex待機者を全て起こす
+ */
+static inline void can_shm_futex_wake_all(uint32_t* addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * データ部が変化した更新の公開（バケットロック保持中に呼び出す）
+ * @param shm バケットを含むセグメント
+ * @param bucket 更新したバケット
+ */
+static inline void can_shm_bucket_publish_change(SharedMemoryLayout* shm, CANBucket* bucket) {
+    // SEQ_CSTの加算で後続のwaiters読み込みとの順序を保証（待機側の登録と対になる）
+    uint32_t seq = __atomic_add_fetch(&bucket->change_sequence, 1, __ATOMIC_SEQ_CST);
+
+    // リアクタはグループ単位の変更カウンタで走査対象を絞る
+    // change_sequence の後に公開する（新しい値を見たリアクタが古い change_sequence を読まないように）
+    uint32_t group = (uint32_t)(bucket - shm->buckets) >> CAN_SHM_DIRTY_GROUP_SHIFT;
+    __atomic_add_fetch(&shm->dirty_groups[group], 1, __ATOMIC_RELEASE);
+    if (__atomic_load_n(&bucket->waiters, __ATOMIC_RELAXED) != 0 &&
+        (int32_t)(seq - __atomic_load_n(&bucket->wake_at, __ATOMIC_RELAXED)) >= 0) {
+        can_shm_futex_wake_all(&bucket->change_sequence);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_FUTEX_H
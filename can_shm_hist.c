@@ -0,0 +1,184 @@
+#include "can_shm_hist.h"
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern int g_is_initialized;
+
+static CANShmResult resolve_segment(uint32_t bus, SharedMemoryLayout** shm_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (bus >= CAN_SHM_MAX_BUSES) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    *shm_out = can_shm_bus_segment(bus);
+    return *shm_out != NULL ? CAN_SHM_SUCCESS : CAN_SHM_ERROR_INIT_FAILED;
+}
+
+// 記録中のヒストグラムのコピー（count はバケット合計に揃える）
+static void copy_histogram(const CANLatencyHistogram* src, CANLatencyHistogram* dst) {
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < CAN_SHM_HIST_BUCKETS; i++) {
+        dst->buckets[i] = __atomic_load_n(&src->buckets[i], __ATOMIC_RELAXED);
+        count += dst->buckets[i];
+    }
+    dst->count = count;
+    dst->sum = __atomic_load_n(&src->sum, __ATOMIC_RELAXED);
+    dst->max = __atomic_load_n(&src->max, __ATOMIC_RELAXED);
+}
+
+static void clear_histogram(CANLatencyHistogram* hist) {
+    for (uint32_t i = 0; i < CAN_SHM_HIST_BUCKETS; i++) {
+        __atomic_store_n(&hist->buckets[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&hist->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->sum, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&hist->max, 0, __ATOMIC_RELAXED);
+}
+
+CANShmResult can_shm_hist_set_enabled(uint32_t bus, uint32_t mask) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    if (mask >> CAN_SHM_HIST_KINDS) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    __atomic_store_n(&shm->hist_enabled, mask, __ATOMIC_RELAXED);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_hist_snapshot(uint32_t bus, CANShmHistKind kind, CANLatencyHistogram* hist_out) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    if ((uint32_t)kind >= CAN_SHM_HIST_KINDS || hist_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    copy_histogram(&shm->histograms[kind], hist_out);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_hist_subscriber_snapshot(uint32_t bus, uint32_t slot, CANSubscriberHistogram* hist_out) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    if (slot >= CAN_SHM_HIST_MAX_SUBSCRIBERS || hist_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANSubscriberHistogram* entry = &shm->subscriber_histograms[slot];
+    if (!__atomic_load_n(&entry->in_use, __ATOMIC_ACQUIRE)) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    hist_out->in_use = 1;
+    hist_out->can_id = entry->can_id;
+    hist_out->owner_pid = entry->owner_pid;
+    hist_out->padding = 0;
+    copy_histogram(&entry->hist, &hist_out->hist);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_hist_reset(uint32_t bus) {
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    for (uint32_t i = 0; i < CAN_SHM_HIST_KINDS; i++) {
+        clear_histogram(&shm->histograms[i]);
+    }
+    for (uint32_t i = 0; i < CAN_SHM_HIST_MAX_SUBSCRIBERS; i++) {
+        clear_histogram(&shm->subscriber_histograms[i].hist);
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+uint64_t can_shm_hist_percentile(const CANLatencyHistogram* hist, double percentile) {
+    if (hist == NULL || hist->count == 0) {
+        return 0;
+    }
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    }
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    // 順位 ceil(count * p / 100) の値を含むバケット（最低1件目）
+    uint64_t rank = (uint64_t)(hist->count * percentile / 100.0 + 0.999999);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < CAN_SHM_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = can_shm_hist_upper_bound(i);
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+CANLatencyHistogram* can_shm_hist_subscriber_acquire(SharedMemoryLayout* shm, uint32_t can_id) {
+    if (!(__atomic_load_n(&shm->hist_enabled, __ATOMIC_RELAXED) & (1u << CAN_SHM_HIST_DELIVERY))) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < CAN_SHM_HIST_MAX_SUBSCRIBERS; i++) {
+        CANSubscriberHistogram* entry = &shm->subscriber_histograms[i];
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&entry->in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            entry->can_id = can_id;
+            entry->owner_pid = (uint32_t)getpid();
+            clear_histogram(&entry->hist);
+            return &entry->hist;
+        }
+    }
+    return NULL;
+}
+
+void can_shm_hist_subscriber_release(SharedMemoryLayout* shm, CANLatencyHistogram* hist) {
+    (void)shm;
+    if (hist == NULL) {
+        return;
+    }
+    CANSubscriberHistogram* entry = (CANSubscriberHistogram*)((char*)hist - offsetof(CANSubscriberHistogram, hist));
+    __atomic_store_n(&entry->in_use, 0, __ATOMIC_RELEASE);
+}
+
+void can_shm_hist_record_delivery(SharedMemoryLayout* shm, CANLatencyHistogram* subscriber_hist,
+                                  const CANData* data) {
+    if (!(__atomic_load_n(&shm->hist_enabled, __ATOMIC_RELAXED) & (1u << CAN_SHM_HIST_DELIVERY))) {
+        return;
+    }
+
+    uint64_t now = can_shm_clock_now_ns();
+    if (data->timestamp > now) {
+        return;  // 呼び出し元指定のタイムスタンプ等
+    }
+    uint64_t delay = now - data->timestamp;
+    can_shm_hist_record(&shm->histograms[CAN_SHM_HIST_DELIVERY], delay);
+    if (subscriber_hist != NULL) {
+        can_shm_hist_record(subscriber_hist, delay);
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef CAN_SHM_HIST_H
+#define CAN_SHM_HIST_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * レイテンシヒストグラム（共有メモリ内、対数線形）
+ * ================================================
+ *
+ * 平均値（PerfectHashTableStats.total_access_time_ns 等）では制御周期を
+ * 壊すテールレイテンシが見えないため、分布をセグメント内に記録する。
+ *
+ * - 値 v < 8 はそのままの番号、それ以上は最上位ビット位置 e と続く3ビットで
+ *   (e-2)*8 + sub の番号に割り当てる（各バケット幅は下限の1/8以下）
+ * - 記録はリラックスドアトミックの加算のみ（max はCASで更新）
+ * - 記録の有無は hist_enabled のビットで種類ごとに切り替え（既定は全て無効）。
+ *   無効時の追加コストはフラグの読み込み1回
+ * - 購読者別の配信遅延は購読開始時に空きスロットを確保した購読者のみ記録する
+ *   （スロットが不足した場合も全体の CAN_SHM_HIST_DELIVERY には記録される）
+ * - スナップショットとリセットは記録と並行して行えるが、リセット中の記録は失われうる
+ */
+
+/**
+ * 値に対応するバケット番号
+ */
+static inline uint32_t can_shm_hist_index(uint64_t value) {
+    if (value < CAN_SHM_HIST_SUB_COUNT) {
+        return (uint32_t)value;
+    }
+    uint32_t exponent = 63 - (uint32_t)__builtin_clzll(value);
+    uint32_t sub = (uint32_t)(value >> (exponent - CAN_SHM_HIST_SUB_BITS)) & (CAN_SHM_HIST_SUB_COUNT - 1);
+    return (exponent - CAN_SHM_HIST_SUB_BITS + 1) * CAN_SHM_HIST_SUB_COUNT + sub;
+}
+
+/**
+ * バケットに入る値の下限
+ */
+static inline uint64_t can_shm_hist_lower_bound(uint32_t index) {
+    if (index < CAN_SHM_HIST_SUB_COUNT) {
+        return index;
+    }
+    uint32_t exponent = index / CAN_SHM_HIST_SUB_COUNT + CAN_SHM_HIST_SUB_BITS - 1;
+    uint64_t sub = index % CAN_SHM_HIST_SUB_COUNT;
+    return (1ULL << exponent) | (sub << (exponent - CAN_SHM_HIST_SUB_BITS));
+}
+
+/**
+ * バケットに入る値の上限（この値を含む）
+ */
+static inline uint64_t can_shm_hist_upper_bound(uint32_t index) {
+    if (index + 1 >= CAN_SHM_HIST_BUCKETS) {
+        return UINT64_MAX;
+    }
+    return can_shm_hist_lower_bound(index + 1) - 1;
+}
+
+/**
+ * 値の記録（リラックスドアトミック）
+ */
+static inline void can_shm_hist_record(CANLatencyHistogram* hist, uint64_t value) {
+    __atomic_add_fetch(&hist->buckets[can_shm_hist_index(value)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&hist->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&hist->sum, value, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    while (value > max &&
+           !__atomic_compare_exchange_n(&hist->max, &max, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * 種類が記録対象なら値を記録
+ */
+static inline void can_shm_hist_record_kind(SharedMemoryLayout* shm, CANShmHistKind kind, uint64_t value) {
+    if (__atomic_load_n(&shm->hist_enabled, __ATOMIC_RELAXED) & (1u << kind)) {
+        can_shm_hist_record(&shm->histograms[kind], value);
+    }
+}
+
+/**
+ * 記録するヒストグラムの設定
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param mask 記録する種類のビットマスク（bit i = CANShmHistKind i、0=全て無効）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_hist_set_enabled(uint32_t bus, uint32_t mask);
+
+/**
+ * ヒストグラムのスナップショット取得（count はバケットの合計から再計算）
+ * @param bus バス番号
+ * @param kind ヒストグラムの種類
+ * @param hist_out スナップショットの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_hist_snapshot(uint32_t bus, CANShmHistKind kind, CANLatencyHistogram* hist_out);
+
+/**
+ * 購読者別ヒストグラムのスナップショット取得
+ * @param bus バス番号
+ * @param slot スロット番号 (0~CAN_SHM_HIST_MAX_SUBSCRIBERS-1)
+ * @param hist_out スナップショットの格納先（can_id / owner_pid を含む）
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the slot is unused
+ */
+CANShmResult can_shm_hist_subscriber_snapshot(uint32_t bus, uint32_t slot, CANSubscriberHistogram* hist_out);
+
+/**
+ * 全ヒストグラム（購読者別を含む）のリセット
+ * @param bus バス番号
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_hist_reset(uint32_t bus);
+
+/**
+ * パーセンタイル値（該当バケットの上限値）
+ * @param hist スナップショット
+ * @param percentile 0.0~100.0
+ * @return パーセンタイル値（記録がなければ0）
+ */
+uint64_t can_shm_hist_percentile(const CANLatencyHistogram* hist, double percentile);
+
+// 以下は can_shm_api.c から使用する内部関数
+
+/**
+ * 購読者別ヒストグラムのスロット確保（配信遅延の記録が無効、または空きがなければNULL）
+ */
+CANLatencyHistogram* can_shm_hist_subscriber_acquire(SharedMemoryLayout* shm, uint32_t can_id);
+
+/**
+ * 購読者別ヒストグラムのスロット解放
+ */
+void can_shm_hist_subscriber_release(SharedMemoryLayout* shm, CANLatencyHistogram* hist);
+
+/**
+ * 配信遅延の記録（全体と購読者別、data->timestamp が現在時刻より後なら記録しない）
+ */
+void can_shm_hist_record_delivery(SharedMemoryLayout* shm, CANLatencyHistogram* subscriber_hist,
+                                  const CANData* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_HIST_H
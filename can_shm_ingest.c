@@ -0,0 +1,475 @@
+/*
+ * SocketCAN取り込みデーモン
+ * ========================
+ *
+ * SocketCANインターフェース（試験時はvcan）からrecvmmsgでフレームをまとめて受信し、
+ * CANDataへ変換して can_shm_set_batch_timestamped で共有メモリへ投入する。
+ *
+ * - CAN/CAN FDフレームの両方に対応（CAN_RAW_FD_FRAMES）
+ * - SO_TIMESTAMPINGでカーネル受信時刻（ハードウェア時刻が取れればそれ）を取得
+ *   カーネルのソフトウェア時刻はCLOCK_REALTIME基準のため、CLOCK_MONOTONICへ換算して格納する。
+ *   ハードウェア時刻（NIC時計）も同じフレームのソフトウェア時刻との差からCLOCK_MONOTONICへ換算し、
+ *   同一IDでハードウェア時刻とソフトウェア時刻が混在しても時刻系がずれないようにする
+ * - SO_RXQ_OVFLでソケット受信キュー溢れによる欠落数を取得
+ * - インターフェース別の受信数・スループット・欠落数を定期出力
+ * - -S で周期リストを指定すると、取り込みと同じプロセスで途絶監視のtick処理を行う
+ * - -B を指定すると、k番目の -i インターフェースをバスkのセグメントへ投入する
+ *   （指定しない場合は全インターフェースをバス0へ投入）
+ *
+ * 使用例:
+ *   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+ *   ./can_shm_ingest -i vcan0 -i vcan1 -b 64
+ *   cangen vcan0 -g 0 -I r -L 8
+ */
+
+#define _GNU_SOURCE
+#include "can_shm_api.h"
+#include "can_shm_stale.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+
+#define INGEST_MAX_INTERFACES 8
+#define INGEST_MAX_BATCH 256
+#define INGEST_CMSG_SIZE 256
+#define INGEST_HW_OFFSET_WINDOW 1024   // NIC時計のずれを取り直すフレーム数
+
+// 受信時刻の取得元
+typedef enum {
+    INGEST_TIMESTAMP_SOFTWARE = 0,   // カーネル受信時刻（CLOCK_MONOTONICへ換算）
+    INGEST_TIMESTAMP_HARDWARE,       // NICのハードウェア時刻（CLOCK_MONOTONICへ換算、取れない場合はソフトウェア時刻）
+    INGEST_TIMESTAMP_NONE            // 投入時の現在時刻
+} IngestTimestampMode;
+
+// インターフェース別の状態と統計
+typedef struct {
+    char     name[IFNAMSIZ];
+    int      fd;
+    uint64_t frames;              // 受信フレーム数
+    uint64_t fd_frames;           // うちCAN FDフレーム数
+    uint64_t error_frames;        // エラーフレーム数（投入しない）
+    uint64_t kernel_drops;        // ソケット受信キュー溢れによる欠落数
+    uint32_t last_ovfl;           // SO_RXQ_OVFLの前回値（累積値）
+    int      ovfl_seen;
+    uint64_t hw_timestamps;       // ハードウェア時刻を使用したフレーム数
+    int64_t  hw_offset;           // NIC時計 → CLOCK_MONOTONIC の差（前の区間の最小値）
+    int64_t  hw_window_min;       // 現在の区間での差の最小値
+    uint32_t hw_window_frames;    // 現在の区間のフレーム数
+    int      hw_offset_valid;
+    uint64_t last_report_frames;
+} IngestInterface;
+
+// 受信バッファ（recvmmsg用）
+typedef struct {
+    struct canfd_frame frames[INGEST_MAX_BATCH];
+    struct iovec iov[INGEST_MAX_BATCH];
+    struct mmsghdr msgs[INGEST_MAX_BATCH];
+    char control[INGEST_MAX_BATCH][INGEST_CMSG_SIZE];
+} IngestRxBuffer;
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t timespec_to_ns(const struct timespec* ts) {
+    return (uint64_t)ts->tv_sec * 1000000000ULL + (uint64_t)ts->tv_nsec;
+}
+
+// CLOCK_MONOTONIC - CLOCK_REALTIME の差[ns]（受信バッチごとに更新）
+static int64_t realtime_to_monotonic_offset(void) {
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    return (int64_t)timespec_to_ns(&mono) - (int64_t)timespec_to_ns(&real);
+}
+
+/**
+ * NICのハードウェア時刻をCLOCK_MONOTONICへ換算
+ * 同じフレームのソフトウェア時刻との差（受信処理の遅延を含む）の最小値を時計のずれとみなし、
+ * INGEST_HW_OFFSET_WINDOW フレームごとに取り直す（NIC時計のドリフトに追従）。
+ * 換算結果はソフトウェア時刻を超えない（未来の時刻を格納しない）
+ */
+static uint64_t hw_to_monotonic(IngestInterface* itf, uint64_t hw_ns, uint64_t sw_mono_ns) {
+    int64_t offset = (int64_t)sw_mono_ns - (int64_t)hw_ns;
+    if (itf->hw_window_frames == 0 || offset < itf->hw_window_min) {
+        itf->hw_window_min = offset;
+    }
+    int64_t applied = itf->hw_window_min;
+    if (itf->hw_offset_valid && itf->hw_offset < applied) {
+        applied = itf->hw_offset;
+    }
+    if (++itf->hw_window_frames >= INGEST_HW_OFFSET_WINDOW) {
+        itf->hw_offset = itf->hw_window_min;
+        itf->hw_offset_valid = 1;
+        itf->hw_window_frames = 0;
+    }
+
+    uint64_t timestamp = (uint64_t)((int64_t)hw_ns + applied);
+    return timestamp < sw_mono_ns ? timestamp : sw_mono_ns;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s -i <ifname> [-i <ifname> ...] [OPTIONS]\n", prog);
+    printf("\n");
+    printf("Options:\n");
+    printf("  -i <ifname>  SocketCAN interface to read (up to %d, e.g. vcan0)\n",
+           INGEST_MAX_INTERFACES);
+    printf("  -b <n>       Frames per recvmmsg / publish batch (default: 64, max %d)\n",
+           INGEST_MAX_BATCH);
+    printf("  -T <mode>    Timestamp source: sw, hw (NIC clock mapped to CLOCK_MONOTONIC), none (default: sw)\n");
+    printf("  -r <sec>     Statistics report interval, 0=off (default: 1)\n");
+    printf("  -S <file>    Monitor stale IDs from an ID list with cycle times (e.g. 0x100:10)\n");
+    printf("  -C <ms>      Cycle time for IDs without one in the -S list (default: 100)\n");
+    printf("  -B           Publish the k-th interface to bus k (default: all to bus 0)\n");
+    printf("  -t <sec>     Stop after the given number of seconds (default: run until SIGINT)\n");
+    printf("  -h           Show this help message\n");
+}
+
+// CAN RAWソケットを開いて受信オプションを設定
+static int open_interface(IngestInterface* itf, IngestTimestampMode ts_mode) {
+    int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW);
+    if (fd < 0) {
+        fprintf(stderr, "%s: socket: %s\n", itf->name, strerror(errno));
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, itf->name, IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        fprintf(stderr, "%s: no such interface: %s\n", itf->name, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // CAN FDフレームも受信（FD非対応のインターフェースでは失敗するが継続）
+    int enable = 1;
+    if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) < 0) {
+        fprintf(stderr, "%s: CAN FD frames not supported, classic CAN only\n", itf->name);
+    }
+
+    // 受信キュー溢れの累積数をcmsgで受け取る
+    if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0) {
+        fprintf(stderr, "%s: SO_RXQ_OVFL not supported, kernel drops not reported\n",
+                itf->name);
+    }
+
+    // 受信時刻
+    if (ts_mode != INGEST_TIMESTAMP_NONE) {
+        int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (ts_mode == INGEST_TIMESTAMP_HARDWARE) {
+            flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        }
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+            fprintf(stderr, "%s: SO_TIMESTAMPING failed (%s), using publish time\n",
+                    itf->name, strerror(errno));
+        }
+    }
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "%s: bind: %s\n", itf->name, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    itf->fd = fd;
+    return 0;
+}
+
+static void prepare_rx_buffer(IngestRxBuffer* rx, uint32_t batch) {
+    memset(rx->msgs, 0, sizeof(rx->msgs[0]) * batch);
+    for (uint32_t i = 0; i < batch; i++) {
+        rx->iov[i].iov_base = &rx->frames[i];
+        rx->iov[i].iov_len = sizeof(rx->frames[i]);
+        rx->msgs[i].msg_hdr.msg_iov = &rx->iov[i];
+        rx->msgs[i].msg_hdr.msg_iovlen = 1;
+        rx->msgs[i].msg_hdr.msg_control = rx->control[i];
+        rx->msgs[i].msg_hdr.msg_controllen = INGEST_CMSG_SIZE;
+    }
+}
+
+/**
+ * 受信メッセージ1件をCANDataへ変換
+ * @return 1=変換成功, 0=投入対象外（エラーフレーム・不正長）
+ */
+static int convert_message(IngestInterface* itf, struct mmsghdr* msg,
+                           const struct canfd_frame* frame, IngestTimestampMode ts_mode,
+                           int64_t mono_offset, CANData* out) {
+    // 受信時刻とキュー溢れカウンタ
+    uint64_t timestamp = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg->msg_hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg->msg_hdr, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SO_TIMESTAMPING && ts_mode != INGEST_TIMESTAMP_NONE) {
+            // ts[0]=ソフトウェア時刻（CLOCK_REALTIME）, ts[2]=ハードウェア生時刻
+            // ハードウェア時刻の換算にはソフトウェア時刻が必要（両方そろったフレームのみ使用）
+            struct timespec ts[3];
+            memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+            int has_sw = ts[0].tv_sec != 0 || ts[0].tv_nsec != 0;
+            int has_hw = ts[2].tv_sec != 0 || ts[2].tv_nsec != 0;
+            if (has_sw) {
+                timestamp = (uint64_t)((int64_t)timespec_to_ns(&ts[0]) + mono_offset);
+                if (ts_mode == INGEST_TIMESTAMP_HARDWARE && has_hw) {
+                    timestamp = hw_to_monotonic(itf, timespec_to_ns(&ts[2]), timestamp);
+                    itf->hw_timestamps++;
+                }
+            }
+        } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t ovfl;
+            memcpy(&ovfl, CMSG_DATA(cmsg), sizeof(ovfl));
+            if (itf->ovfl_seen) {
+                itf->kernel_drops += (uint32_t)(ovfl - itf->last_ovfl);
+            } else {
+                itf->kernel_drops += ovfl;
+                itf->ovfl_seen = 1;
+            }
+            itf->last_ovfl = ovfl;
+        }
+    }
+
+    if (msg->msg_len != CAN_MTU && msg->msg_len != CANFD_MTU) {
+        return 0;
+    }
+
+    itf->frames++;
+    if (frame->can_id & CAN_ERR_FLAG) {
+        itf->error_frames++;
+        return 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->can_id = (frame->can_id & CAN_EFF_FLAG) ? (frame->can_id & CAN_EFF_MASK)
+                                                 : (frame->can_id & CAN_SFF_MASK);
+    out->timestamp = timestamp;
+
+    if (msg->msg_len == CANFD_MTU) {
+        itf->fd_frames++;
+        out->dlc = frame->len > CANFD_MAX_DLEN ? CANFD_MAX_DLEN : frame->len;
+    } else if (frame->can_id & CAN_RTR_FLAG) {
+        // リモートフレームはデータ部なし
+        out->dlc = 0;
+    } else {
+        out->dlc = frame->len > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->len;
+    }
+    memcpy(out->data, frame->data, out->dlc);
+    return 1;
+}
+
+static void print_stats(IngestInterface* itfs, uint32_t count, double elapsed_s,
+                        uint64_t publish_errors) {
+    for (uint32_t i = 0; i < count; i++) {
+        IngestInterface* itf = &itfs[i];
+        double rate = elapsed_s > 0 ? (itf->frames - itf->last_report_frames) / elapsed_s : 0;
+        printf("%-8s frames=%llu rate=%.0f/s fd=%llu err=%llu drops=%llu hwts=%llu\n",
+               itf->name, (unsigned long long)itf->frames, rate,
+               (unsigned long long)itf->fd_frames, (unsigned long long)itf->error_frames,
+               (unsigned long long)itf->kernel_drops, (unsigned long long)itf->hw_timestamps);
+        itf->last_report_frames = itf->frames;
+    }
+    if (publish_errors > 0) {
+        printf("publish errors=%llu\n", (unsigned long long)publish_errors);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    IngestInterface itfs[INGEST_MAX_INTERFACES];
+    uint32_t itf_count = 0;
+    uint32_t batch = 64;
+    IngestTimestampMode ts_mode = INGEST_TIMESTAMP_SOFTWARE;
+    uint32_t report_s = 1;
+    uint32_t duration_s = 0;
+    const char* stale_list = NULL;
+    uint32_t stale_default_cycle_ms = 100;
+    int per_bus = 0;
+
+    memset(itfs, 0, sizeof(itfs));
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:b:T:r:S:C:Bt:h")) != -1) {
+        switch (opt) {
+            case 'i':
+                if (itf_count >= INGEST_MAX_INTERFACES) {
+                    fprintf(stderr, "Too many interfaces (max %d)\n", INGEST_MAX_INTERFACES);
+                    return 1;
+                }
+                strncpy(itfs[itf_count].name, optarg, IFNAMSIZ - 1);
+                itfs[itf_count].fd = -1;
+                itf_count++;
+                break;
+            case 'b':
+                batch = (uint32_t)strtoul(optarg, NULL, 0);
+                if (batch == 0 || batch > INGEST_MAX_BATCH) {
+                    fprintf(stderr, "Batch size must be 1..%d\n", INGEST_MAX_BATCH);
+                    return 1;
+                }
+                break;
+            case 'T':
+                if (strcmp(optarg, "sw") == 0) {
+                    ts_mode = INGEST_TIMESTAMP_SOFTWARE;
+                } else if (strcmp(optarg, "hw") == 0) {
+                    ts_mode = INGEST_TIMESTAMP_HARDWARE;
+                } else if (strcmp(optarg, "none") == 0) {
+                    ts_mode = INGEST_TIMESTAMP_NONE;
+                } else {
+                    fprintf(stderr, "Unknown timestamp mode: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'r': report_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'S': stale_list = optarg; break;
+            case 'C': stale_default_cycle_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'B': per_bus = 1; break;
+            case 't': duration_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (itf_count == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    int epfd = epoll_create1(0);
+    if (epfd < 0) {
+        fprintf(stderr, "epoll_create1: %s\n", strerror(errno));
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < itf_count; i++) {
+        if (open_interface(&itfs[i], ts_mode) != 0) {
+            return 1;
+        }
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, itfs[i].fd, &ev);
+    }
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to initialize shared memory\n");
+        return 1;
+    }
+
+    if (stale_list != NULL) {
+        uint32_t loaded = 0;
+        can_shm_stale_configure(0);
+        if (can_shm_stale_load_file(stale_list, stale_default_cycle_ms, 0, &loaded) !=
+                CAN_SHM_SUCCESS && loaded == 0) {
+            fprintf(stderr, "Failed to load stale ID list: %s\n", stale_list);
+            can_shm_cleanup();
+            return 1;
+        }
+        can_shm_stale_monitor_start(0);
+        printf("Monitoring %u ID(s) for stale signals\n", loaded);
+    }
+
+    static IngestRxBuffer rx;
+    static CANData publish[INGEST_MAX_INTERFACES * INGEST_MAX_BATCH];
+    uint64_t publish_errors = 0;
+    uint64_t start = get_timestamp_ns();
+    uint64_t last_report = start;
+
+    printf("Ingesting from %u interface(s), batch=%u%s\n", itf_count, batch,
+           per_bus ? ", one bus per interface" : "");
+
+    while (!g_stop) {
+        struct epoll_event events[INGEST_MAX_INTERFACES];
+        int ready = epoll_wait(epfd, events, INGEST_MAX_INTERFACES, 100);
+        if (ready < 0 && errno != EINTR) {
+            fprintf(stderr, "epoll_wait: %s\n", strerror(errno));
+            break;
+        }
+
+        // 準備できた全インターフェースの受信分を1回のバッチで投入
+        // （バス別投入時はインターフェースごとに対応するバスのセグメントへ投入）
+        uint32_t pending = 0;
+        int64_t mono_offset = realtime_to_monotonic_offset();
+        for (int e = 0; e < ready; e++) {
+            uint32_t bus = events[e].data.u32;
+            IngestInterface* itf = &itfs[bus];
+            prepare_rx_buffer(&rx, batch);
+            int n = recvmmsg(itf->fd, rx.msgs, batch, MSG_DONTWAIT, NULL);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    fprintf(stderr, "%s: recvmmsg: %s\n", itf->name, strerror(errno));
+                }
+                continue;
+            }
+            for (int k = 0; k < n; k++) {
+                if (convert_message(itf, &rx.msgs[k], &rx.frames[k], ts_mode, mono_offset,
+                                    &publish[pending])) {
+                    pending++;
+                }
+            }
+            if (per_bus && pending > 0) {
+                uint32_t stored = 0;
+                can_shm_bus_set_batch_timestamped(bus, publish, pending, &stored);
+                publish_errors += pending - stored;
+                pending = 0;
+            }
+        }
+
+        if (pending > 0) {
+            uint32_t stored = 0;
+            can_shm_set_batch_timestamped(publish, pending, &stored);
+            publish_errors += pending - stored;
+        }
+
+        uint64_t now = get_timestamp_ns();
+        if (report_s > 0 && now - last_report >= (uint64_t)report_s * 1000000000ULL) {
+            print_stats(itfs, itf_count, (now - last_report) / 1e9, publish_errors);
+            last_report = now;
+        }
+        if (duration_s > 0 && now - start >= (uint64_t)duration_s * 1000000000ULL) {
+            break;
+        }
+    }
+
+    print_stats(itfs, itf_count, (get_timestamp_ns() - last_report) / 1e9, publish_errors);
+
+    can_shm_stale_monitor_stop();
+    for (uint32_t i = 0; i < itf_count; i++) {
+        close(itfs[i].fd);
+    }
+    close(epfd);
+    can_shm_cleanup();
+    return 0;
+}
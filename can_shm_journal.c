@@ -0,0 +1,104 @@
+#include "can_shm_journal.h"
+#include "can_shm_api.h"
+#include <string.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern SharedMemoryLayout* g_shm_ptr;
+extern int g_is_initialized;
+
+CANShmResult can_shm_journal_attach(CANJournalCursor* cursor) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (cursor == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANJournal* journal = &g_shm_ptr->journal;
+    __atomic_fetch_add(&journal->active, 1, __ATOMIC_SEQ_CST);
+
+    cursor->position = __atomic_load_n(&journal->head, __ATOMIC_ACQUIRE);
+    cursor->dropped = 0;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_journal_detach(void) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANJournal* journal = &g_shm_ptr->journal;
+    uint32_t active = __atomic_load_n(&journal->active, __ATOMIC_RELAXED);
+    while (active > 0 &&
+           !__atomic_compare_exchange_n(&journal->active, &active, active - 1, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+void can_shm_journal_append(SharedMemoryLayout* shm, const CANData* data) {
+    CANJournal* journal = &shm->journal;
+
+    uint64_t pos = __atomic_fetch_add(&journal->head, 1, __ATOMIC_RELAXED);
+    CANJournalEntry* entry = &journal->entries[pos & CAN_SHM_JOURNAL_MASK];
+
+    // エントリ単位のseqlock（奇数=書き込み中）
+    __atomic_store_n(&entry->seq, 2 * pos + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    entry->can_data = *data;
+
+    __atomic_store_n(&entry->seq, 2 * pos + 2, __ATOMIC_RELEASE);
+}
+
+uint32_t can_shm_journal_read(CANJournalCursor* cursor, CANData* out, uint32_t max) {
+    if (!g_is_initialized || cursor == NULL || out == NULL) {
+        return 0;
+    }
+
+    CANJournal* journal = &g_shm_ptr->journal;
+    uint64_t head = __atomic_load_n(&journal->head, __ATOMIC_ACQUIRE);
+    uint64_t pos = cursor->position;
+
+    // リング1周以上遅れている場合は読めない分を欠落として読み飛ばす
+    if (head - pos > CAN_SHM_JOURNAL_SIZE) {
+        cursor->dropped += head - CAN_SHM_JOURNAL_SIZE - pos;
+        pos = head - CAN_SHM_JOURNAL_SIZE;
+    }
+
+    uint32_t count = 0;
+    while (count < max && pos < head) {
+        CANJournalEntry* entry = &journal->entries[pos & CAN_SHM_JOURNAL_MASK];
+        uint64_t expected = 2 * pos + 2;
+
+        uint64_t seq1 = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq1 != expected) {
+            if (seq1 > expected) {
+                // 読み出し前に次の周回で上書きされた
+                cursor->dropped++;
+                pos++;
+                continue;
+            }
+            // 位置は確保済みだが書き込み未完了、次回の読み出しで再試行
+            break;
+        }
+
+        out[count] = entry->can_data;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        uint64_t seq2 = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+        if (seq2 != seq1) {
+            // コピー中に上書きされた
+            cursor->dropped++;
+            pos++;
+            continue;
+        }
+
+        count++;
+        pos++;
+    }
+
+    cursor->position = pos;
+    return count;
+}
@@ -0,0 +1,71 @@
+#ifndef CAN_SHM_JOURNAL_H
+#define CAN_SHM_JOURNAL_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 更新ジャーナル
+ * ==============
+ *
+ * 共有メモリ内の固定長リングバッファに全てのSet結果を追記する。
+ * レコーダが1つも接続していない間、Set側のコストはフラグ1回の読み込みのみ。
+ * 接続中はfetch_add 1回とCANDataのコピー1回が追加される。
+ * 読み出しが追いつかずに上書きされたレコードは読み出し側で欠落として数える
+ * （Set側が待たされることはない）。
+ */
+
+// 読み出しカーソル（プロセスローカル）
+typedef struct {
+    uint64_t position;  // 次に読み出す位置
+    uint64_t dropped;   // 上書きにより失われたレコード数（累計）
+} CANJournalCursor;
+
+/**
+ * ジャーナルへのレコーダ接続
+ * 接続時点以降の更新のみが記録対象となる
+ * @param cursor 読み出しカーソルの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_journal_attach(CANJournalCursor* cursor);
+
+/**
+ * ジャーナルからのレコーダ切断
+ * 最後のレコーダが切断するとSet側の追記が停止する
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_journal_detach(void);
+
+/**
+ * ジャーナルからまとめて読み出し
+ * @param cursor 読み出しカーソル
+ * @param out 読み出したCANデータの格納先配列
+ * @param max 配列の要素数
+ * @return 読み出したレコード数
+ */
+uint32_t can_shm_journal_read(CANJournalCursor* cursor, CANData* out, uint32_t max);
+
+/**
+ * ジャーナルへの追記（Set実装から呼び出す）
+ * バケットロック保持中に呼び出すことで同一CAN IDの記録順がシーケンス順と一致する
+ * @param shm 書き込み先セグメント
+ * @param data 更新後のCANデータ
+ */
+void can_shm_journal_append(SharedMemoryLayout* shm, const CANData* data);
+
+/**
+ * レコーダが接続中か（Set側のホットパス用）
+ */
+static inline int can_shm_journal_active(const SharedMemoryLayout* shm) {
+    return __atomic_load_n(&shm->journal.active, __ATOMIC_RELAXED) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_JOURNAL_H
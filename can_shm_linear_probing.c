@@ -1,8 +1,17 @@
 #include "can_shm_linear_probing.h"
 #include "can_shm_api.h"
+#include "can_shm_journal.h"
+#include "can_shm_queue.h"
+#include "can_shm_payload.h"
+#include "can_shm_futex.h"
+#include "can_shm_trace.h"
+#include "can_shm_clock.h"
+#include "can_shm_presence.h"
+#include "can_shm_ext.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <time.h>
 #include <pthread.h>
 
@@ -20,18 +29,31 @@ typedef struct {
 
 static HashStats g_hash_stats = {0, 0, 0, 0};
 
-// タイムスタンプ取得（ナノ秒）
-static uint64_t get_timestamp_ns(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
-}
-
 /**
  * seqlockによる安全なデータ書き込み
+ * @return 購読者への通知が必要な更新なら1（On-changeモードでデータ部が不変なら0）
  */
-static void write_can_data_with_seqlock(CANBucket* bucket, uint32_t can_id, 
+static int write_can_data_with_seqlock(CANBucket* bucket, uint32_t can_id, 
                                        uint16_t dlc, const uint8_t* data) {
+    // 比較・格納用にデータ部を64byteへ整形（パディング部分は0）
+    uint8_t incoming[64];
+    if (dlc > 0 && data != NULL) {
+        memcpy(incoming, data, dlc);
+    }
+    if (dlc < 64) {
+        memset(&incoming[dlc], 0, 64 - dlc);
+    }
+    
+    // On-changeモード：同一ID・同一DLCでデータ部（無視マスク以外）が不変なら通知しない
+    uint64_t ignore_mask;
+    uint32_t mode = can_bucket_publish_mode(g_shm_ptr, bucket, can_id, &ignore_mask);
+    int notify = 1;
+    if (mode == CAN_SHM_PUBLISH_ON_CHANGE && bucket->is_valid &&
+        bucket->can_data.can_id == can_id && bucket->can_data.dlc == dlc) {
+        uint64_t diff = can_payload_diff_mask(bucket->can_data.data, incoming);
+        notify = (diff & can_payload_dlc_mask(dlc) & ~ignore_mask) != 0;
+    }
+    
     // seqlock書き込み開始（奇数にする）
     uint32_t seq = bucket->can_data.sequence + 1;
     __atomic_store_n(&bucket->can_data.sequence, seq, __ATOMIC_RELEASE);
@@ -39,13 +61,28 @@ static void write_can_data_with_seqlock(CANBucket* bucket, uint32_t can_id,
     // データ設定
     bucket->can_data.can_id = can_id;
     bucket->can_data.dlc = dlc;
-    if (dlc > 0 && data != NULL) {
-        memcpy(bucket->can_data.data, data, dlc);
-    }
-    bucket->can_data.timestamp = get_timestamp_ns();
+    memcpy(bucket->can_data.data, incoming, 64);
+    bucket->can_data.timestamp = can_shm_clock_now_ns();
     
     // seqlock書き込み完了（偶数にする）
     __atomic_store_n(&bucket->can_data.sequence, seq + 1, __ATOMIC_RELEASE);
+    
+    if (notify) {
+        can_shm_bucket_publish_change(g_shm_ptr, bucket);
+    }
+    
+    // レコーダ接続中のみジャーナルへ追記
+    if (can_shm_journal_active(g_shm_ptr)) {
+        can_shm_journal_append(g_shm_ptr, &bucket->can_data);
+    }
+    
+    // 購読キューへの配信（購読状態はホームバケットに登録されている）
+    uint32_t queue_mask = can_shm_queue_mask(g_shm_ptr, can_id);
+    if (notify && queue_mask != 0) {
+        can_shm_queue_push(g_shm_ptr, queue_mask, &bucket->can_data);
+    }
+    
+    return notify;
 }
 
 /**
@@ -63,6 +100,7 @@ static int read_can_data_with_seqlock(CANBucket* bucket, CANData* data_out) {
             // 書き込み中（奇数）の場合はリトライ
             retry_count++;
             if (retry_count > MAX_RETRIES) {
+                __atomic_add_fetch(&bucket->read_retries, MAX_RETRIES, __ATOMIC_RELAXED);
                 return -1; // リトライ上限
             }
             continue;
@@ -76,10 +114,16 @@ static int read_can_data_with_seqlock(CANBucket* bucket, CANData* data_out) {
         
         retry_count++;
         if (retry_count > MAX_RETRIES) {
+            __atomic_add_fetch(&bucket->read_retries, MAX_RETRIES, __ATOMIC_RELAXED);
             return -1; // リトライ上限
         }
     } while (seq1 != seq2);
     
+    if (retry_count > 1) {
+        __atomic_add_fetch(&bucket->read_retries, retry_count - 1, __ATOMIC_RELAXED);
+        CAN_SHM_TRACE_SEQLOCK_RETRY(data_out->can_id, retry_count - 1);
+    }
+    
     return 0; // 成功
 }
 
@@ -104,25 +148,35 @@ CANShmResult can_shm_set_linear_probing(uint32_t can_id, uint16_t dlc, const uin
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
     
+    CAN_SHM_TRACE_SET_BEGIN(can_id, dlc);
+    
     // 初期ハッシュ値計算
     uint32_t initial_hash = can_id_hash(can_id);
     uint32_t probe_distance = 0;
     int found_slot = 0;
+    int notify = 1;
     
-    // リニアプロービングによる探索
-    for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
+    // リニアプロービングによる探索（CAN_SHM_MAX_PROBE を超える場合は拡張領域）
+    for (int i = 0; i < CAN_SHM_MAX_PROBE && !found_slot; i++) {
         uint32_t probe_index = (initial_hash + i) % MAX_CAN_ENTRIES;
         CANBucket* bucket = &g_shm_ptr->buckets[probe_index];
         
         // バケットロック取得
         if (pthread_mutex_lock(&bucket->mutex) != 0) {
+            CAN_SHM_TRACE_SET_END(can_id, 0);
             return CAN_SHM_ERROR_MUTEX_FAILED;
         }
         
         // 空きバケットまたは同じCAN IDのバケットを発見
         if (bucket->is_valid == 0) {
-            // 空きバケットに新規挿入
-            write_can_data_with_seqlock(bucket, can_id, dlc, data);
+            // 削除で空いたバケットに入る場合、拡張領域に格納済みの値は破棄する
+            // （拡張領域の削除は存在フィルタのビットを落とすため、登録より先に行う）
+            if (can_shm_ext_active(g_shm_ptr)) {
+                can_shm_ext_delete(can_id);
+            }
+            // 空きバケットに新規挿入（存在フィルタへの登録が先）
+            can_shm_presence_add(g_shm_ptr, can_id);
+            notify = write_can_data_with_seqlock(bucket, can_id, dlc, data);
             bucket->is_valid = 1;
             found_slot = 1;
             
@@ -136,7 +190,7 @@ CANShmResult can_shm_set_linear_probing(uint32_t can_id, uint16_t dlc, const uin
             
         } else if (bucket->can_data.can_id == can_id) {
             // 同じCAN IDの更新
-            write_can_data_with_seqlock(bucket, can_id, dlc, data);
+            notify = write_can_data_with_seqlock(bucket, can_id, dlc, data);
             found_slot = 1;
             
             // 統計更新
@@ -145,26 +199,62 @@ CANShmResult can_shm_set_linear_probing(uint32_t can_id, uint16_t dlc, const uin
         }
         
         pthread_mutex_unlock(&bucket->mutex);
+    }
+    
+    if (!found_slot) {
+        // 拡張領域へ格納（満杯なら世代を増やし、旧世代の移行はSetごとに少しずつ進める）
+        CANData stored;
+        int changed;
+        CANShmResult result = can_shm_ext_set(can_id, dlc, data, &stored, &changed);
+        if (result != CAN_SHM_SUCCESS) {
+            // 最終世代も満杯
+            CAN_SHM_TRACE_SET_END(can_id, 0);
+            return result;
+        }
         
-        if (found_slot) {
-            // 最大探査距離更新
-            if (probe_distance > g_hash_stats.max_probe_distance) {
-                g_hash_stats.max_probe_distance = probe_distance;
-            }
-            
-            // グローバル統計更新とSubscribe通知
-            pthread_mutex_lock(&g_shm_ptr->global_mutex);
-            g_shm_ptr->total_sets++;
-            g_shm_ptr->global_sequence++;
-            pthread_cond_broadcast(&g_shm_ptr->update_condition);
-            pthread_mutex_unlock(&g_shm_ptr->global_mutex);
-            
-            return CAN_SHM_SUCCESS;
+        // On-changeモードの判定はセグメント全体の設定のみ（IDごとの設定はバケット単位のため）
+        notify = g_shm_ptr->publish_mode != CAN_SHM_PUBLISH_ON_CHANGE || changed;
+        
+        // 通知・キュー配信はホームバケットで行う（購読キューの書き込み側をホームバケットのロックで1つにする）
+        CANBucket* home = &g_shm_ptr->buckets[initial_hash];
+        if (pthread_mutex_lock(&home->mutex) != 0) {
+            CAN_SHM_TRACE_SET_END(can_id, 0);
+            return CAN_SHM_ERROR_MUTEX_FAILED;
+        }
+        if (notify) {
+            can_shm_bucket_publish_change(g_shm_ptr, home);
         }
+        if (can_shm_journal_active(g_shm_ptr)) {
+            can_shm_journal_append(g_shm_ptr, &stored);
+        }
+        uint32_t queue_mask = can_shm_queue_mask(g_shm_ptr, can_id);
+        if (notify && queue_mask != 0) {
+            can_shm_queue_push(g_shm_ptr, queue_mask, &stored);
+        }
+        pthread_mutex_unlock(&home->mutex);
+        g_hash_stats.total_probes += CAN_SHM_MAX_PROBE;
+        probe_distance = CAN_SHM_MAX_PROBE;
+    }
+    
+    // 最大探査距離更新
+    if (probe_distance > g_hash_stats.max_probe_distance) {
+        g_hash_stats.max_probe_distance = probe_distance;
+    }
+    
+    // グローバル統計更新とSubscribe通知
+    pthread_mutex_lock(&g_shm_ptr->global_mutex);
+    g_shm_ptr->total_sets++;
+    if (notify) {
+        g_shm_ptr->global_sequence++;
+        pthread_cond_broadcast(&g_shm_ptr->update_condition);
+    } else {
+        g_shm_ptr->total_suppressed++;
     }
+    pthread_mutex_unlock(&g_shm_ptr->global_mutex);
     
-    // ハッシュテーブルが満杯
-    return CAN_SHM_ERROR_NOT_FOUND; // 適切なエラーコードが必要
+    CAN_SHM_TRACE_PROBE_COUNT(can_id, probe_distance + 1);
+    CAN_SHM_TRACE_SET_END(can_id, notify);
+    return CAN_SHM_SUCCESS;
 }
 
 /**
@@ -184,21 +274,29 @@ CANShmResult can_shm_get_linear_probing(uint32_t can_id, CANData* data_out) {
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
     
+    // 存在フィルタで未登録と分かれば探査チェーンを辿らない
+    if (!can_shm_presence_maybe(g_shm_ptr, can_id)) {
+        CAN_SHM_TRACE_PROBE_COUNT(can_id, 0);
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+    
     // 初期ハッシュ値計算
     uint32_t initial_hash = can_id_hash(can_id);
     
     // リニアプロービングによる探索
-    for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
+    for (int i = 0; i < CAN_SHM_MAX_PROBE; i++) {
         uint32_t probe_index = (initial_hash + i) % MAX_CAN_ENTRIES;
         CANBucket* bucket = &g_shm_ptr->buckets[probe_index];
         
-        // 空きバケットに到達した場合、データは存在しない
+        // 空きバケットに到達した場合、メインテーブルには存在しない
         if (bucket->is_valid == 0) {
+            CAN_SHM_TRACE_PROBE_COUNT(can_id, i + 1);
             break;
         }
         
         // CAN IDが一致するかチェック
         if (bucket->can_data.can_id == can_id) {
+            CAN_SHM_TRACE_PROBE_COUNT(can_id, i + 1);
             // seqlockによる安全な読み取り
             if (read_can_data_with_seqlock(bucket, data_out) == 0) {
                 // 統計更新
@@ -214,6 +312,17 @@ CANShmResult can_shm_get_linear_probing(uint32_t can_id, CANData* data_out) {
         }
     }
     
+    // 探査範囲に空きがなかったIDは拡張領域
+    if (can_shm_ext_active(g_shm_ptr)) {
+        CANShmResult result = can_shm_ext_get(can_id, data_out);
+        if (result == CAN_SHM_SUCCESS) {
+            pthread_mutex_lock(&g_shm_ptr->global_mutex);
+            g_shm_ptr->total_gets++;
+            pthread_mutex_unlock(&g_shm_ptr->global_mutex);
+        }
+        return result;
+    }
+    
     return CAN_SHM_ERROR_NOT_FOUND;
 }
 
@@ -236,7 +345,7 @@ CANShmResult can_shm_delete_linear_probing(uint32_t can_id) {
     uint32_t initial_hash = can_id_hash(can_id);
     
     // リニアプロービングによる探索
-    for (int i = 0; i < MAX_CAN_ENTRIES; i++) {
+    for (int i = 0; i < CAN_SHM_MAX_PROBE; i++) {
         uint32_t probe_index = (initial_hash + i) % MAX_CAN_ENTRIES;
         CANBucket* bucket = &g_shm_ptr->buckets[probe_index];
         
@@ -257,8 +366,20 @@ CANShmResult can_shm_delete_linear_probing(uint32_t can_id) {
             // 実際の実装では後続要素の再配置が必要
             
             // 簡易実装：Tombstone方式（削除マーク）
+            // シーケンスは戻さない（読み取り側・読み取りキャッシュが削除を検出できるように）
+            uint32_t seq = bucket->can_data.sequence + 1;
+            __atomic_store_n(&bucket->can_data.sequence, seq, __ATOMIC_RELEASE);
             bucket->is_valid = 0;
-            memset(&bucket->can_data, 0, sizeof(CANData));
+            memset((uint8_t*)&bucket->can_data + offsetof(CANData, can_id), 0,
+                   sizeof(CANData) - offsetof(CANData, can_id));
+            __atomic_store_n(&bucket->can_data.sequence, seq + 1, __ATOMIC_RELEASE);
+            // 個別の通知設定は削除したIDのもの（次にバケットを使うIDに引き継がない）
+            bucket->publish_mode = CAN_SHM_PUBLISH_DEFAULT;
+            bucket->ignore_mask = 0;
+            bucket->mode_can_id = 0;
+            // 探査チェーンが変わるため解決済みハンドルを無効化
+            __atomic_add_fetch(&g_shm_ptr->table_generation, 1, __ATOMIC_RELEASE);
+            can_shm_presence_remove(g_shm_ptr, can_id);
             
             // 統計更新
             g_hash_stats.current_entries--;
@@ -270,6 +391,11 @@ CANShmResult can_shm_delete_linear_probing(uint32_t can_id) {
         pthread_mutex_unlock(&bucket->mutex);
     }
     
+    // 存在フィルタのビットは can_shm_ext_delete がスロットロック保持中に落とす
+    if (can_shm_ext_active(g_shm_ptr) && can_shm_ext_delete(can_id) == CAN_SHM_SUCCESS) {
+        return CAN_SHM_SUCCESS;
+    }
+    
     return CAN_SHM_ERROR_NOT_FOUND;
 }
 
@@ -11,11 +11,13 @@ extern "C" {
 /**
  * リニアプロービング法を使用したSet関数
  * ハッシュ衝突時に次の空きバケットを線形探索で見つけてデータを格納
+ * ホーム位置から CAN_SHM_MAX_PROBE 以内に空きがなければ拡張領域（can_shm_ext.h）へ格納
  * 
  * @param can_id CAN ID (29bit有効値)
  * @param dlc データ長 (0~64)
  * @param data データ部へのポインタ (dlc=0の場合NULLも可)
- * @return CAN_SHM_SUCCESS on success, error code on failure
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the extension table is also full,
+ *         CAN_SHM_ERROR_TIMEOUT if a stalled extension migration blocks the store
  */
 CANShmResult can_shm_set_linear_probing(uint32_t can_id, uint16_t dlc, const uint8_t* data);
 
@@ -0,0 +1,79 @@
+#ifndef CAN_SHM_PAYLOAD_H
+#define CAN_SHM_PAYLOAD_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * CANデータ部（64byte）の比較
+ * ===========================
+ *
+ * On-changeモードのSet処理で、格納済みデータ部と新しいデータ部を比較する。
+ * 結果はbyte単位の差分ビットマスク（bit i = data[i]が異なる）で返し、
+ * 呼び出し側で無視マスク（アライブカウンタ等）とDLC範囲を適用する。
+ * AVX2/SSE2が使える場合は32/16byte単位で比較し、それ以外は8byte単位で比較する。
+ */
+
+/**
+ * 64byteのデータ部のbyte単位差分マスク
+ * @param a 比較元（64byte）
+ * @param b 比較先（64byte）
+ * @return bit i = a[i] != b[i]
+ */
+static inline uint64_t can_payload_diff_mask(const uint8_t* a, const uint8_t* b) {
+#if defined(__AVX2__)
+    uint64_t equal = 0;
+    for (int i = 0; i < 64; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        equal |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) << i;
+    }
+    return ~equal;
+#elif defined(__SSE2__)
+    uint64_t equal = 0;
+    for (int i = 0; i < 64; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        equal |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) << i;
+    }
+    return ~equal;
+#else
+    uint64_t diff = 0;
+    for (int i = 0; i < 64; i += 8) {
+        uint64_t wa, wb;
+        memcpy(&wa, a + i, 8);
+        memcpy(&wb, b + i, 8);
+        uint64_t x = wa ^ wb;
+        if (x == 0) {
+            continue;
+        }
+        for (int k = 0; k < 8; k++) {
+            if (a[i + k] != b[i + k]) {
+                diff |= 1ULL << (i + k);
+            }
+        }
+    }
+    return diff;
+#endif
+}
+
+/**
+ * データ部の有効範囲マスク（DLCバイト分のビット）
+ */
+static inline uint64_t can_payload_dlc_mask(uint16_t dlc) {
+    return dlc >= 64 ? ~0ULL : ((1ULL << dlc) - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_PAYLOAD_H
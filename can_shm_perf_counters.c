@@ -0,0 +1,224 @@
+#include "can_shm_perf_counters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+// 明示設定（-1=未設定、環境変数に従う）
+static int g_perf_enabled_override = -1;
+
+// イベント名（出力用）
+static const char* const PERF_EVENT_NAMES[CAN_SHM_PERF_NUM_EVENTS] = {
+    "cycles",
+    "instructions",
+    "cache-refs",
+    "cache-misses",
+    "branch-miss",
+    "L1d-miss",
+    "HITM"
+};
+
+int can_shm_perf_counters_enabled(void) {
+    if (g_perf_enabled_override >= 0) {
+        return g_perf_enabled_override;
+    }
+    const char* env = getenv("CAN_SHM_PERF_COUNTERS");
+    return (env != NULL && env[0] != '\0' && env[0] != '0');
+}
+
+void can_shm_perf_counters_set_enabled(int enable) {
+    g_perf_enabled_override = enable ? 1 : 0;
+}
+
+#ifdef __linux__
+
+/**
+ * 単一イベントのオープン（呼び出しスレッド、全CPU、カーネル除外）
+ */
+static int open_perf_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int can_shm_perf_counters_open(CANShmPerfCounters* pc) {
+    if (pc == NULL) {
+        return 0;
+    }
+
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        pc->fds[i] = -1;
+    }
+
+    pc->fds[CAN_SHM_PERF_CYCLES] =
+        open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    pc->fds[CAN_SHM_PERF_INSTRUCTIONS] =
+        open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    pc->fds[CAN_SHM_PERF_CACHE_REFERENCES] =
+        open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+    pc->fds[CAN_SHM_PERF_CACHE_MISSES] =
+        open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    pc->fds[CAN_SHM_PERF_BRANCH_MISSES] =
+        open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    pc->fds[CAN_SHM_PERF_L1D_READ_MISSES] =
+        open_perf_event(PERF_TYPE_HW_CACHE,
+                        PERF_COUNT_HW_CACHE_L1D |
+                        (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+    // HITMはCPUモデル依存のRAWイベントのため、明示指定時のみ
+    const char* hitm = getenv("CAN_SHM_PERF_HITM_EVENT");
+    if (hitm != NULL && hitm[0] != '\0') {
+        uint64_t raw = strtoull(hitm, NULL, 0);
+        if (raw != 0) {
+            pc->fds[CAN_SHM_PERF_HITM] = open_perf_event(PERF_TYPE_RAW, raw);
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        if (pc->fds[i] >= 0) {
+            count++;
+        }
+    }
+    pc->available = (count > 0);
+    return count;
+}
+
+void can_shm_perf_counters_start(CANShmPerfCounters* pc) {
+    if (pc == NULL || !pc->available) {
+        return;
+    }
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        if (pc->fds[i] >= 0) {
+            ioctl(pc->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(pc->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void can_shm_perf_counters_stop(CANShmPerfCounters* pc, CANShmPerfSample* sample) {
+    if (sample == NULL) {
+        return;
+    }
+    memset(sample, 0, sizeof(*sample));
+    if (pc == NULL || !pc->available) {
+        return;
+    }
+
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        if (pc->fds[i] >= 0) {
+            ioctl(pc->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        if (pc->fds[i] < 0) {
+            continue;
+        }
+
+        // {value, time_enabled, time_running}
+        uint64_t buf[3];
+        if (read(pc->fds[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+            continue;
+        }
+        if (buf[2] == 0) {
+            continue;  // PMUに一度もスケジュールされなかった
+        }
+
+        // 多重化による欠落を補正
+        if (buf[2] < buf[1]) {
+            sample->value[i] = (uint64_t)((double)buf[0] * buf[1] / buf[2]);
+        } else {
+            sample->value[i] = buf[0];
+        }
+        sample->valid[i] = 1;
+    }
+}
+
+void can_shm_perf_counters_close(CANShmPerfCounters* pc) {
+    if (pc == NULL) {
+        return;
+    }
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        if (pc->fds[i] >= 0) {
+            close(pc->fds[i]);
+            pc->fds[i] = -1;
+        }
+    }
+    pc->available = 0;
+}
+
+#else // !__linux__
+
+int can_shm_perf_counters_open(CANShmPerfCounters* pc) {
+    if (pc != NULL) {
+        for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+            pc->fds[i] = -1;
+        }
+        pc->available = 0;
+    }
+    return 0;
+}
+
+void can_shm_perf_counters_start(CANShmPerfCounters* pc) {
+    (void)pc;
+}
+
+void can_shm_perf_counters_stop(CANShmPerfCounters* pc, CANShmPerfSample* sample) {
+    (void)pc;
+    if (sample != NULL) {
+        memset(sample, 0, sizeof(*sample));
+    }
+}
+
+void can_shm_perf_counters_close(CANShmPerfCounters* pc) {
+    (void)pc;
+}
+
+#endif // __linux__
+
+void can_shm_perf_counters_print(const char* label, const CANShmPerfSample* sample,
+                                 uint64_t ops) {
+    if (sample == NULL || ops == 0) {
+        return;
+    }
+
+    int any_valid = 0;
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        any_valid |= sample->valid[i];
+    }
+    if (!any_valid) {
+        printf("%-22s (perf counters unavailable)\n", label);
+        return;
+    }
+
+    printf("%-22s", label);
+    for (int i = 0; i < CAN_SHM_PERF_NUM_EVENTS; i++) {
+        if (sample->valid[i]) {
+            printf(" %s=%.2f", PERF_EVENT_NAMES[i], (double)sample->value[i] / ops);
+        }
+    }
+
+    // IPCは両方計測できた場合のみ
+    if (sample->valid[CAN_SHM_PERF_CYCLES] && sample->valid[CAN_SHM_PERF_INSTRUCTIONS] &&
+        sample->value[CAN_SHM_PERF_CYCLES] > 0) {
+        printf(" IPC=%.2f", (double)sample->value[CAN_SHM_PERF_INSTRUCTIONS] /
+                            sample->value[CAN_SHM_PERF_CYCLES]);
+    }
+    printf("\n");
+}
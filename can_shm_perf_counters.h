@@ -0,0 +1,102 @@
+#ifndef CAN_SHM_PERF_COUNTERS_H
+#define CAN_SHM_PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * ハードウェア性能カウンタ（perf_event_open）ラッパー
+ * ===================================================
+ *
+ * ベンチマークの各フェーズを囲み、キャッシュミス・分岐ミス・命令数・
+ * サイクル数を計測する。カウンタが使用できない環境（コンテナ、
+ * perf_event_paranoid制限、非対応CPU）では各イベントが無効として扱われ、
+ * 計測値の出力は自動的に省略される。
+ *
+ * 環境変数:
+ *   CAN_SHM_PERF_COUNTERS=1     ベンチマークでのカウンタ計測を有効化
+ *   CAN_SHM_PERF_HITM_EVENT=0x.. クロスコアHITM計測用のRAWイベントコード
+ *                               （CPUモデル依存のため明示指定時のみ使用）
+ */
+
+// 計測対象イベント
+typedef enum {
+    CAN_SHM_PERF_CYCLES = 0,        // CPUサイクル
+    CAN_SHM_PERF_INSTRUCTIONS,      // リタイア命令数
+    CAN_SHM_PERF_CACHE_REFERENCES,  // LLC参照
+    CAN_SHM_PERF_CACHE_MISSES,      // LLCミス
+    CAN_SHM_PERF_BRANCH_MISSES,     // 分岐予測ミス
+    CAN_SHM_PERF_L1D_READ_MISSES,   // L1Dリードミス
+    CAN_SHM_PERF_HITM,              // クロスコアHITM（RAWイベント指定時のみ）
+    CAN_SHM_PERF_NUM_EVENTS
+} CANShmPerfEvent;
+
+// 1フェーズ分の計測結果
+typedef struct {
+    uint64_t value[CAN_SHM_PERF_NUM_EVENTS];  // 多重化補正済みのカウント値
+    uint8_t  valid[CAN_SHM_PERF_NUM_EVENTS];  // 計測できたイベントのみ1
+} CANShmPerfSample;
+
+// カウンタセット（プロセス内の呼び出しスレッドを計測）
+typedef struct {
+    int fds[CAN_SHM_PERF_NUM_EVENTS];  // perfイベントFD（-1=使用不可）
+    int available;                     // 1つ以上のカウンタが使用可能なら1
+} CANShmPerfCounters;
+
+/**
+ * ベンチマークでのカウンタ計測が要求されているか
+ * 明示設定がなければ環境変数CAN_SHM_PERF_COUNTERSに従う
+ * @return 1 if enabled, 0 otherwise
+ */
+int can_shm_perf_counters_enabled(void);
+
+/**
+ * ベンチマークでのカウンタ計測を明示的に有効/無効化
+ * @param enable 1=有効, 0=無効
+ */
+void can_shm_perf_counters_set_enabled(int enable);
+
+/**
+ * カウンタセットをオープン
+ * 一部または全てのイベントが使用できなくても失敗にはしない
+ * @param pc カウンタセット
+ * @return 使用可能なイベント数 (0=カウンタ使用不可)
+ */
+int can_shm_perf_counters_open(CANShmPerfCounters* pc);
+
+/**
+ * カウンタをリセットして計測開始
+ * @param pc カウンタセット
+ */
+void can_shm_perf_counters_start(CANShmPerfCounters* pc);
+
+/**
+ * 計測を停止して結果を取得
+ * @param pc カウンタセット
+ * @param sample 計測結果の格納先
+ */
+void can_shm_perf_counters_stop(CANShmPerfCounters* pc, CANShmPerfSample* sample);
+
+/**
+ * カウンタセットをクローズ
+ * @param pc カウンタセット
+ */
+void can_shm_perf_counters_close(CANShmPerfCounters* pc);
+
+/**
+ * 1操作あたりのカウンタ値を出力
+ * @param label フェーズ名
+ * @param sample 計測結果
+ * @param ops フェーズ内の操作回数
+ */
+void can_shm_perf_counters_print(const char* label, const CANShmPerfSample* sample,
+                                 uint64_t ops);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_PERF_COUNTERS_H
@@ -1,74 +1,348 @@
 #include "can_shm_perfect_hash.h"
 #include "can_shm_api.h"
 #include "can_shm_linear_probing.h"
+#include "can_shm_perf_counters.h"
+#include "can_shm_journal.h"
+#include "can_shm_trace.h"
+#include "can_shm_clock.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <sched.h>
 #include <pthread.h>
 
 // 外部変数（can_shm_api.cで定義）
 extern SharedMemoryLayout* g_shm_ptr;
 extern int g_is_initialized;
 
-// 完全ハッシュ専用テーブル（デモ用）
-static CANData g_perfect_hash_table[PERFECT_HASH_TABLE_SIZE];
-static uint8_t g_perfect_hash_valid[PERFECT_HASH_TABLE_SIZE];
-static pthread_mutex_t g_perfect_hash_mutexes[PERFECT_HASH_TABLE_SIZE];
-static int g_perfect_hash_initialized = 0;
+// 書き込み中スロットでのスピン回数上限（超えたらyield）
+#define PHASH_SPIN_LIMIT 64
 
-// 統計情報
+// 変位の探索上限（グループごと）
+#define PHASH_MAX_SEED 0xFFFF
+
+// 統計情報（プロセス内）
 typedef struct {
     uint64_t total_sets;
     uint64_t total_gets;
     uint64_t total_deletes;
     uint64_t total_access_time_ns;
-    uint32_t current_entries;
 } PerfectHashTableStats;
 
 static PerfectHashTableStats g_perfect_stats = {0};
 
-// タイムスタンプ取得（ナノ秒）
-static uint64_t get_timestamp_ns(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+// スロット位置のハッシュ（murmur3の最終化関数、種ごとに別の関数になる）
+static inline uint32_t phash_mix(uint32_t can_id, uint32_t seed) {
+    uint32_t h = can_id ^ (seed * 0x9E3779B9U);
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35U;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline uint32_t phash_group(uint32_t can_id, uint32_t group_mask) {
+    return phash_mix(can_id, 0x5BD1E995U) & group_mask & (CAN_SHM_PHASH_MAX_GROUPS - 1);
+}
+
+// 構築途中の面を読んでも範囲外を参照しないよう上限でもマスクする
+static inline uint32_t phash_slot(const CANPerfectHashTable* table, uint32_t can_id) {
+    uint32_t group = phash_group(can_id, table->group_mask);
+    return phash_mix(can_id, table->seeds[group]) & table->slot_mask & (CAN_SHM_PHASH_MAX_SLOTS - 1);
+}
+
+// 書き手同士の排他を兼ねたseqlock書き込み開始（開始前のシーケンスを返す）
+static uint32_t lock_slot(CANData* slot) {
+    uint32_t spins = 0;
+    uint32_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    for (;;) {
+        if (!(seq & 1) &&
+            __atomic_compare_exchange_n(&slot->sequence, &seq, seq + 1, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            // 奇数シーケンスをデータ部より先に見せる
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return seq;
+        }
+        if (++spins >= PHASH_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+        seq = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    }
+}
+
+static void unlock_slot(CANData* slot, uint32_t seq) {
+    __atomic_store_n(&slot->sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+// 構築用の一時領域
+typedef struct {
+    uint32_t group;
+    uint32_t count;
+} PhashGroupOrder;
+
+static int compare_group_size(const void* a, const void* b) {
+    const PhashGroupOrder* ga = (const PhashGroupOrder*)a;
+    const PhashGroupOrder* gb = (const PhashGroupOrder*)b;
+    if (ga->count != gb->count) {
+        return ga->count > gb->count ? -1 : 1;
+    }
+    return ga->group < gb->group ? -1 : (ga->group > gb->group);
+}
+
+static int compare_id(const void* a, const void* b) {
+    uint32_t ia = *(const uint32_t*)a;
+    uint32_t ib = *(const uint32_t*)b;
+    return ia < ib ? -1 : (ia > ib);
 }
 
 /**
- * 完全ハッシュテーブルの初期化
+ * hash-and-displace による配置の探索
+ * IDをグループに分け、大きいグループから順に全IDが空きスロットに入る種を探す
+ * @return 1 on success (keys_out/seeds_out に配置), 0 if no seed was found for some group
  */
-static int init_perfect_hash_table(void) {
-    if (g_perfect_hash_initialized) {
-        return 1;
-    }
-    
-    // テーブルクリア
-    memset(g_perfect_hash_table, 0, sizeof(g_perfect_hash_table));
-    memset(g_perfect_hash_valid, 0, sizeof(g_perfect_hash_valid));
-    memset(&g_perfect_stats, 0, sizeof(g_perfect_stats));
-    
-    // ミューテックス初期化
-    pthread_mutexattr_t mutex_attr;
-    pthread_mutexattr_init(&mutex_attr);
-    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
-    
-    for (int i = 0; i < PERFECT_HASH_TABLE_SIZE; i++) {
-        if (pthread_mutex_init(&g_perfect_hash_mutexes[i], &mutex_attr) != 0) {
-            // 初期化済みのミューテックスを破棄
-            for (int j = 0; j < i; j++) {
-                pthread_mutex_destroy(&g_perfect_hash_mutexes[j]);
+static int build_layout(const uint32_t* ids, uint32_t count, uint32_t slot_mask, uint32_t group_mask,
+                        uint32_t* keys_out, uint16_t* seeds_out) {
+    uint32_t num_groups = group_mask + 1;
+    uint32_t* start = calloc(num_groups + 1, sizeof(uint32_t));
+    uint32_t* members = malloc(count * sizeof(uint32_t));
+    PhashGroupOrder* order = malloc(num_groups * sizeof(PhashGroupOrder));
+    uint32_t tried[64];
+    int ok = start != NULL && members != NULL && order != NULL;
+
+    if (ok) {
+        // グループごとのID一覧（計数ソート）
+        for (uint32_t i = 0; i < count; i++) {
+            start[phash_group(ids[i], group_mask) + 1]++;
+        }
+        for (uint32_t g = 0; g < num_groups; g++) {
+            start[g + 1] += start[g];
+            order[g].group = g;
+            order[g].count = start[g + 1] - start[g];
+        }
+        uint32_t* fill = calloc(num_groups, sizeof(uint32_t));
+        ok = fill != NULL;
+        for (uint32_t i = 0; ok && i < count; i++) {
+            uint32_t g = phash_group(ids[i], group_mask);
+            members[start[g] + fill[g]++] = ids[i];
+        }
+        free(fill);
+        qsort(order, num_groups, sizeof(PhashGroupOrder), compare_group_size);
+    }
+
+    for (uint32_t s = 0; s <= slot_mask; s++) {
+        keys_out[s] = CAN_SHM_PHASH_NO_ID;
+    }
+    memset(seeds_out, 0, num_groups * sizeof(uint16_t));
+
+    for (uint32_t n = 0; ok && n < num_groups && order[n].count > 0; n++) {
+        uint32_t g = order[n].group;
+        const uint32_t* group_ids = &members[start[g]];
+        uint32_t group_count = order[n].count;
+        if (group_count > 64) {
+            ok = 0;
+            break;
+        }
+
+        int placed = 0;
+        for (uint32_t seed = 1; seed <= PHASH_MAX_SEED && !placed; seed++) {
+            placed = 1;
+            for (uint32_t k = 0; k < group_count && placed; k++) {
+                uint32_t slot = phash_mix(group_ids[k], seed) & slot_mask;
+                if (keys_out[slot] != CAN_SHM_PHASH_NO_ID) {
+                    placed = 0;
+                }
+                for (uint32_t j = 0; j < k && placed; j++) {
+                    if (tried[j] == slot) {
+                        placed = 0;
+                    }
+                }
+                tried[k] = slot;
+            }
+            if (placed) {
+                for (uint32_t k = 0; k < group_count; k++) {
+                    keys_out[tried[k]] = group_ids[k];
+                }
+                seeds_out[g] = (uint16_t)seed;
             }
-            pthread_mutexattr_destroy(&mutex_attr);
-            return 0;
         }
+        ok = placed;
     }
-    
-    pthread_mutexattr_destroy(&mutex_attr);
-    g_perfect_hash_initialized = 1;
-    
-    printf("Perfect hash table initialized (size: %d)\n", PERFECT_HASH_TABLE_SIZE);
-    return 1;
+
+    free(start);
+    free(members);
+    free(order);
+    return ok;
+}
+
+/**
+ * IDセットの構築と公開（publish_mutex 保持中）
+ */
+static CANShmResult publish_locked(const uint32_t* ids, uint32_t count) {
+    CANPerfectHashShared* phash = &g_shm_ptr->phash;
+
+    // 配置は一時領域で決める（構築中の面は読み取り側が参照しうるため、書くのは確定後のみ）
+    uint32_t* sorted = malloc(count * sizeof(uint32_t));
+    uint32_t* keys = malloc(CAN_SHM_PHASH_MAX_SLOTS * sizeof(uint32_t));
+    uint16_t* seeds = malloc(CAN_SHM_PHASH_MAX_GROUPS * sizeof(uint16_t));
+    uint32_t* frozen = malloc(CAN_SHM_PHASH_MAX_SLOTS * sizeof(uint32_t));
+    if (sorted == NULL || keys == NULL || seeds == NULL || frozen == NULL) {
+        free(sorted);
+        free(keys);
+        free(seeds);
+        free(frozen);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANShmResult result = CAN_SHM_SUCCESS;
+    memcpy(sorted, ids, count * sizeof(uint32_t));
+    qsort(sorted, count, sizeof(uint32_t), compare_id);
+    for (uint32_t i = 0; i < count && result == CAN_SHM_SUCCESS; i++) {
+        if (!is_valid_can_id(sorted[i])) {
+            result = CAN_SHM_ERROR_INVALID_ID;
+        } else if (i > 0 && sorted[i] == sorted[i - 1]) {
+            result = CAN_SHM_ERROR_INVALID_PARAM;  // 重複
+        }
+    }
+
+    // スロット数はID数の1.25倍以上、グループ数はID数/4以上（いずれも2の累乗）
+    uint32_t num_slots = 16;
+    while (num_slots < count + count / 4) {
+        num_slots <<= 1;
+    }
+    uint32_t num_groups = 1;
+    while (num_groups * 4 < count) {
+        num_groups <<= 1;
+    }
+    int built = 0;
+    while (result == CAN_SHM_SUCCESS && !built) {
+        built = build_layout(sorted, count, num_slots - 1, num_groups - 1, keys, seeds);
+        if (!built) {
+            if (num_slots >= CAN_SHM_PHASH_MAX_SLOTS) {
+                result = CAN_SHM_ERROR_INVALID_PARAM;
+            }
+            num_slots <<= 1;
+        }
+    }
+
+    if (result == CAN_SHM_SUCCESS) {
+        uint32_t epoch = phash->epoch;
+        CANPerfectHashTable* old = epoch != 0 ? &phash->tables[epoch & 1] : NULL;
+        CANPerfectHashTable* next = &phash->tables[(epoch + 1) & 1];
+
+        // 記述子とスロットの初期化（古い版の書き手が残っていてもスロット単位で排他される）
+        next->num_ids = count;
+        next->slot_mask = num_slots - 1;
+        next->group_mask = num_groups - 1;
+        memcpy(next->seeds, seeds, num_groups * sizeof(uint16_t));
+        for (uint32_t s = 0; s < num_slots; s++) {
+            CANData* slot = &next->slots[s].can_data;
+            uint32_t seq = lock_slot(slot);
+            next->keys[s] = keys[s];
+            next->slots[s].valid = 0;
+            memset((uint8_t*)slot + sizeof(slot->sequence), 0, sizeof(CANData) - sizeof(slot->sequence));
+            unlock_slot(slot, seq);
+        }
+
+        // 旧版の値の引き継ぎ：旧スロットは公開まで書き込み中のまま保持し、
+        // 引き継ぎ後の旧版への書き込みを公開後に新しい版でやり直させる
+        uint32_t old_slots = old != NULL ? old->slot_mask + 1 : 0;
+        for (uint32_t s = 0; s < old_slots; s++) {
+            CANData* slot = &old->slots[s].can_data;
+            frozen[s] = lock_slot(slot);
+            uint32_t can_id = old->keys[s];
+            if (!old->slots[s].valid || can_id == CAN_SHM_PHASH_NO_ID) {
+                continue;
+            }
+            uint32_t target = phash_slot(next, can_id);
+            if (next->keys[target] != can_id) {
+                continue;  // 新しいセットにないID
+            }
+            CANData* dest = &next->slots[target].can_data;
+            uint32_t seq = lock_slot(dest);
+            memcpy((uint8_t*)dest + sizeof(dest->sequence), (const uint8_t*)slot + sizeof(slot->sequence),
+                   sizeof(CANData) - sizeof(slot->sequence));
+            next->slots[target].valid = 1;
+            unlock_slot(dest, seq);
+        }
+
+        // 公開（1回のストアで読み取り側・書き手が新しい面へ切り替わる）
+        phash->version++;
+        next->version = phash->version;
+        __atomic_store_n(&phash->epoch, epoch + 1, __ATOMIC_RELEASE);
+
+        for (uint32_t s = 0; s < old_slots; s++) {
+            unlock_slot(&old->slots[s].can_data, frozen[s]);
+        }
+    }
+
+    free(sorted);
+    free(keys);
+    free(seeds);
+    free(frozen);
+    return result;
+}
+
+/**
+ * IDセットの公開（未公開ならデモ用の固定セット）
+ */
+static CANShmResult ensure_id_set(void) {
+    if (__atomic_load_n(&g_shm_ptr->phash.epoch, __ATOMIC_ACQUIRE) != 0) {
+        return CAN_SHM_SUCCESS;
+    }
+    CANShmResult result = CAN_SHM_SUCCESS;
+    pthread_mutex_lock(&g_shm_ptr->phash.publish_mutex);
+    if (g_shm_ptr->phash.epoch == 0) {
+        result = publish_locked(DEMO_CAN_IDS, PERFECT_HASH_NUM_CAN_IDS);
+    }
+    pthread_mutex_unlock(&g_shm_ptr->phash.publish_mutex);
+    return result;
+}
+
+CANShmResult can_shm_perfect_hash_publish(const uint32_t* can_ids, uint32_t count) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (can_ids == NULL || count == 0 || count > CAN_SHM_PHASH_MAX_IDS) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    if (pthread_mutex_lock(&g_shm_ptr->phash.publish_mutex) != 0) {
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+    CANShmResult result = publish_locked(can_ids, count);
+    pthread_mutex_unlock(&g_shm_ptr->phash.publish_mutex);
+    return result;
+}
+
+CANShmResult can_shm_perfect_hash_get_info(CANPerfectHashInfo* info_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (info_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    CANShmResult result = ensure_id_set();
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    CANPerfectHashShared* phash = &g_shm_ptr->phash;
+    pthread_mutex_lock(&phash->publish_mutex);
+    const CANPerfectHashTable* table = &phash->tables[phash->epoch & 1];
+    info_out->version = table->version;
+    info_out->epoch = phash->epoch;
+    info_out->num_ids = table->num_ids;
+    info_out->num_slots = table->slot_mask + 1;
+    info_out->num_groups = table->group_mask + 1;
+    info_out->stored = 0;
+    for (uint32_t s = 0; s <= table->slot_mask; s++) {
+        info_out->stored += table->slots[s].valid;
+    }
+    pthread_mutex_unlock(&phash->publish_mutex);
+    return CAN_SHM_SUCCESS;
 }
 
 /**
@@ -79,7 +353,7 @@ CANShmResult can_shm_set_perfect_hash(uint32_t can_id, uint16_t dlc, const uint8
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
-    if (!init_perfect_hash_table()) {
+    if (ensure_id_set() != CAN_SHM_SUCCESS) {
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
@@ -96,46 +370,64 @@ CANShmResult can_shm_set_perfect_hash(uint32_t can_id, uint16_t dlc, const uint8
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
     
-    // 完全ハッシュ関数でインデックス計算
-    uint32_t index = can_id_perfect_hash_demo(can_id);
-    if (index == 0xFFFFFFFF || index >= PERFECT_HASH_TABLE_SIZE) {
-        return CAN_SHM_ERROR_INVALID_ID;  // 事前定義されていないCAN ID
-    }
-    
-    // 事前検証: 指定されたCAN IDが正しくマッピングされるかチェック
-    if (!is_valid_can_id_for_perfect_hash_demo(can_id)) {
-        return CAN_SHM_ERROR_INVALID_ID;
-    }
-    
-    uint64_t start_time = get_timestamp_ns();
-    
-    // インデックス用ミューテックス取得
-    if (pthread_mutex_lock(&g_perfect_hash_mutexes[index]) != 0) {
-        return CAN_SHM_ERROR_MUTEX_FAILED;
-    }
-    
-    // データ設定（seqlockは簡略化、必要に応じて追加可能）
-    CANData* entry = &g_perfect_hash_table[index];
-    
-    entry->can_id = can_id;
-    entry->dlc = dlc;
-    entry->sequence++;  // 簡易的なバージョン管理
-    
-    if (dlc > 0 && data != NULL) {
-        memcpy(entry->data, data, dlc);
-    }
-    entry->timestamp = get_timestamp_ns();
-    
-    // 新規エントリの場合
-    if (!g_perfect_hash_valid[index]) {
-        g_perfect_hash_valid[index] = 1;
-        g_perfect_stats.current_entries++;
+    CAN_SHM_TRACE_SET_BEGIN(can_id, dlc);
+    // 受信時刻を兼ねる（時刻取得はフレーム格納と統計で計2回）
+    uint64_t start_time = can_shm_clock_now_ns();
+    CANPerfectHashShared* phash = &g_shm_ptr->phash;
+    
+    for (;;) {
+        uint32_t epoch = __atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE);
+        CANPerfectHashTable* table = &phash->tables[epoch & 1];
+        
+        // 完全ハッシュ関数でインデックス計算（照合で定義外のIDを除く）
+        uint32_t index = phash_slot(table, can_id);
+        if (table->keys[index] != can_id) {
+            if (__atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE) != epoch) {
+                continue;
+            }
+            CAN_SHM_TRACE_SET_END(can_id, 0);
+            return CAN_SHM_ERROR_INVALID_ID;  // IDセットにないCAN ID
+        }
+        
+        // スロットのseqlockで書き手同士も排他
+        CANData* entry = &table->slots[index].can_data;
+        uint32_t seq = lock_slot(entry);
+        if (__atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE) != epoch) {
+            // 新しい版が公開された（引き継ぎ済みの旧版には書かない）
+            unlock_slot(entry, seq);
+            continue;
+        }
+        
+        entry->can_id = can_id;
+        entry->dlc = dlc;
+        if (dlc > 0) {
+            memcpy(entry->data, data, dlc);
+        }
+        if (dlc < 64) {
+            memset(&entry->data[dlc], 0, 64 - dlc);
+        }
+        entry->timestamp = start_time;
+        table->slots[index].valid = 1;
+        
+        // ジャーナル用の記録はロック解除前にコピー（解除後は別の書き手が上書きしうる）
+        int journal = can_shm_journal_active(g_shm_ptr);
+        CANData record;
+        if (journal) {
+            record = *entry;
+            record.sequence = seq + 2;
+        }
+        unlock_slot(entry, seq);
+        
+        // レコーダ接続中のみジャーナルへ追記
+        if (journal) {
+            can_shm_journal_append(g_shm_ptr, &record);
+        }
+        break;
     }
-    
-    pthread_mutex_unlock(&g_perfect_hash_mutexes[index]);
+    CAN_SHM_TRACE_SET_END(can_id, 1);
     
     // 統計更新
-    uint64_t end_time = get_timestamp_ns();
+    uint64_t end_time = can_shm_clock_now_ns();
     g_perfect_stats.total_sets++;
     g_perfect_stats.total_access_time_ns += (end_time - start_time);
     
@@ -150,7 +442,7 @@ CANShmResult can_shm_get_perfect_hash(uint32_t can_id, CANData* data_out) {
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
-    if (!init_perfect_hash_table()) {
+    if (ensure_id_set() != CAN_SHM_SUCCESS) {
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
@@ -163,34 +455,56 @@ CANShmResult can_shm_get_perfect_hash(uint32_t can_id, CANData* data_out) {
         return CAN_SHM_ERROR_INVALID_PARAM;
     }
     
-    // 完全ハッシュ関数でインデックス計算
-    uint32_t index = can_id_perfect_hash_demo(can_id);
-    if (index == 0xFFFFFFFF || index >= PERFECT_HASH_TABLE_SIZE) {
-        return CAN_SHM_ERROR_INVALID_ID;
+    uint64_t start_time = can_shm_clock_now_ns();
+    CANPerfectHashShared* phash = &g_shm_ptr->phash;
+    
+    // 完全ハッシュは常に1バケットの参照で確定
+    CAN_SHM_TRACE_PROBE_COUNT(can_id, 1);
+    
+    // ロックなし：読み取り前後で版（epoch）とスロットのシーケンスが変わっていなければ確定
+    int known, valid = 0;
+    uint32_t spins = 0;
+    for (;;) {
+        uint32_t epoch = __atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE);
+        const CANPerfectHashTable* table = &phash->tables[epoch & 1];
+        uint32_t index = phash_slot(table, can_id);
+        known = table->keys[index] == can_id;
+        if (known) {
+            const CANData* entry = &table->slots[index].can_data;
+            uint32_t seq1 = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+            if (seq1 & 1) {
+                // 書き込み中（公開処理の引き継ぎ中を含む）
+                if (++spins >= PHASH_SPIN_LIMIT) {
+                    sched_yield();
+                    spins = 0;
+                }
+                continue;
+            }
+            *data_out = *entry;
+            valid = table->slots[index].valid;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&entry->sequence, __ATOMIC_RELAXED) != seq1) {
+                continue;
+            }
+        } else {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        }
+        if (__atomic_load_n(&phash->epoch, __ATOMIC_RELAXED) == epoch) {
+            break;
+        }
     }
     
-    // 事前検証
-    if (!is_valid_can_id_for_perfect_hash_demo(can_id)) {
-        return CAN_SHM_ERROR_INVALID_ID;
+    if (!known) {
+        return CAN_SHM_ERROR_INVALID_ID;  // IDセットにないCAN ID
     }
     
-    uint64_t start_time = get_timestamp_ns();
-    
     // データ存在チェック
-    if (!g_perfect_hash_valid[index]) {
+    if (!valid) {
         return CAN_SHM_ERROR_NOT_FOUND;
     }
     
-    // データ取得（ロックフリー読み取り、必要に応じてseqlock追加可能）
-    *data_out = g_perfect_hash_table[index];
-    
-    // 整合性チェック
-    if (data_out->can_id != can_id) {
-        return CAN_SHM_ERROR_NOT_FOUND;  // 理論上発生しないはず
-    }
-    
     // 統計更新
-    uint64_t end_time = get_timestamp_ns();
+    uint64_t end_time = can_shm_clock_now_ns();
     g_perfect_stats.total_gets++;
     g_perfect_stats.total_access_time_ns += (end_time - start_time);
     
@@ -205,7 +519,7 @@ CANShmResult can_shm_delete_perfect_hash(uint32_t can_id) {
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
-    if (!init_perfect_hash_table()) {
+    if (ensure_id_set() != CAN_SHM_SUCCESS) {
         return CAN_SHM_ERROR_INIT_FAILED;
     }
     
@@ -214,38 +528,42 @@ CANShmResult can_shm_delete_perfect_hash(uint32_t can_id) {
         return CAN_SHM_ERROR_INVALID_ID;
     }
     
-    // 完全ハッシュ関数でインデックス計算
-    uint32_t index = can_id_perfect_hash_demo(can_id);
-    if (index == 0xFFFFFFFF || index >= PERFECT_HASH_TABLE_SIZE) {
-        return CAN_SHM_ERROR_INVALID_ID;
-    }
+    uint64_t start_time = can_shm_clock_now_ns();
+    CANPerfectHashShared* phash = &g_shm_ptr->phash;
     
-    if (!is_valid_can_id_for_perfect_hash_demo(can_id)) {
-        return CAN_SHM_ERROR_INVALID_ID;
-    }
-    
-    uint64_t start_time = get_timestamp_ns();
-    
-    // ミューテックス取得
-    if (pthread_mutex_lock(&g_perfect_hash_mutexes[index]) != 0) {
-        return CAN_SHM_ERROR_MUTEX_FAILED;
-    }
-    
-    // データ存在チェック
-    if (!g_perfect_hash_valid[index]) {
-        pthread_mutex_unlock(&g_perfect_hash_mutexes[index]);
-        return CAN_SHM_ERROR_NOT_FOUND;
+    for (;;) {
+        uint32_t epoch = __atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE);
+        CANPerfectHashTable* table = &phash->tables[epoch & 1];
+        uint32_t index = phash_slot(table, can_id);
+        if (table->keys[index] != can_id) {
+            if (__atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE) != epoch) {
+                continue;
+            }
+            return CAN_SHM_ERROR_INVALID_ID;
+        }
+        
+        CANData* entry = &table->slots[index].can_data;
+        uint32_t seq = lock_slot(entry);
+        if (__atomic_load_n(&phash->epoch, __ATOMIC_ACQUIRE) != epoch) {
+            unlock_slot(entry, seq);
+            continue;
+        }
+        
+        // データ存在チェック
+        if (!table->slots[index].valid) {
+            unlock_slot(entry, seq);
+            return CAN_SHM_ERROR_NOT_FOUND;
+        }
+        
+        // 削除実行
+        table->slots[index].valid = 0;
+        memset((uint8_t*)entry + sizeof(entry->sequence), 0, sizeof(CANData) - sizeof(entry->sequence));
+        unlock_slot(entry, seq);
+        break;
     }
     
-    // 削除実行
-    g_perfect_hash_valid[index] = 0;
-    memset(&g_perfect_hash_table[index], 0, sizeof(CANData));
-    g_perfect_stats.current_entries--;
-    
-    pthread_mutex_unlock(&g_perfect_hash_mutexes[index]);
-    
     // 統計更新
-    uint64_t end_time = get_timestamp_ns();
+    uint64_t end_time = can_shm_clock_now_ns();
     g_perfect_stats.total_deletes++;
     g_perfect_stats.total_access_time_ns += (end_time - start_time);
     
@@ -256,12 +574,16 @@ CANShmResult can_shm_delete_perfect_hash(uint32_t can_id) {
  * 完全ハッシュテーブルの統計情報を取得
  */
 void can_shm_print_perfect_hash_stats(void) {
+    CANPerfectHashInfo info;
+    memset(&info, 0, sizeof(info));
+    can_shm_perfect_hash_get_info(&info);
+    
     printf("=== Perfect Hash Table Statistics ===\n");
-    printf("Table Size: %d\n", PERFECT_HASH_TABLE_SIZE);
-    printf("Current Entries: %u / %d\n", 
-           g_perfect_stats.current_entries, PERFECT_HASH_TABLE_SIZE);
+    printf("ID Set Version: %u (%u IDs)\n", info.version, info.num_ids);
+    printf("Table Size: %u\n", info.num_slots);
+    printf("Current Entries: %u / %u\n", info.stored, info.num_slots);
     printf("Load Factor: %.2f%%\n", 
-           (double)g_perfect_stats.current_entries / PERFECT_HASH_TABLE_SIZE * 100.0);
+           info.num_slots > 0 ? (double)info.stored / info.num_slots * 100.0 : 0.0);
     
     printf("Total Operations:\n");
     printf("  Set: %lu\n", g_perfect_stats.total_sets);
@@ -315,7 +637,7 @@ void can_shm_benchmark_perfect_vs_linear(void) {
     printf("Operations per test: %d (+ %d warm-up)\n", NUM_OPERATIONS, NUM_WARM_UP);
     
     // 初期化確認
-    if (!init_perfect_hash_table()) {
+    if (ensure_id_set() != CAN_SHM_SUCCESS) {
         printf("Error: Failed to initialize perfect hash table\n");
         return;
     }
@@ -327,6 +649,24 @@ void can_shm_benchmark_perfect_vs_linear(void) {
     // ウォームアップ用のテストデータ準備
     uint8_t test_data[] = {0x01, 0x02, 0x03, 0x04};
     
+    // 性能カウンタ（要求時のみ、使用不可なら時間計測のみ）
+    CANShmPerfCounters perf;
+    CANShmPerfSample perfect_set_perf, perfect_get_perf;
+    CANShmPerfSample linear_set_perf, linear_get_perf;
+    int use_perf = 0;
+    
+    memset(&perfect_set_perf, 0, sizeof(perfect_set_perf));
+    memset(&perfect_get_perf, 0, sizeof(perfect_get_perf));
+    memset(&linear_set_perf, 0, sizeof(linear_set_perf));
+    memset(&linear_get_perf, 0, sizeof(linear_get_perf));
+    
+    if (can_shm_perf_counters_enabled()) {
+        use_perf = (can_shm_perf_counters_open(&perf) > 0);
+        if (!use_perf) {
+            printf("Perf counters requested but unavailable, reporting timings only\n");
+        }
+    }
+    
     printf("\n--- Perfect Hash Performance ---\n");
     
     // Perfect Hash Set ベンチマーク
@@ -338,12 +678,18 @@ void can_shm_benchmark_perfect_vs_linear(void) {
         can_shm_set_perfect_hash(can_id, 4, test_data);
     }
     
+    if (use_perf) {
+        can_shm_perf_counters_start(&perf);
+    }
     clock_gettime(CLOCK_MONOTONIC, &start);
     for (int i = 0; i < NUM_OPERATIONS; i++) {
         uint32_t can_id = DEMO_CAN_IDS[i % PERFECT_HASH_NUM_CAN_IDS];
         can_shm_set_perfect_hash(can_id, 4, test_data);
     }
     clock_gettime(CLOCK_MONOTONIC, &end);
+    if (use_perf) {
+        can_shm_perf_counters_stop(&perf, &perfect_set_perf);
+    }
     
     perfect_set_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
     
@@ -357,12 +703,18 @@ void can_shm_benchmark_perfect_vs_linear(void) {
         can_shm_get_perfect_hash(can_id, &retrieved_data);
     }
     
+    if (use_perf) {
+        can_shm_perf_counters_start(&perf);
+    }
     clock_gettime(CLOCK_MONOTONIC, &start);
     for (int i = 0; i < NUM_OPERATIONS; i++) {
         uint32_t can_id = DEMO_CAN_IDS[i % PERFECT_HASH_NUM_CAN_IDS];
         can_shm_get_perfect_hash(can_id, &retrieved_data);
     }
     clock_gettime(CLOCK_MONOTONIC, &end);
+    if (use_perf) {
+        can_shm_perf_counters_stop(&perf, &perfect_get_perf);
+    }
     
     perfect_get_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
     
@@ -377,12 +729,18 @@ void can_shm_benchmark_perfect_vs_linear(void) {
         can_shm_set_linear_probing(can_id, 4, test_data);
     }
     
+    if (use_perf) {
+        can_shm_perf_counters_start(&perf);
+    }
     clock_gettime(CLOCK_MONOTONIC, &start);
     for (int i = 0; i < NUM_OPERATIONS; i++) {
         uint32_t can_id = DEMO_CAN_IDS[i % PERFECT_HASH_NUM_CAN_IDS];
         can_shm_set_linear_probing(can_id, 4, test_data);
     }
     clock_gettime(CLOCK_MONOTONIC, &end);
+    if (use_perf) {
+        can_shm_perf_counters_stop(&perf, &linear_set_perf);
+    }
     
     linear_set_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
     
@@ -395,12 +753,18 @@ void can_shm_benchmark_perfect_vs_linear(void) {
         can_shm_get_linear_probing(can_id, &retrieved_data);
     }
     
+    if (use_perf) {
+        can_shm_perf_counters_start(&perf);
+    }
     clock_gettime(CLOCK_MONOTONIC, &start);
     for (int i = 0; i < NUM_OPERATIONS; i++) {
         uint32_t can_id = DEMO_CAN_IDS[i % PERFECT_HASH_NUM_CAN_IDS];
         can_shm_get_linear_probing(can_id, &retrieved_data);
     }
     clock_gettime(CLOCK_MONOTONIC, &end);
+    if (use_perf) {
+        can_shm_perf_counters_stop(&perf, &linear_get_perf);
+    }
     
     linear_get_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
     
@@ -436,6 +800,15 @@ void can_shm_benchmark_perfect_vs_linear(void) {
                perfect_get_time / linear_get_time);
     }
     
+    if (use_perf) {
+        printf("\n=== Hardware Counters (per operation) ===\n");
+        can_shm_perf_counters_print("Perfect Hash Set", &perfect_set_perf, NUM_OPERATIONS);
+        can_shm_perf_counters_print("Perfect Hash Get", &perfect_get_perf, NUM_OPERATIONS);
+        can_shm_perf_counters_print("Linear Probing Set", &linear_set_perf, NUM_OPERATIONS);
+        can_shm_perf_counters_print("Linear Probing Get", &linear_get_perf, NUM_OPERATIONS);
+        can_shm_perf_counters_close(&perf);
+    }
+    
     printf("\nNote: Perfect Hash guarantees O(1) with zero collisions\n");
     printf("      Linear Probing performance depends on load factor\n");
     printf("============================================================\n");
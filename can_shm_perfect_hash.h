@@ -9,11 +9,54 @@
 extern "C" {
 #endif
 
+/*
+ * 共有メモリ内の完全ハッシュ
+ * ==========================
+ *
+ * IDセットの記述子（グループごとの変位）と値のテーブルは共有メモリに2面あり、
+ * 新しいIDセットは参照されていない面に構築して epoch の1回のストアで公開する。
+ *
+ * - 構築は hash-and-displace：IDをグループに分け、大きいグループから順に
+ *   全IDが空きスロットに入る種を探す。Getはグループの種の参照とハッシュ2回で1スロットに確定する
+ * - 公開時、新旧両方のセットにあるIDの値は新しい面へ引き継ぐ。引き継ぎ中の旧スロットは
+ *   書き込み中として保持し、その間のSetは公開後に新しい面でやり直す
+ * - Get/Setはロックを取らない。読み取り前後で epoch とスロットのシーケンスを比較し、
+ *   変化していれば読み直す
+ * - 最初の操作時にIDセットが未公開なら、デモ用の固定セット（DEMO_CAN_IDS）を公開する
+ */
+
+// 公開中のIDセットの状態
+typedef struct {
+    uint32_t version;            // 版数（公開ごとに増加）
+    uint32_t epoch;
+    uint32_t num_ids;            // ID数
+    uint32_t num_slots;          // スロット数
+    uint32_t num_groups;         // 変位グループ数
+    uint32_t stored;             // 値が格納済みのID数
+} CANPerfectHashInfo;
+
+/**
+ * IDセットの構築と公開（公開中のセットと共通するIDの値は引き継ぐ）
+ * 実行中の読み取り側・書き手は停止しない。公開はプロセス間で排他される
+ * @param can_ids IDの配列（重複不可）
+ * @param count ID数 (1~CAN_SHM_PHASH_MAX_IDS)
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_INVALID_ID if an ID is invalid,
+ *         CAN_SHM_ERROR_INVALID_PARAM if the set is empty, too large, has duplicates or cannot be placed
+ */
+CANShmResult can_shm_perfect_hash_publish(const uint32_t* can_ids, uint32_t count);
+
+/**
+ * 公開中のIDセットの状態取得
+ * @param info_out 格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_perfect_hash_get_info(CANPerfectHashInfo* info_out);
+
 /**
  * 完全ハッシュ関数を使用したSet関数
  * ハッシュ衝突が発生しないため、常にO(1)での格納が保証される
  * 
- * @param can_id CAN ID (事前定義されたIDセットのみ有効)
+ * @param can_id CAN ID (公開中のIDセットのみ有効)
  * @param dlc データ長 (0~64)
  * @param data データ部へのポインタ (dlc=0の場合NULLも可)
  * @return CAN_SHM_SUCCESS on success, error code on failure
@@ -24,7 +67,7 @@ CANShmResult can_shm_set_perfect_hash(uint32_t can_id, uint16_t dlc, const uint8
  * 完全ハッシュ関数を使用したGet関数
  * ハッシュ衝突が発生しないため、常にO(1)での取得が保証される
  * 
- * @param can_id CAN ID (事前定義されたIDセットのみ有効)
+ * @param can_id CAN ID (公開中のIDセットのみ有効)
  * @param data_out 取得したCANデータの格納先
  * @return CAN_SHM_SUCCESS on success, error code on failure
  */
@@ -33,7 +76,7 @@ CANShmResult can_shm_get_perfect_hash(uint32_t can_id, CANData* data_out);
 /**
  * 完全ハッシュ関数での削除
  * 
- * @param can_id CAN ID (事前定義されたIDセットのみ有効)
+ * @param can_id CAN ID (公開中のIDセットのみ有効)
  * @return CAN_SHM_SUCCESS on success, error code on failure
  */
 CANShmResult can_shm_delete_perfect_hash(uint32_t can_id);
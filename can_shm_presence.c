@@ -0,0 +1,50 @@
+#include "can_shm_presence.h"
+#include "can_shm_api.h"
+#include <string.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern int g_is_initialized;
+
+static CANShmResult resolve_segment(uint32_t bus, SharedMemoryLayout** shm_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (bus >= CAN_SHM_MAX_BUSES) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    *shm_out = can_shm_bus_segment(bus);
+    return *shm_out != NULL ? CAN_SHM_SUCCESS : CAN_SHM_ERROR_INIT_FAILED;
+}
+
+CANShmResult can_shm_presence_get_info(uint32_t bus, CANPresenceInfo* info_out) {
+    if (info_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+
+    memset(info_out, 0, sizeof(CANPresenceInfo));
+    for (uint32_t i = 0; i < CAN_SHM_PRESENCE_STD_WORDS; i++) {
+        info_out->std_ids += (uint32_t)__builtin_popcountll(
+            __atomic_load_n(&shm->presence.std_bitmap[i], __ATOMIC_RELAXED));
+    }
+    for (uint32_t b = 0; b < CAN_SHM_PRESENCE_BLOOM_BLOCKS; b++) {
+        for (uint32_t w = 0; w < 8; w++) {
+            info_out->bloom_bits_set += (uint32_t)__builtin_popcountll(
+                __atomic_load_n(&shm->presence.bloom[b].words[w], __ATOMIC_RELAXED));
+        }
+    }
+    info_out->bloom_bits_total = CAN_SHM_PRESENCE_BLOOM_BLOCKS * 512;
+
+    double fill = (double)info_out->bloom_bits_set / info_out->bloom_bits_total;
+    double rate = 1.0;
+    for (int k = 0; k < CAN_SHM_PRESENCE_BLOOM_HASHES; k++) {
+        rate *= fill;
+    }
+    info_out->bloom_false_positive_rate = rate;
+    return CAN_SHM_SUCCESS;
+}
@@ -0,0 +1,110 @@
+#ifndef CAN_SHM_PRESENCE_H
+#define CAN_SHM_PRESENCE_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 登録済みIDの存在フィルタ（共有メモリ内）
+ * ========================================
+ *
+ * 未登録IDのGet（診断ツールのポーリングで多い）をバケットや探査チェーンに
+ * 触れずに NOT_FOUND とするための要約。
+ *
+ * - 11bit ID（0~0x7FF）は直接ビットマップ（256byte）。判定は正確
+ * - それ以上のIDはブロック化Bloomフィルタ。IDのハッシュでブロック（64byte）を選び、
+ *   そのブロック内の4ビットを立てる。判定は1キャッシュラインの読み込みで済み、
+ *   偽陽性（通常の探索にフォールバック）はあるが偽陰性はない
+ * - ビットは書き込み側がバケットを有効にする前に立てる（未設定なら書き込み未完了として扱える）。
+ *   既に立っている場合は書き込まないため、定常状態のSetでキャッシュラインを汚さない
+ * - 削除（can_shm_delete_linear_probing）で落とせるのはビットマップ側のみ。
+ *   Bloomフィルタのビットはセグメント再作成まで残る
+ */
+
+// Bloomフィルタ用ハッシュ（上位ビットでブロック、中位36bitをブロック内の位置4つに使う）
+static inline uint64_t can_shm_presence_hash(uint32_t can_id) {
+    return (uint64_t)can_id * 0x9E3779B97F4A7C15ULL;
+}
+
+static inline uint32_t can_shm_presence_bit(uint64_t hash, int k) {
+    return (uint32_t)(hash >> (20 + 9 * k)) & 511;
+}
+
+/**
+ * IDが登録済みの可能性があれば1（0なら確実に未登録）
+ */
+static inline int can_shm_presence_maybe(const SharedMemoryLayout* shm, uint32_t can_id) {
+    if (can_id <= CAN_SHM_PRESENCE_STD_MAX) {
+        uint64_t word = __atomic_load_n(&shm->presence.std_bitmap[can_id >> 6], __ATOMIC_ACQUIRE);
+        return (int)((word >> (can_id & 63)) & 1);
+    }
+
+    uint64_t hash = can_shm_presence_hash(can_id);
+    const CANPresenceBlock* block = &shm->presence.bloom[hash >> (64 - CAN_SHM_PRESENCE_BLOOM_BITS)];
+    for (int k = 0; k < CAN_SHM_PRESENCE_BLOOM_HASHES; k++) {
+        uint32_t bit = can_shm_presence_bit(hash, k);
+        if (!((__atomic_load_n(&block->words[bit >> 6], __ATOMIC_ACQUIRE) >> (bit & 63)) & 1)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// ワードにビットを立てる（立っていれば書き込まない）
+static inline void can_shm_presence_set_bits(uint64_t* word, uint64_t mask) {
+    if ((__atomic_load_n(word, __ATOMIC_RELAXED) & mask) != mask) {
+        __atomic_fetch_or(word, mask, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * IDの登録（バケットを有効にする前に呼ぶ）
+ */
+static inline void can_shm_presence_add(SharedMemoryLayout* shm, uint32_t can_id) {
+    if (can_id <= CAN_SHM_PRESENCE_STD_MAX) {
+        can_shm_presence_set_bits(&shm->presence.std_bitmap[can_id >> 6], 1ULL << (can_id & 63));
+        return;
+    }
+
+    uint64_t hash = can_shm_presence_hash(can_id);
+    CANPresenceBlock* block = &shm->presence.bloom[hash >> (64 - CAN_SHM_PRESENCE_BLOOM_BITS)];
+    for (int k = 0; k < CAN_SHM_PRESENCE_BLOOM_HASHES; k++) {
+        uint32_t bit = can_shm_presence_bit(hash, k);
+        can_shm_presence_set_bits(&block->words[bit >> 6], 1ULL << (bit & 63));
+    }
+}
+
+/**
+ * IDの登録解除（11bit IDのみ、バケットを無効にした後に呼ぶ）
+ */
+static inline void can_shm_presence_remove(SharedMemoryLayout* shm, uint32_t can_id) {
+    if (can_id <= CAN_SHM_PRESENCE_STD_MAX) {
+        __atomic_fetch_and(&shm->presence.std_bitmap[can_id >> 6], ~(1ULL << (can_id & 63)), __ATOMIC_RELEASE);
+    }
+}
+
+// 存在フィルタの状態（can_shm_presence_get_info用）
+typedef struct {
+    uint32_t std_ids;            // ビットマップに登録済みの11bit ID数
+    uint32_t bloom_bits_set;     // Bloomフィルタで立っているビット数
+    uint32_t bloom_bits_total;   // Bloomフィルタの総ビット数
+    double   bloom_false_positive_rate;  // 未登録IDが通過する推定確率（充填率^ハッシュ数）
+} CANPresenceInfo;
+
+/**
+ * 存在フィルタの状態取得
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param info_out 格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_presence_get_info(uint32_t bus, CANPresenceInfo* info_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_PRESENCE_H
@@ -0,0 +1,239 @@
+#include "can_shm_queue.h"
+#include "can_shm_api.h"
+#include "can_shm_futex.h"
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern SharedMemoryLayout* g_shm_ptr;
+extern int g_is_initialized;
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ハンドルが指す使用中キュー（不正ならNULL）
+static CANSubscriberQueue* handle_queue(const CANQueueHandle* handle) {
+    if (handle == NULL || handle->index >= CAN_SHM_MAX_QUEUES) {
+        return NULL;
+    }
+    CANSubscriberQueue* queue = &g_shm_ptr->queues[handle->index];
+    if (__atomic_load_n(&queue->in_use, __ATOMIC_ACQUIRE) == 0 || queue->can_id != handle->can_id) {
+        return NULL;
+    }
+    return queue;
+}
+
+// CAN IDを格納しているバケット（リニアプロービングで移動した場合を含む、未格納ならNULL）
+static CANBucket* find_stored_bucket(uint32_t can_id) {
+    uint32_t home = can_id_hash(can_id);
+    for (uint32_t i = 0; i < CAN_SHM_MAX_PROBE; i++) {
+        CANBucket* bucket = &g_shm_ptr->buckets[(home + i) % MAX_CAN_ENTRIES];
+        if (!bucket->is_valid) {
+            return NULL;
+        }
+        if (bucket->can_data.can_id == can_id) {
+            return bucket;
+        }
+    }
+    return NULL;
+}
+
+CANShmResult can_shm_queue_subscribe(uint32_t can_id, CANQueueHandle* handle_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+
+    if (handle_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    // 空きキューの確保
+    uint32_t index;
+    for (index = 0; index < CAN_SHM_MAX_QUEUES; index++) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&g_shm_ptr->queues[index].in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (index == CAN_SHM_MAX_QUEUES) {
+        return CAN_SHM_ERROR_NOT_FOUND;  // キューが全て使用中
+    }
+
+    // queue_mask に載る前なので書き込み側はまだ存在しない
+    CANSubscriberQueue* queue = &g_shm_ptr->queues[index];
+    queue->can_id = can_id;
+    queue->owner_pid = (uint32_t)getpid();
+    queue->head = 0;
+    queue->tail = 0;
+    queue->overruns = 0;
+    queue->waiting = 0;
+
+    // ホームバケットのロック下で配信対象に追加（以降のSetから積まれる）
+    CANBucket* home = &g_shm_ptr->buckets[can_id_hash(can_id)];
+    if (pthread_mutex_lock(&home->mutex) != 0) {
+        __atomic_store_n(&queue->in_use, 0, __ATOMIC_RELEASE);
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+    __atomic_or_fetch(&home->queue_mask, 1U << index, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&home->mutex);
+
+    handle_out->index = index;
+    handle_out->can_id = can_id;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_queue_unsubscribe(const CANQueueHandle* handle) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANSubscriberQueue* queue = handle_queue(handle);
+    if (queue == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANBucket* home = &g_shm_ptr->buckets[can_id_hash(handle->can_id)];
+    if (pthread_mutex_lock(&home->mutex) != 0) {
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+    __atomic_and_fetch(&home->queue_mask, ~(1U << handle->index), __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&home->mutex);
+
+    // プロービングで別バケットに格納されているIDは、そのバケットのSetが抜けるのを待つ
+    CANBucket* stored = find_stored_bucket(handle->can_id);
+    if (stored != NULL && stored != home) {
+        pthread_mutex_lock(&stored->mutex);
+        pthread_mutex_unlock(&stored->mutex);
+    }
+
+    __atomic_store_n(&queue->in_use, 0, __ATOMIC_RELEASE);
+    return CAN_SHM_SUCCESS;
+}
+
+void can_shm_queue_push(SharedMemoryLayout* shm, uint32_t mask, const CANData* data) {
+    while (mask != 0) {
+        uint32_t index = (uint32_t)__builtin_ctz(mask);
+        mask &= mask - 1;
+
+        // ホームバケットを共有する別IDの購読は対象外
+        CANSubscriberQueue* queue = &shm->queues[index];
+        if (queue->can_id != data->can_id) {
+            continue;
+        }
+
+        uint32_t head = queue->head;
+        uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+        if (head - tail >= CAN_SHM_QUEUE_SIZE) {
+            // 満杯：Set側は待たずに破棄
+            __atomic_store_n(&queue->overruns, queue->overruns + 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        queue->entries[head & CAN_SHM_QUEUE_MASK] = *data;
+
+        // SEQ_CSTのストアで後続のwaiting読み込みとの順序を保証（待機側の登録と対になる）
+        __atomic_store_n(&queue->head, head + 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&queue->waiting, __ATOMIC_RELAXED) != 0) {
+            can_shm_futex_wake_all(&queue->head);
+        }
+    }
+}
+
+// 空でなくなるまで待機（1=データあり, 0=タイムアウト）
+static int wait_not_empty(CANSubscriberQueue* queue, uint32_t tail, int32_t timeout_ms) {
+    uint64_t deadline_ns = timeout_ms > 0 ? get_timestamp_ns() + (uint64_t)timeout_ms * 1000000ULL : 0;
+
+    for (;;) {
+        if (__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) != tail) {
+            return 1;
+        }
+        if (timeout_ms == 0) {
+            return 0;
+        }
+
+        struct timespec timeout_spec;
+        struct timespec* timeout_ptr = NULL;
+        if (timeout_ms > 0) {
+            uint64_t now_ns = get_timestamp_ns();
+            if (now_ns >= deadline_ns) {
+                return 0;
+            }
+            uint64_t remain = deadline_ns - now_ns;
+            timeout_spec.tv_sec = (time_t)(remain / 1000000000ULL);
+            timeout_spec.tv_nsec = (long)(remain % 1000000000ULL);
+            timeout_ptr = &timeout_spec;
+        }
+
+        // 待機登録後にheadを再確認（Set側のheadストアと対になる）
+        __atomic_store_n(&queue->waiting, 1, __ATOMIC_SEQ_CST);
+        uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST);
+        if (head == tail) {
+            can_shm_futex_wait(&queue->head, head, timeout_ptr);
+        }
+        __atomic_store_n(&queue->waiting, 0, __ATOMIC_RELAXED);
+    }
+}
+
+CANShmResult can_shm_queue_receive(const CANQueueHandle* handle, CANData* out, uint32_t max,
+                                   int32_t timeout_ms, uint32_t* count_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANSubscriberQueue* queue = handle_queue(handle);
+    if (queue == NULL || out == NULL || max == 0 || count_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    *count_out = 0;
+    uint32_t tail = queue->tail;
+    if (!wait_not_empty(queue, tail, timeout_ms)) {
+        return CAN_SHM_ERROR_TIMEOUT;
+    }
+
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+    if (count > max) {
+        count = max;
+    }
+
+    // リング終端で折り返す場合は2回に分けてコピー
+    uint32_t start = tail & CAN_SHM_QUEUE_MASK;
+    uint32_t first = CAN_SHM_QUEUE_SIZE - start;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(out, &queue->entries[start], first * sizeof(CANData));
+    memcpy(out + first, &queue->entries[0], (count - first) * sizeof(CANData));
+
+    // 読み出し完了後に領域を書き込み側へ返却
+    __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+
+    *count_out = count;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_queue_get_overruns(const CANQueueHandle* handle, uint64_t* overruns_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANSubscriberQueue* queue = handle_queue(handle);
+    if (queue == NULL || overruns_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    *overruns_out = __atomic_load_n(&queue->overruns, __ATOMIC_RELAXED);
+    return CAN_SHM_SUCCESS;
+}
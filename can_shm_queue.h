@@ -0,0 +1,88 @@
+#ifndef CAN_SHM_QUEUE_H
+#define CAN_SHM_QUEUE_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 購読キュー（購読ごとのSPSCリングバッファ）
+ * ==========================================
+ *
+ * 購読1件につき共有メモリ内のリングバッファを1つ割り当て、Set側は
+ * 購読されているCAN IDの更新のみをそのリングへコピーする。
+ * 同一CAN IDのSetはバケットロックで直列化されるため、リングの書き込み側は
+ * 常に1つであり、head/tailのみで同期できる（グローバルロック不要）。
+ * このため1つのIDは can_shm_set 系か、リニアプロービング・ハンドル経由の
+ * Set（探査先バケットのロック）のどちらか一方でのみ書き込むこと。
+ * 読み出し側が追いついている限り更新は全て順序どおりに届く。
+ * リングが満杯の場合、Set側は待たずにそのフレームを捨てて overruns を加算する。
+ * On-changeモードで通知が省略された更新はキューにも積まれない。
+ */
+
+// 購読ハンドル（プロセスローカル）
+typedef struct {
+    uint32_t index;     // queues[] のインデックス
+    uint32_t can_id;    // 購読対象CAN ID
+} CANQueueHandle;
+
+/**
+ * 購読キューの割り当てと購読開始
+ * 購読開始以降の更新のみがキューに積まれる
+ * @param can_id 購読対象CAN ID
+ * @param handle_out 購読ハンドルの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_queue_subscribe(uint32_t can_id, CANQueueHandle* handle_out);
+
+/**
+ * 購読終了とキューの解放
+ * @param handle 購読ハンドル
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_queue_unsubscribe(const CANQueueHandle* handle);
+
+/**
+ * キューからまとめて受信
+ * キューが空の場合は更新が届くかタイムアウトするまでfutexで待機する
+ * @param handle 購読ハンドル
+ * @param out 受信したCANデータの格納先配列
+ * @param max 配列の要素数
+ * @param timeout_ms タイムアウト時間 (0=待機しない, -1=無期限)
+ * @param count_out 受信件数の格納先
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_TIMEOUT if empty, error code on failure
+ */
+CANShmResult can_shm_queue_receive(const CANQueueHandle* handle, CANData* out, uint32_t max,
+                                   int32_t timeout_ms, uint32_t* count_out);
+
+/**
+ * キュー満杯で失われた更新数の取得
+ * @param handle 購読ハンドル
+ * @param overruns_out 累計ドロップ数の格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_queue_get_overruns(const CANQueueHandle* handle, uint64_t* overruns_out);
+
+/**
+ * 購読キューへの配信（Set実装からバケットロック保持中に呼び出す）
+ * @param shm 書き込み先セグメント
+ * @param mask 対象キューのビットマスク（ホームバケットの queue_mask）
+ * @param data 更新後のCANデータ
+ */
+void can_shm_queue_push(SharedMemoryLayout* shm, uint32_t mask, const CANData* data);
+
+/**
+ * CAN IDを購読中のキューのビットマスク（Set側のホットパス用）
+ */
+static inline uint32_t can_shm_queue_mask(const SharedMemoryLayout* shm, uint32_t can_id) {
+    return __atomic_load_n(&shm->buckets[can_id_hash(can_id)].queue_mask, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_QUEUE_H
@@ -0,0 +1,434 @@
+#include "can_shm_reactor.h"
+#include "can_shm_api.h"
+#include "can_shm_hist.h"
+#include "can_shm_ext.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern int g_is_initialized;
+
+// 初期の購読テーブルサイズ
+#define REACTOR_INITIAL_CAPACITY 64
+
+// 停止要求確認のための最大待機時間[ns]
+#define REACTOR_MAX_WAIT_NS 100000000ULL
+
+// 購読エントリ（削除時は無効化のみ行い、同一グループへの追加で再利用する）
+// 登録時に未格納のIDは格納バケットが決まらないため未確定リストに置き、初回の格納で該当グループへ移す
+typedef struct {
+    uint32_t can_id;
+    uint32_t active;
+    CANBucket* bucket;
+    uint32_t last_sequence;      // 最後に確認した change_sequence
+    uint64_t last_ext_timestamp; // 拡張領域のIDで最後に配信した値の受信時刻
+    int32_t next;                // 同一グループの次のエントリ（-1=終端）
+    CANDataCallback callback;
+    void* user_data;
+} ReactorEntry;
+
+struct CANReactor {
+    SharedMemoryLayout* shm;
+    ReactorEntry* entries;
+    uint32_t entry_count;
+    uint32_t capacity;
+    int32_t group_head[CAN_SHM_DIRTY_GROUPS];     // グループごとのエントリリスト
+    uint32_t group_seen[CAN_SHM_DIRTY_GROUPS];    // 最後に確認した dirty_groups の値
+    int32_t pending_head;                         // 格納バケット未確定のエントリリスト
+    int stop_requested;
+    CANReactorStats stats;
+};
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// バケットからのseqlock読み取り（CAN IDが一致しなければ0）
+static int read_bucket(CANBucket* bucket, uint32_t can_id, CANData* data_out) {
+    uint32_t seq1, seq2;
+    uint32_t attempts = 0;
+    do {
+        attempts++;
+        seq1 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+        if (seq1 & 1) continue; // 書き込み中
+
+        *data_out = bucket->can_data;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        seq2 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_RELAXED);
+    } while ((seq1 & 1) || seq1 != seq2);
+
+    if (attempts > 1) {
+        __atomic_add_fetch(&bucket->read_retries, attempts - 1, __ATOMIC_RELAXED);
+    }
+
+    return bucket->is_valid && data_out->can_id == can_id;
+}
+
+// 拡張領域のIDの受信時刻（未格納なら0）
+static uint64_t ext_timestamp(const SharedMemoryLayout* shm, uint32_t can_id, CANData* data_out) {
+    if (!can_shm_ext_active(shm) || can_shm_ext_get(can_id, data_out) != CAN_SHM_SUCCESS) {
+        return 0;
+    }
+    return data_out->timestamp;
+}
+
+/**
+ * CAN IDの格納バケット（リニアプロービングで移動済みならそのバケット、拡張領域ならホームバケット）
+ * @return 1=格納済み, 0=未格納（index_out はホームバケット）
+ */
+static int resolve_bucket_index(const SharedMemoryLayout* shm, uint32_t can_id, uint32_t* index_out) {
+    uint32_t home = can_id_hash(can_id);
+    *index_out = home;
+    for (uint32_t i = 0; i < CAN_SHM_MAX_PROBE; i++) {
+        uint32_t index = (home + i) % MAX_CAN_ENTRIES;
+        const CANBucket* bucket = &shm->buckets[index];
+        if (!bucket->is_valid) {
+            break;
+        }
+        if (bucket->can_data.can_id == can_id) {
+            *index_out = index;
+            return 1;
+        }
+    }
+
+    // 拡張領域のIDの更新はホームバケットで通知される
+    CANData current;
+    return ext_timestamp(shm, can_id, &current) != 0;
+}
+
+// 探査範囲（ホームから CAN_SHM_MAX_PROBE バケット）のいずれかのグループが前回の走査以降に変化したか
+static int probe_groups_changed(const CANReactor* reactor, const uint32_t* current, uint32_t can_id) {
+    uint32_t first = can_id_hash(can_id) >> CAN_SHM_DIRTY_GROUP_SHIFT;
+    for (uint32_t k = 0; k <= (CAN_SHM_MAX_PROBE >> CAN_SHM_DIRTY_GROUP_SHIFT); k++) {
+        uint32_t g = (first + k) % CAN_SHM_DIRTY_GROUPS;
+        if (current[g] != reactor->group_seen[g]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// エントリをグループのリストへ追加
+static void link_entry(CANReactor* reactor, int32_t index, uint32_t bucket_index) {
+    uint32_t group = bucket_index >> CAN_SHM_DIRTY_GROUP_SHIFT;
+    ReactorEntry* entry = &reactor->entries[index];
+    entry->bucket = &reactor->shm->buckets[bucket_index];
+    entry->next = reactor->group_head[group];
+    reactor->group_head[group] = index;
+}
+
+/**
+ * 未確定エントリの格納バケットを探し直す（dispatch でグループを走査する前に呼ぶ）
+ * 格納済みになったエントリは格納先のグループへ移し、初回の格納を未配信として扱う
+ * @param current 今回の走査で使う dirty_groups の値
+ */
+static void resolve_pending(CANReactor* reactor, const uint32_t* current) {
+    int32_t prev = -1;
+    int32_t next;
+    for (int32_t i = reactor->pending_head; i >= 0; i = next) {
+        ReactorEntry* entry = &reactor->entries[i];
+        next = entry->next;
+
+        uint32_t bucket_index;
+        if (!entry->active || !probe_groups_changed(reactor, current, entry->can_id) ||
+            !resolve_bucket_index(reactor->shm, entry->can_id, &bucket_index)) {
+            prev = i;
+            continue;
+        }
+
+        if (prev < 0) {
+            reactor->pending_head = next;
+        } else {
+            reactor->entries[prev].next = next;
+        }
+        link_entry(reactor, i, bucket_index);
+        entry->last_sequence =
+            __atomic_load_n(&entry->bucket->change_sequence, __ATOMIC_ACQUIRE) - 1;
+        entry->last_ext_timestamp = 0;
+    }
+}
+
+static uint64_t read_global_sequence(SharedMemoryLayout* shm) {
+    pthread_mutex_lock(&shm->global_mutex);
+    uint64_t seq = shm->global_sequence;
+    pthread_mutex_unlock(&shm->global_mutex);
+    return seq;
+}
+
+/**
+ * global_sequence が seen から進むまで待機
+ * @param deadline_ns 待機期限（CLOCK_MONOTONIC、0=無期限）
+ * @return 1=更新あり, 0=更新なし（期限・停止確認のための周期起床）
+ */
+static int wait_update(SharedMemoryLayout* shm, uint64_t seen, uint64_t deadline_ns) {
+    uint64_t wait_ns = REACTOR_MAX_WAIT_NS;
+    if (deadline_ns != 0) {
+        uint64_t now = get_timestamp_ns();
+        if (now >= deadline_ns) {
+            return 0;
+        }
+        if (deadline_ns - now < wait_ns) {
+            wait_ns = deadline_ns - now;
+        }
+    }
+
+    // 共有条件変数はCLOCK_REALTIME基準
+    struct timespec abs;
+    clock_gettime(CLOCK_REALTIME, &abs);
+    uint64_t nsec = (uint64_t)abs.tv_nsec + wait_ns;
+    abs.tv_sec += (time_t)(nsec / 1000000000ULL);
+    abs.tv_nsec = (long)(nsec % 1000000000ULL);
+
+    int changed = 0;
+    pthread_mutex_lock(&shm->global_mutex);
+    while (shm->global_sequence == seen) {
+        if (pthread_cond_timedwait(&shm->update_condition, &shm->global_mutex, &abs) == ETIMEDOUT) {
+            break;
+        }
+    }
+    changed = shm->global_sequence != seen;
+    pthread_mutex_unlock(&shm->global_mutex);
+    return changed;
+}
+
+// 変化したグループの購読へ配信（呼び出したコールバック数を返す）
+static uint32_t dispatch(CANReactor* reactor) {
+    uint32_t dispatched = 0;
+
+    // 未確定エントリの移動とグループの走査で同じ値を使う（間の格納は次回の走査で検出）
+    uint32_t current[CAN_SHM_DIRTY_GROUPS];
+    for (uint32_t g = 0; g < CAN_SHM_DIRTY_GROUPS; g++) {
+        current[g] = __atomic_load_n(&reactor->shm->dirty_groups[g], __ATOMIC_ACQUIRE);
+    }
+    if (reactor->pending_head >= 0) {
+        resolve_pending(reactor, current);
+    }
+
+    for (uint32_t g = 0; g < CAN_SHM_DIRTY_GROUPS; g++) {
+        if (current[g] == reactor->group_seen[g]) {
+            continue;
+        }
+        reactor->group_seen[g] = current[g];
+        if (reactor->group_head[g] < 0) {
+            continue;
+        }
+        reactor->stats.groups_scanned++;
+
+        int32_t next;
+        for (int32_t i = reactor->group_head[g]; i >= 0; i = next) {
+            // コールバック内の追加でテーブルが再確保されうるため毎回参照し直す
+            ReactorEntry* entry = &reactor->entries[i];
+            next = entry->next;
+            if (!entry->active) {
+                continue;
+            }
+            reactor->stats.entries_scanned++;
+
+            uint32_t seq = __atomic_load_n(&entry->bucket->change_sequence, __ATOMIC_ACQUIRE);
+            if (seq == entry->last_sequence) {
+                continue;
+            }
+            entry->last_sequence = seq;
+
+            CANData data;
+            if (!read_bucket(entry->bucket, entry->can_id, &data)) {
+                // 拡張領域のIDはホームバケットで通知される（別IDの更新と区別するため受信時刻を比較）
+                uint64_t timestamp = ext_timestamp(reactor->shm, entry->can_id, &data);
+                if (timestamp == 0 || timestamp == entry->last_ext_timestamp) {
+                    continue;  // 同一バケットの別IDによる更新
+                }
+                entry->last_ext_timestamp = timestamp;
+            }
+            __atomic_add_fetch(&entry->bucket->wakeups, 1, __ATOMIC_RELAXED);
+            can_shm_hist_record_delivery(reactor->shm, NULL, &data);
+
+            entry->callback(entry->can_id, &data, entry->user_data);
+            dispatched++;
+        }
+    }
+
+    reactor->stats.dispatched += dispatched;
+    return dispatched;
+}
+
+CANShmResult can_shm_reactor_create(uint32_t bus, CANReactor** reactor_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (reactor_out == NULL || bus >= CAN_SHM_MAX_BUSES) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    SharedMemoryLayout* shm = can_shm_bus_segment(bus);
+    if (shm == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANReactor* reactor = (CANReactor*)calloc(1, sizeof(CANReactor));
+    if (reactor == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    reactor->shm = shm;
+    reactor->pending_head = -1;
+    for (uint32_t g = 0; g < CAN_SHM_DIRTY_GROUPS; g++) {
+        reactor->group_head[g] = -1;
+        reactor->group_seen[g] = __atomic_load_n(&shm->dirty_groups[g], __ATOMIC_ACQUIRE);
+    }
+
+    *reactor_out = reactor;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_reactor_destroy(CANReactor* reactor) {
+    if (reactor == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    free(reactor->entries);
+    free(reactor);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_reactor_add(CANReactor* reactor, uint32_t can_id,
+                                 CANDataCallback callback, void* user_data) {
+    if (reactor == NULL || callback == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+
+    uint32_t bucket_index;
+    int stored = resolve_bucket_index(reactor->shm, can_id, &bucket_index);
+    int32_t* head = stored ? &reactor->group_head[bucket_index >> CAN_SHM_DIRTY_GROUP_SHIFT]
+                           : &reactor->pending_head;
+
+    // 同一リストの無効エントリを再利用
+    ReactorEntry* entry = NULL;
+    for (int32_t i = *head; i >= 0; i = reactor->entries[i].next) {
+        if (!reactor->entries[i].active) {
+            entry = &reactor->entries[i];
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        if (reactor->entry_count == reactor->capacity) {
+            uint32_t capacity = reactor->capacity ? reactor->capacity * 2 : REACTOR_INITIAL_CAPACITY;
+            ReactorEntry* entries = (ReactorEntry*)realloc(reactor->entries,
+                                                           capacity * sizeof(ReactorEntry));
+            if (entries == NULL) {
+                return CAN_SHM_ERROR_INIT_FAILED;
+            }
+            reactor->entries = entries;
+            reactor->capacity = capacity;
+        }
+        int32_t index = (int32_t)reactor->entry_count++;
+        entry = &reactor->entries[index];
+        entry->next = *head;
+        *head = index;
+    }
+
+    entry->can_id = can_id;
+    entry->bucket = &reactor->shm->buckets[bucket_index];
+    entry->last_sequence = __atomic_load_n(&entry->bucket->change_sequence, __ATOMIC_ACQUIRE);
+    CANData current;
+    entry->last_ext_timestamp = ext_timestamp(reactor->shm, can_id, &current);
+    entry->callback = callback;
+    entry->user_data = user_data;
+    entry->active = 1;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_reactor_remove(CANReactor* reactor, uint32_t can_id,
+                                    CANDataCallback callback, void* user_data) {
+    if (reactor == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < reactor->entry_count; i++) {
+        ReactorEntry* entry = &reactor->entries[i];
+        if (entry->active && entry->can_id == can_id && entry->callback == callback &&
+            entry->user_data == user_data) {
+            entry->active = 0;
+            return CAN_SHM_SUCCESS;
+        }
+    }
+    return CAN_SHM_ERROR_NOT_FOUND;
+}
+
+CANShmResult can_shm_reactor_poll(CANReactor* reactor, int32_t timeout_ms, uint32_t* dispatched_out) {
+    if (dispatched_out != NULL) {
+        *dispatched_out = 0;
+    }
+
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (reactor == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    uint64_t deadline_ns = timeout_ms > 0 ? get_timestamp_ns() + (uint64_t)timeout_ms * 1000000ULL : 0;
+
+    for (;;) {
+        // 走査前の通知シーケンスを記録してから走査（走査中の更新は次の待機で検出）
+        uint64_t seen = read_global_sequence(reactor->shm);
+        uint32_t dispatched = dispatch(reactor);
+        if (dispatched > 0) {
+            if (dispatched_out != NULL) {
+                *dispatched_out = dispatched;
+            }
+            return CAN_SHM_SUCCESS;
+        }
+
+        if (timeout_ms == 0 || __atomic_load_n(&reactor->stop_requested, __ATOMIC_ACQUIRE)) {
+            return CAN_SHM_ERROR_TIMEOUT;
+        }
+
+        if (wait_update(reactor->shm, seen, deadline_ns)) {
+            reactor->stats.wakeups++;
+        } else if (deadline_ns != 0 && get_timestamp_ns() >= deadline_ns) {
+            return CAN_SHM_ERROR_TIMEOUT;
+        }
+    }
+}
+
+CANShmResult can_shm_reactor_run(CANReactor* reactor) {
+    if (reactor == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    while (!__atomic_load_n(&reactor->stop_requested, __ATOMIC_ACQUIRE)) {
+        CANShmResult result = can_shm_reactor_poll(reactor, -1, NULL);
+        if (result != CAN_SHM_SUCCESS && result != CAN_SHM_ERROR_TIMEOUT) {
+            return result;
+        }
+    }
+
+    __atomic_store_n(&reactor->stop_requested, 0, __ATOMIC_RELEASE);
+    return CAN_SHM_SUCCESS;
+}
+
+void can_shm_reactor_stop(CANReactor* reactor) {
+    if (reactor != NULL) {
+        __atomic_store_n(&reactor->stop_requested, 1, __ATOMIC_RELEASE);
+    }
+}
+
+CANShmResult can_shm_reactor_get_stats(const CANReactor* reactor, CANReactorStats* stats_out) {
+    if (reactor == NULL || stats_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    *stats_out = reactor->stats;
+    return CAN_SHM_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#ifndef CAN_SHM_REACTOR_H
+#define CAN_SHM_REACTOR_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 購読リアクタ（1スレッドで多数の購読を処理）
+ * ==========================================
+ *
+ * can_shm_subscribe は購読1件ごとにスレッドを1つ待機させる。リアクタは
+ * プロセス内の任意個の (CAN ID, コールバック) を登録し、1つのスレッドが
+ * セグメントの更新通知を1回待つだけで全ての購読へ配信する。
+ *
+ * 起床後の走査はグループ単位の変更カウンタ（dirty_groups、16バケット単位）で絞る：
+ *   1. 256個のグループカウンタ（16キャッシュライン）を前回値と比較
+ *   2. 変化したグループに登録された購読のみ、バケットの change_sequence を比較
+ *   3. 変化していればseqlockで読み取ってコールバックを呼ぶ
+ * 購読数が増えても、更新のないグループの購読は走査しない。
+ * 待機前に global_sequence を記録し、値が変わっていない場合のみ待機するため
+ * 走査と待機の間の更新を取りこぼさない。
+ *
+ * 購読は登録時に格納バケット（リニアプロービングで移動済みならその位置）のグループへ置く。
+ * 未格納のIDは格納先が決まらないため未確定として保持し、ホームから CAN_SHM_MAX_PROBE
+ * バケットの範囲のグループが変化した走査で探し直して、初回の格納から配信する。
+ *
+ * リアクタはプロセスローカルのオブジェクトで、poll/run は1スレッドから呼び出す。
+ * コールバック内からの add/remove/stop は可能。
+ */
+
+typedef struct CANReactor CANReactor;
+
+// リアクタの統計
+typedef struct {
+    uint64_t wakeups;            // 更新通知による起床回数
+    uint64_t groups_scanned;     // 変化を検出したグループ数
+    uint64_t entries_scanned;    // change_sequenceを比較した購読数
+    uint64_t dispatched;         // コールバック呼び出し回数
+} CANReactorStats;
+
+/**
+ * リアクタ作成
+ * @param bus 対象バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param reactor_out 作成したリアクタの格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reactor_create(uint32_t bus, CANReactor** reactor_out);
+
+/**
+ * リアクタ破棄
+ * @param reactor リアクタ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reactor_destroy(CANReactor* reactor);
+
+/**
+ * 購読の追加（登録以降の更新が配信対象、未格納のIDは最初の格納から配信）
+ * 同一CAN IDに複数のコールバックを登録できる
+ * @param reactor リアクタ
+ * @param can_id CAN ID (29bit有効値)
+ * @param callback データ受信時のコールバック関数
+ * @param user_data コールバック関数に渡すユーザーデータ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reactor_add(CANReactor* reactor, uint32_t can_id,
+                                 CANDataCallback callback, void* user_data);
+
+/**
+ * 購読の削除（CAN ID・コールバック・ユーザーデータが一致する購読）
+ * @param reactor リアクタ
+ * @param can_id CAN ID (29bit有効値)
+ * @param callback 登録時のコールバック関数
+ * @param user_data 登録時のユーザーデータ
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if not registered
+ */
+CANShmResult can_shm_reactor_remove(CANReactor* reactor, uint32_t can_id,
+                                    CANDataCallback callback, void* user_data);
+
+/**
+ * 更新を1回待って配信
+ * @param reactor リアクタ
+ * @param timeout_ms 更新待ちのタイムアウト[ミリ秒] (0=待機しない, <0=無期限)
+ * @param dispatched_out 呼び出したコールバック数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS if dispatched, CAN_SHM_ERROR_TIMEOUT if nothing to dispatch
+ */
+CANShmResult can_shm_reactor_poll(CANReactor* reactor, int32_t timeout_ms, uint32_t* dispatched_out);
+
+/**
+ * can_shm_reactor_stop が呼ばれるまで配信を繰り返す
+ * @param reactor リアクタ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reactor_run(CANReactor* reactor);
+
+/**
+ * run の終了要求（コールバック内・他スレッドから呼び出し可）
+ * @param reactor リアクタ
+ */
+void can_shm_reactor_stop(CANReactor* reactor);
+
+/**
+ * 統計取得
+ * @param reactor リアクタ
+ * @param stats_out 統計の格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reactor_get_stats(const CANReactor* reactor, CANReactorStats* stats_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_REACTOR_H
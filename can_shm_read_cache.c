@@ -0,0 +1,77 @@
+#include "can_shm_read_cache.h"
+#include <string.h>
+
+typedef struct {
+    const SharedMemoryLayout* shm;   // NULL=未使用
+    const CANBucket* bucket;
+    uint32_t can_id;
+    uint32_t generation;             // 登録時の g_cache_generation
+    CANData data;                    // data.sequence が登録時のシーケンス
+} CANReadCacheEntry;
+
+typedef struct {
+    CANReadCacheEntry entries[CAN_SHM_READ_CACHE_SIZE];
+    CANReadCacheStats stats;
+} CANReadCache;
+
+int g_can_shm_read_cache_enabled = 0;
+
+// アンマップ・設定変更で増やし、古い世代のエントリを無視する
+static uint32_t g_cache_generation = 1;
+
+// 共有ライブラリ内でも __tls_get_addr を経由しないようにinitial-execモデルを使う
+// （静的TLS領域を使うため、実行時のdlopenによる読み込みは想定しない）
+static __thread CANReadCache t_cache __attribute__((tls_model("initial-exec")));
+
+static inline CANReadCacheEntry* cache_entry(uint32_t can_id) {
+    uint32_t slot = (uint32_t)(((uint64_t)can_id * 0x9E3779B97F4A7C15ULL) >> (64 - CAN_SHM_READ_CACHE_BITS));
+    return &t_cache.entries[slot];
+}
+
+int can_shm_read_cache_lookup(const SharedMemoryLayout* shm, uint32_t can_id, CANData* data_out) {
+    CANReadCacheEntry* entry = cache_entry(can_id);
+    if (entry->shm == shm && entry->can_id == can_id &&
+        entry->generation == __atomic_load_n(&g_cache_generation, __ATOMIC_ACQUIRE)) {
+        // 登録後にバケットへの書き込みがなければシーケンスは不変
+        uint32_t seq = __atomic_load_n(&entry->bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+        if (seq == entry->data.sequence) {
+            *data_out = entry->data;
+            t_cache.stats.hits++;
+            return 1;
+        }
+    }
+    t_cache.stats.misses++;
+    return 0;
+}
+
+void can_shm_read_cache_store(const SharedMemoryLayout* shm, const CANBucket* bucket, const CANData* data) {
+    CANReadCacheEntry* entry = cache_entry(data->can_id);
+    entry->shm = shm;
+    entry->bucket = bucket;
+    entry->can_id = data->can_id;
+    entry->generation = __atomic_load_n(&g_cache_generation, __ATOMIC_ACQUIRE);
+    entry->data = *data;
+}
+
+void can_shm_read_cache_invalidate_all(void) {
+    __atomic_add_fetch(&g_cache_generation, 1, __ATOMIC_RELEASE);
+}
+
+CANShmResult can_shm_read_cache_enable(int enabled) {
+    can_shm_read_cache_invalidate_all();
+    __atomic_store_n(&g_can_shm_read_cache_enabled, enabled ? 1 : 0, __ATOMIC_RELAXED);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_read_cache_get_stats(CANReadCacheStats* stats_out) {
+    if (stats_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    *stats_out = t_cache.stats;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_read_cache_reset_stats(void) {
+    memset(&t_cache.stats, 0, sizeof(t_cache.stats));
+    return CAN_SHM_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#ifndef CAN_SHM_READ_CACHE_H
+#define CAN_SHM_READ_CACHE_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * プロセス内の読み取りキャッシュ（can_shm_get / can_shm_bus_get 用）
+ * ================================================================
+ *
+ * 同じIDを繰り返しGetする消費者向けに、最後に読んだ値とseqlockのシーケンスを
+ * スレッドローカルに保持する。
+ *
+ * - キャッシュはスレッドごとの直接マップ（CAN_SHM_READ_CACHE_SIZE エントリ、共有メモリは使わない）
+ * - ヒット判定はバケットのシーケンス（4byte）の読み込みのみ。一致すれば保持している値を返し、
+ *   不一致ならバケットから読み直してキャッシュを更新する
+ * - ヒットしたGetはグローバルミューテックスを取らないため total_gets に数えない
+ *   （ヒット・ミスの回数は can_shm_read_cache_get_stats で取得）
+ * - 有効・無効はプロセス全体の設定（既定は無効）。can_shm_cleanup で全スレッドのキャッシュが無効になる
+ */
+
+#define CAN_SHM_READ_CACHE_BITS 6
+#define CAN_SHM_READ_CACHE_SIZE (1 << CAN_SHM_READ_CACHE_BITS)
+
+// 読み取りキャッシュの統計（呼び出しスレッド分）
+typedef struct {
+    uint64_t hits;               // シーケンス一致で保持値を返した回数
+    uint64_t misses;             // バケットから読み直した回数（未登録・エントリ競合を含む）
+} CANReadCacheStats;
+
+/**
+ * 読み取りキャッシュの有効化・無効化（プロセス全体）
+ * @param enabled 1=有効, 0=無効
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_read_cache_enable(int enabled);
+
+/**
+ * 呼び出しスレッドの統計取得
+ * @param stats_out 格納先
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_read_cache_get_stats(CANReadCacheStats* stats_out);
+
+/**
+ * 呼び出しスレッドの統計リセット
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_read_cache_reset_stats(void);
+
+// 以下は can_shm_api.c から使用
+
+extern int g_can_shm_read_cache_enabled;
+
+static inline int can_shm_read_cache_enabled(void) {
+    return __atomic_load_n(&g_can_shm_read_cache_enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * キャッシュの参照（ヒットなら1を返して data_out に値を格納）
+ */
+int can_shm_read_cache_lookup(const SharedMemoryLayout* shm, uint32_t can_id, CANData* data_out);
+
+/**
+ * バケットから読んだ値の登録（data->sequence は読み取り時のシーケンス）
+ */
+void can_shm_read_cache_store(const SharedMemoryLayout* shm, const CANBucket* bucket, const CANData* data);
+
+/**
+ * 全スレッドのキャッシュを無効化（セグメントのアンマップ時）
+ */
+void can_shm_read_cache_invalidate_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_READ_CACHE_H
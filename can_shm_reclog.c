@@ -0,0 +1,444 @@
+#include "can_shm_reclog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CAN_RECLOG_ID_MASK (CAN_RECLOG_MAX_IDS - 1)
+
+// IDインデックスのハッシュ（乗算ハッシュ）
+static inline uint32_t reclog_id_slot(uint32_t can_id) {
+    return (can_id * 0x9E3779B1U) >> 20 & CAN_RECLOG_ID_MASK;
+}
+
+/**
+ * ファイルサイズからレコード数・インデックス領域を決定
+ */
+static int compute_layout(uint64_t file_size, uint64_t* record_capacity,
+                          uint64_t* time_index_capacity) {
+    uint64_t fixed = CAN_RECLOG_HEADER_SIZE +
+                     (uint64_t)CAN_RECLOG_MAX_IDS * sizeof(CANRecLogIdIndexEntry);
+    if (file_size <= fixed + sizeof(CANRecLogRecord) + sizeof(CANRecLogTimeIndexEntry)) {
+        return -1;
+    }
+
+    uint64_t avail = file_size - fixed;
+    uint64_t records = (avail * CAN_RECLOG_TIME_INDEX_STRIDE) /
+                       (sizeof(CANRecLogRecord) * CAN_RECLOG_TIME_INDEX_STRIDE +
+                        sizeof(CANRecLogTimeIndexEntry));
+
+    // 端数で溢れないよう調整
+    while (records > 0 &&
+           records * sizeof(CANRecLogRecord) +
+           (records / CAN_RECLOG_TIME_INDEX_STRIDE + 1) * sizeof(CANRecLogTimeIndexEntry) > avail) {
+        records--;
+    }
+    if (records == 0) {
+        return -1;
+    }
+
+    *record_capacity = records;
+    *time_index_capacity = records / CAN_RECLOG_TIME_INDEX_STRIDE + 1;
+    return 0;
+}
+
+void can_shm_reclog_path(char* buf, size_t size, const char* directory,
+                         const char* prefix, uint32_t file_index) {
+    snprintf(buf, size, "%s/%s_%06u.canrec", directory, prefix, file_index);
+}
+
+/**
+ * 新しいログファイルを作成・事前確保・マップ
+ */
+static CANShmResult open_log_file(CANRecLogWriter* writer) {
+    char path[512];
+    can_shm_reclog_path(path, sizeof(path), writer->directory, writer->prefix,
+                        writer->file_index);
+
+    uint64_t record_capacity, time_index_capacity;
+    if (compute_layout(writer->file_size, &record_capacity, &time_index_capacity) != 0) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    // 既存の記録を上書きしない（再起動時は can_shm_reclog_open が続きの番号から始める）
+    int fd = open(path, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) {
+        perror(path);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    // ブロックを事前確保（記録中のファイル拡張・割り当てを避ける）
+    int rc = posix_fallocate(fd, 0, (off_t)writer->file_size);
+    if (rc != 0) {
+        // fallocate非対応のファイルシステム（tmpfs以外の一部等）ではサイズ設定のみ
+        if (ftruncate(fd, (off_t)writer->file_size) == -1) {
+            perror("ftruncate");
+            close(fd);
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+    }
+
+    // ページも事前に確保してホットパスでのページフォルトを避ける
+    uint8_t* map = (uint8_t*)mmap(NULL, writer->file_size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANRecLogHeader* header = (CANRecLogHeader*)map;
+    memset(header, 0, CAN_RECLOG_HEADER_SIZE);
+    memcpy(header->magic, CAN_RECLOG_MAGIC, sizeof(header->magic));
+    header->version = CAN_RECLOG_VERSION;
+    header->header_size = CAN_RECLOG_HEADER_SIZE;
+    header->file_size = writer->file_size;
+    header->record_capacity = record_capacity;
+    header->time_index_offset = CAN_RECLOG_HEADER_SIZE + record_capacity * sizeof(CANRecLogRecord);
+    header->time_index_capacity = time_index_capacity;
+    header->id_index_offset = header->time_index_offset +
+                              time_index_capacity * sizeof(CANRecLogTimeIndexEntry);
+    header->file_index = writer->file_index;
+
+    writer->fd = fd;
+    writer->map = map;
+    writer->header = header;
+    writer->records = (CANRecLogRecord*)(map + CAN_RECLOG_HEADER_SIZE);
+    writer->time_index = (CANRecLogTimeIndexEntry*)(map + header->time_index_offset);
+    writer->id_index = (CANRecLogIdIndexEntry*)(map + header->id_index_offset);
+
+    // IDインデックス領域をクリア（新規作成だがfallocate後の内容に依存しない）
+    memset(writer->id_index, 0, CAN_RECLOG_MAX_IDS * sizeof(CANRecLogIdIndexEntry));
+
+    return CAN_SHM_SUCCESS;
+}
+
+/**
+ * 現在のファイルを確定してクローズ
+ */
+static void close_log_file(CANRecLogWriter* writer) {
+    if (writer->map == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&writer->header->finalized, 1, __ATOMIC_RELEASE);
+    msync(writer->map, writer->file_size, MS_ASYNC);
+    munmap(writer->map, writer->file_size);
+    close(writer->fd);
+
+    writer->map = NULL;
+    writer->header = NULL;
+    writer->records = NULL;
+    writer->time_index = NULL;
+    writer->id_index = NULL;
+    writer->fd = -1;
+}
+
+/**
+ * 次のファイルへ切り替え（保持数を超えた最古のファイルを削除）
+ */
+static CANShmResult rotate_log_file(CANRecLogWriter* writer) {
+    close_log_file(writer);
+    writer->file_index++;
+    writer->files_rotated++;
+
+    if (writer->max_files > 0 && writer->file_index >= writer->max_files) {
+        char old_path[512];
+        can_shm_reclog_path(old_path, sizeof(old_path), writer->directory, writer->prefix,
+                            writer->file_index - writer->max_files);
+        unlink(old_path);
+    }
+
+    return open_log_file(writer);
+}
+
+/**
+ * ディレクトリ内の既存ファイル（<prefix>_<番号>.canrec）の最大番号を検索
+ * @return 見つかった場合1
+ */
+static int find_last_index(const char* directory, const char* prefix, uint32_t* index_out) {
+    DIR* dir = opendir(directory);
+    if (dir == NULL) {
+        return 0;
+    }
+
+    size_t prefix_len = strlen(prefix);
+    int found = 0;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char* name = ent->d_name;
+        if (strncmp(name, prefix, prefix_len) != 0 || name[prefix_len] != '_') {
+            continue;
+        }
+        const char* digits = name + prefix_len + 1;
+        char* end;
+        errno = 0;
+        unsigned long index = strtoul(digits, &end, 10);
+        if (end == digits || *digits < '0' || *digits > '9' || errno != 0 ||
+            index > UINT32_MAX || strcmp(end, ".canrec") != 0) {
+            continue;
+        }
+        if (!found || (uint32_t)index > *index_out) {
+            *index_out = (uint32_t)index;
+            found = 1;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+CANShmResult can_shm_reclog_open(CANRecLogWriter* writer, const char* directory,
+                                 const char* prefix, uint64_t file_size, uint32_t max_files) {
+    if (writer == NULL || directory == NULL || prefix == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+    snprintf(writer->directory, sizeof(writer->directory), "%s", directory);
+    snprintf(writer->prefix, sizeof(writer->prefix), "%s", prefix);
+    writer->file_size = file_size;
+    writer->max_files = max_files;
+
+    uint64_t record_capacity, time_index_capacity;
+    if (compute_layout(file_size, &record_capacity, &time_index_capacity) != 0) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    // 前回の記録が残っていれば最大番号の次から始める（保持数の判定も通し番号で行う）
+    uint32_t last_index;
+    if (find_last_index(directory, prefix, &last_index)) {
+        if (last_index == UINT32_MAX) {
+            return CAN_SHM_ERROR_INIT_FAILED;
+        }
+        writer->file_index = last_index + 1;
+    }
+
+    return open_log_file(writer);
+}
+
+/**
+ * IDインデックス更新
+ */
+static void update_id_index(CANRecLogWriter* writer, uint32_t can_id, uint64_t record_index) {
+    uint32_t slot = reclog_id_slot(can_id);
+
+    for (uint32_t i = 0; i < CAN_RECLOG_MAX_IDS; i++) {
+        CANRecLogIdIndexEntry* entry = &writer->id_index[(slot + i) & CAN_RECLOG_ID_MASK];
+        if (entry->count == 0) {
+            entry->can_id = can_id;
+            entry->first_index = record_index;
+            entry->last_index = record_index;
+            entry->count = 1;
+            writer->header->id_index_count++;
+            return;
+        }
+        if (entry->can_id == can_id) {
+            entry->last_index = record_index;
+            entry->count++;
+            return;
+        }
+    }
+
+    writer->header->id_index_overflow++;
+}
+
+CANShmResult can_shm_reclog_append(CANRecLogWriter* writer, const CANData* frames,
+                                   uint32_t count) {
+    if (writer == NULL || writer->map == NULL || (frames == NULL && count > 0)) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t done = 0;
+    while (done < count) {
+        CANRecLogHeader* header = writer->header;
+        uint64_t index = header->record_count;
+
+        if (index >= header->record_capacity) {
+            CANShmResult result = rotate_log_file(writer);
+            if (result != CAN_SHM_SUCCESS) {
+                return result;
+            }
+            continue;
+        }
+
+        // 現在のファイルに収まる分をまとめてコピー
+        uint64_t room = header->record_capacity - index;
+        uint32_t chunk = (count - done < room) ? count - done : (uint32_t)room;
+
+        for (uint32_t k = 0; k < chunk; k++) {
+            const CANData* src = &frames[done + k];
+            CANRecLogRecord* rec = &writer->records[index + k];
+            uint16_t dlc = src->dlc <= 64 ? src->dlc : 64;
+
+            rec->timestamp = src->timestamp;
+            rec->can_id = src->can_id;
+            rec->sequence = src->sequence;
+            rec->dlc = dlc;
+            memcpy(rec->data, src->data, 64);
+
+            uint64_t rec_index = index + k;
+            if (rec_index % CAN_RECLOG_TIME_INDEX_STRIDE == 0) {
+                CANRecLogTimeIndexEntry* ti =
+                    &writer->time_index[rec_index / CAN_RECLOG_TIME_INDEX_STRIDE];
+                ti->timestamp = src->timestamp;
+                ti->record_index = rec_index;
+                header->time_index_count = rec_index / CAN_RECLOG_TIME_INDEX_STRIDE + 1;
+            }
+
+            update_id_index(writer, src->can_id, rec_index);
+        }
+
+        if (index == 0) {
+            header->first_timestamp = frames[done].timestamp;
+        }
+        header->last_timestamp = frames[done + chunk - 1].timestamp;
+
+        // バッチのコミット（読み出し側はrecord_countまでを参照）
+        __atomic_store_n(&header->record_count, index + chunk, __ATOMIC_RELEASE);
+
+        done += chunk;
+        writer->total_records += chunk;
+    }
+
+    return CAN_SHM_SUCCESS;
+}
+
+void can_shm_reclog_note_dropped(CANRecLogWriter* writer, uint64_t dropped) {
+    if (writer != NULL && writer->header != NULL) {
+        writer->header->dropped += dropped;
+    }
+}
+
+CANShmResult can_shm_reclog_close(CANRecLogWriter* writer) {
+    if (writer == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    close_log_file(writer);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_reclog_open_reader(CANRecLogReader* reader, const char* path) {
+    if (reader == NULL || path == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd == -1) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    struct stat st;
+    if (fstat(reader->fd, &st) != 0 || st.st_size < CAN_RECLOG_HEADER_SIZE) {
+        close(reader->fd);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    reader->map_size = (size_t)st.st_size;
+    reader->map = (uint8_t*)mmap(NULL, reader->map_size, PROT_READ, MAP_SHARED, reader->fd, 0);
+    if (reader->map == MAP_FAILED) {
+        close(reader->fd);
+        reader->map = NULL;
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    const CANRecLogHeader* header = (const CANRecLogHeader*)reader->map;
+    if (memcmp(header->magic, CAN_RECLOG_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CAN_RECLOG_VERSION ||
+        header->file_size != reader->map_size ||
+        header->id_index_offset + CAN_RECLOG_MAX_IDS * sizeof(CANRecLogIdIndexEntry) >
+            reader->map_size) {
+        can_shm_reclog_close_reader(reader);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    reader->header = header;
+    reader->records = (const CANRecLogRecord*)(reader->map + header->header_size);
+    reader->time_index = (const CANRecLogTimeIndexEntry*)(reader->map + header->time_index_offset);
+    reader->id_index = (const CANRecLogIdIndexEntry*)(reader->map + header->id_index_offset);
+    return CAN_SHM_SUCCESS;
+}
+
+uint64_t can_shm_reclog_record_count(const CANRecLogReader* reader) {
+    if (reader == NULL || reader->header == NULL) {
+        return 0;
+    }
+    return __atomic_load_n(&reader->header->record_count, __ATOMIC_ACQUIRE);
+}
+
+const CANRecLogRecord* can_shm_reclog_record_at(const CANRecLogReader* reader,
+                                                uint64_t index) {
+    if (index >= can_shm_reclog_record_count(reader)) {
+        return NULL;
+    }
+    return &reader->records[index];
+}
+
+uint64_t can_shm_reclog_seek_time(const CANRecLogReader* reader, uint64_t timestamp) {
+    uint64_t count = can_shm_reclog_record_count(reader);
+    if (count == 0) {
+        return 0;
+    }
+
+    // 時刻インデックスを二分探索し、timestamp未満の最後のエントリから線形探索
+    uint64_t index_count = (count - 1) / CAN_RECLOG_TIME_INDEX_STRIDE + 1;
+    uint64_t lo = 0;
+    uint64_t hi = index_count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (reader->time_index[mid].timestamp < timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    uint64_t start = (lo > 0) ? reader->time_index[lo - 1].record_index : 0;
+    for (uint64_t i = start; i < count; i++) {
+        if (reader->records[i].timestamp >= timestamp) {
+            return i;
+        }
+    }
+    return count;
+}
+
+CANShmResult can_shm_reclog_lookup_id(const CANRecLogReader* reader, uint32_t can_id,
+                                      CANRecLogIdIndexEntry* entry_out) {
+    if (reader == NULL || reader->header == NULL || entry_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t slot = reclog_id_slot(can_id);
+    for (uint32_t i = 0; i < CAN_RECLOG_MAX_IDS; i++) {
+        const CANRecLogIdIndexEntry* entry = &reader->id_index[(slot + i) & CAN_RECLOG_ID_MASK];
+        if (entry->count == 0) {
+            break;
+        }
+        if (entry->can_id == can_id) {
+            *entry_out = *entry;
+            return CAN_SHM_SUCCESS;
+        }
+    }
+    return CAN_SHM_ERROR_NOT_FOUND;
+}
+
+void can_shm_reclog_close_reader(CANRecLogReader* reader) {
+    if (reader == NULL) {
+        return;
+    }
+    if (reader->map != NULL) {
+        munmap(reader->map, reader->map_size);
+        reader->map = NULL;
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+    }
+    reader->fd = -1;
+    reader->header = NULL;
+}
@@ -0,0 +1,201 @@
+#ifndef CAN_SHM_RECLOG_H
+#define CAN_SHM_RECLOG_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * CAN記録ログファイル（メモリマップ・ローリング）
+ * ===============================================
+ *
+ * ファイルは作成時に固定サイズで事前確保してmmapし、レコードは固定長で追記する。
+ * ファイル内レイアウト:
+ *   [CANRecLogHeader (4096 byte)]
+ *   [CANRecLogRecord x record_capacity]
+ *   [CANRecLogTimeIndexEntry x time_index_capacity]  (STRIDEレコードごとの時刻)
+ *   [CANRecLogIdIndexEntry x CAN_RECLOG_MAX_IDS]      (CAN ID別の件数・先頭/末尾位置)
+ * ファイルが満杯になると次の番号のファイルへ切り替え、保持数を超えた最古のファイルを削除する。
+ */
+
+#define CAN_RECLOG_MAGIC "CANREC01"
+#define CAN_RECLOG_VERSION 1
+#define CAN_RECLOG_HEADER_SIZE 4096
+#define CAN_RECLOG_TIME_INDEX_STRIDE 256   // 時刻インデックスの間隔（レコード数）
+#define CAN_RECLOG_MAX_IDS 4096            // IDインデックスのエントリ数（2の冪）
+
+// ファイルヘッダ
+typedef struct {
+    char     magic[8];              // CAN_RECLOG_MAGIC
+    uint32_t version;               // CAN_RECLOG_VERSION
+    uint32_t header_size;           // CAN_RECLOG_HEADER_SIZE
+    uint64_t file_size;             // ファイル全体サイズ
+    uint64_t record_capacity;       // 格納可能レコード数
+    uint64_t record_count;          // コミット済みレコード数（バッチ単位で更新）
+    uint64_t first_timestamp;       // 先頭レコードの時刻
+    uint64_t last_timestamp;        // 末尾レコードの時刻
+    uint64_t time_index_offset;     // 時刻インデックスのファイル内オフセット
+    uint64_t time_index_capacity;   // 時刻インデックスのエントリ数上限
+    uint64_t time_index_count;      // 時刻インデックスの有効エントリ数
+    uint64_t id_index_offset;       // IDインデックスのファイル内オフセット
+    uint32_t id_index_count;        // 登録済みCAN ID数
+    uint32_t id_index_overflow;     // IDインデックス満杯で索引できなかったレコード数
+    uint64_t dropped;               // 記録前に失われたレコード数（ジャーナル欠落）
+    uint32_t file_index;            // ローリング番号
+    uint32_t finalized;             // 1=書き込み完了（ファイル切り替え・終了時）
+} CANRecLogHeader;
+
+// 記録レコード（固定長88byte）
+typedef struct {
+    uint64_t timestamp;   // CANData.timestamp
+    uint32_t can_id;      // CAN ID
+    uint32_t sequence;    // バケットのシーケンス番号
+    uint16_t dlc;         // データ長
+    uint8_t  reserved[6];
+    uint8_t  data[64];    // データ部
+} CANRecLogRecord;
+
+// 時刻インデックス
+typedef struct {
+    uint64_t timestamp;      // 該当レコードの時刻
+    uint64_t record_index;   // レコード位置
+} CANRecLogTimeIndexEntry;
+
+// IDインデックス（オープンアドレス法、count=0は空き）
+typedef struct {
+    uint32_t can_id;
+    uint32_t count;          // 記録件数
+    uint64_t first_index;    // 先頭レコード位置
+    uint64_t last_index;     // 末尾レコード位置
+} CANRecLogIdIndexEntry;
+
+// 書き込み側（プロセスローカル）
+typedef struct {
+    char     directory[256];
+    char     prefix[64];
+    uint64_t file_size;
+    uint32_t max_files;           // 保持ファイル数（0=無制限）
+    uint32_t file_index;          // 現在のファイル番号
+    int      fd;
+    uint8_t* map;
+    CANRecLogHeader* header;
+    CANRecLogRecord* records;
+    CANRecLogTimeIndexEntry* time_index;
+    CANRecLogIdIndexEntry* id_index;
+    uint64_t total_records;       // 全ファイル通算の記録数
+    uint32_t files_rotated;       // ファイル切り替え回数
+} CANRecLogWriter;
+
+// 読み出し側
+typedef struct {
+    int      fd;
+    uint8_t* map;
+    size_t   map_size;
+    const CANRecLogHeader* header;
+    const CANRecLogRecord* records;
+    const CANRecLogTimeIndexEntry* time_index;
+    const CANRecLogIdIndexEntry* id_index;
+} CANRecLogReader;
+
+/**
+ * 書き込み開始（最初のファイルを事前確保して作成）
+ * ディレクトリに同じプレフィックスの記録が残っている場合は最大番号の次から始め、既存ファイルは上書きしない
+ * @param writer 書き込み状態
+ * @param directory 出力ディレクトリ
+ * @param prefix ファイル名プレフィックス（<prefix>_<番号>.canrec）
+ * @param file_size 1ファイルのサイズ[byte]
+ * @param max_files 保持ファイル数（0=無制限）
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_INIT_FAILED if the file already exists
+ *         or cannot be created
+ */
+CANShmResult can_shm_reclog_open(CANRecLogWriter* writer, const char* directory,
+                                 const char* prefix, uint64_t file_size, uint32_t max_files);
+
+/**
+ * レコードのバッチ追記
+ * バッチ全体をコピーした後にrecord_countを更新してコミットする
+ * @param writer 書き込み状態
+ * @param frames 記録するCANデータ配列
+ * @param count 配列の要素数
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reclog_append(CANRecLogWriter* writer, const CANData* frames,
+                                   uint32_t count);
+
+/**
+ * 欠落レコード数を現在のファイルヘッダに加算
+ * @param writer 書き込み状態
+ * @param dropped 欠落数
+ */
+void can_shm_reclog_note_dropped(CANRecLogWriter* writer, uint64_t dropped);
+
+/**
+ * 書き込み終了（現在のファイルを確定）
+ * @param writer 書き込み状態
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reclog_close(CANRecLogWriter* writer);
+
+/**
+ * 記録ファイルのパスを生成
+ * @param buf 出力バッファ
+ * @param size バッファサイズ
+ * @param directory 出力ディレクトリ
+ * @param prefix ファイル名プレフィックス
+ * @param file_index ファイル番号
+ */
+void can_shm_reclog_path(char* buf, size_t size, const char* directory,
+                         const char* prefix, uint32_t file_index);
+
+/**
+ * 記録ファイルを読み出し用に開く（書き込み中のファイルも可）
+ * @param reader 読み出し状態
+ * @param path ファイルパス
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_reclog_open_reader(CANRecLogReader* reader, const char* path);
+
+/**
+ * 読み出し可能なレコード数
+ */
+uint64_t can_shm_reclog_record_count(const CANRecLogReader* reader);
+
+/**
+ * 指定位置のレコードを取得
+ * @return レコードへのポインタ（範囲外はNULL）
+ */
+const CANRecLogRecord* can_shm_reclog_record_at(const CANRecLogReader* reader,
+                                                uint64_t index);
+
+/**
+ * 指定時刻以降の最初のレコード位置を検索（時刻インデックス + 線形探索）
+ * @param reader 読み出し状態
+ * @param timestamp 検索時刻
+ * @return レコード位置（該当なしはレコード数）
+ */
+uint64_t can_shm_reclog_seek_time(const CANRecLogReader* reader, uint64_t timestamp);
+
+/**
+ * CAN IDのインデックス情報を取得
+ * @param reader 読み出し状態
+ * @param can_id CAN ID
+ * @param entry_out インデックス情報の格納先
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if not recorded
+ */
+CANShmResult can_shm_reclog_lookup_id(const CANRecLogReader* reader, uint32_t can_id,
+                                      CANRecLogIdIndexEntry* entry_out);
+
+/**
+ * 読み出し終了
+ */
+void can_shm_reclog_close_reader(CANRecLogReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_RECLOG_H
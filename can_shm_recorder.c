@@ -0,0 +1,163 @@
+/*
+ * 共有メモリレコーダ
+ * ==================
+ *
+ * 共有メモリの更新ジャーナルから全てのSet結果をまとめて読み出し、
+ * 事前確保したメモリマップログファイル（can_shm_reclog）へ追記する。
+ * Set側の追加コストはジャーナルへの1回のコピーのみで、レコーダが遅れても
+ * Set側は待たされない（欠落はレコーダ側で計数してログヘッダに記録する）。
+ */
+
+#include "can_shm_api.h"
+#include "can_shm_journal.h"
+#include "can_shm_reclog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECORDER_BATCH_SIZE 512
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [OPTIONS]\n", prog);
+    printf("\n");
+    printf("Options:\n");
+    printf("  -d <dir>    Output directory (default: .)\n");
+    printf("  -p <name>   File name prefix (default: canrec)\n");
+    printf("  -s <MiB>    Size of each preallocated log file (default: 64)\n");
+    printf("  -k <n>      Number of log files to keep, 0=unlimited (default: 8)\n");
+    printf("  -i <us>     Poll interval when the journal is empty (default: 200)\n");
+    printf("  -t <sec>    Stop after the given number of seconds (default: run until SIGINT)\n");
+    printf("  -h          Show this help message\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* directory = ".";
+    const char* prefix = "canrec";
+    uint64_t file_size_mib = 64;
+    uint32_t max_files = 8;
+    uint32_t poll_us = 200;
+    uint32_t duration_s = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:p:s:k:i:t:h")) != -1) {
+        switch (opt) {
+            case 'd': directory = optarg; break;
+            case 'p': prefix = optarg; break;
+            case 's': file_size_mib = strtoull(optarg, NULL, 0); break;
+            case 'k': max_files = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': poll_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': duration_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to initialize shared memory\n");
+        return 1;
+    }
+
+    CANRecLogWriter writer;
+    if (can_shm_reclog_open(&writer, directory, prefix, file_size_mib * 1024 * 1024,
+                            max_files) != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to create log file in %s\n", directory);
+        can_shm_cleanup();
+        return 1;
+    }
+
+    CANJournalCursor cursor;
+    if (can_shm_journal_attach(&cursor) != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to attach to update journal\n");
+        can_shm_reclog_close(&writer);
+        can_shm_cleanup();
+        return 1;
+    }
+
+    printf("Recording to %s/%s_*.canrec (%llu MiB x %u files)\n", directory, prefix,
+           (unsigned long long)file_size_mib, max_files);
+
+    static CANData batch[RECORDER_BATCH_SIZE];
+    uint64_t start = get_timestamp_ns();
+    uint64_t last_report = start;
+    uint64_t last_records = 0;
+    uint64_t reported_dropped = 0;
+    // ポーリング間隔（1秒以上は tv_sec に分ける。tv_nsec は10^9未満でないと nanosleep が失敗する）
+    struct timespec poll = {(time_t)(poll_us / 1000000U), (long)(poll_us % 1000000U) * 1000L};
+
+    while (!g_stop) {
+        uint32_t n = can_shm_journal_read(&cursor, batch, RECORDER_BATCH_SIZE);
+        if (n > 0) {
+            if (can_shm_reclog_append(&writer, batch, n) != CAN_SHM_SUCCESS) {
+                fprintf(stderr, "Failed to append to log file\n");
+                break;
+            }
+        }
+
+        if (cursor.dropped != reported_dropped) {
+            can_shm_reclog_note_dropped(&writer, cursor.dropped - reported_dropped);
+            reported_dropped = cursor.dropped;
+        }
+
+        uint64_t now = get_timestamp_ns();
+        if (now - last_report >= 1000000000ULL) {
+            double rate = (writer.total_records - last_records) * 1e9 / (now - last_report);
+            printf("records=%llu rate=%.0f/s dropped=%llu files=%u\n",
+                   (unsigned long long)writer.total_records, rate,
+                   (unsigned long long)cursor.dropped, writer.files_rotated + 1);
+            fflush(stdout);
+            last_report = now;
+            last_records = writer.total_records;
+        }
+        if (duration_s > 0 && now - start >= (uint64_t)duration_s * 1000000000ULL) {
+            break;
+        }
+
+        // ジャーナルが空なら次の更新が溜まるまで待機
+        if (n == 0) {
+            nanosleep(&poll, NULL);
+        }
+    }
+
+    can_shm_journal_detach();
+
+    // 切断前に書き込まれた残りを回収
+    uint32_t n;
+    while ((n = can_shm_journal_read(&cursor, batch, RECORDER_BATCH_SIZE)) > 0) {
+        can_shm_reclog_append(&writer, batch, n);
+    }
+    if (cursor.dropped != reported_dropped) {
+        can_shm_reclog_note_dropped(&writer, cursor.dropped - reported_dropped);
+    }
+
+    printf("Recorded %llu updates (%llu dropped) in %u file(s)\n",
+           (unsigned long long)writer.total_records, (unsigned long long)cursor.dropped,
+           writer.files_rotated + 1);
+
+    can_shm_reclog_close(&writer);
+    can_shm_cleanup();
+    return 0;
+}
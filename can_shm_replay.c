@@ -0,0 +1,651 @@
+/*
+ * CANログ再生ツール
+ * =================
+ *
+ * candumpログ・Vector ASCログ・コンパクトバイナリ形式を読み込み、
+ * can_shm_set / can_shm_set_batch / can_shm_set_linear_probing で共有メモリへ投入する。
+ * 元のフレーム間隔を再現するリアルタイム再生と、最大速度での再生に対応し、
+ * 持続スループット（frames/s）とSet遅延分布を出力する。
+ *
+ * 対応フォーマット:
+ *   candump -l : (1436509052.249713) vcan0 123#DEADBEEF / 123##1AABB (CAN FD)
+ *   ASC        :    0.010000 1  123             Rx   d 8 01 02 03 04 05 06 07 08
+ *   バイナリ   : "CANSHMR1" + CANReplayRecordHeader + data[len] の繰り返し
+ */
+
+#include "can_shm_api.h"
+#include "can_shm_linear_probing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <linux/can.h>
+
+#define REPLAY_BINARY_MAGIC "CANSHMR1"
+#define REPLAY_BINARY_MAGIC_LEN 8
+#define REPLAY_MAX_BATCH 1024
+#define REPLAY_LINE_MAX 1024
+
+// バイナリ形式のレコードヘッダ（リトルエンディアン、直後にdata[len]）
+typedef struct {
+    uint64_t timestamp_ns;  // 受信時刻（ログの時刻基準）
+    uint32_t can_id;        // CAN ID (29bit)
+    uint8_t  len;           // データ長 (0~64)
+    uint8_t  flags;         // CAN FDフラグ等（未使用時0）
+} __attribute__((packed)) CANReplayRecordHeader;
+
+// 再生用フレーム
+typedef struct {
+    uint64_t timestamp_ns;
+    uint32_t can_id;
+    uint16_t dlc;
+    uint8_t  data[64];
+} ReplayFrame;
+
+typedef enum {
+    REPLAY_FORMAT_AUTO = 0,
+    REPLAY_FORMAT_CANDUMP,
+    REPLAY_FORMAT_ASC,
+    REPLAY_FORMAT_BINARY
+} ReplayFormat;
+
+typedef enum {
+    REPLAY_API_DEFAULT = 0,   // can_shm_set / can_shm_set_batch
+    REPLAY_API_LINEAR         // can_shm_set_linear_probing
+} ReplayApi;
+
+// 再生設定
+typedef struct {
+    const char* input_path;
+    const char* output_path;  // 指定時はバイナリ変換のみ
+    ReplayFormat format;
+    ReplayApi api;
+    int realtime;             // 1=元のフレーム間隔を再現
+    double speed;             // リアルタイム再生の速度倍率
+    uint32_t batch_size;      // 1=can_shm_set, >1=can_shm_set_batch
+    uint32_t loops;           // 繰り返し回数
+} ReplayConfig;
+
+// フレーム配列（可変長）
+typedef struct {
+    ReplayFrame* frames;
+    size_t count;
+    size_t capacity;
+} FrameList;
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int frame_list_push(FrameList* list, const ReplayFrame* frame) {
+    if (list->count == list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 4096;
+        ReplayFrame* p = (ReplayFrame*)realloc(list->frames, new_capacity * sizeof(ReplayFrame));
+        if (p == NULL) {
+            return -1;
+        }
+        list->frames = p;
+        list->capacity = new_capacity;
+    }
+    list->frames[list->count++] = *frame;
+    return 0;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 秒表記（"1436509052.249713"）をナノ秒に変換
+static uint64_t parse_seconds_ns(const char* s, const char** end) {
+    uint64_t sec = 0;
+    uint64_t frac = 0;
+    int frac_digits = 0;
+
+    while (isdigit((unsigned char)*s)) {
+        sec = sec * 10 + (uint64_t)(*s - '0');
+        s++;
+    }
+    if (*s == '.') {
+        s++;
+        while (isdigit((unsigned char)*s)) {
+            if (frac_digits < 9) {
+                frac = frac * 10 + (uint64_t)(*s - '0');
+                frac_digits++;
+            }
+            s++;
+        }
+    }
+    while (frac_digits < 9) {
+        frac *= 10;
+        frac_digits++;
+    }
+    if (end != NULL) {
+        *end = s;
+    }
+    return sec * 1000000000ULL + frac;
+}
+
+/**
+ * candump -l 形式の1行を解析
+ * (timestamp) iface ID#DATA | ID##<flags>DATA | ID#R
+ */
+static int parse_candump_line(const char* line, ReplayFrame* frame) {
+    const char* p = line;
+    while (isspace((unsigned char)*p)) p++;
+    if (*p != '(') {
+        return -1;
+    }
+    p++;
+    frame->timestamp_ns = parse_seconds_ns(p, &p);
+    if (*p != ')') {
+        return -1;
+    }
+    p++;
+
+    // インターフェース名をスキップ
+    while (isspace((unsigned char)*p)) p++;
+    while (*p != '\0' && !isspace((unsigned char)*p)) p++;
+    while (isspace((unsigned char)*p)) p++;
+
+    // CAN ID
+    uint32_t can_id = 0;
+    int id_digits = 0;
+    int v;
+    while ((v = hex_value(*p)) >= 0) {
+        can_id = (can_id << 4) | (uint32_t)v;
+        id_digits++;
+        p++;
+    }
+    if (id_digits == 0 || *p != '#') {
+        return -1;
+    }
+    p++;
+    // エラーフレーム（candumpはCAN_ERR_FLAG付きのIDで出力する）は投入しない
+    if (can_id & CAN_ERR_FLAG) {
+        return -1;
+    }
+    frame->can_id = can_id & CAN_ID_MAX;
+
+    // CAN FD: "##" の直後にフラグ1桁
+    if (*p == '#') {
+        p++;
+        if (hex_value(*p) < 0) {
+            return -1;
+        }
+        p++;
+    } else if (*p == 'R' || *p == 'r') {
+        // リモートフレーム（データなし）
+        frame->dlc = 0;
+        return 0;
+    }
+
+    uint16_t len = 0;
+    while (len < 64) {
+        if (*p == '.') {  // candumpの区切り表記 "11.22.33"
+            p++;
+            continue;
+        }
+        int hi = hex_value(p[0]);
+        if (hi < 0) {
+            break;
+        }
+        int lo = hex_value(p[1]);
+        if (lo < 0) {
+            return -1;
+        }
+        frame->data[len++] = (uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+    frame->dlc = len;
+    return 0;
+}
+
+/**
+ * Vector ASC形式（クラシックCAN）の1行を解析
+ * <time> <channel> <ID>[x] <Rx|Tx> d <dlc> <bytes...>
+ */
+static int parse_asc_line(const char* line, ReplayFrame* frame) {
+    const char* p = line;
+    while (isspace((unsigned char)*p)) p++;
+    if (!isdigit((unsigned char)*p)) {
+        return -1;  // ヘッダ行（date, base, ...）
+    }
+    frame->timestamp_ns = parse_seconds_ns(p, &p);
+
+    char channel[16];
+    char id_text[16];
+    char direction[8];
+    char type[4];
+    unsigned int dlc = 0;
+    int consumed = 0;
+
+    if (sscanf(p, "%15s %15s %7s %3s %u%n", channel, id_text, direction, type,
+               &dlc, &consumed) != 5) {
+        return -1;
+    }
+    if (!isdigit((unsigned char)channel[0]) || (type[0] != 'd' && type[0] != 'D')) {
+        return -1;  // エラーフレーム・統計行・リモートフレーム等
+    }
+    if (dlc > 8) {
+        return -1;
+    }
+
+    char* end = NULL;
+    unsigned long can_id = strtoul(id_text, &end, 16);
+    if (end == id_text || (*end != '\0' && *end != 'x' && *end != 'X')) {
+        return -1;
+    }
+    frame->can_id = (uint32_t)can_id & CAN_ID_MAX;
+
+    p += consumed;
+    for (unsigned int i = 0; i < dlc; i++) {
+        unsigned int byte;
+        int n = 0;
+        if (sscanf(p, "%2x%n", &byte, &n) != 1) {
+            return -1;
+        }
+        frame->data[i] = (uint8_t)byte;
+        p += n;
+    }
+    frame->dlc = (uint16_t)dlc;
+    return 0;
+}
+
+static int load_text_log(FILE* fp, ReplayFormat format, FrameList* list) {
+    char line[REPLAY_LINE_MAX];
+    size_t skipped = 0;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        ReplayFrame frame;
+        memset(&frame, 0, sizeof(frame));
+
+        int rc = (format == REPLAY_FORMAT_ASC) ? parse_asc_line(line, &frame)
+                                               : parse_candump_line(line, &frame);
+        if (rc != 0) {
+            skipped++;
+            continue;
+        }
+        if (frame_list_push(list, &frame) != 0) {
+            fprintf(stderr, "Out of memory while loading log\n");
+            return -1;
+        }
+    }
+
+    if (skipped > 0) {
+        printf("Skipped %zu non-frame lines\n", skipped);
+    }
+    return 0;
+}
+
+static int load_binary_log(FILE* fp, FrameList* list) {
+    CANReplayRecordHeader header;
+
+    while (fread(&header, sizeof(header), 1, fp) == 1) {
+        if (header.len > 64) {
+            fprintf(stderr, "Corrupt binary record (len=%u)\n", header.len);
+            return -1;
+        }
+
+        ReplayFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.timestamp_ns = header.timestamp_ns;
+        frame.can_id = header.can_id & CAN_ID_MAX;
+        frame.dlc = header.len;
+        if (header.len > 0 && fread(frame.data, header.len, 1, fp) != 1) {
+            fprintf(stderr, "Truncated binary record\n");
+            return -1;
+        }
+        if (frame_list_push(list, &frame) != 0) {
+            fprintf(stderr, "Out of memory while loading log\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * ログ読み込み（フォーマット自動判定）
+ */
+static int load_log(const char* path, ReplayFormat format, FrameList* list) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char magic[REPLAY_BINARY_MAGIC_LEN];
+    size_t n = fread(magic, 1, sizeof(magic), fp);
+    int is_binary = (n == sizeof(magic) &&
+                     memcmp(magic, REPLAY_BINARY_MAGIC, REPLAY_BINARY_MAGIC_LEN) == 0);
+
+    if (format == REPLAY_FORMAT_AUTO) {
+        if (is_binary) {
+            format = REPLAY_FORMAT_BINARY;
+        } else {
+            const char* ext = strrchr(path, '.');
+            format = (ext != NULL && strcmp(ext, ".asc") == 0) ? REPLAY_FORMAT_ASC
+                                                                : REPLAY_FORMAT_CANDUMP;
+        }
+    }
+
+    int rc;
+    if (format == REPLAY_FORMAT_BINARY) {
+        if (!is_binary) {
+            fprintf(stderr, "%s: missing binary magic\n", path);
+            fclose(fp);
+            return -1;
+        }
+        rc = load_binary_log(fp, list);
+    } else {
+        rewind(fp);
+        rc = load_text_log(fp, format, list);
+    }
+
+    fclose(fp);
+    return rc;
+}
+
+/**
+ * バイナリ形式で書き出し
+ */
+static int write_binary_log(const char* path, const FrameList* list) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    int rc = 0;
+    if (fwrite(REPLAY_BINARY_MAGIC, REPLAY_BINARY_MAGIC_LEN, 1, fp) != 1) {
+        rc = -1;
+    }
+    for (size_t i = 0; rc == 0 && i < list->count; i++) {
+        const ReplayFrame* f = &list->frames[i];
+        CANReplayRecordHeader header;
+        header.timestamp_ns = f->timestamp_ns;
+        header.can_id = f->can_id;
+        header.len = (uint8_t)f->dlc;
+        header.flags = 0;
+        if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+            (f->dlc > 0 && fwrite(f->data, f->dlc, 1, fp) != 1)) {
+            rc = -1;
+        }
+    }
+
+    if (fclose(fp) != 0) {
+        rc = -1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "%s: write failed\n", path);
+    }
+    return rc;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// リアルタイム再生：ログ時刻に対応する時刻まで待機
+static void wait_until(uint64_t target_ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(target_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(target_ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+/**
+ * 再生本体
+ * Set呼び出し1回ごとの遅延を記録し、frames/sと遅延分布を出力する
+ */
+static int replay(const ReplayConfig* cfg, const FrameList* list) {
+    size_t total_calls_max = list->count * cfg->loops;
+    uint64_t* latencies = (uint64_t*)malloc(total_calls_max * sizeof(uint64_t));
+    CANData* batch = (CANData*)calloc(cfg->batch_size, sizeof(CANData));
+    if (latencies == NULL || batch == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        free(latencies);
+        free(batch);
+        return -1;
+    }
+
+    size_t calls = 0;
+    uint64_t frames_sent = 0;
+    uint64_t errors = 0;
+    uint64_t max_lag_ns = 0;
+    uint64_t log_base = list->frames[0].timestamp_ns;
+    uint64_t loop_span = list->frames[list->count - 1].timestamp_ns - log_base;
+    uint64_t start = get_timestamp_ns();
+
+    for (uint32_t loop = 0; loop < cfg->loops; loop++) {
+        uint64_t loop_offset = (uint64_t)((double)loop * loop_span / cfg->speed);
+        size_t i = 0;
+
+        while (i < list->count) {
+            // 今回投入するフレーム範囲 [i, end)
+            size_t end = i + 1;
+            if (cfg->realtime) {
+                uint64_t target = start + loop_offset +
+                    (uint64_t)((double)(list->frames[i].timestamp_ns - log_base) / cfg->speed);
+                uint64_t now = get_timestamp_ns();
+                if (now < target) {
+                    wait_until(target);
+                    now = get_timestamp_ns();
+                }
+                if (now - target > max_lag_ns) {
+                    max_lag_ns = now - target;
+                }
+                // 期限到来済みのフレームをバッチにまとめる
+                while (end < list->count && end - i < cfg->batch_size) {
+                    uint64_t t = start + loop_offset +
+                        (uint64_t)((double)(list->frames[end].timestamp_ns - log_base) / cfg->speed);
+                    if (t > now) {
+                        break;
+                    }
+                    end++;
+                }
+            } else {
+                end = i + cfg->batch_size;
+                if (end > list->count) {
+                    end = list->count;
+                }
+            }
+
+            uint64_t t0, t1;
+            if (cfg->batch_size > 1 && cfg->api == REPLAY_API_DEFAULT) {
+                uint32_t n = (uint32_t)(end - i);
+                for (uint32_t k = 0; k < n; k++) {
+                    const ReplayFrame* f = &list->frames[i + k];
+                    batch[k].can_id = f->can_id;
+                    batch[k].dlc = f->dlc;
+                    memcpy(batch[k].data, f->data, f->dlc);
+                }
+                uint32_t stored = 0;
+                t0 = get_timestamp_ns();
+                can_shm_set_batch(batch, n, &stored);
+                t1 = get_timestamp_ns();
+                frames_sent += stored;
+                errors += n - stored;
+            } else {
+                t0 = get_timestamp_ns();
+                for (size_t k = i; k < end; k++) {
+                    const ReplayFrame* f = &list->frames[k];
+                    CANShmResult rc = (cfg->api == REPLAY_API_LINEAR)
+                        ? can_shm_set_linear_probing(f->can_id, f->dlc, f->data)
+                        : can_shm_set(f->can_id, f->dlc, f->data);
+                    if (rc == CAN_SHM_SUCCESS) {
+                        frames_sent++;
+                    } else {
+                        errors++;
+                    }
+                }
+                t1 = get_timestamp_ns();
+            }
+            latencies[calls++] = t1 - t0;
+            i = end;
+        }
+    }
+
+    uint64_t elapsed = get_timestamp_ns() - start;
+    double elapsed_s = elapsed / 1e9;
+
+    qsort(latencies, calls, sizeof(uint64_t), compare_u64);
+    uint64_t sum = 0;
+    for (size_t k = 0; k < calls; k++) {
+        sum += latencies[k];
+    }
+
+    printf("\n=== Replay Results ===\n");
+    printf("Mode: %s, API: %s, batch size: %u, loops: %u\n",
+           cfg->realtime ? "realtime" : "max speed",
+           cfg->api == REPLAY_API_LINEAR ? "linear probing" : "default",
+           cfg->batch_size, cfg->loops);
+    if (cfg->realtime) {
+        printf("Speed factor: %.2fx, max schedule lag: %.1f us\n",
+               cfg->speed, max_lag_ns / 1e3);
+    }
+    printf("Frames: %llu stored, %llu failed\n",
+           (unsigned long long)frames_sent, (unsigned long long)errors);
+    printf("Elapsed: %.6f sec\n", elapsed_s);
+    printf("Throughput: %.0f frames/sec\n", elapsed_s > 0 ? frames_sent / elapsed_s : 0.0);
+    printf("Set latency per call (ns): min=%llu avg=%.1f p50=%llu p99=%llu p99.9=%llu max=%llu\n",
+           (unsigned long long)latencies[0],
+           (double)sum / calls,
+           (unsigned long long)latencies[calls / 2],
+           (unsigned long long)latencies[(size_t)(calls * 0.99)],
+           (unsigned long long)latencies[(size_t)(calls * 0.999)],
+           (unsigned long long)latencies[calls - 1]);
+    if (cfg->batch_size > 1 && frames_sent > 0) {
+        printf("Set latency per frame (ns): avg=%.1f\n", (double)sum / frames_sent);
+    }
+
+    free(latencies);
+    free(batch);
+    return errors == 0 ? 0 : 1;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [OPTIONS] <logfile>\n", prog);
+    printf("\n");
+    printf("Options:\n");
+    printf("  -f <fmt>    Input format: auto|candump|asc|bin (default: auto)\n");
+    printf("  -r          Replay with original inter-frame timing\n");
+    printf("  -s <x>      Speed factor for realtime replay (default: 1.0)\n");
+    printf("  -b <n>      Batch size, >1 uses can_shm_set_batch (default: 1, max: %d)\n",
+           REPLAY_MAX_BATCH);
+    printf("  -n <n>      Number of loops over the log (default: 1)\n");
+    printf("  -m <api>    Set API: default|linear (default: default)\n");
+    printf("  -o <file>   Convert the log to binary format and exit\n");
+    printf("  -h          Show this help message\n");
+}
+
+int main(int argc, char* argv[]) {
+    ReplayConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.speed = 1.0;
+    cfg.batch_size = 1;
+    cfg.loops = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:rs:b:n:m:o:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "candump") == 0) cfg.format = REPLAY_FORMAT_CANDUMP;
+                else if (strcmp(optarg, "asc") == 0) cfg.format = REPLAY_FORMAT_ASC;
+                else if (strcmp(optarg, "bin") == 0) cfg.format = REPLAY_FORMAT_BINARY;
+                else if (strcmp(optarg, "auto") == 0) cfg.format = REPLAY_FORMAT_AUTO;
+                else {
+                    fprintf(stderr, "Unknown format: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'r':
+                cfg.realtime = 1;
+                break;
+            case 's':
+                cfg.speed = atof(optarg);
+                break;
+            case 'b':
+                cfg.batch_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                cfg.loops = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                if (strcmp(optarg, "default") == 0) cfg.api = REPLAY_API_DEFAULT;
+                else if (strcmp(optarg, "linear") == 0) cfg.api = REPLAY_API_LINEAR;
+                else {
+                    fprintf(stderr, "Unknown API: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                cfg.output_path = optarg;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    cfg.input_path = argv[optind];
+
+    if (cfg.speed <= 0.0 || cfg.batch_size == 0 || cfg.batch_size > REPLAY_MAX_BATCH ||
+        cfg.loops == 0) {
+        fprintf(stderr, "Invalid speed, batch size or loop count\n");
+        return 1;
+    }
+
+    FrameList list;
+    memset(&list, 0, sizeof(list));
+    if (load_log(cfg.input_path, cfg.format, &list) != 0) {
+        free(list.frames);
+        return 1;
+    }
+    if (list.count == 0) {
+        fprintf(stderr, "%s: no frames found\n", cfg.input_path);
+        free(list.frames);
+        return 1;
+    }
+    printf("Loaded %zu frames from %s\n", list.count, cfg.input_path);
+
+    // バイナリ変換モード
+    if (cfg.output_path != NULL) {
+        int rc = write_binary_log(cfg.output_path, &list);
+        if (rc == 0) {
+            printf("Wrote %zu frames to %s\n", list.count, cfg.output_path);
+        }
+        free(list.frames);
+        return rc == 0 ? 0 : 1;
+    }
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to initialize shared memory\n");
+        free(list.frames);
+        return 1;
+    }
+
+    int rc = replay(&cfg, &list);
+
+    can_shm_cleanup();
+    free(list.frames);
+    return rc;
+}
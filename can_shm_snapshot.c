@@ -0,0 +1,469 @@
+#include "can_shm_snapshot.h"
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include "can_shm_futex.h"
+#include "can_shm_presence.h"
+#include "can_shm_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <libgen.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern int g_is_initialized;
+
+// CRC32（IEEE 802.3、反転多項式 0xEDB88320）
+static uint32_t g_crc_table[256];
+static pthread_once_t g_crc_once = PTHREAD_ONCE_INIT;
+
+static void init_crc_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        g_crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32_update(uint32_t crc, const void* buf, size_t len) {
+    const uint8_t* p = (const uint8_t*)buf;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = g_crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t snapshot_checksum(const CANSnapshotHeader* header, const CANSnapshotRecord* records) {
+    pthread_once(&g_crc_once, init_crc_table);
+    CANSnapshotHeader copy = *header;
+    copy.checksum = 0;
+    uint32_t crc = crc32_update(0, &copy, sizeof(copy));
+    return crc32_update(crc, records, (size_t)header->record_count * sizeof(CANSnapshotRecord));
+}
+
+static uint64_t get_realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static CANShmResult resolve_segment(uint32_t bus, SharedMemoryLayout** shm_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (bus >= CAN_SHM_MAX_BUSES) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    *shm_out = can_shm_bus_segment(bus);
+    return *shm_out != NULL ? CAN_SHM_SUCCESS : CAN_SHM_ERROR_INIT_FAILED;
+}
+
+// 全量書き込み（EINTR・部分書き込みを継続）
+static int write_all(int fd, const void* buf, size_t len) {
+    const uint8_t* p = (const uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// rename を永続化するためにディレクトリをfsync
+static void sync_parent_directory(const char* path) {
+    char buf[PATH_MAX];
+    snprintf(buf, sizeof(buf), "%s", path);
+    int dir_fd = open(dirname(buf), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+}
+
+// 保存レコードの蓄積先（拡張領域のIDで MAX_CAN_ENTRIES を超える場合は拡張する）
+typedef struct {
+    CANSnapshotRecord* records;
+    uint32_t count;
+    uint32_t capacity;
+    int failed;
+} RecordBuffer;
+
+static CANSnapshotRecord* append_record(RecordBuffer* buf) {
+    if (buf->count == buf->capacity) {
+        uint32_t capacity = buf->capacity * 2;
+        CANSnapshotRecord* records = (CANSnapshotRecord*)realloc(buf->records,
+                                                                 sizeof(CANSnapshotRecord) * capacity);
+        if (records == NULL) {
+            buf->failed = 1;
+            return NULL;
+        }
+        buf->records = records;
+        buf->capacity = capacity;
+    }
+    CANSnapshotRecord* rec = &buf->records[buf->count++];
+    memset(rec, 0, sizeof(CANSnapshotRecord));
+    return rec;
+}
+
+// 拡張領域のIDのレコード（通知設定はセグメント全体のもののみのため保存しない）
+static void append_ext_record(const CANData* data, void* user_data) {
+    CANSnapshotRecord* rec = append_record((RecordBuffer*)user_data);
+    if (rec == NULL) {
+        return;
+    }
+    rec->bucket_index = CAN_SNAPSHOT_EXT_BUCKET;
+    rec->can_id = data->can_id;
+    rec->timestamp = data->timestamp;
+    rec->dlc = data->dlc;
+    memcpy(rec->data, data->data, sizeof(rec->data));
+}
+
+// メインテーブルの探査範囲に格納済みか（拡張領域のIDの復元前の確認）
+static int stored_in_probe_range(const SharedMemoryLayout* shm, uint32_t can_id) {
+    uint32_t home = can_id_hash(can_id);
+    for (uint32_t i = 0; i < CAN_SHM_MAX_PROBE; i++) {
+        const CANBucket* bucket = &shm->buckets[(home + i) % MAX_CAN_ENTRIES];
+        if (bucket->is_valid && bucket->can_data.can_id == can_id) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+CANShmResult can_shm_snapshot_save(uint32_t bus, const char* path, uint32_t* saved_out) {
+    if (saved_out != NULL) {
+        *saved_out = 0;
+    }
+
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    if (path == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    RecordBuffer buf = {NULL, 0, MAX_CAN_ENTRIES, 0};
+    buf.records = (CANSnapshotRecord*)malloc(sizeof(CANSnapshotRecord) * buf.capacity);
+    if (buf.records == NULL) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    // 有効なバケットをseqlockで一貫して読み取り（書き込み側は止めない）
+    for (uint32_t i = 0; i < MAX_CAN_ENTRIES; i++) {
+        CANBucket* bucket = &shm->buckets[i];
+        if (!bucket->is_valid) {
+            continue;
+        }
+
+        CANData data;
+        uint32_t seq1, seq2;
+        do {
+            seq1 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+            if (seq1 & 1) continue; // 書き込み中
+            data = bucket->can_data;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            seq2 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_RELAXED);
+        } while ((seq1 & 1) || seq1 != seq2);
+
+        CANSnapshotRecord* rec = append_record(&buf);
+        rec->bucket_index = i;
+        rec->can_id = data.can_id;
+        rec->timestamp = data.timestamp;
+        rec->dlc = data.dlc;
+        // 個別の通知設定は格納中のIDに対するもののみ保存
+        if (bucket->mode_can_id == data.can_id) {
+            rec->ignore_mask = bucket->ignore_mask;
+            rec->publish_mode = bucket->publish_mode;
+        }
+        memcpy(rec->data, data.data, sizeof(rec->data));
+    }
+
+    // 探査範囲に空きがなかったID（拡張領域はバス0のみ）
+    if (bus == 0) {
+        can_shm_ext_foreach(append_ext_record, &buf);
+    }
+    if (buf.failed) {
+        free(buf.records);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    CANSnapshotRecord* records = buf.records;
+    uint32_t count = buf.count;
+
+    CANSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAN_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = CAN_SNAPSHOT_VERSION;
+    header.layout_version = CAN_SHM_LAYOUT_VERSION;
+    header.table_size = MAX_CAN_ENTRIES;
+    header.bus = bus;
+    header.record_count = count;
+    header.saved_monotonic_ns = can_shm_clock_now_ns();
+    header.saved_realtime_ns = get_realtime_ns();
+    header.checksum = snapshot_checksum(&header, records);
+
+    // 一時ファイルへ書き込み、fsync後にrenameで置き換え
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%d", path, (int)getpid());
+    int fd = open(tmp_path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd == -1) {
+        perror(tmp_path);
+        free(records);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    int failed = write_all(fd, &header, sizeof(header)) != 0 ||
+                 write_all(fd, records, (size_t)count * sizeof(CANSnapshotRecord)) != 0 ||
+                 fsync(fd) != 0;
+    close(fd);
+    free(records);
+
+    if (failed || rename(tmp_path, path) != 0) {
+        perror(path);
+        unlink(tmp_path);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    sync_parent_directory(path);
+
+    if (saved_out != NULL) {
+        *saved_out = count;
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_snapshot_load(uint32_t bus, const char* path, uint32_t* loaded_out) {
+    if (loaded_out != NULL) {
+        *loaded_out = 0;
+    }
+
+    SharedMemoryLayout* shm;
+    CANShmResult result = resolve_segment(bus, &shm);
+    if (result != CAN_SHM_SUCCESS) {
+        return result;
+    }
+    if (path == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return errno == ENOENT ? CAN_SHM_ERROR_NOT_FOUND : CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CANSnapshotHeader)) {
+        close(fd);
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    // ヘッダ・サイズ・チェックサムの検証
+    const CANSnapshotHeader* header = (const CANSnapshotHeader*)map;
+    const CANSnapshotRecord* records = (const CANSnapshotRecord*)(header + 1);
+    if (memcmp(header->magic, CAN_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CAN_SNAPSHOT_VERSION ||
+        header->layout_version != CAN_SHM_LAYOUT_VERSION ||
+        header->table_size != MAX_CAN_ENTRIES ||
+        header->record_count > CAN_SNAPSHOT_MAX_RECORDS ||
+        (uint64_t)st.st_size != sizeof(CANSnapshotHeader) +
+                                (uint64_t)header->record_count * sizeof(CANSnapshotRecord) ||
+        snapshot_checksum(header, records) != header->checksum) {
+        munmap(map, (size_t)st.st_size);
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    // 保存時点からの経過時間（再起動をまたぐためCLOCK_REALTIMEで計測）
+    uint64_t now = can_shm_clock_now_ns();
+    uint64_t realtime = get_realtime_ns();
+    uint64_t downtime = realtime > header->saved_realtime_ns ? realtime - header->saved_realtime_ns : 0;
+
+    uint32_t loaded = 0;
+    for (uint32_t i = 0; i < header->record_count; i++) {
+        const CANSnapshotRecord* rec = &records[i];
+        int ext = rec->bucket_index == CAN_SNAPSHOT_EXT_BUCKET;
+        if ((!ext && rec->bucket_index >= MAX_CAN_ENTRIES) || (ext && bus != 0) ||
+            !is_valid_can_id(rec->can_id) || rec->dlc > 64) {
+            continue;
+        }
+
+        // 保存時点での経過時間に停止期間を加えた時刻へ換算
+        uint64_t age = header->saved_monotonic_ns > rec->timestamp ? header->saved_monotonic_ns - rec->timestamp : 0;
+        age += downtime;
+        uint64_t timestamp = now > age ? now - age : 1;
+
+        if (ext) {
+            // 再起動後に受信済み（メインテーブル・拡張領域のどちらか）なら復元しない
+            CANData current;
+            if (stored_in_probe_range(shm, rec->can_id) ||
+                (can_shm_ext_active(shm) && can_shm_ext_get(rec->can_id, &current) == CAN_SHM_SUCCESS)) {
+                continue;
+            }
+            CANData value;
+            memset(&value, 0, sizeof(value));
+            value.can_id = rec->can_id;
+            value.dlc = rec->dlc;
+            value.timestamp = timestamp;
+            memcpy(value.data, rec->data, sizeof(value.data));
+            if (can_shm_ext_restore(&value) != CAN_SHM_SUCCESS) {
+                continue;
+            }
+
+            // 拡張領域のIDの更新はホームバケットで通知する
+            CANBucket* home = &shm->buckets[can_id_hash(rec->can_id)];
+            if (pthread_mutex_lock(&home->mutex) == 0) {
+                can_shm_bucket_publish_change(shm, home);
+                pthread_mutex_unlock(&home->mutex);
+            }
+            loaded++;
+            continue;
+        }
+
+        CANBucket* bucket = &shm->buckets[rec->bucket_index];
+        if (pthread_mutex_lock(&bucket->mutex) != 0) {
+            continue;
+        }
+        if (bucket->is_valid) {
+            pthread_mutex_unlock(&bucket->mutex);
+            continue;  // 再起動後に受信済み
+        }
+
+        can_shm_presence_add(shm, rec->can_id);
+        uint32_t seq = bucket->can_data.sequence + 1;
+        __atomic_store_n(&bucket->can_data.sequence, seq, __ATOMIC_RELEASE);
+        bucket->can_data.can_id = rec->can_id;
+        bucket->can_data.dlc = rec->dlc;
+        bucket->can_data.timestamp = timestamp;
+        memcpy(bucket->can_data.data, rec->data, sizeof(rec->data));
+        bucket->ignore_mask = rec->ignore_mask;
+        bucket->publish_mode = rec->publish_mode;
+        bucket->mode_can_id = rec->can_id;
+        bucket->is_valid = 1;
+        __atomic_store_n(&bucket->can_data.sequence, seq + 1, __ATOMIC_RELEASE);
+        can_shm_bucket_publish_change(shm, bucket);
+
+        pthread_mutex_unlock(&bucket->mutex);
+        loaded++;
+    }
+    munmap(map, (size_t)st.st_size);
+
+    // 待機中の購読者への通知は全体で1回
+    if (loaded > 0) {
+        pthread_mutex_lock(&shm->global_mutex);
+        shm->global_sequence += loaded;
+        pthread_cond_broadcast(&shm->update_condition);
+        pthread_mutex_unlock(&shm->global_mutex);
+    }
+
+    if (loaded_out != NULL) {
+        *loaded_out = loaded;
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+// 定期保存スレッド（プロセスローカル）
+static pthread_mutex_t g_autosave_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_autosave_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_autosave_thread;
+static int g_autosave_running = 0;
+static int g_autosave_stop = 0;
+static uint32_t g_autosave_bus = 0;
+static uint32_t g_autosave_interval_ms = 0;
+static char g_autosave_path[PATH_MAX];
+
+static void* autosave_thread_func(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_autosave_mutex);
+    while (!g_autosave_stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += g_autosave_interval_ms / 1000;
+        deadline.tv_nsec += (long)(g_autosave_interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!g_autosave_stop &&
+               pthread_cond_timedwait(&g_autosave_cond, &g_autosave_mutex, &deadline) != ETIMEDOUT) {
+        }
+        if (g_autosave_stop) {
+            break;
+        }
+
+        pthread_mutex_unlock(&g_autosave_mutex);
+        can_shm_snapshot_save(g_autosave_bus, g_autosave_path, NULL);
+        pthread_mutex_lock(&g_autosave_mutex);
+    }
+    pthread_mutex_unlock(&g_autosave_mutex);
+
+    // 停止時は最終値を保存（定期保存の途中で停止要求が来た場合も含む）
+    can_shm_snapshot_save(g_autosave_bus, g_autosave_path, NULL);
+    return NULL;
+}
+
+CANShmResult can_shm_snapshot_autosave_start(uint32_t bus, const char* path, uint32_t interval_ms) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    if (bus >= CAN_SHM_MAX_BUSES || path == NULL || interval_ms == 0 ||
+        strlen(path) >= sizeof(g_autosave_path)) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&g_autosave_mutex);
+    if (g_autosave_running) {
+        pthread_mutex_unlock(&g_autosave_mutex);
+        return CAN_SHM_ERROR_INVALID_PARAM;  // 既に実行中
+    }
+    g_autosave_bus = bus;
+    g_autosave_interval_ms = interval_ms;
+    snprintf(g_autosave_path, sizeof(g_autosave_path), "%s", path);
+    g_autosave_stop = 0;
+    if (pthread_create(&g_autosave_thread, NULL, autosave_thread_func, NULL) != 0) {
+        pthread_mutex_unlock(&g_autosave_mutex);
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    g_autosave_running = 1;
+    pthread_mutex_unlock(&g_autosave_mutex);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_snapshot_autosave_stop(void) {
+    pthread_mutex_lock(&g_autosave_mutex);
+    if (!g_autosave_running) {
+        pthread_mutex_unlock(&g_autosave_mutex);
+        return CAN_SHM_SUCCESS;
+    }
+    g_autosave_stop = 1;
+    pthread_cond_signal(&g_autosave_cond);
+    pthread_mutex_unlock(&g_autosave_mutex);
+
+    pthread_join(g_autosave_thread, NULL);
+
+    pthread_mutex_lock(&g_autosave_mutex);
+    g_autosave_running = 0;
+    pthread_mutex_unlock(&g_autosave_mutex);
+    return CAN_SHM_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#ifndef CAN_SHM_SNAPSHOT_H
+#define CAN_SHM_SNAPSHOT_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * テーブルのスナップショット（ウォームリスタート用）
+ * ==================================================
+ *
+ * 有効なバケットの最終値をファイルへ保存し、再起動時に読み戻す。
+ * ECUの再送を待たずに、起動直後から各IDの最終値を参照できる。
+ *
+ * ファイル内レイアウト:
+ *   [CANSnapshotHeader]
+ *   [CANSnapshotRecord x record_count]  (有効なバケット、続いて拡張領域のID)
+ *
+ * - 保存は一時ファイルへの書き込み・fsync後のrenameで行い、途中の状態は見えない
+ * - 読み込みはファイルをmmapしてバケットへ直接コピーする（Setの通知・ジャーナルは経由しない）
+ * - レイアウトバージョン・テーブルサイズ・チェックサムが一致しないファイルは読み込まない
+ * - 既に有効なバケット（再起動後に受信済みの値）は上書きしない
+ * - バス0の拡張領域（can_shm_ext.h）のIDは bucket_index=CAN_SNAPSHOT_EXT_BUCKET のレコードとして保存し、
+ *   再起動後に未受信のIDのみ拡張領域へ復元する（メインテーブルのレコードの後に読み込む）
+ * - タイムスタンプは保存時点からの経過時間（CLOCK_REALTIME基準）を加味して現在の時刻系へ換算する
+ */
+
+#define CAN_SNAPSHOT_MAGIC "CANSNP01"
+#define CAN_SNAPSHOT_VERSION 1
+
+// 拡張領域のIDのレコードの bucket_index
+#define CAN_SNAPSHOT_EXT_BUCKET 0xFFFFFFFFu
+
+// レコード数の上限（メインテーブル + 拡張領域の最終世代）
+#define CAN_SNAPSHOT_MAX_RECORDS \
+    (MAX_CAN_ENTRIES + (1u << (CAN_SHM_EXT_BASE_BITS + CAN_SHM_EXT_MAX_LEVELS - 1)))
+
+// ファイルヘッダ
+typedef struct {
+    char     magic[8];              // CAN_SNAPSHOT_MAGIC
+    uint32_t version;               // CAN_SNAPSHOT_VERSION
+    uint32_t layout_version;        // 保存時の CAN_SHM_LAYOUT_VERSION
+    uint32_t table_size;            // 保存時の MAX_CAN_ENTRIES
+    uint32_t bus;                   // 保存元のバス番号
+    uint32_t record_count;          // レコード数
+    uint32_t checksum;              // CRC32（checksum=0としたヘッダ + レコード部）
+    uint64_t saved_monotonic_ns;    // 保存時刻（タイムスタンプと同じ時刻系）
+    uint64_t saved_realtime_ns;     // 保存時刻（CLOCK_REALTIME、再起動をまたいだ経過時間用）
+} CANSnapshotHeader;
+
+// バケット1件分（固定長96byte）
+typedef struct {
+    uint32_t bucket_index;          // 格納先バケット（リニアプロービングでの移動先を含む、拡張領域は CAN_SNAPSHOT_EXT_BUCKET）
+    uint32_t can_id;
+    uint64_t timestamp;
+    uint64_t ignore_mask;           // On-change比較の無視マスク
+    uint16_t dlc;
+    uint8_t  publish_mode;          // バケット個別の通知モード
+    uint8_t  reserved[5];
+    uint8_t  data[64];
+} CANSnapshotRecord;
+
+/**
+ * スナップショットの保存
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param path 保存先ファイル
+ * @param saved_out 保存したID数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_snapshot_save(uint32_t bus, const char* path, uint32_t* saved_out);
+
+/**
+ * スナップショットの読み込み（無効なバケットのみ復元）
+ * @param bus バス番号 (0~CAN_SHM_MAX_BUSES-1)
+ * @param path スナップショットファイル
+ * @param loaded_out 復元したID数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if the file does not exist,
+ *         CAN_SHM_ERROR_INVALID_PARAM if the file is corrupt or from another layout
+ */
+CANShmResult can_shm_snapshot_load(uint32_t bus, const char* path, uint32_t* loaded_out);
+
+/**
+ * 定期保存の開始（バックグラウンドスレッド、プロセス内で1つ）
+ * @param bus バス番号
+ * @param path 保存先ファイル
+ * @param interval_ms 保存間隔
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_snapshot_autosave_start(uint32_t bus, const char* path, uint32_t interval_ms);
+
+/**
+ * 定期保存の停止（停止前に最終値を保存、can_shm_cleanup からも呼ばれる）
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_snapshot_autosave_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_SNAPSHOT_H
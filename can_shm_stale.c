@@ -0,0 +1,626 @@
+#include "can_shm_stale.h"
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include "can_shm_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+// 外部変数（can_shm_api.cで定義）
+extern SharedMemoryLayout* g_shm_ptr;
+extern int g_is_initialized;
+
+#define STALE_ENTRY_MASK (CAN_SHM_STALE_MAX_IDS - 1)
+#define STALE_EVENT_MASK (CAN_SHM_STALE_EVENT_SIZE - 1)
+#define STALE_LEVEL1_SHIFT CAN_SHM_STALE_WHEEL0_BITS
+#define STALE_LEVEL2_SHIFT (CAN_SHM_STALE_WHEEL0_BITS + CAN_SHM_STALE_WHEEL1_BITS)
+#define STALE_MAX_DELTA (1ULL << (STALE_LEVEL2_SHIFT + CAN_SHM_STALE_WHEEL2_BITS))
+
+// スロット番号（レベル x 256 + インデックス）
+#define STALE_SLOT(level, index) ((int32_t)((level) * 256 + (index)))
+
+// エントリ状態
+#define STALE_STATE_EMPTY 0
+#define STALE_STATE_USED 1
+#define STALE_STATE_DELETED 2
+
+// 監視スレッド（プロセスローカル）
+static pthread_t g_monitor_thread;
+static volatile int g_monitor_running = 0;
+static uint32_t g_monitor_interval_ms = 0;
+
+static int32_t* slot_head(CANStaleMonitor* mon, int32_t slot) {
+    int32_t level = slot / 256;
+    int32_t index = slot % 256;
+    if (level == 0) return &mon->wheel0[index];
+    if (level == 1) return &mon->wheel1[index];
+    return &mon->wheel2[index];
+}
+
+// タイマーをスロットから外す
+static void timer_unlink(CANStaleMonitor* mon, int32_t idx) {
+    CANStaleEntry* e = &mon->entries[idx];
+    if (e->slot < 0) {
+        return;
+    }
+    if (e->prev >= 0) {
+        mon->entries[e->prev].next = e->next;
+    } else {
+        *slot_head(mon, e->slot) = e->next;
+    }
+    if (e->next >= 0) {
+        mon->entries[e->next].prev = e->prev;
+    }
+    e->next = e->prev = e->slot = -1;
+}
+
+// 満了tickに応じたレベルのスロットへタイマーを登録（満了済みは現在tickのスロット）
+static void timer_link(CANStaleMonitor* mon, int32_t idx, uint64_t expires) {
+    CANStaleEntry* e = &mon->entries[idx];
+    uint64_t now = mon->current_tick;
+
+    if (expires < now) {
+        expires = now;
+    }
+    // ホイールの範囲外は範囲の末尾に置き、満了時に再評価する
+    if (expires - now >= STALE_MAX_DELTA) {
+        expires = now + STALE_MAX_DELTA - 1;
+    }
+
+    uint64_t delta = expires - now;
+    int32_t slot;
+    if (delta < CAN_SHM_STALE_WHEEL0_SIZE) {
+        slot = STALE_SLOT(0, expires & (CAN_SHM_STALE_WHEEL0_SIZE - 1));
+    } else if (delta < (1ULL << STALE_LEVEL2_SHIFT)) {
+        slot = STALE_SLOT(1, (expires >> STALE_LEVEL1_SHIFT) & (CAN_SHM_STALE_WHEEL1_SIZE - 1));
+    } else {
+        slot = STALE_SLOT(2, (expires >> STALE_LEVEL2_SHIFT) & (CAN_SHM_STALE_WHEEL2_SIZE - 1));
+    }
+
+    int32_t* head = slot_head(mon, slot);
+    e->slot = slot;
+    e->prev = -1;
+    e->next = *head;
+    if (*head >= 0) {
+        mon->entries[*head].prev = idx;
+    }
+    *head = idx;
+}
+
+// 時刻[ns]を満了tickへ変換（切り上げ）
+static uint64_t ns_to_tick(const CANStaleMonitor* mon, uint64_t ns) {
+    if (ns <= mon->base_ns) {
+        return 0;
+    }
+    return (ns - mon->base_ns + mon->tick_ns - 1) / mon->tick_ns;
+}
+
+static uint32_t entry_hash(uint32_t can_id) {
+    return can_id_hash(can_id) & STALE_ENTRY_MASK;
+}
+
+// 登録済みエントリの検索（-1=未登録）
+static int32_t find_entry(const CANStaleMonitor* mon, uint32_t can_id) {
+    uint32_t h = entry_hash(can_id);
+    for (uint32_t i = 0; i < CAN_SHM_STALE_MAX_IDS; i++) {
+        uint32_t idx = (h + i) & STALE_ENTRY_MASK;
+        const CANStaleEntry* e = &mon->entries[idx];
+        uint8_t state = __atomic_load_n(&e->state, __ATOMIC_ACQUIRE);
+        if (state == STALE_STATE_EMPTY) {
+            return -1;
+        }
+        if (state == STALE_STATE_USED && e->can_id == can_id) {
+            return (int32_t)idx;
+        }
+    }
+    return -1;
+}
+
+/**
+ * バケットから最後の受信時刻を取得（直接ハッシュ・リニアプロービング・拡張領域に対応）
+ * @return 受信時刻（未受信は0）
+ */
+static uint64_t read_last_timestamp(uint32_t can_id) {
+    uint32_t initial_hash = can_id_hash(can_id);
+
+    for (int i = 0; i < CAN_SHM_MAX_PROBE; i++) {
+        CANBucket* bucket = &g_shm_ptr->buckets[(initial_hash + i) % MAX_CAN_ENTRIES];
+        if (!bucket->is_valid) {
+            break;
+        }
+
+        uint32_t seq1, seq2;
+        uint32_t id;
+        uint64_t timestamp;
+        do {
+            seq1 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+            id = bucket->can_data.can_id;
+            timestamp = bucket->can_data.timestamp;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            seq2 = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_RELAXED);
+        } while ((seq1 & 1) || seq1 != seq2);
+
+        if (id == can_id) {
+            return timestamp;
+        }
+    }
+
+    // 探査範囲に空きがなかったIDは拡張領域
+    CANData data;
+    if (can_shm_ext_active(g_shm_ptr) && can_shm_ext_get(can_id, &data) == CAN_SHM_SUCCESS) {
+        return data.timestamp;
+    }
+    return 0;
+}
+
+static void push_event(CANStaleMonitor* mon, const CANStaleEntry* e, uint32_t kind,
+                       uint64_t now_ns) {
+    CANStaleEvent* ev = &mon->events[mon->event_head & STALE_EVENT_MASK];
+    ev->seq = mon->event_head + 1;
+    ev->can_id = e->can_id;
+    ev->kind = kind;
+    ev->last_timestamp = e->last_timestamp;
+    ev->detected_at = now_ns;
+    mon->event_head++;
+}
+
+// 満了したタイマーの評価
+static uint32_t expire_entry(CANStaleMonitor* mon, int32_t idx, uint64_t now_ns) {
+    CANStaleEntry* e = &mon->entries[idx];
+
+    // ホイール範囲外で仮置きしたタイマーは再登録
+    if (e->expires_tick > mon->current_tick) {
+        timer_link(mon, idx, e->expires_tick);
+        return 0;
+    }
+
+    uint64_t last = read_last_timestamp(e->can_id);
+    uint64_t reference = last > e->armed_at ? last : e->armed_at;
+    uint64_t deadline_ns = reference + (uint64_t)e->timeout_ms * 1000000ULL;
+    uint32_t events = 0;
+
+    if (deadline_ns > now_ns) {
+        // 期限内に受信あり：次の期限で再登録
+        e->last_timestamp = last;
+        if (e->stale) {
+            __atomic_store_n(&e->stale, 0, __ATOMIC_RELEASE);
+            mon->stale_now--;
+            push_event(mon, e, CAN_SHM_STALE_EVENT_RECOVERED, now_ns);
+            events++;
+        }
+        e->expires_tick = ns_to_tick(mon, deadline_ns);
+    } else {
+        // 途絶：周期ごとに受信再開を確認
+        e->last_timestamp = last;
+        if (!e->stale) {
+            __atomic_store_n(&e->stale, 1, __ATOMIC_RELEASE);
+            e->stale_count++;
+            mon->stale_now++;
+            push_event(mon, e, CAN_SHM_STALE_EVENT_TIMEOUT, now_ns);
+            events++;
+        }
+        e->expires_tick = mon->current_tick +
+                          ns_to_tick(mon, mon->base_ns + (uint64_t)e->cycle_ms * 1000000ULL);
+    }
+
+    timer_link(mon, idx, e->expires_tick);
+    return events;
+}
+
+// 上位レベルのスロットを下位レベルへ展開
+static void cascade(CANStaleMonitor* mon, int32_t* head) {
+    int32_t idx = *head;
+    *head = -1;
+    while (idx >= 0) {
+        int32_t next = mon->entries[idx].next;
+        CANStaleEntry* e = &mon->entries[idx];
+        e->next = e->prev = e->slot = -1;
+        timer_link(mon, idx, e->expires_tick);
+        idx = next;
+    }
+}
+
+static void reset_monitor(CANStaleMonitor* mon, uint64_t tick_ns) {
+    for (int i = 0; i < CAN_SHM_STALE_WHEEL0_SIZE; i++) mon->wheel0[i] = -1;
+    for (int i = 0; i < CAN_SHM_STALE_WHEEL1_SIZE; i++) mon->wheel1[i] = -1;
+    for (int i = 0; i < CAN_SHM_STALE_WHEEL2_SIZE; i++) mon->wheel2[i] = -1;
+    memset(mon->entries, 0, sizeof(mon->entries));
+    for (int i = 0; i < CAN_SHM_STALE_MAX_IDS; i++) {
+        mon->entries[i].next = mon->entries[i].prev = mon->entries[i].slot = -1;
+    }
+    mon->base_ns = can_shm_clock_now_ns();
+    mon->current_tick = 0;
+    mon->entry_count = 0;
+    mon->stale_now = 0;
+    __atomic_store_n(&mon->tick_ns, tick_ns, __ATOMIC_RELEASE);
+}
+
+CANShmResult can_shm_stale_configure(uint32_t tick_ms) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    if (pthread_mutex_lock(&mon->mutex) != 0) {
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+    reset_monitor(mon, (uint64_t)(tick_ms ? tick_ms : CAN_SHM_STALE_DEFAULT_TICK_MS) * 1000000ULL);
+    pthread_mutex_unlock(&mon->mutex);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_stale_register(uint32_t can_id, uint32_t cycle_ms, uint32_t timeout_ms) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (!is_valid_can_id(can_id)) {
+        return CAN_SHM_ERROR_INVALID_ID;
+    }
+
+    if (cycle_ms == 0) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    if (timeout_ms == 0) {
+        timeout_ms = cycle_ms * CAN_SHM_STALE_DEFAULT_MULTIPLIER;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    if (pthread_mutex_lock(&mon->mutex) != 0) {
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+
+    if (mon->tick_ns == 0) {
+        reset_monitor(mon, (uint64_t)CAN_SHM_STALE_DEFAULT_TICK_MS * 1000000ULL);
+    }
+
+    int32_t idx = find_entry(mon, can_id);
+    if (idx < 0) {
+        // 空き（または削除済み）スロットを確保
+        uint32_t h = entry_hash(can_id);
+        for (uint32_t i = 0; i < CAN_SHM_STALE_MAX_IDS; i++) {
+            uint32_t probe = (h + i) & STALE_ENTRY_MASK;
+            if (mon->entries[probe].state != STALE_STATE_USED) {
+                idx = (int32_t)probe;
+                break;
+            }
+        }
+        if (idx < 0) {
+            pthread_mutex_unlock(&mon->mutex);
+            return CAN_SHM_ERROR_NOT_FOUND;  // 監視テーブルが満杯
+        }
+        CANStaleEntry* e = &mon->entries[idx];
+        memset(e, 0, sizeof(*e));
+        e->can_id = can_id;
+        e->next = e->prev = e->slot = -1;
+        __atomic_store_n(&e->state, STALE_STATE_USED, __ATOMIC_RELEASE);
+        mon->entry_count++;
+    } else {
+        timer_unlink(mon, idx);
+    }
+
+    CANStaleEntry* e = &mon->entries[idx];
+    uint64_t now = can_shm_clock_now_ns();
+    e->cycle_ms = cycle_ms;
+    e->timeout_ms = timeout_ms;
+    e->armed_at = now;
+    e->last_timestamp = read_last_timestamp(can_id);
+
+    uint64_t reference = e->last_timestamp > now ? e->last_timestamp : now;
+    e->expires_tick = ns_to_tick(mon, reference + (uint64_t)timeout_ms * 1000000ULL);
+    if (e->expires_tick <= mon->current_tick) {
+        e->expires_tick = mon->current_tick + 1;  // 処理済みtickのスロットには置かない
+    }
+    timer_link(mon, idx, e->expires_tick);
+
+    pthread_mutex_unlock(&mon->mutex);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_stale_unregister(uint32_t can_id) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    if (pthread_mutex_lock(&mon->mutex) != 0) {
+        return CAN_SHM_ERROR_MUTEX_FAILED;
+    }
+
+    int32_t idx = mon->tick_ns != 0 ? find_entry(mon, can_id) : -1;
+    if (idx < 0) {
+        pthread_mutex_unlock(&mon->mutex);
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    CANStaleEntry* e = &mon->entries[idx];
+    timer_unlink(mon, idx);
+    if (e->stale) {
+        mon->stale_now--;
+    }
+    e->stale = 0;
+    __atomic_store_n(&e->state, STALE_STATE_DELETED, __ATOMIC_RELEASE);
+    mon->entry_count--;
+
+    pthread_mutex_unlock(&mon->mutex);
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_stale_load_file(const char* path, uint32_t default_cycle_ms,
+                                     uint32_t multiplier, uint32_t* loaded_out) {
+    if (loaded_out != NULL) {
+        *loaded_out = 0;
+    }
+
+    if (path == NULL || default_cycle_ms == 0) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    if (multiplier == 0) {
+        multiplier = CAN_SHM_STALE_DEFAULT_MULTIPLIER;
+    }
+
+    char line[512];
+    uint32_t loaded = 0;
+    CANShmResult first_error = CAN_SHM_SUCCESS;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        // コメント除去
+        char* comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+
+        // "0x100", "0x100:10", "0x100, 0x101:20" 形式
+        char* saveptr = NULL;
+        for (char* token = strtok_r(line, ", \t\r\n", &saveptr); token != NULL;
+             token = strtok_r(NULL, ", \t\r\n", &saveptr)) {
+            char* end = NULL;
+            unsigned long can_id = strtoul(token, &end, 0);
+            if (end == token) {
+                continue;
+            }
+
+            uint32_t cycle_ms = default_cycle_ms;
+            if (*end == ':') {
+                cycle_ms = (uint32_t)strtoul(end + 1, NULL, 0);
+            }
+
+            CANShmResult result = can_shm_stale_register((uint32_t)can_id, cycle_ms,
+                                                         cycle_ms * multiplier);
+            if (result == CAN_SHM_SUCCESS) {
+                loaded++;
+            } else if (first_error == CAN_SHM_SUCCESS) {
+                first_error = result;
+            }
+        }
+    }
+
+    fclose(fp);
+
+    if (loaded_out != NULL) {
+        *loaded_out = loaded;
+    }
+    return first_error;
+}
+
+uint32_t can_shm_stale_tick(uint64_t now_ns) {
+    if (!g_is_initialized) {
+        return 0;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    if (__atomic_load_n(&mon->tick_ns, __ATOMIC_ACQUIRE) == 0) {
+        return 0;
+    }
+
+    if (pthread_mutex_lock(&mon->mutex) != 0) {
+        return 0;
+    }
+
+    uint64_t target = now_ns > mon->base_ns ? (now_ns - mon->base_ns) / mon->tick_ns : 0;
+    uint32_t events = 0;
+
+    while (mon->current_tick < target) {
+        uint64_t t = ++mon->current_tick;
+
+        // 下位レベルが1周したら上位レベルの該当スロットを展開
+        if ((t & (CAN_SHM_STALE_WHEEL0_SIZE - 1)) == 0) {
+            if (((t >> STALE_LEVEL1_SHIFT) & (CAN_SHM_STALE_WHEEL1_SIZE - 1)) == 0) {
+                cascade(mon, &mon->wheel2[(t >> STALE_LEVEL2_SHIFT) &
+                                          (CAN_SHM_STALE_WHEEL2_SIZE - 1)]);
+            }
+            cascade(mon, &mon->wheel1[(t >> STALE_LEVEL1_SHIFT) & (CAN_SHM_STALE_WHEEL1_SIZE - 1)]);
+        }
+
+        // 満了スロットのタイマーを処理
+        int32_t* head = &mon->wheel0[t & (CAN_SHM_STALE_WHEEL0_SIZE - 1)];
+        int32_t idx = *head;
+        *head = -1;
+        while (idx >= 0) {
+            int32_t next = mon->entries[idx].next;
+            CANStaleEntry* e = &mon->entries[idx];
+            e->next = e->prev = e->slot = -1;
+            events += expire_entry(mon, idx, now_ns);
+            idx = next;
+        }
+    }
+
+    // 購読者への通知はtick処理1回につき1回
+    if (events > 0) {
+        pthread_cond_broadcast(&mon->event_condition);
+    }
+
+    pthread_mutex_unlock(&mon->mutex);
+    return events;
+}
+
+CANShmResult can_shm_stale_check(uint32_t can_id, int* stale_out) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (!is_valid_can_id(can_id) || stale_out == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    if (__atomic_load_n(&mon->tick_ns, __ATOMIC_ACQUIRE) == 0) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    int32_t idx = find_entry(mon, can_id);
+    if (idx < 0) {
+        return CAN_SHM_ERROR_NOT_FOUND;
+    }
+
+    const CANStaleEntry* e = &mon->entries[idx];
+    int stale = __atomic_load_n(&e->stale, __ATOMIC_ACQUIRE);
+    if (stale && read_last_timestamp(can_id) > e->last_timestamp) {
+        // 途絶検出後に受信再開済み（監視側の復帰イベントは次の満了時）
+        stale = 0;
+    }
+
+    *stale_out = stale;
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_subscribe_stale(uint32_t can_id,
+                                     uint32_t subscribe_count,
+                                     int32_t timeout_ms,
+                                     CANStaleCallback callback,
+                                     void* user_data) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if ((can_id != CAN_SHM_STALE_ANY_ID && !is_valid_can_id(can_id)) || callback == NULL) {
+        return CAN_SHM_ERROR_INVALID_PARAM;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    CANStaleEvent batch[CAN_SHM_STALE_EVENT_SIZE];
+    uint32_t received_count = 0;
+
+    struct timespec timeout_spec;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &timeout_spec);
+        timeout_spec.tv_sec += timeout_ms / 1000;
+        timeout_spec.tv_nsec += (timeout_ms % 1000) * 1000000;
+        if (timeout_spec.tv_nsec >= 1000000000) {
+            timeout_spec.tv_sec++;
+            timeout_spec.tv_nsec -= 1000000000;
+        }
+    }
+
+    pthread_mutex_lock(&mon->mutex);
+    uint64_t cursor = mon->event_head;
+
+    while (subscribe_count == 0 || received_count < subscribe_count) {
+        // 新しいイベント待ち
+        while (mon->event_head == cursor) {
+            int wait_result;
+            if (timeout_ms >= 0) {
+                wait_result = pthread_cond_timedwait(&mon->event_condition, &mon->mutex,
+                                                     &timeout_spec);
+            } else {
+                wait_result = pthread_cond_wait(&mon->event_condition, &mon->mutex);
+            }
+            if (wait_result == ETIMEDOUT) {
+                pthread_mutex_unlock(&mon->mutex);
+                return CAN_SHM_ERROR_TIMEOUT;
+            }
+        }
+
+        // リング1周以上遅れた分は読み飛ばす
+        if (mon->event_head - cursor > CAN_SHM_STALE_EVENT_SIZE) {
+            cursor = mon->event_head - CAN_SHM_STALE_EVENT_SIZE;
+        }
+        uint32_t n = 0;
+        while (cursor < mon->event_head) {
+            const CANStaleEvent* ev = &mon->events[cursor & STALE_EVENT_MASK];
+            if (can_id == CAN_SHM_STALE_ANY_ID || ev->can_id == can_id) {
+                batch[n++] = *ev;
+            }
+            cursor++;
+        }
+        pthread_mutex_unlock(&mon->mutex);
+
+        // コールバックはロック外で呼び出す
+        for (uint32_t i = 0; i < n; i++) {
+            if (subscribe_count != 0 && received_count >= subscribe_count) {
+                break;
+            }
+            callback(&batch[i], user_data);
+            received_count++;
+        }
+
+        pthread_mutex_lock(&mon->mutex);
+    }
+
+    pthread_mutex_unlock(&mon->mutex);
+    return CAN_SHM_SUCCESS;
+}
+
+static void* monitor_thread_func(void* arg) {
+    (void)arg;
+    struct timespec interval = {
+        (time_t)(g_monitor_interval_ms / 1000),
+        (long)(g_monitor_interval_ms % 1000) * 1000000L
+    };
+    while (g_monitor_running) {
+        can_shm_stale_tick(can_shm_clock_now_ns());
+        nanosleep(&interval, NULL);
+    }
+    return NULL;
+}
+
+CANShmResult can_shm_stale_monitor_start(uint32_t interval_ms) {
+    if (!g_is_initialized) {
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+
+    if (g_monitor_running) {
+        return CAN_SHM_SUCCESS;
+    }
+
+    CANStaleMonitor* mon = &g_shm_ptr->stale_monitor;
+    if (mon->tick_ns == 0) {
+        can_shm_stale_configure(0);
+    }
+
+    if (interval_ms == 0) {
+        interval_ms = (uint32_t)(mon->tick_ns / 1000000ULL);
+        if (interval_ms == 0) {
+            interval_ms = 1;
+        }
+    }
+
+    g_monitor_interval_ms = interval_ms;
+    g_monitor_running = 1;
+    if (pthread_create(&g_monitor_thread, NULL, monitor_thread_func, NULL) != 0) {
+        g_monitor_running = 0;
+        return CAN_SHM_ERROR_INIT_FAILED;
+    }
+    return CAN_SHM_SUCCESS;
+}
+
+CANShmResult can_shm_stale_monitor_stop(void) {
+    if (!g_monitor_running) {
+        return CAN_SHM_SUCCESS;
+    }
+
+    g_monitor_running = 0;
+    pthread_join(g_monitor_thread, NULL);
+    return CAN_SHM_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#ifndef CAN_SHM_STALE_H
+#define CAN_SHM_STALE_H
+
+#include "can_shm_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 失効（stale）監視
+ * =================
+ *
+ * CAN IDごとの期待送信周期を登録し、共有メモリ内の階層タイマーホイール
+ * （256 x 1tick / 64 x 256tick / 64 x 16384tick）で途絶を検出する。
+ * Set側には一切コストを追加しない。タイマー満了時にバケットの受信時刻を確認し、
+ * 更新されていれば次の満了時刻で再登録、されていなければ途絶としてイベントを発行する。
+ * 1tickあたりの処理量は満了したタイマー数のみに比例し、登録ID数には依存しない。
+ *
+ * tick処理は1プロセス（取り込みデーモン等）が can_shm_stale_tick を定期的に呼び出すか、
+ * can_shm_stale_monitor_start で起動した監視スレッドが行う。
+ */
+
+#define CAN_SHM_STALE_ANY_ID 0xFFFFFFFFu        // 全IDのイベントを購読
+#define CAN_SHM_STALE_DEFAULT_TICK_MS 1         // 既定tick間隔
+#define CAN_SHM_STALE_DEFAULT_MULTIPLIER 3      // 途絶判定時間 = 周期 x 倍率
+
+// イベント種別
+typedef enum {
+    CAN_SHM_STALE_EVENT_TIMEOUT = 1,    // 途絶検出
+    CAN_SHM_STALE_EVENT_RECOVERED = 2   // 受信再開
+} CANStaleEventKind;
+
+// 途絶・復帰イベントのコールバック関数型
+typedef void (*CANStaleCallback)(const CANStaleEvent* event, void* user_data);
+
+/**
+ * 失効監視の初期化（登録済みIDは全て解除される）
+ * @param tick_ms tick間隔[ミリ秒] (0=既定値)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_stale_configure(uint32_t tick_ms);
+
+/**
+ * 監視対象IDの登録（登録済みの場合は周期を更新）
+ * 未設定の場合は既定のtick間隔で初期化する
+ * @param can_id CAN ID (29bit有効値)
+ * @param cycle_ms 期待送信周期[ミリ秒]
+ * @param timeout_ms 途絶判定時間[ミリ秒] (0=周期 x CAN_SHM_STALE_DEFAULT_MULTIPLIER)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_stale_register(uint32_t can_id, uint32_t cycle_ms, uint32_t timeout_ms);
+
+/**
+ * 監視対象IDの登録解除
+ * @param can_id CAN ID (29bit有効値)
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if not registered
+ */
+CANShmResult can_shm_stale_unregister(uint32_t can_id);
+
+/**
+ * IDリストファイルから監視対象を一括登録
+ * can_id_sample.txt と同じ形式で、"0x100:10" のように周期[ミリ秒]を付記できる
+ * @param path ファイルパス
+ * @param default_cycle_ms 周期の付記がないIDの周期[ミリ秒]
+ * @param multiplier 途絶判定時間の周期に対する倍率 (0=既定値)
+ * @param loaded_out 登録したID数の格納先 (NULL可)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_stale_load_file(const char* path, uint32_t default_cycle_ms,
+                                     uint32_t multiplier, uint32_t* loaded_out);
+
+/**
+ * タイマーホイールを指定時刻まで進める
+ * @param now_ns 現在時刻（CLOCK_MONOTONIC基準[ns]）
+ * @return 発行したイベント数
+ */
+uint32_t can_shm_stale_tick(uint64_t now_ns);
+
+/**
+ * IDが途絶中か確認
+ * 途絶検出後に受信が再開していれば、次のtickを待たずに0を返す
+ * @param can_id CAN ID (29bit有効値)
+ * @param stale_out 1=途絶中, 0=受信中の格納先
+ * @return CAN_SHM_SUCCESS on success, CAN_SHM_ERROR_NOT_FOUND if not registered
+ */
+CANShmResult can_shm_stale_check(uint32_t can_id, int* stale_out);
+
+/**
+ * 途絶・復帰イベントの購読
+ * @param can_id CAN ID (CAN_SHM_STALE_ANY_ID=全ID)
+ * @param subscribe_count 受信イベント数 (0=無限回)
+ * @param timeout_ms タイムアウト時間[ミリ秒] (<0=タイムアウト無効)
+ * @param callback イベント受信時のコールバック関数
+ * @param user_data コールバック関数に渡すユーザーデータ
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_subscribe_stale(uint32_t can_id,
+                                     uint32_t subscribe_count,
+                                     int32_t timeout_ms,
+                                     CANStaleCallback callback,
+                                     void* user_data);
+
+/**
+ * 監視スレッドの起動（このプロセスでtick処理を行う）
+ * @param interval_ms 処理間隔[ミリ秒] (0=tick間隔)
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_stale_monitor_start(uint32_t interval_ms);
+
+/**
+ * 監視スレッドの停止
+ * @return CAN_SHM_SUCCESS on success, error code on failure
+ */
+CANShmResult can_shm_stale_monitor_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SHM_STALE_H
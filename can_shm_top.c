@@ -0,0 +1,223 @@
+/*
+ * 共有メモリのライブモニタ（can_shm_top）
+ * ======================================
+ *
+ * 共有メモリのCAN IDごとの診断カウンタを周期的に読み取り、更新レート・
+ * 最終更新からの経過時間・seqlockリトライ・購読者の起床回数を表示する。
+ * カウンタはSet/Get/Subscribeの処理中に更新済みのため、本ツールは
+ * 読み取りのみを行い、稼働中のプロセスに影響を与えない。
+ *
+ * - rate が高いID: ホットID
+ * - bus load（推定値）: フレーム長からの概算（ビットスタッフィングは含まない）
+ * - retry/s が高いID: 読み手と書き手の競合
+ * - wake/s が rate を大きく下回るID: 購読者の処理遅れ（更新の読み飛ばし）
+ */
+
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+// 表示行（前回サンプルとの差分）
+typedef struct {
+    uint32_t can_id;
+    uint16_t dlc;
+    double rate;            // 更新/s
+    double retry_rate;      // seqlockリトライ/s
+    double wake_rate;       // 購読者起床/s
+    double age_ms;          // 最終更新からの経過時間
+    uint32_t updates;
+} TopRow;
+
+typedef enum {
+    SORT_RATE = 0,
+    SORT_AGE,
+    SORT_RETRIES,
+    SORT_WAKEUPS,
+    SORT_ID
+} SortKey;
+
+static SortKey g_sort_key = SORT_RATE;
+
+static int compare_rows(const void* a, const void* b) {
+    const TopRow* ra = (const TopRow*)a;
+    const TopRow* rb = (const TopRow*)b;
+    double ka, kb;
+    switch (g_sort_key) {
+        case SORT_AGE:     ka = ra->age_ms;     kb = rb->age_ms;     break;
+        case SORT_RETRIES: ka = ra->retry_rate; kb = rb->retry_rate; break;
+        case SORT_WAKEUPS: ka = ra->wake_rate;  kb = rb->wake_rate;  break;
+        case SORT_ID:
+            return ra->can_id < rb->can_id ? -1 : ra->can_id > rb->can_id;
+        case SORT_RATE:
+        default:           ka = ra->rate;       kb = rb->rate;       break;
+    }
+    if (ka != kb) {
+        return ka > kb ? -1 : 1;  // 降順
+    }
+    return ra->can_id < rb->can_id ? -1 : ra->can_id > rb->can_id;
+}
+
+// 1フレームのビット数（推定、スタッフビットを除く）
+static double frame_bits(uint32_t can_id, uint16_t dlc) {
+    return (can_id > 0x7FF ? 67.0 : 47.0) + 8.0 * dlc;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [OPTIONS]\n", prog);
+    printf("\n");
+    printf("Options:\n");
+    printf("  -b <bus>    Bus number (default: 0)\n");
+    printf("  -i <ms>     Refresh interval (default: 1000)\n");
+    printf("  -n <rows>   Number of IDs to show (default: 20)\n");
+    printf("  -s <key>    Sort by rate|age|retries|wakeups|id (default: rate)\n");
+    printf("  -r <bps>    Bus bitrate for the load estimate (default: 500000)\n");
+    printf("  -c <n>      Exit after n refreshes (default: run until SIGINT)\n");
+    printf("  -B          Batch mode (no screen clear, for logging)\n");
+    printf("  -h          Show this help message\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t bus = 0;
+    uint32_t interval_ms = 1000;
+    uint32_t rows = 20;
+    uint32_t bitrate = 500000;
+    uint32_t iterations = 0;
+    int batch = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:i:n:s:r:c:Bh")) != -1) {
+        switch (opt) {
+            case 'b': bus = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': interval_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': rows = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': bitrate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': iterations = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'B': batch = 1; break;
+            case 's':
+                if (strcmp(optarg, "rate") == 0) g_sort_key = SORT_RATE;
+                else if (strcmp(optarg, "age") == 0) g_sort_key = SORT_AGE;
+                else if (strcmp(optarg, "retries") == 0) g_sort_key = SORT_RETRIES;
+                else if (strcmp(optarg, "wakeups") == 0) g_sort_key = SORT_WAKEUPS;
+                else if (strcmp(optarg, "id") == 0) g_sort_key = SORT_ID;
+                else {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (interval_ms == 0 || bitrate == 0 || bus >= CAN_SHM_MAX_BUSES) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to initialize shared memory\n");
+        return 1;
+    }
+
+    // バケット番号で前回サンプルを引くため、差分用の配列はバケット数分確保
+    static CANIdStats current[MAX_CAN_ENTRIES];
+    static CANIdStats previous[MAX_CAN_ENTRIES];
+    static uint8_t has_previous[MAX_CAN_ENTRIES];
+    static TopRow table[MAX_CAN_ENTRIES];
+    uint32_t count = 0;
+
+    if (can_shm_bus_get_id_stats(bus, current, MAX_CAN_ENTRIES, &count) != CAN_SHM_SUCCESS) {
+        fprintf(stderr, "Failed to read bus %u\n", bus);
+        can_shm_cleanup();
+        return 1;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        previous[current[i].bucket] = current[i];
+        has_previous[current[i].bucket] = 1;
+    }
+    uint64_t last_sample = can_shm_clock_now_ns();
+    struct timespec interval = {(time_t)(interval_ms / 1000), (long)(interval_ms % 1000) * 1000000L};
+
+    for (uint32_t iter = 0; !g_stop && (iterations == 0 || iter < iterations); iter++) {
+        nanosleep(&interval, NULL);
+        if (g_stop) {
+            break;
+        }
+
+        if (can_shm_bus_get_id_stats(bus, current, MAX_CAN_ENTRIES, &count) != CAN_SHM_SUCCESS) {
+            fprintf(stderr, "Failed to read bus %u\n", bus);
+            break;
+        }
+        uint64_t now = can_shm_clock_now_ns();
+        double dt = (now - last_sample) / 1e9;
+        last_sample = now;
+
+        double total_rate = 0.0;
+        double total_bits = 0.0;
+        for (uint32_t i = 0; i < count; i++) {
+            const CANIdStats* cur = &current[i];
+            const CANIdStats* prev = &previous[cur->bucket];
+            int same = has_previous[cur->bucket] && prev->can_id == cur->can_id;
+
+            TopRow* row = &table[i];
+            row->can_id = cur->can_id;
+            row->dlc = cur->dlc;
+            row->updates = cur->updates;
+            row->rate = same ? (uint32_t)(cur->updates - prev->updates) / dt : 0.0;
+            row->retry_rate = same ? (uint32_t)(cur->read_retries - prev->read_retries) / dt : 0.0;
+            row->wake_rate = same ? (uint32_t)(cur->wakeups - prev->wakeups) / dt : 0.0;
+            row->age_ms = cur->timestamp <= now ? (now - cur->timestamp) / 1e6 : 0.0;
+
+            total_rate += row->rate;
+            total_bits += row->rate * frame_bits(cur->can_id, cur->dlc);
+
+            previous[cur->bucket] = *cur;
+            has_previous[cur->bucket] = 1;
+        }
+        qsort(table, count, sizeof(TopRow), compare_rows);
+
+        uint64_t total_sets = 0, global_sequence = 0;
+        can_shm_bus_get_stats(bus, &total_sets, &global_sequence);
+
+        if (!batch) {
+            printf("\033[H\033[2J");
+        }
+        printf("can_shm_top - bus %u, %u IDs, %.0f frames/s, est. bus load %.1f%% @ %u bps, sets=%llu\n",
+               bus, count, total_rate, total_bits * 100.0 / bitrate, bitrate,
+               (unsigned long long)total_sets);
+        printf("%-10s %4s %10s %10s %12s %10s %10s\n",
+               "CAN ID", "DLC", "rate/s", "age ms", "updates", "retry/s", "wake/s");
+        for (uint32_t i = 0; i < count && i < rows; i++) {
+            const TopRow* row = &table[i];
+            printf("0x%08X %4u %10.1f %10.1f %12u %10.1f %10.1f\n",
+                   row->can_id, row->dlc, row->rate, row->age_ms, row->updates,
+                   row->retry_rate, row->wake_rate);
+        }
+        if (batch) {
+            printf("\n");
+        }
+        fflush(stdout);
+    }
+
+    can_shm_cleanup();
+    return 0;
+}
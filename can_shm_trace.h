@@ -0,0 +1,52 @@
+#ifndef CAN_SHM_TRACE_H
+#define CAN_SHM_TRACE_H
+
+/*
+ * 静的トレースポイント（USDT）
+ * ============================
+ *
+ * Set/Get/Subscribeのホットパスに置くトレースポイント。
+ * CAN_SHM_ENABLE_USDT 定義時（CMakeオプション CAN_SHM_ENABLE_USDT=ON かつ
+ * sys/sdt.h が存在する場合）は sys/sdt.h のプローブとしてNOP命令1個に展開され、
+ * トレース未接続時のコストはほぼ0。未定義時はコードを生成しない。
+ *
+ * プロバイダ名は can_shm。プローブ一覧（引数）:
+ *   set__begin     (can_id, dlc)          Set開始（検証後、バケットロック前）
+ *   set__end       (can_id, notified)     Set完了（バケットロック解放後）。set__begin 後の
+ *                                         エラー終了でも notified=0 で必ず対になる
+ *   seqlock__retry (can_id, retries)      seqlock読み取りがリトライした場合のみ
+ *   probe__count   (can_id, probes)       テーブル探索で参照したバケット数
+ *   wakeup         (can_id, change_seq)   購読者が更新を検出して起床
+ *   callback__begin(can_id, user_data)    購読コールバック呼び出し前
+ *   callback__end  (can_id, user_data)    購読コールバック復帰後
+ *
+ * 例（Setのレイテンシ分布）:
+ *   bpftrace -e 'usdt:./libcan_shm.so:can_shm:set__begin { @s[tid] = nsecs; }
+ *                usdt:./libcan_shm.so:can_shm:set__end /@s[tid]/ {
+ *                    @ns = hist(nsecs - @s[tid]); delete(@s[tid]); }'
+ */
+
+#ifdef CAN_SHM_ENABLE_USDT
+#include <sys/sdt.h>
+
+#define CAN_SHM_TRACE_SET_BEGIN(can_id, dlc)            DTRACE_PROBE2(can_shm, set__begin, can_id, dlc)
+#define CAN_SHM_TRACE_SET_END(can_id, notified)         DTRACE_PROBE2(can_shm, set__end, can_id, notified)
+#define CAN_SHM_TRACE_SEQLOCK_RETRY(can_id, retries)    DTRACE_PROBE2(can_shm, seqlock__retry, can_id, retries)
+#define CAN_SHM_TRACE_PROBE_COUNT(can_id, probes)       DTRACE_PROBE2(can_shm, probe__count, can_id, probes)
+#define CAN_SHM_TRACE_WAKEUP(can_id, change_seq)        DTRACE_PROBE2(can_shm, wakeup, can_id, change_seq)
+#define CAN_SHM_TRACE_CALLBACK_BEGIN(can_id, user_data) DTRACE_PROBE2(can_shm, callback__begin, can_id, user_data)
+#define CAN_SHM_TRACE_CALLBACK_END(can_id, user_data)   DTRACE_PROBE2(can_shm, callback__end, can_id, user_data)
+
+#else
+
+#define CAN_SHM_TRACE_SET_BEGIN(can_id, dlc)            ((void)0)
+#define CAN_SHM_TRACE_SET_END(can_id, notified)         ((void)0)
+#define CAN_SHM_TRACE_SEQLOCK_RETRY(can_id, retries)    ((void)0)
+#define CAN_SHM_TRACE_PROBE_COUNT(can_id, probes)       ((void)0)
+#define CAN_SHM_TRACE_WAKEUP(can_id, change_seq)        ((void)0)
+#define CAN_SHM_TRACE_CALLBACK_BEGIN(can_id, user_data) ((void)0)
+#define CAN_SHM_TRACE_CALLBACK_END(can_id, user_data)   ((void)0)
+
+#endif // CAN_SHM_ENABLE_USDT
+
+#endif // CAN_SHM_TRACE_H
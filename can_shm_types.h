@@ -25,13 +25,297 @@ typedef struct {
     pthread_mutex_t mutex;        // プロセス間共有ミューテックス
     CANData can_data;            // CANデータ本体
     uint8_t is_valid;            // データ有効フラグ
-    uint8_t padding[7];          // アライメント調整
+    uint8_t publish_mode;        // 通知モード（CANShmPublishMode、0=グローバル設定に従う）
+    uint8_t padding[2];          // アライメント調整
+    uint32_t change_sequence;    // データ部が変化した更新の回数（Subscribeの判定用、futex待機対象）
+    uint64_t ignore_mask;        // On-change比較で無視するbyte（bit i = data[i]）
+    uint32_t waiters;            // change_sequenceでfutex待機中の購読者数
+    uint32_t wake_at;            // 待機中購読者を起こすchange_sequenceの最小値
+    uint32_t queue_mask;         // このバケットをホームとするIDの購読キュー（bit i = queues[i]）
+    uint32_t read_retries;       // seqlock読み取りのリトライ回数（診断用、リトライ時のみ加算）
+    uint32_t wakeups;            // 購読者がこのバケットの更新で起床した回数（診断用）
+    uint32_t mode_can_id;        // publish_mode・ignore_mask を設定したCAN ID（他のIDは全体設定に従う）
 } __attribute__((aligned(8))) CANBucket;
 
 // 共有メモリ全体のレイアウト
 #define MAX_CAN_ENTRIES 4096     // ハッシュテーブルサイズ
 #define SHM_NAME "/can_data_shm"
+#define SHM_BUS_NAME_FORMAT "/can_data_shm.bus%u"  // バス1以降のセグメント名
+#define CAN_SHM_MAX_BUSES 8      // バス数上限（バス0は SHM_NAME）
 #define MAGIC_NUMBER 0xCADDA7A  // マジックナンバー
+#define CAN_SHM_LAYOUT_VERSION 18 // レイアウト変更時に更新（不一致なら再初期化）
+
+// 更新ジャーナル（レコーダ用の全更新リングバッファ）
+#define CAN_SHM_JOURNAL_SIZE 8192  // エントリ数（2の冪）
+#define CAN_SHM_JOURNAL_MASK (CAN_SHM_JOURNAL_SIZE - 1)
+
+typedef struct {
+    uint64_t seq;                // 2*pos+1: 書き込み中, 2*pos+2: 書き込み完了
+    CANData can_data;            // 更新後のCANデータのコピー
+    uint8_t padding[6];          // 8byte境界調整
+} __attribute__((aligned(8))) CANJournalEntry;
+
+typedef struct {
+    uint32_t active;             // 接続中レコーダ数（0なら書き込み側は何もしない）
+    uint8_t  padding0[60];       // headを別キャッシュラインに配置
+    uint64_t head;               // 次の書き込み位置（単調増加）
+    uint8_t  padding1[56];
+    CANJournalEntry entries[CAN_SHM_JOURNAL_SIZE];
+} __attribute__((aligned(64))) CANJournal;
+
+// 失効（stale）監視：周期送信IDの途絶検出用タイマーホイール
+#define CAN_SHM_STALE_MAX_IDS 1024        // 監視対象ID数上限（2の冪）
+#define CAN_SHM_STALE_WHEEL0_BITS 8       // レベル0: 256スロット x 1tick
+#define CAN_SHM_STALE_WHEEL1_BITS 6       // レベル1: 64スロット x 256tick
+#define CAN_SHM_STALE_WHEEL2_BITS 6       // レベル2: 64スロット x 16384tick
+#define CAN_SHM_STALE_WHEEL0_SIZE (1 << CAN_SHM_STALE_WHEEL0_BITS)
+#define CAN_SHM_STALE_WHEEL1_SIZE (1 << CAN_SHM_STALE_WHEEL1_BITS)
+#define CAN_SHM_STALE_WHEEL2_SIZE (1 << CAN_SHM_STALE_WHEEL2_BITS)
+#define CAN_SHM_STALE_EVENT_SIZE 256      // 失効・復帰イベントリング（2の冪）
+
+typedef struct {
+    uint32_t can_id;             // 監視対象CAN ID
+    uint8_t  state;              // 0=空き, 1=登録済み, 2=削除済み（オープンアドレス用）
+    uint8_t  stale;              // 1=途絶中
+    uint8_t  padding[2];
+    uint32_t cycle_ms;           // 期待送信周期
+    uint32_t timeout_ms;         // 途絶判定時間
+    int32_t  next;               // タイマースロット内の双方向リスト
+    int32_t  prev;
+    int32_t  slot;               // 所属スロット（-1=未登録）
+    uint32_t padding2;
+    uint64_t expires_tick;       // 満了tick
+    uint64_t armed_at;           // 登録時刻（未受信IDの基準時刻）
+    uint64_t last_timestamp;     // 最後に確認した受信時刻
+    uint64_t stale_count;        // 途絶検出回数
+} CANStaleEntry;
+
+typedef struct {
+    uint64_t seq;                // イベント番号（1始まり）
+    uint32_t can_id;
+    uint32_t kind;               // CANStaleEventKind
+    uint64_t last_timestamp;     // 最後の受信時刻（0=未受信）
+    uint64_t detected_at;        // 検出時刻
+} CANStaleEvent;
+
+typedef struct {
+    pthread_mutex_t mutex;             // 監視テーブル・ホイール保護（tick処理と登録のみ）
+    pthread_cond_t  event_condition;   // 失効・復帰イベント通知
+    uint64_t tick_ns;                  // tick間隔
+    uint64_t base_ns;                  // tick 0の時刻
+    uint64_t current_tick;             // 処理済みtick
+    uint32_t entry_count;              // 登録済みID数
+    uint32_t stale_now;                // 現在途絶中のID数
+    uint64_t event_head;               // 発行済みイベント数
+    int32_t  wheel0[CAN_SHM_STALE_WHEEL0_SIZE];
+    int32_t  wheel1[CAN_SHM_STALE_WHEEL1_SIZE];
+    int32_t  wheel2[CAN_SHM_STALE_WHEEL2_SIZE];
+    CANStaleEvent events[CAN_SHM_STALE_EVENT_SIZE];
+    CANStaleEntry entries[CAN_SHM_STALE_MAX_IDS];
+} __attribute__((aligned(64))) CANStaleMonitor;
+
+// 更新グループ（リアクタの走査範囲を絞るためのバケット群単位の変更カウンタ）
+#define CAN_SHM_DIRTY_GROUP_SHIFT 4       // 1グループ = 16バケット
+#define CAN_SHM_DIRTY_GROUPS (MAX_CAN_ENTRIES >> CAN_SHM_DIRTY_GROUP_SHIFT)
+
+// 存在フィルタ（未登録IDのGetを1キャッシュラインの参照で判定）
+#define CAN_SHM_PRESENCE_STD_MAX 0x7FF              // 直接ビットマップで管理するID上限（11bit）
+#define CAN_SHM_PRESENCE_STD_WORDS ((CAN_SHM_PRESENCE_STD_MAX + 1) / 64)
+#define CAN_SHM_PRESENCE_BLOOM_BITS 8               // 29bit ID用Bloomフィルタのブロック数（2^8）
+#define CAN_SHM_PRESENCE_BLOOM_BLOCKS (1 << CAN_SHM_PRESENCE_BLOOM_BITS)
+#define CAN_SHM_PRESENCE_BLOOM_HASHES 4             // ブロック内で立てるビット数
+
+typedef struct {
+    uint64_t words[8];           // 512bit（1キャッシュライン）
+} __attribute__((aligned(64))) CANPresenceBlock;
+
+typedef struct {
+    uint64_t std_bitmap[CAN_SHM_PRESENCE_STD_WORDS];     // bit i = ID i が登録済み
+    CANPresenceBlock bloom[CAN_SHM_PRESENCE_BLOOM_BLOCKS];  // 0x800以上のID（登録のみ、削除なし）
+} __attribute__((aligned(64))) CANPresenceFilter;
+
+// 拡張領域（リニアプロービングの探査範囲が埋まったIDの格納先、オンラインで倍々に拡張）
+#define CAN_SHM_MAX_PROBE 64                        // メインテーブルでの探査上限
+#define SHM_EXT_NAME_FORMAT "/can_data_shm.ext%u.%llx" // 拡張領域のセグメント名（世代は1から、所有者の識別子）
+#define CAN_SHM_EXT_BASE_BITS 10                    // 第1世代のバケット数（2^10、以後世代ごとに倍）
+#define CAN_SHM_EXT_MAX_LEVELS 12                   // 世代数上限
+#define CAN_SHM_EXT_MIGRATE_STEP 8                  // Set1回あたりに移行する旧世代のバケット数
+#define CAN_SHM_EXT_MAGIC 0xCADE7001
+
+// 拡張領域のバケット状態
+typedef enum {
+    CAN_SHM_EXT_EMPTY = 0,
+    CAN_SHM_EXT_USED = 1,
+    CAN_SHM_EXT_DELETED = 2,     // 削除済み（探査は継続）
+    CAN_SHM_EXT_MOVED = 3        // 新しい世代へ移行済み（読み取り側は新しい世代を引き直す）
+} CANExtBucketState;
+
+typedef struct {
+    CANData can_data;            // can_data.sequence がseqlock（奇数=書き込み中、書き手同士の排他も兼ねる）
+    uint8_t state;               // CANExtBucketState
+    uint8_t padding[13];
+} __attribute__((aligned(8))) CANExtBucket;
+
+typedef struct {
+    uint32_t magic_number;
+    uint32_t level;              // 世代
+    uint32_t bits;               // バケット数 = 2^bits
+    uint32_t occupied;           // 使用済みバケット数（削除済みを含む、拡張判定用）
+    uint64_t instance_id;        // 作成したメインセグメントの CANExtControl.instance_id
+    uint8_t  padding[40];
+    CANExtBucket buckets[];
+} CANExtLayout;
+
+// メインセグメント内の拡張領域の管理情報
+typedef struct {
+    pthread_mutex_t resize_mutex;  // 世代の作成・切り替え（通常のSet/Getでは取らない）
+    uint32_t epoch;              // 切り替えごとに更新（読み取り側は前後で比較して再試行）
+    uint32_t current;            // 現在の世代（0=未作成）
+    uint32_t previous;           // 移行中の旧世代（0=移行なし）
+    uint32_t migrated;           // 移行を終えた旧世代のバケット数
+    uint32_t entries;            // 拡張領域に格納中のID数
+    uint64_t migrate_cursor;     // 上位32bit=移行中の旧世代、下位32bit=次に移行するバケット
+    uint64_t instance_id;        // メインセグメントの作成ごとに変わる識別子（拡張領域のセグメントと照合）
+} CANExtControl;
+
+// 完全ハッシュのIDセット（共有メモリ内、2面を切り替えて公開）
+#define CAN_SHM_PHASH_MAX_IDS 1024                  // IDセットの最大ID数
+#define CAN_SHM_PHASH_MAX_SLOTS 2048                // スロット数上限（ID数の1.25倍以上の2の累乗）
+#define CAN_SHM_PHASH_MAX_GROUPS 256                // 変位グループ数上限（ID数/4以上の2の累乗）
+#define CAN_SHM_PHASH_NO_ID 0xFFFFFFFFu             // 未使用スロット（有効なCAN IDと重ならない）
+
+// 完全ハッシュのスロット（seqlockのシーケンスを4byte境界に置くため96byte）
+typedef struct {
+    CANData  can_data;                             // can_data.sequence がseqlock（書き手同士の排他も兼ねる）
+    uint8_t  valid;                                // 値の格納済みフラグ（seqlock内で更新）
+    uint8_t  padding[13];
+} __attribute__((aligned(8))) CANPerfectHashSlot;
+
+// 完全ハッシュの1面（記述子とテーブル）
+typedef struct {
+    uint32_t version;                              // 公開時の版数
+    uint32_t num_ids;                              // IDセットのID数（0=未構築）
+    uint32_t slot_mask;                            // スロット数-1
+    uint32_t group_mask;                           // グループ数-1
+    uint16_t seeds[CAN_SHM_PHASH_MAX_GROUPS];      // グループごとの変位（スロット位置のハッシュの種）
+    uint32_t keys[CAN_SHM_PHASH_MAX_SLOTS];        // スロットのID（照合用）
+    CANPerfectHashSlot slots[CAN_SHM_PHASH_MAX_SLOTS];
+} __attribute__((aligned(64))) CANPerfectHashTable;
+
+typedef struct {
+    pthread_mutex_t publish_mutex;                 // 構築・公開の排他（Set/Getでは取らない）
+    uint32_t epoch;                                // 公開ごとに増加、下位1bitが参照中の面（0=未公開）
+    uint32_t version;                              // 最後に公開した版数
+    CANPerfectHashTable tables[2];
+} CANPerfectHashShared;
+
+// 購読キュー（購読ごとのSPSCリングバッファ）
+#define CAN_SHM_MAX_QUEUES 32             // 購読キュー数上限（queue_maskのビット数）
+#define CAN_SHM_QUEUE_SIZE 256            // キューあたりのエントリ数（2の冪）
+#define CAN_SHM_QUEUE_MASK (CAN_SHM_QUEUE_SIZE - 1)
+
+typedef struct {
+    // 管理情報（購読・解除時のみ更新）
+    uint32_t in_use;             // 1=使用中
+    uint32_t can_id;             // 購読対象CAN ID
+    uint32_t owner_pid;          // 購読プロセス
+    uint32_t padding0;
+    // 書き込み側（同一IDのSetはバケットロックで直列化されるため単一生産者）
+    uint32_t head;               // 次の書き込み位置
+    uint32_t padding1;
+    uint64_t overruns;           // キュー満杯で格納できなかったフレーム数
+    uint8_t  padding2[32];
+    // 読み出し側
+    uint32_t tail;               // 次の読み出し位置
+    uint32_t waiting;            // 1=読み出し側がheadでfutex待機中
+    uint8_t  padding3[56];
+    CANData entries[CAN_SHM_QUEUE_SIZE];
+} __attribute__((aligned(64))) CANSubscriberQueue;
+
+// レイテンシヒストグラム（対数線形：2のべき乗ごとに8分割、相対誤差12.5%以下）
+#define CAN_SHM_HIST_SUB_BITS 3
+#define CAN_SHM_HIST_SUB_COUNT (1 << CAN_SHM_HIST_SUB_BITS)
+#define CAN_SHM_HIST_BUCKETS ((64 - CAN_SHM_HIST_SUB_BITS + 1) * CAN_SHM_HIST_SUB_COUNT)
+#define CAN_SHM_HIST_MAX_SUBSCRIBERS 32    // 購読者別ヒストグラム数上限
+
+// ヒストグラムの種類（hist_enabled のビット位置）
+typedef enum {
+    CAN_SHM_HIST_SET_DURATION = 0,   // can_shm_set の所要時間[ns]
+    CAN_SHM_HIST_READ_RETRIES = 1,   // seqlock読み取り1回あたりのリトライ回数
+    CAN_SHM_HIST_DELIVERY = 2,       // Setから購読コールバック直前までの遅延[ns]（全購読者）
+    CAN_SHM_HIST_KINDS = 3
+} CANShmHistKind;
+
+typedef struct {
+    uint64_t count;              // 記録数
+    uint64_t sum;                // 記録値の合計
+    uint64_t max;                // 最大値
+    uint64_t buckets[CAN_SHM_HIST_BUCKETS];
+} __attribute__((aligned(64))) CANLatencyHistogram;
+
+// 購読者別の配信遅延ヒストグラム
+typedef struct {
+    uint32_t in_use;
+    uint32_t can_id;             // 購読対象CAN ID
+    uint32_t owner_pid;
+    uint32_t padding;
+    CANLatencyHistogram hist;
+} __attribute__((aligned(64))) CANSubscriberHistogram;
+
+// サイズクラス別スロットの省メモリテーブル（別セグメント、can_shm_compact.h）
+#define SHM_COMPACT_NAME "/can_data_shm.compact"
+#define CAN_SHM_COMPACT_LAYOUT_VERSION 1
+#define CAN_SHM_COMPACT_INDEX_SIZE 4096    // ID索引のエントリ数（2の冪）
+#define CAN_SHM_COMPACT_CLASSES 4          // データ部 8/16/32/64 byte
+#define CAN_SHM_COMPACT_HEADER_SIZE 24     // スロットヘッダ（CANCompactSlotHeader）
+#define CAN_SHM_COMPACT_SLOTS_8  4096      // クラス別スロット数（8の倍数）
+#define CAN_SHM_COMPACT_SLOTS_16 512
+#define CAN_SHM_COMPACT_SLOTS_32 512
+#define CAN_SHM_COMPACT_SLOTS_64 1024
+#define CAN_SHM_COMPACT_STRIDE(payload) ((CAN_SHM_COMPACT_HEADER_SIZE + (payload) + 7) & ~7)
+#define CAN_SHM_COMPACT_POOL_BYTES \
+    (CAN_SHM_COMPACT_SLOTS_8 * CAN_SHM_COMPACT_STRIDE(8) + \
+     CAN_SHM_COMPACT_SLOTS_16 * CAN_SHM_COMPACT_STRIDE(16) + \
+     CAN_SHM_COMPACT_SLOTS_32 * CAN_SHM_COMPACT_STRIDE(32) + \
+     CAN_SHM_COMPACT_SLOTS_64 * CAN_SHM_COMPACT_STRIDE(64))
+#define CAN_SHM_COMPACT_MOVED 0x80         // size_class: 上位クラスへ移動済み（索引を引き直す）
+
+// スロットヘッダ（直後にデータ部が続く。8byteクラスは32byteで1キャッシュラインに収まる）
+typedef struct {
+    uint32_t sequence;           // seqlock（奇数=書き込み中、書き手同士の排他も兼ねる）
+    uint32_t can_id;
+    uint64_t timestamp;
+    uint16_t dlc;
+    uint8_t  size_class;         // 0~3（CAN_SHM_COMPACT_MOVED 付きなら移動済み）
+    uint8_t  padding[5];
+} CANCompactSlotHeader;
+
+// ID索引のエントリ（slot_ref = 0 は未使用、(class << 24) | (スロット番号 + 1)）
+typedef struct {
+    uint32_t can_id;
+    uint32_t slot_ref;
+} CANCompactIndexEntry;
+
+typedef struct {
+    uint32_t magic_number;
+    uint32_t version;
+    pthread_mutex_t alloc_mutex;       // 索引への登録・スロット割り当て用（Set/Getでは使用しない）
+    uint32_t entries;                  // 登録済みID数
+    uint32_t pool_used[CAN_SHM_COMPACT_CLASSES];
+    uint32_t moves;                    // 上位クラスへの移動回数
+    uint8_t  padding[32];
+    CANCompactIndexEntry index[CAN_SHM_COMPACT_INDEX_SIZE];
+    uint8_t  pools[CAN_SHM_COMPACT_POOL_BYTES] __attribute__((aligned(64)));
+} __attribute__((aligned(64))) CANCompactLayout;
+
+// 時刻源の設定とTSC校正値（バス0のセグメント作成時に校正、以後不変）
+typedef struct {
+    uint32_t source;             // CANShmClockSource（全プロセス共通）
+    uint32_t tsc_calibrated;     // 不変TSCが利用可能で校正済みなら1
+    uint64_t tsc_base;           // 校正時のTSC値
+    uint64_t ns_base;            // tsc_base 時点の CLOCK_MONOTONIC[ns]
+    uint64_t tsc_mult;           // ns = ns_base + ((tsc - tsc_base) * tsc_mult) >> 32
+} CANClockCalibration;
 
 typedef struct {
     // 管理情報
@@ -47,11 +331,50 @@ typedef struct {
     uint64_t total_sets;         // Set操作回数
     uint64_t total_gets;         // Get操作回数
     uint64_t total_subscribes;   // Subscribe操作回数
+    uint64_t total_suppressed;   // On-changeモードで通知を省略したSet回数
+    
+    // 通知モード（CANShmPublishMode、バケット個別設定がない場合に適用）
+    uint32_t publish_mode;
+    uint32_t bus;                // バス番号（セグメント作成時に設定）
+    uint32_t hist_enabled;       // 記録するヒストグラム（bit i = CANShmHistKind i）
+    uint32_t table_generation;   // バケット配置が変わる操作（削除・セグメント再作成）で更新
+    
+    // タイムスタンプの時刻源
+    CANClockCalibration clock;
+    
+    // セグメントを作成・復旧したブート（ファイル配置時に再起動をまたいだかの判定用）
+    char boot_id[40];            // /proc/sys/kernel/random/boot_id
+    int64_t realtime_offset_ns;  // そのブートでの CLOCK_REALTIME - CLOCK_MONOTONIC
     
     uint8_t padding[64];         // キャッシュライン境界調整
     
+    // グループ内のいずれかのバケットでデータ部が変化した回数（bucket_index >> CAN_SHM_DIRTY_GROUP_SHIFT）
+    uint32_t dirty_groups[CAN_SHM_DIRTY_GROUPS];
+    
+    // 登録済みIDの存在フィルタ（偽陽性のみ、偽陰性なし）
+    CANPresenceFilter presence;
+    
+    // リニアプロービングの拡張領域
+    CANExtControl ext;
+    
+    // 完全ハッシュのIDセット
+    CANPerfectHashShared phash;
+    
     // ハッシュテーブル
     CANBucket buckets[MAX_CAN_ENTRIES];
+    
+    // 更新ジャーナル（レコーダ接続時のみ書き込み）
+    CANJournal journal;
+    
+    // 失効監視（監視プロセスのtick処理のみが更新）
+    CANStaleMonitor stale_monitor;
+    
+    // 購読キュー
+    CANSubscriberQueue queues[CAN_SHM_MAX_QUEUES];
+    
+    // レイテンシヒストグラム
+    CANLatencyHistogram histograms[CAN_SHM_HIST_KINDS];
+    CANSubscriberHistogram subscriber_histograms[CAN_SHM_HIST_MAX_SUBSCRIBERS];
 } __attribute__((aligned(64))) SharedMemoryLayout;
 
 // エラーコード
@@ -62,12 +385,72 @@ typedef enum {
     CAN_SHM_ERROR_TIMEOUT = -3,
     CAN_SHM_ERROR_INVALID_PARAM = -4,
     CAN_SHM_ERROR_INIT_FAILED = -5,
-    CAN_SHM_ERROR_MUTEX_FAILED = -6
+    CAN_SHM_ERROR_MUTEX_FAILED = -6,
+    CAN_SHM_ERROR_STALE = -7           // ハンドルの解決後にテーブルが再編成された（再解決が必要）
 } CANShmResult;
 
+// Set時の更新通知モード
+typedef enum {
+    CAN_SHM_PUBLISH_DEFAULT = 0,    // グローバル設定に従う（バケット個別設定用）
+    CAN_SHM_PUBLISH_ALWAYS = 1,     // 毎回通知（従来動作）
+    CAN_SHM_PUBLISH_ON_CHANGE = 2   // データ部・DLCが変化した場合のみ通知
+} CANShmPublishMode;
+
 // Subscribe用のコールバック関数型
 typedef void (*CANDataCallback)(uint32_t can_id, const CANData* data, void* user_data);
 
+// CAN IDごとの診断カウンタ（can_shm_bus_get_id_stats用）
+typedef struct {
+    uint32_t can_id;
+    uint32_t bucket;             // 格納バケット番号
+    uint32_t updates;            // Set回数（seqlockシーケンス/2）
+    uint32_t change_sequence;    // データ部が変化した更新の回数
+    uint32_t read_retries;       // seqlock読み取りのリトライ回数
+    uint32_t wakeups;            // 購読者の起床回数
+    uint64_t timestamp;          // 最終更新タイムスタンプ（nanoseconds）
+    uint16_t dlc;
+    uint8_t  padding[6];
+} CANIdStats;
+
+// Subscribe配信モード（can_shm_subscribe_ex用）
+typedef enum {
+    CAN_SHM_SUBSCRIBE_EVERY = 0,         // 全ての更新を配信
+    CAN_SHM_SUBSCRIBE_MIN_INTERVAL = 1,  // 前回配信から interval_ms 以上空けて最新値を配信
+    CAN_SHM_SUBSCRIBE_EVERY_NTH = 2,     // every_n 回の更新ごとに最新値を配信
+    CAN_SHM_SUBSCRIBE_SAMPLE = 3         // interval_ms 周期で最新値を配信（更新があった周期のみ）
+} CANSubscribeMode;
+
+// Subscribeオプション
+typedef struct {
+    CANSubscribeMode mode;
+    uint32_t interval_ms;   // MIN_INTERVAL / SAMPLE の間隔
+    uint32_t every_n;       // EVERY_NTH の間引き数
+} CANSubscribeOptions;
+
+// ファイル配置セグメントの書き戻しポリシー（can_shm_init_ex用）
+typedef enum {
+    CAN_SHM_SYNC_NONE = 0,          // カーネルの書き戻しに任せる
+    CAN_SHM_SYNC_ON_CLEANUP = 1,    // can_shm_cleanup でmsync
+    CAN_SHM_SYNC_PERIODIC = 2       // sync_interval_ms ごと、およびcan_shm_cleanup でmsync
+} CANShmSyncPolicy;
+
+// 初期化オプション（can_shm_init_ex用）
+typedef struct {
+    const char* snapshot_path;       // ウォームリスタート用スナップショット（NULL=使用しない）
+    uint32_t snapshot_interval_ms;   // スナップショットの定期保存間隔（0=定期保存しない）
+    const char* backing_path;        // セグメントを置くファイル（NULL=環境変数 CAN_SHM_BACKING_PATH、未設定なら /dev/shm の SHM_NAME）
+    uint32_t sync_policy;            // CANShmSyncPolicy（/dev/shm 上では実質的に効果なし）
+    uint32_t sync_interval_ms;       // CAN_SHM_SYNC_PERIODIC の間隔
+} CANShmInitOptions;
+
+// 解決済みスロットのハンドル（can_shm_resolve で取得し、内容は変更しない）
+typedef struct {
+    uint32_t can_id;
+    uint32_t index;              // バケット番号
+    uint32_t generation;         // 解決時の table_generation
+    uint32_t bus;
+} CANShmHandle;
+
 // ハッシュ関数（CAN IDからバケットインデックスを計算）
 static inline uint32_t can_id_hash(uint32_t can_id) {
     // CAN IDの29bit制約チェック
@@ -81,6 +464,18 @@ static inline int is_valid_can_id(uint32_t can_id) {
     return can_id <= CAN_ID_MAX;
 }
 
+// Setするバケットでの通知モードと無視マスク
+// 個別設定はバケットに1つで、設定したIDにのみ適用する（ホーム位置を共有する別IDは全体設定・無視マスクなし）
+static inline uint32_t can_bucket_publish_mode(const SharedMemoryLayout* shm, const CANBucket* bucket,
+                                               uint32_t can_id, uint64_t* ignore_mask_out) {
+    if (bucket->mode_can_id != can_id) {
+        *ignore_mask_out = 0;
+        return shm->publish_mode;
+    }
+    *ignore_mask_out = bucket->ignore_mask;
+    return bucket->publish_mode != CAN_SHM_PUBLISH_DEFAULT ? bucket->publish_mode : shm->publish_mode;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,162 @@
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define NUM_IDS 100
+
+static char g_path[256];
+static char g_bus1_path[300];
+static char g_other_path[256];
+
+/**
+ * ファイル配置セグメントの作成と再オープン
+ */
+void test_file_backed_segment(void) {
+    CANShmInitOptions options = {.backing_path = g_path, .sync_policy = CAN_SHM_SYNC_ON_CLEANUP};
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_SUCCESS, "Init with backing file");
+
+    uint8_t data[8];
+    for (uint32_t i = 0; i < NUM_IDS; i++) {
+        memset(data, (int)i, sizeof(data));
+        can_shm_set(0x18000000 + i, 8, data);
+    }
+    data[0] = 0x5A;
+    TEST_ASSERT(can_shm_bus_set(1, 0x123, 8, data) == CAN_SHM_SUCCESS, "Bus 1 set");
+
+    struct stat st;
+    TEST_ASSERT(stat(g_path, &st) == 0 && st.st_size >= (off_t)sizeof(SharedMemoryLayout),
+                "Segment file sized for layout");
+    TEST_ASSERT(access(g_bus1_path, F_OK) == 0, "Bus segment placed next to backing file");
+    can_shm_cleanup();
+
+    // 別の配置のテーブルは使われていない（/dev/shm の本番セグメントには触れない）
+    CANData out;
+    CANShmInitOptions other = {.backing_path = g_other_path};
+    can_shm_init_ex(&other);
+    TEST_ASSERT(can_shm_get(0x18000001, &out) == CAN_SHM_ERROR_NOT_FOUND, "Other table untouched");
+    can_shm_cleanup();
+
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_SUCCESS, "Reopen backing file");
+    int kept = 1;
+    for (uint32_t i = 0; i < NUM_IDS; i++) {
+        if (can_shm_get(0x18000000 + i, &out) != CAN_SHM_SUCCESS || out.data[7] != (uint8_t)i) {
+            kept = 0;
+            break;
+        }
+    }
+    TEST_ASSERT(kept, "Values kept in backing file");
+    TEST_ASSERT(can_shm_bus_get(1, 0x123, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x5A,
+                "Bus segment kept in backing file");
+    can_shm_cleanup();
+}
+
+/**
+ * 再起動をまたいだセグメントの復旧
+ */
+void test_reboot_recovery(void) {
+    CANShmInitOptions options = {.backing_path = g_path, .sync_policy = CAN_SHM_SYNC_ON_CLEANUP};
+    can_shm_init_ex(&options);
+
+    CANData before;
+    can_shm_get(0x18000002, &before);
+    uint64_t age_before = can_shm_clock_now_ns() - before.timestamp;
+
+    // 前回ブートで書き込み中・ロック保持中に停止した状態を再現
+    g_shm_ptr->boot_id[0] ^= 0x01;
+    g_shm_ptr->realtime_offset_ns -= 5000000000LL;  // 停止期間5秒相当
+    g_shm_ptr->buckets[can_id_hash(0x18000003)].can_data.sequence |= 1;
+    pthread_mutex_lock(&g_shm_ptr->global_mutex);
+    can_shm_cleanup();
+
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_SUCCESS, "Reopen after reboot");
+
+    CANData out;
+    TEST_ASSERT(can_shm_get(0x18000002, &out) == CAN_SHM_SUCCESS && out.data[0] == 2, "Value kept after reboot");
+    uint64_t age = can_shm_clock_now_ns() - out.timestamp;
+    TEST_ASSERT(age >= age_before + 5000000000ULL && age < age_before + 6000000000ULL,
+                "Timestamps rebased to current boot");
+    TEST_ASSERT(can_shm_get(0x18000003, &out) == CAN_SHM_SUCCESS && out.data[0] == 3,
+                "Interrupted write does not block readers");
+
+    uint8_t data[8] = {0xAB};
+    TEST_ASSERT(can_shm_set(0x18000004, 8, data) == CAN_SHM_SUCCESS &&
+                can_shm_get(0x18000004, &out) == CAN_SHM_SUCCESS && out.data[0] == 0xAB,
+                "Locks usable after reboot");
+    can_shm_cleanup();
+}
+
+/**
+ * 書き戻しポリシー
+ */
+void test_sync_policy(void) {
+    CANShmInitOptions options = {.backing_path = g_path, .sync_policy = CAN_SHM_SYNC_PERIODIC};
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_ERROR_INVALID_PARAM, "Periodic sync without interval rejected");
+    options.sync_policy = 7;
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_ERROR_INVALID_PARAM, "Unknown sync policy rejected");
+    options.backing_path = "";
+    options.sync_policy = CAN_SHM_SYNC_NONE;
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_ERROR_INVALID_PARAM, "Empty backing path rejected");
+    options.backing_path = "/nonexistent/can_shm.seg";
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_ERROR_INIT_FAILED, "Unwritable backing path reported");
+    TEST_ASSERT(can_shm_sync() == CAN_SHM_ERROR_INIT_FAILED, "Sync before init rejected");
+
+    options.backing_path = g_path;
+    options.sync_policy = CAN_SHM_SYNC_PERIODIC;
+    options.sync_interval_ms = 10;
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_SUCCESS, "Init with periodic sync");
+    uint8_t data[8] = {0x77};
+    can_shm_set(0x18000005, 8, data);
+    usleep(50000);
+    TEST_ASSERT(can_shm_sync() == CAN_SHM_SUCCESS, "Explicit sync");
+    TEST_ASSERT(can_shm_cleanup() == CAN_SHM_SUCCESS, "Cleanup stops periodic sync");
+}
+
+int main(void) {
+    printf("Starting Backing File Tests...\n\n");
+
+    snprintf(g_path, sizeof(g_path), "/tmp/can_shm_test_backing.%d", (int)getpid());
+    snprintf(g_bus1_path, sizeof(g_bus1_path), "%s.bus1", g_path);
+    snprintf(g_other_path, sizeof(g_other_path), "/tmp/can_shm_test_backing_other.%d", (int)getpid());
+
+    test_file_backed_segment();
+    test_reboot_recovery();
+    test_sync_policy();
+
+    unlink(g_path);
+    unlink(g_bus1_path);
+    unlink(g_other_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
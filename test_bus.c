@@ -0,0 +1,187 @@
+#include "can_shm_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+/**
+ * 同一CAN IDのバス別格納
+ */
+void test_bus_isolation(void) {
+    uint8_t data0[8] = {0x00, 0x11};
+    uint8_t data1[8] = {0x01, 0x22};
+    uint8_t data2[8] = {0x02, 0x33};
+
+    TEST_ASSERT(can_shm_bus_set(0, 0x100, 8, data0) == CAN_SHM_SUCCESS, "Set on bus 0");
+    TEST_ASSERT(can_shm_bus_set(1, 0x100, 8, data1) == CAN_SHM_SUCCESS, "Set same ID on bus 1");
+    TEST_ASSERT(can_shm_bus_set(2, 0x100, 8, data2) == CAN_SHM_SUCCESS, "Set same ID on bus 2");
+
+    CANData out;
+    TEST_ASSERT(can_shm_bus_get(1, 0x100, &out) == CAN_SHM_SUCCESS && out.data[1] == 0x22,
+                "Bus 1 keeps its own value");
+    TEST_ASSERT(can_shm_bus_get(2, 0x100, &out) == CAN_SHM_SUCCESS && out.data[1] == 0x33,
+                "Bus 2 keeps its own value");
+    TEST_ASSERT(can_shm_get(0x100, &out) == CAN_SHM_SUCCESS && out.data[1] == 0x11,
+                "Bus 0 is the default segment");
+    TEST_ASSERT(can_shm_bus_get(3, 0x100, &out) == CAN_SHM_ERROR_NOT_FOUND,
+                "ID not present on untouched bus");
+    TEST_ASSERT(can_shm_bus_get(CAN_SHM_MAX_BUSES, 0x100, &out) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Out-of-range bus rejected");
+    TEST_ASSERT(g_shm_ptr->bus == 0, "Default segment tagged as bus 0");
+}
+
+/**
+ * バス別の独立したシーケンス
+ */
+void test_bus_sequences(void) {
+    uint64_t sets1_before, seq1_before, sets2_before, seq2_before;
+    can_shm_bus_get_stats(1, &sets1_before, &seq1_before);
+    can_shm_bus_get_stats(2, &sets2_before, &seq2_before);
+
+    CANData frames[4];
+    memset(frames, 0, sizeof(frames));
+    for (int i = 0; i < 4; i++) {
+        frames[i].can_id = 0x200 + i;
+        frames[i].dlc = 1;
+        frames[i].data[0] = (uint8_t)i;
+    }
+    uint32_t stored = 0;
+    TEST_ASSERT(can_shm_bus_set_batch(1, frames, 4, &stored) == CAN_SHM_SUCCESS && stored == 4,
+                "Batch stored on bus 1");
+
+    uint64_t sets1, seq1, sets2, seq2;
+    can_shm_bus_get_stats(1, &sets1, &seq1);
+    can_shm_bus_get_stats(2, &sets2, &seq2);
+    TEST_ASSERT(sets1 - sets1_before == 4 && seq1 - seq1_before == 4, "Bus 1 sequence advanced");
+    TEST_ASSERT(sets2 == sets2_before && seq2 == seq2_before, "Bus 2 sequence unchanged");
+}
+
+// バス別購読スレッド
+typedef struct {
+    uint32_t bus;
+    uint32_t received;
+    uint8_t last_value;
+    CANShmResult result;
+} BusSubscriber;
+
+static void bus_callback(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    BusSubscriber* sub = (BusSubscriber*)user_data;
+    sub->received++;
+    sub->last_value = data->data[0];
+}
+
+static void* subscriber_thread(void* arg) {
+    BusSubscriber* sub = (BusSubscriber*)arg;
+    sub->result = can_shm_bus_subscribe_ex(sub->bus, 0x300, 1, 500, NULL, bus_callback, sub);
+    return NULL;
+}
+
+/**
+ * 他バスの同一IDの更新では起床しない
+ */
+void test_bus_subscribe(void) {
+    BusSubscriber sub = {3, 0, 0, CAN_SHM_ERROR_TIMEOUT};
+    pthread_t thread;
+    pthread_create(&thread, NULL, subscriber_thread, &sub);
+    usleep(20000);
+
+    uint8_t other = 0xAA;
+    uint8_t mine = 0x55;
+    can_shm_bus_set(0, 0x300, 1, &other);
+    can_shm_bus_set(1, 0x300, 1, &other);
+    usleep(20000);
+    can_shm_bus_set(3, 0x300, 1, &mine);
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT(sub.result == CAN_SHM_SUCCESS && sub.received == 1 && sub.last_value == 0x55,
+                "Subscriber receives only its bus");
+}
+
+// バス別並行書き込み
+#define PARALLEL_FRAMES 50000
+
+static void* writer_thread(void* arg) {
+    uint32_t bus = (uint32_t)(uintptr_t)arg;
+    uint8_t data[8] = {0};
+    for (uint32_t i = 0; i < PARALLEL_FRAMES; i++) {
+        memcpy(data, &i, sizeof(i));
+        can_shm_bus_set(bus, 0x400 + (i & 0xFF), 8, data);
+    }
+    return NULL;
+}
+
+/**
+ * 複数バスへの並行書き込み
+ */
+void test_bus_parallel_writers(void) {
+    uint64_t before[4], seq;
+    for (uint32_t bus = 4; bus < 8; bus++) {
+        can_shm_bus_get_stats(bus, &before[bus - 4], &seq);
+    }
+
+    pthread_t threads[4];
+    for (uint32_t bus = 4; bus < 8; bus++) {
+        pthread_create(&threads[bus - 4], NULL, writer_thread, (void*)(uintptr_t)bus);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int all_counted = 1;
+    for (uint32_t bus = 4; bus < 8; bus++) {
+        uint64_t sets;
+        can_shm_bus_get_stats(bus, &sets, &seq);
+        if (sets - before[bus - 4] != PARALLEL_FRAMES) {
+            all_counted = 0;
+        }
+    }
+    TEST_ASSERT(all_counted, "Each bus counts only its own writes");
+}
+
+int main(void) {
+    printf("Starting Multi-Bus Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_bus_isolation();
+    test_bus_sequences();
+    test_bus_subscribe();
+    test_bus_parallel_writers();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
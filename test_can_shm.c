@@ -7,6 +7,7 @@
 #include <time.h>
 
 #include "can_shm_api.h"
+#include "can_shm_linear_probing.h"
 
 // テスト結果統計
 static int tests_run = 0;
@@ -101,6 +102,131 @@ void test_set_overwrite() {
                 "TC-SET-004: Data was overwritten correctly");
 }
 
+// TC-SET-005: バッチ設定
+void test_set_batch() {
+    CANData frames[3];
+    memset(frames, 0, sizeof(frames));
+    for (int i = 0; i < 3; i++) {
+        frames[i].can_id = 0x500 + i;
+        frames[i].dlc = 2;
+        frames[i].data[0] = 0x50;
+        frames[i].data[1] = (uint8_t)i;
+    }
+    
+    uint64_t sets_before, sets_after, gets, subscribes;
+    can_shm_get_stats(&sets_before, &gets, &subscribes);
+    
+    uint32_t stored = 0;
+    CANShmResult result = can_shm_set_batch(frames, 3, &stored);
+    TEST_ASSERT(result == CAN_SHM_SUCCESS && stored == 3, "TC-SET-005: Set batch (result)");
+    
+    can_shm_get_stats(&sets_after, &gets, &subscribes);
+    TEST_ASSERT(sets_after - sets_before == 3, "TC-SET-005: Set batch (stats)");
+    
+    CANData retrieved;
+    result = can_shm_get(0x502, &retrieved);
+    TEST_ASSERT(result == CAN_SHM_SUCCESS && retrieved.dlc == 2 && retrieved.data[1] == 2,
+                "TC-SET-005: Set batch (data)");
+    
+    // 無効なフレームを含むバッチ：有効なフレームのみ格納
+    frames[1].can_id = 0x20000000;
+    result = can_shm_set_batch(frames, 3, &stored);
+    TEST_ASSERT(result == CAN_SHM_ERROR_INVALID_ID && stored == 2,
+                "TC-SET-005: Set batch with invalid frame");
+}
+
+// TC-SET-006: 受信時刻指定バッチ
+void test_set_batch_timestamped() {
+    CANData frames[2];
+    memset(frames, 0, sizeof(frames));
+    frames[0].can_id = 0x510;
+    frames[0].dlc = 1;
+    frames[0].timestamp = 123456789ULL;
+    frames[1].can_id = 0x511;
+    frames[1].dlc = 1;
+    frames[1].timestamp = 0;
+    
+    uint32_t stored = 0;
+    CANShmResult result = can_shm_set_batch_timestamped(frames, 2, &stored);
+    TEST_ASSERT(result == CAN_SHM_SUCCESS && stored == 2, "TC-SET-006: Set batch timestamped (result)");
+    
+    CANData retrieved;
+    can_shm_get(0x510, &retrieved);
+    TEST_ASSERT(retrieved.timestamp == 123456789ULL, "TC-SET-006: Set batch timestamped (frame time)");
+    can_shm_get(0x511, &retrieved);
+    TEST_ASSERT(retrieved.timestamp > 123456789ULL, "TC-SET-006: Set batch timestamped (zero uses now)");
+}
+
+// TC-SET-007: On-change通知モード
+void test_set_on_change() {
+    uint8_t data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00};
+    uint64_t suppressed_before, suppressed_after;
+    CANData first, second;
+    
+    TEST_ASSERT(can_shm_set_publish_mode(CAN_SHM_PUBLISH_ON_CHANGE) == CAN_SHM_SUCCESS,
+                "TC-SET-007: Set on-change mode");
+    can_shm_set(0x520, 8, data);
+    can_shm_get(0x520, &first);
+    
+    // 同一データ：タイムスタンプのみ更新、通知なし
+    uint64_t seq_before = g_shm_ptr->global_sequence;
+    can_shm_get_suppressed_count(&suppressed_before);
+    can_shm_set(0x520, 8, data);
+    can_shm_get_suppressed_count(&suppressed_after);
+    can_shm_get(0x520, &second);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before && suppressed_after == suppressed_before + 1,
+                "TC-SET-007: Identical payload suppressed");
+    TEST_ASSERT(second.timestamp >= first.timestamp, "TC-SET-007: Timestamp refreshed");
+    
+    // データ変化：通知あり
+    data[0] = 0x12;
+    can_shm_set(0x520, 8, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before + 1, "TC-SET-007: Changed payload notified");
+    
+    // DLC変化：通知あり
+    can_shm_set(0x520, 7, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before + 2, "TC-SET-007: Changed DLC notified");
+    
+    // 無視マスク：アライブカウンタ（data[7]）の変化は通知しない
+    can_shm_set_publish_mode_id(0x521, CAN_SHM_PUBLISH_ON_CHANGE, 1ULL << 7);
+    can_shm_set(0x521, 8, data);
+    seq_before = g_shm_ptr->global_sequence;
+    data[7]++;
+    can_shm_set(0x521, 8, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before, "TC-SET-007: Ignored byte suppressed");
+    can_shm_get(0x521, &second);
+    TEST_ASSERT(second.data[7] == data[7], "TC-SET-007: Ignored byte still stored");
+    data[1]++;
+    can_shm_set(0x521, 8, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before + 1, "TC-SET-007: Other byte notified");
+    
+    // ID個別にALWAYSを指定すると全体設定より優先
+    can_shm_set_publish_mode_id(0x521, CAN_SHM_PUBLISH_ALWAYS, 0);
+    can_shm_set(0x521, 8, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before + 2, "TC-SET-007: Per-ID always overrides");
+    
+    // 個別設定は設定したIDのみ：ホーム位置を共有する別IDは全体設定に従う
+    uint32_t sharing = 0x522;
+    while (can_id_hash(sharing) != can_id_hash(0x521)) {
+        sharing++;
+    }
+    can_shm_set(sharing, 8, data);
+    seq_before = g_shm_ptr->global_sequence;
+    can_shm_set(sharing, 8, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before, "TC-SET-007: Colliding ID does not inherit per-ID mode");
+    
+    // 削除で個別設定は消える
+    can_shm_set_linear_probing(0x18F00521, 8, data);
+    can_shm_set_publish_mode_id(0x18F00521, CAN_SHM_PUBLISH_ALWAYS, 0);
+    can_shm_delete_linear_probing(0x18F00521);
+    can_shm_set_linear_probing(0x18F00521, 8, data);
+    seq_before = g_shm_ptr->global_sequence;
+    can_shm_set_linear_probing(0x18F00521, 8, data);
+    TEST_ASSERT(g_shm_ptr->global_sequence == seq_before, "TC-SET-007: Per-ID mode cleared by delete");
+    
+    can_shm_set_publish_mode(CAN_SHM_PUBLISH_ALWAYS);
+}
+
 // TC-GET-001: 存在するCAN IDの取得
 void test_get_existing_id() {
     uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
@@ -198,6 +324,9 @@ int main() {
     test_set_max_dlc();
     test_set_dlc_zero();
     test_set_overwrite();
+    test_set_batch();
+    test_set_batch_timestamped();
+    test_set_on_change();
     
     test_get_existing_id();
     test_get_nonexistent_id();
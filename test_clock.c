@@ -0,0 +1,198 @@
+#include "can_shm_api.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+static uint64_t abs_diff(uint64_t a, uint64_t b) {
+    return a > b ? a - b : b - a;
+}
+
+/**
+ * TSC換算値とCLOCK_MONOTONICの一致
+ */
+void test_tsc_tracks_monotonic(void) {
+    if (g_shm_ptr->clock.tsc_calibrated == 0) {
+        printf("  invariant TSC not available, skipping\n");
+        TEST_ASSERT(can_shm_clock_get_source() == CAN_SHM_CLOCK_MONOTONIC, "Falls back to monotonic");
+        TEST_ASSERT(can_shm_clock_set_source(CAN_SHM_CLOCK_TSC) == CAN_SHM_ERROR_INVALID_PARAM,
+                    "TSC rejected when not calibrated");
+        return;
+    }
+
+    printf("  TSC frequency: %llu Hz\n", (unsigned long long)can_shm_clock_tsc_hz());
+    TEST_ASSERT(can_shm_clock_set_source(CAN_SHM_CLOCK_TSC) == CAN_SHM_SUCCESS &&
+                can_shm_clock_get_source() == CAN_SHM_CLOCK_TSC, "TSC source selected");
+
+    uint64_t max_diff = 0;
+    for (int i = 0; i < 20; i++) {
+        uint64_t mono = can_shm_clock_monotonic_ns();
+        uint64_t tsc = can_shm_clock_now_ns();
+        if (abs_diff(mono, tsc) > max_diff) {
+            max_diff = abs_diff(mono, tsc);
+        }
+        usleep(1000);
+    }
+    printf("  max |tsc - monotonic|: %llu ns\n", (unsigned long long)max_diff);
+    TEST_ASSERT(max_diff < 1000000, "TSC time within 1ms of CLOCK_MONOTONIC");
+
+    int monotonic = 1;
+    uint64_t prev = can_shm_clock_now_ns();
+    for (int i = 0; i < 100000; i++) {
+        uint64_t now = can_shm_clock_now_ns();
+        if (now < prev) {
+            monotonic = 0;
+            break;
+        }
+        prev = now;
+    }
+    TEST_ASSERT(monotonic, "TSC time does not go backwards");
+}
+
+/**
+ * 時刻源の切り替え
+ */
+void test_source_switch(void) {
+    CANShmClockSource original = can_shm_clock_get_source();
+    TEST_ASSERT(can_shm_clock_set_source(CAN_SHM_CLOCK_MONOTONIC) == CAN_SHM_SUCCESS &&
+                can_shm_clock_get_source() == CAN_SHM_CLOCK_MONOTONIC, "Monotonic source selected");
+    TEST_ASSERT(can_shm_clock_set_source((CANShmClockSource)7) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Unknown source rejected");
+
+    uint8_t data[8] = {1};
+    uint64_t before = can_shm_clock_monotonic_ns();
+    can_shm_set(0x18F00001, 8, data);
+    uint64_t after = can_shm_clock_monotonic_ns();
+    CANData out;
+    can_shm_get(0x18F00001, &out);
+    TEST_ASSERT(out.timestamp >= before && out.timestamp <= after, "Monotonic timestamp stored");
+
+    can_shm_clock_set_source(original);
+}
+
+/**
+ * 呼び出し元指定のタイムスタンプ
+ */
+void test_caller_timestamp(void) {
+    uint8_t data[8] = {2};
+    CANData out;
+
+    TEST_ASSERT(can_shm_set_timestamped(0x18F00002, 8, data, 123456789ULL) == CAN_SHM_SUCCESS,
+                "Timestamped set");
+    can_shm_get(0x18F00002, &out);
+    TEST_ASSERT(out.timestamp == 123456789ULL && out.data[0] == 2, "Caller timestamp stored as given");
+
+    uint64_t before = can_shm_clock_now_ns();
+    can_shm_set_timestamped(0x18F00002, 8, data, 0);
+    can_shm_get(0x18F00002, &out);
+    TEST_ASSERT(out.timestamp >= before && out.timestamp <= can_shm_clock_now_ns(),
+                "Zero timestamp uses current time");
+
+    can_shm_bus_set_timestamped(1, 0x18F00002, 8, data, 42);
+    can_shm_bus_get(1, 0x18F00002, &out);
+    TEST_ASSERT(out.timestamp == 42, "Bus timestamped set");
+    TEST_ASSERT(can_shm_bus_set_timestamped(CAN_SHM_MAX_BUSES, 0x18F00002, 8, data, 42) ==
+                CAN_SHM_ERROR_INVALID_PARAM, "Invalid bus rejected");
+}
+
+/**
+ * 別プロセスのタイムスタンプとの比較
+ */
+void test_cross_process(void) {
+    uint64_t before = can_shm_clock_now_ns();
+    pid_t pid = fork();
+    if (pid == 0) {
+        // 子プロセスは独自にマップして書き込む
+        can_shm_cleanup();
+        if (can_shm_init() != CAN_SHM_SUCCESS) {
+            _exit(1);
+        }
+        uint8_t data[8] = {3};
+        can_shm_set(0x18F00003, 8, data);
+        can_shm_cleanup();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    uint64_t after = can_shm_clock_now_ns();
+
+    CANData out;
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                can_shm_get(0x18F00003, &out) == CAN_SHM_SUCCESS, "Child process set");
+    TEST_ASSERT(out.timestamp >= before && out.timestamp <= after,
+                "Child timestamp comparable with parent clock");
+}
+
+/**
+ * 時刻取得のコスト比較
+ */
+void test_cost(void) {
+    const int ops = 1000000;
+    volatile uint64_t sink = 0;
+
+    uint64_t start = can_shm_clock_monotonic_ns();
+    for (int i = 0; i < ops; i++) {
+        sink += can_shm_clock_monotonic_ns();
+    }
+    double mono_ns = (double)(can_shm_clock_monotonic_ns() - start) / ops;
+
+    start = can_shm_clock_monotonic_ns();
+    for (int i = 0; i < ops; i++) {
+        sink += can_shm_clock_now_ns();
+    }
+    double now_ns = (double)(can_shm_clock_monotonic_ns() - start) / ops;
+    (void)sink;
+
+    printf("  clock_gettime: %.1f ns/call, can_shm_clock_now_ns (%s): %.1f ns/call\n", mono_ns,
+           can_shm_clock_get_source() == CAN_SHM_CLOCK_TSC ? "tsc" : "monotonic", now_ns);
+    TEST_ASSERT(now_ns > 0.0, "Clock cost measured");
+}
+
+int main(void) {
+    printf("Starting Clock Source Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_tsc_tracks_monotonic();
+    test_source_switch();
+    test_caller_timestamp();
+    test_cross_process();
+    test_cost();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
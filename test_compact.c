@@ -0,0 +1,201 @@
+#include "can_shm_api.h"
+#include "can_shm_compact.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+/**
+ * Set/Getとサイズクラスの選択
+ */
+void test_basic_operations(void) {
+    uint8_t data[64];
+    for (int i = 0; i < 64; i++) {
+        data[i] = (uint8_t)(i + 1);
+    }
+    CANData out;
+
+    TEST_ASSERT(can_shm_compact_get(0x100, &out) == CAN_SHM_ERROR_NOT_FOUND, "Unknown ID not found");
+    TEST_ASSERT(can_shm_compact_set(0x100, 8, data) == CAN_SHM_SUCCESS, "Classic frame set");
+    TEST_ASSERT(can_shm_compact_get(0x100, &out) == CAN_SHM_SUCCESS && out.can_id == 0x100 &&
+                out.dlc == 8 && memcmp(out.data, data, 8) == 0 && out.data[8] == 0 && out.timestamp != 0,
+                "Classic frame get");
+
+    TEST_ASSERT(can_shm_compact_set(0x18DA00F1, 64, data) == CAN_SHM_SUCCESS, "FD frame set");
+    TEST_ASSERT(can_shm_compact_get(0x18DA00F1, &out) == CAN_SHM_SUCCESS && out.dlc == 64 &&
+                memcmp(out.data, data, 64) == 0, "FD frame get");
+
+    CANCompactInfo info;
+    TEST_ASSERT(can_shm_compact_get_info(&info) == CAN_SHM_SUCCESS && info.used[0] == 1 &&
+                info.used[3] == 1 && info.entries == 2, "Slots taken from matching classes");
+    TEST_ASSERT(info.slot_size[0] <= 64 && 64 % info.slot_size[0] == 0,
+                "Classic slot fits in one cache line");
+
+    TEST_ASSERT(can_shm_compact_set(0x20000000, 8, data) == CAN_SHM_ERROR_INVALID_ID, "Invalid ID rejected");
+    TEST_ASSERT(can_shm_compact_set(0x101, 65, data) == CAN_SHM_ERROR_INVALID_PARAM, "DLC over 64 rejected");
+    TEST_ASSERT(can_shm_compact_set(0x101, 8, NULL) == CAN_SHM_ERROR_INVALID_PARAM, "NULL data rejected");
+}
+
+/**
+ * 短いDLCでの上書きとクラス移動
+ */
+void test_resize(void) {
+    uint8_t data[64];
+    memset(data, 0xAA, sizeof(data));
+    CANData out;
+
+    can_shm_compact_set(0x200, 8, data);
+    uint8_t shorter[4] = {1, 2, 3, 4};
+    can_shm_compact_set(0x200, 4, shorter);
+    TEST_ASSERT(can_shm_compact_get(0x200, &out) == CAN_SHM_SUCCESS && out.dlc == 4 &&
+                memcmp(out.data, shorter, 4) == 0 && out.data[4] == 0 && out.data[7] == 0,
+                "Shorter frame clears previous tail");
+
+    CANCompactInfo before, after;
+    can_shm_compact_get_info(&before);
+    TEST_ASSERT(can_shm_compact_set(0x200, 48, data) == CAN_SHM_SUCCESS, "Larger frame set");
+    can_shm_compact_get_info(&after);
+    TEST_ASSERT(after.moves == before.moves + 1 && after.used[3] == before.used[3] + 1 &&
+                after.entries == before.entries, "ID moved to larger class");
+    TEST_ASSERT(can_shm_compact_get(0x200, &out) == CAN_SHM_SUCCESS && out.dlc == 48 &&
+                memcmp(out.data, data, 48) == 0, "Data readable after move");
+
+    // 事前登録したIDは未書き込みの間は取得できない
+    TEST_ASSERT(can_shm_compact_reserve(0x300, 32) == CAN_SHM_SUCCESS, "Reserve FD ID");
+    TEST_ASSERT(can_shm_compact_get(0x300, &out) == CAN_SHM_ERROR_NOT_FOUND, "Reserved ID empty until set");
+    can_shm_compact_get_info(&before);
+    can_shm_compact_set(0x300, 12, data);
+    can_shm_compact_set(0x300, 32, data);
+    can_shm_compact_get_info(&after);
+    TEST_ASSERT(after.moves == before.moves && after.used[2] == before.used[2],
+                "Reserved class avoids moves");
+}
+
+typedef struct {
+    volatile int stop;
+    uint32_t can_id;
+} StressContext;
+
+// 全byteが同じ値のフレームを書き込み続ける
+static void* writer_thread(void* arg) {
+    StressContext* ctx = (StressContext*)arg;
+    uint8_t data[64];
+    for (uint32_t i = 0; !ctx->stop; i++) {
+        uint16_t dlc = (uint16_t)(i % 2 == 0 ? 8 : 40);
+        memset(data, (int)(i & 0xFF), dlc);
+        can_shm_compact_set(ctx->can_id, dlc, data);
+    }
+    return NULL;
+}
+
+/**
+ * 並行書き込み中の読み取りの一貫性（クラス移動を含む）
+ */
+void test_concurrent_consistency(void) {
+    StressContext ctx = {0, 0x400};
+    uint8_t seed[8] = {0};
+    can_shm_compact_set(ctx.can_id, 8, seed);
+
+    pthread_t writers[2];
+    for (int i = 0; i < 2; i++) {
+        pthread_create(&writers[i], NULL, writer_thread, &ctx);
+    }
+
+    int torn = 0;
+    CANData out;
+    for (int i = 0; i < 200000; i++) {
+        if (can_shm_compact_get(ctx.can_id, &out) != CAN_SHM_SUCCESS) {
+            torn++;
+            continue;
+        }
+        for (int b = 1; b < out.dlc; b++) {
+            if (out.data[b] != out.data[0]) {
+                torn++;
+                break;
+            }
+        }
+        for (int b = out.dlc; b < 64; b++) {
+            if (out.data[b] != 0) {
+                torn++;
+                break;
+            }
+        }
+    }
+    ctx.stop = 1;
+    for (int i = 0; i < 2; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    TEST_ASSERT(torn == 0, "No torn reads under concurrent writers");
+}
+
+/**
+ * 通常テーブルとのメモリ使用量比較
+ */
+void test_memory_footprint(void) {
+    CANCompactInfo info;
+    can_shm_compact_get_info(&info);
+
+    size_t bucket_bytes = sizeof(CANBucket) * MAX_CAN_ENTRIES;
+    size_t classic_bytes = (size_t)info.slot_size[0] * MAX_CAN_ENTRIES;
+    printf("  CANBucket: %zu bytes/ID, classic slot: %u bytes/ID, FD slot: %u bytes/ID\n",
+           sizeof(CANBucket), info.slot_size[0], info.slot_size[3]);
+    printf("  %d classic IDs: %zu KB (buckets) vs %zu KB (compact slots)\n",
+           MAX_CAN_ENTRIES, bucket_bytes / 1024, classic_bytes / 1024);
+    printf("  segment: %zu KB (compact) vs %zu KB (main layout)\n",
+           info.segment_size / 1024, sizeof(SharedMemoryLayout) / 1024);
+    TEST_ASSERT(classic_bytes * 3 < bucket_bytes, "Classic storage several times smaller");
+}
+
+int main(void) {
+    printf("Starting Compact Table Tests...\n\n");
+
+    // テスト専用のセグメントで空のテーブルから始める（本番の SHM_COMPACT_NAME には触れない）
+    char shm_name[64];
+    snprintf(shm_name, sizeof(shm_name), "%s.test.%d", SHM_COMPACT_NAME, (int)getpid());
+    shm_unlink(shm_name);
+
+    if (can_shm_compact_init_named(shm_name) != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize compact table\n");
+        return 1;
+    }
+
+    test_basic_operations();
+    test_resize();
+    test_concurrent_consistency();
+    test_memory_footprint();
+
+    can_shm_compact_cleanup();
+    shm_unlink(shm_name);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
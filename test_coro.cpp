@@ -0,0 +1,153 @@
+#include "can_shm_coro.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define MANY_BASE_ID 0x18DA0000u
+#define MANY_COUNT 1000
+
+static void send_counter(uint32_t can_id, uint32_t counter) {
+    uint8_t data[8] = {0};
+    std::memcpy(data, &counter, sizeof(counter));
+    can_shm_set(can_id, 8, data);
+}
+
+static uint32_t frame_counter(const CANData& frame) {
+    uint32_t counter;
+    std::memcpy(&counter, frame.data, sizeof(counter));
+    return counter;
+}
+
+static can_shm::Task wait_one(can_shm::Executor& ex, uint32_t can_id, uint32_t* matched) {
+    auto data = co_await ex.next(can_id, std::chrono::milliseconds(3000));
+    if (data && frame_counter(*data) == can_id) {
+        (*matched)++;
+    }
+}
+
+/**
+ * 1スレッドで多数の購読を同時に待機
+ */
+void test_many_awaits() {
+    can_shm::Segment seg;
+    can_shm::Executor ex(seg);
+    uint32_t matched = 0;
+
+    for (uint32_t i = 0; i < MANY_COUNT; i++) {
+        ex.spawn(wait_one(ex, MANY_BASE_ID + i, &matched));
+    }
+
+    std::thread producer([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        for (uint32_t i = 0; i < MANY_COUNT; i++) {
+            send_counter(MANY_BASE_ID + i, MANY_BASE_ID + i);
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    ex.run();
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    producer.join();
+
+    printf("  %d concurrent awaits completed in %.1f ms on one thread\n", MANY_COUNT, elapsed.count());
+    TEST_ASSERT(matched == MANY_COUNT, "All concurrent awaits resumed with their own frame");
+    TEST_ASSERT(ex.task_count() == 0 && ex.pending_count() == 0, "Executor drained");
+}
+
+static can_shm::Task consume_stream(can_shm::Executor& ex, uint32_t can_id,
+                                    std::vector<uint32_t>* counters) {
+    auto sub = ex.subscribe(can_id);
+    while (auto data = co_await sub.next(std::chrono::milliseconds(200))) {
+        counters->push_back(frame_counter(*data));
+    }
+}
+
+/**
+ * 更新列の購読（タイムアウトで終了）
+ */
+void test_subscription_stream() {
+    can_shm::Segment seg;
+    can_shm::Executor ex(seg);
+    std::vector<uint32_t> counters;
+    ex.spawn(consume_stream(ex, 0x18DB0000, &counters));
+
+    std::thread producer([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (uint32_t i = 1; i <= 100; i++) {
+            send_counter(0x18DB0000, i);
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    });
+    ex.run();
+    producer.join();
+
+    bool increasing = true;
+    for (size_t i = 1; i < counters.size(); i++) {
+        if (counters[i] <= counters[i - 1]) {
+            increasing = false;
+        }
+    }
+    printf("  stream: %zu updates delivered\n", counters.size());
+    TEST_ASSERT(!counters.empty() && counters.back() == 100, "Stream delivers latest update");
+    TEST_ASSERT(increasing, "Stream delivers updates in order");
+}
+
+static can_shm::Task wait_timeout(can_shm::Executor& ex, bool* timed_out) {
+    auto data = co_await ex.next(0x18DC0000, std::chrono::milliseconds(50));
+    *timed_out = !data.has_value();
+}
+
+/**
+ * タイムアウト
+ */
+void test_await_timeout() {
+    can_shm::Segment seg;
+    can_shm::Executor ex(seg);
+    bool timed_out = false;
+    ex.spawn(wait_timeout(ex, &timed_out));
+
+    auto start = std::chrono::steady_clock::now();
+    ex.run();
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    TEST_ASSERT(timed_out && elapsed.count() >= 45, "Await times out without updates");
+}
+
+int main() {
+    printf("Starting Coroutine Subscription Tests...\n\n");
+
+    test_many_awaits();
+    test_subscription_stream();
+    test_await_timeout();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,173 @@
+#include "can_shm.hpp"
+#include "can_shm_linear_probing.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+// 型付きビューのテスト用ペイロード
+struct WheelSpeed {
+    uint16_t fl;
+    uint16_t fr;
+    uint16_t rl;
+    uint16_t rr;
+};
+
+/**
+ * RAIIによる初期化・終了
+ */
+void test_segment_lifetime() {
+    {
+        can_shm::Segment outer;
+        TEST_ASSERT(g_is_initialized && outer.layout() == g_shm_ptr, "Segment initializes shared memory");
+        {
+            can_shm::Segment inner;
+            can_shm::Segment moved(std::move(inner));
+            TEST_ASSERT(moved.layout() == g_shm_ptr && inner.layout() == nullptr, "Segment is movable");
+        }
+        TEST_ASSERT(g_is_initialized, "Shared memory kept while a Segment remains");
+    }
+    TEST_ASSERT(!g_is_initialized, "Last Segment cleans up");
+
+    bool thrown = false;
+    try {
+        can_shm::Segment bad(CAN_SHM_MAX_BUSES);
+    } catch (const can_shm::Error& e) {
+        thrown = e.code() == CAN_SHM_ERROR_INVALID_PARAM;
+    }
+    TEST_ASSERT(thrown && !g_is_initialized, "Invalid bus throws without leaking initialization");
+}
+
+/**
+ * 事前解決スロットと型付きビュー
+ */
+void test_slot_access() {
+    can_shm::Segment seg;
+
+    can_shm::Slot slot = seg.slot(0x18FEF100);
+    CANData data;
+    TEST_ASSERT(slot && !slot.read(data), "Slot resolved before first write");
+
+    auto speed = seg.signal<WheelSpeed>(0x18FEF100);
+    TEST_ASSERT(speed.store(WheelSpeed{100, 101, 102, 103}) == CAN_SHM_SUCCESS, "Typed store");
+
+    auto value = speed.load();
+    TEST_ASSERT(value && value->fl == 100 && value->rr == 103, "Typed load");
+
+    CANData c_data;
+    can_shm_get(0x18FEF100, &c_data);
+    TEST_ASSERT(slot.read(data) && data.dlc == sizeof(WheelSpeed) &&
+                std::memcmp(&data, &c_data, sizeof(CANData)) == 0, "Slot read matches C API");
+
+    uint32_t seq = slot.change_sequence();
+    uint8_t raw[2] = {0x12, 0x34};
+    slot.store(raw, 2);
+    TEST_ASSERT(slot.change_sequence() == seq + 1, "Change sequence advances");
+    auto partial = slot.load<WheelSpeed>();
+    TEST_ASSERT(partial && partial->fl == 0x3412 && partial->fr == 0, "Short DLC zero-filled");
+
+    TEST_ASSERT(!seg.get(0x18FEF1FF) && seg.get(0x18FEF100), "Single-shot get");
+
+    // バス指定
+    can_shm::Segment bus1(1);
+    TEST_ASSERT(!bus1.get(0x18FEF100), "Bus segments are independent");
+
+    bool thrown = false;
+    try {
+        seg.slot(CAN_ID_MAX + 1);
+    } catch (const can_shm::Error& e) {
+        thrown = e.code() == CAN_SHM_ERROR_INVALID_ID;
+    }
+    TEST_ASSERT(thrown, "Invalid CAN ID throws");
+}
+
+/**
+ * ホーム位置を共有するID：スロットの読み書きは同じバケット（can_shm_get/set と同じ）
+ */
+void test_slot_colliding_ids() {
+    can_shm::Segment seg;
+    const uint32_t first = 0x18FF1000;
+    const uint32_t second = 0x18FF2030;  // first と同じホーム位置
+    uint8_t raw[2] = {0x11, 0x22};
+
+    // リニアプロービングで second はホームの次のバケットへ
+    can_shm_set_linear_probing(first, 2, raw);
+    can_shm_set_linear_probing(second, 2, raw);
+
+    can_shm::Slot slot = seg.slot(second);
+    WheelSpeed ws = {1, 2, 3, 4};
+    TEST_ASSERT(slot.store(ws) == CAN_SHM_SUCCESS, "Store colliding ID through slot");
+    auto loaded = slot.load<WheelSpeed>();
+    TEST_ASSERT(loaded && loaded->rr == 4, "Slot reads the bucket it stores to");
+
+    CANData data;
+    TEST_ASSERT(can_shm_get(second, &data) == CAN_SHM_SUCCESS && data.dlc == sizeof(WheelSpeed),
+                "Slot store matches can_shm_get");
+}
+
+/**
+ * 読み取りコスト（C API比較、参考値）
+ */
+void test_read_cost() {
+    can_shm::Segment seg;
+    can_shm::Slot slot = seg.slot(0x18FEF100);
+    const int N = 1000000;
+    CANData data;
+    uint64_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) {
+        slot.read(data);
+        sink += data.data[0];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) {
+        can_shm_get(0x18FEF100, &data);
+        sink += data.data[0];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double slot_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    double c_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / N;
+    printf("Read cost: Slot::read %.1f ns, can_shm_get %.1f ns (sink=%llu)\n",
+           slot_ns, c_ns, (unsigned long long)sink);
+    TEST_ASSERT(slot_ns > 0 && c_ns > 0, "Read cost measured");
+}
+
+int main() {
+    printf("Starting C++ Wrapper Tests...\n\n");
+
+    test_segment_lifetime();
+    test_slot_access();
+    test_slot_colliding_ids();
+    test_read_cost();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,348 @@
+#include "can_shm_api.h"
+#include "can_shm_dispatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define ORDER_IDS 8
+#define ORDER_FRAMES 1000
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static CANData make_frame(uint32_t can_id, uint32_t counter) {
+    CANData frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = can_id;
+    frame.dlc = 8;
+    memcpy(frame.data, &counter, sizeof(counter));
+    return frame;
+}
+
+static uint32_t frame_counter(const CANData* frame) {
+    uint32_t counter;
+    memcpy(&counter, frame->data, sizeof(counter));
+    return counter;
+}
+
+// CAN IDごとの受信記録（同一IDのコールバックは同時に実行されない）
+typedef struct {
+    uint32_t next_expected;
+    uint32_t received;
+    int out_of_order;
+    uint32_t sleep_us;
+} OrderState;
+
+static void on_ordered(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    OrderState* state = (OrderState*)user_data;
+    if (frame_counter(data) != state->next_expected) {
+        state->out_of_order = 1;
+    }
+    state->next_expected = frame_counter(data) + 1;
+    state->received++;
+    if (state->sleep_us) {
+        usleep(state->sleep_us);
+    }
+}
+
+/**
+ * CAN IDごとの実行順序
+ */
+void test_dispatch_ordering(void) {
+    CANDispatcherConfig config = {4, 16, 0, CAN_DISPATCH_BLOCK};
+    CANDispatcher* dispatcher = NULL;
+    TEST_ASSERT(can_shm_dispatcher_create(&config, &dispatcher) == CAN_SHM_SUCCESS, "Create dispatcher");
+
+    OrderState states[ORDER_IDS];
+    memset(states, 0, sizeof(states));
+    for (uint32_t n = 0; n < ORDER_FRAMES; n++) {
+        for (uint32_t i = 0; i < ORDER_IDS; i++) {
+            CANData frame = make_frame(0x700 + i, n);
+            can_shm_dispatcher_post(dispatcher, 0x700 + i, &frame, on_ordered, &states[i]);
+        }
+    }
+    TEST_ASSERT(can_shm_dispatcher_drain(dispatcher, 5000) == CAN_SHM_SUCCESS, "Drain completes");
+
+    int ordered = 1;
+    for (uint32_t i = 0; i < ORDER_IDS; i++) {
+        if (states[i].out_of_order || states[i].received != ORDER_FRAMES) {
+            ordered = 0;
+        }
+    }
+    TEST_ASSERT(ordered, "Per-ID order preserved across workers");
+
+    CANDispatcherStats stats;
+    can_shm_dispatcher_get_stats(dispatcher, &stats);
+    printf("  posted=%llu executed=%llu blocked=%llu stolen=%llu\n",
+           (unsigned long long)stats.posted, (unsigned long long)stats.executed,
+           (unsigned long long)stats.blocked, (unsigned long long)stats.stolen);
+    TEST_ASSERT(stats.posted == ORDER_IDS * ORDER_FRAMES && stats.executed == stats.posted &&
+                stats.dropped == 0, "No frames lost with BLOCK policy");
+
+    can_shm_dispatcher_destroy(dispatcher);
+}
+
+/**
+ * 遅いコールバックのワーカー間での並列実行
+ */
+void test_dispatch_parallel(void) {
+    CANDispatcherConfig config = {4, 0, 0, CAN_DISPATCH_BLOCK};
+    CANDispatcher* dispatcher = NULL;
+    can_shm_dispatcher_create(&config, &dispatcher);
+
+    OrderState states[ORDER_IDS];
+    memset(states, 0, sizeof(states));
+    uint64_t start = now_us();
+    for (uint32_t n = 0; n < 8; n++) {
+        for (uint32_t i = 0; i < ORDER_IDS; i++) {
+            states[i].sleep_us = 2000;
+            CANData frame = make_frame(0x710 + i, n);
+            can_shm_dispatcher_post(dispatcher, 0x710 + i, &frame, on_ordered, &states[i]);
+        }
+    }
+    uint64_t post_us = now_us() - start;
+    can_shm_dispatcher_drain(dispatcher, 5000);
+    uint64_t elapsed_us = now_us() - start;
+
+    // 直列実行なら 64 x 2ms = 128ms
+    printf("  64 x 2ms callbacks: post %llu us, completed in %llu us\n",
+           (unsigned long long)post_us, (unsigned long long)elapsed_us);
+    TEST_ASSERT(post_us < 20000, "Posting does not wait for callbacks");
+    TEST_ASSERT(elapsed_us < 100000, "Slow callbacks run in parallel");
+
+    can_shm_dispatcher_destroy(dispatcher);
+}
+
+// 実行中のコールバックを止めておくためのゲート
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int entered;
+    int released;
+    uint32_t counters[32];
+    uint32_t count;
+} Gate;
+
+static void on_gated(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    Gate* gate = (Gate*)user_data;
+    pthread_mutex_lock(&gate->mutex);
+    gate->counters[gate->count++] = frame_counter(data);
+    gate->entered = 1;
+    pthread_cond_broadcast(&gate->cond);
+    while (!gate->released) {
+        pthread_cond_wait(&gate->cond, &gate->mutex);
+    }
+    pthread_mutex_unlock(&gate->mutex);
+}
+
+static void gate_init(Gate* gate) {
+    memset(gate, 0, sizeof(*gate));
+    pthread_mutex_init(&gate->mutex, NULL);
+    pthread_cond_init(&gate->cond, NULL);
+}
+
+static void gate_wait_entered(Gate* gate) {
+    pthread_mutex_lock(&gate->mutex);
+    while (!gate->entered) {
+        pthread_cond_wait(&gate->cond, &gate->mutex);
+    }
+    pthread_mutex_unlock(&gate->mutex);
+}
+
+static void gate_release(Gate* gate) {
+    pthread_mutex_lock(&gate->mutex);
+    gate->released = 1;
+    pthread_cond_broadcast(&gate->cond);
+    pthread_mutex_unlock(&gate->mutex);
+}
+
+// 1件目を実行中にしたまま10件投入し、実行されたカウンタ列を返す
+static void run_overflow(CANDispatchPolicy policy, Gate* gate, CANDispatcherStats* stats) {
+    CANDispatcherConfig config = {1, 4, 0, policy};
+    CANDispatcher* dispatcher = NULL;
+    can_shm_dispatcher_create(&config, &dispatcher);
+    gate_init(gate);
+
+    CANData frame = make_frame(0x720, 0);
+    can_shm_dispatcher_post(dispatcher, 0x720, &frame, on_gated, gate);
+    gate_wait_entered(gate);
+    for (uint32_t n = 1; n <= 10; n++) {
+        frame = make_frame(0x720, n);
+        can_shm_dispatcher_post(dispatcher, 0x720, &frame, on_gated, gate);
+    }
+    gate_release(gate);
+    can_shm_dispatcher_drain(dispatcher, 1000);
+    can_shm_dispatcher_get_stats(dispatcher, stats);
+    can_shm_dispatcher_destroy(dispatcher);
+}
+
+/**
+ * 満杯時のドロップ（新しい方・古い方）
+ */
+void test_dispatch_drop_policies(void) {
+    Gate gate;
+    CANDispatcherStats stats;
+
+    run_overflow(CAN_DISPATCH_DROP_NEWEST, &gate, &stats);
+    TEST_ASSERT(gate.count == 5 && gate.counters[1] == 1 && gate.counters[4] == 4 && stats.dropped == 6,
+                "DROP_NEWEST keeps the oldest queued frames");
+
+    run_overflow(CAN_DISPATCH_DROP_OLDEST, &gate, &stats);
+    TEST_ASSERT(gate.count == 5 && gate.counters[1] == 7 && gate.counters[4] == 10 && stats.dropped == 6,
+                "DROP_OLDEST keeps the newest queued frames");
+}
+
+typedef struct {
+    CANDispatcher* dispatcher;
+    Gate* gate;
+    int returned;
+} BlockedPoster;
+
+static void* blocked_post_thread(void* arg) {
+    BlockedPoster* poster = (BlockedPoster*)arg;
+    CANData frame = make_frame(0x730, 3);
+    can_shm_dispatcher_post(poster->dispatcher, 0x730, &frame, on_gated, poster->gate);
+    __atomic_store_n(&poster->returned, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * BLOCK によるバックプレッシャー
+ */
+void test_dispatch_backpressure(void) {
+    CANDispatcherConfig config = {1, 2, 0, CAN_DISPATCH_BLOCK};
+    CANDispatcher* dispatcher = NULL;
+    can_shm_dispatcher_create(&config, &dispatcher);
+    Gate gate;
+    gate_init(&gate);
+
+    CANData frame = make_frame(0x730, 0);
+    can_shm_dispatcher_post(dispatcher, 0x730, &frame, on_gated, &gate);
+    gate_wait_entered(&gate);
+    for (uint32_t n = 1; n <= 2; n++) {
+        frame = make_frame(0x730, n);
+        can_shm_dispatcher_post(dispatcher, 0x730, &frame, on_gated, &gate);
+    }
+
+    BlockedPoster poster = {dispatcher, &gate, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, blocked_post_thread, &poster);
+    usleep(20000);
+    TEST_ASSERT(!__atomic_load_n(&poster.returned, __ATOMIC_ACQUIRE), "Post blocks while queue is full");
+
+    gate_release(&gate);
+    pthread_join(thread, NULL);
+    can_shm_dispatcher_drain(dispatcher, 1000);
+
+    CANDispatcherStats stats;
+    can_shm_dispatcher_get_stats(dispatcher, &stats);
+    TEST_ASSERT(gate.count == 4 && gate.counters[3] == 3 && stats.blocked == 1 && stats.dropped == 0,
+                "Blocked post resumes after space frees");
+    can_shm_dispatcher_destroy(dispatcher);
+}
+
+// 購読スレッド
+typedef struct {
+    uint32_t can_id;
+    CANDispatchTarget* target;
+} SubscriberArgs;
+
+static void* subscriber_thread(void* arg) {
+    SubscriberArgs* args = (SubscriberArgs*)arg;
+    can_shm_subscribe(args->can_id, 0, 200, can_shm_dispatch_callback, args->target);
+    return NULL;
+}
+
+/**
+ * 購読APIとの接続（遅いコールバックでも購読スレッドは次の更新を検出し続ける）
+ */
+void test_dispatch_subscribe(void) {
+    CANDispatcherConfig config = {2, 256, 0, CAN_DISPATCH_DROP_OLDEST};
+    CANDispatcher* dispatcher = NULL;
+    can_shm_dispatcher_create(&config, &dispatcher);
+
+    OrderState state;
+    memset(&state, 0, sizeof(state));
+    state.sleep_us = 2000;
+    state.next_expected = 1;
+    CANDispatchTarget target = {dispatcher, on_ordered, &state};
+    SubscriberArgs args = {0x740, &target};
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, subscriber_thread, &args);
+    usleep(20000);
+
+    for (uint32_t n = 1; n <= 50; n++) {
+        uint8_t data[8] = {0};
+        memcpy(data, &n, sizeof(n));
+        can_shm_set(0x740, 8, data);
+        usleep(500);
+    }
+    pthread_join(thread, NULL);
+    can_shm_dispatcher_drain(dispatcher, 1000);
+
+    CANDispatcherStats stats;
+    can_shm_dispatcher_get_stats(dispatcher, &stats);
+    printf("  50 updates at 0.5ms with a 2ms callback: posted=%llu executed=%llu\n",
+           (unsigned long long)stats.posted, (unsigned long long)stats.executed);
+    // インライン実行なら2ms間隔でしか検出できず約1/4しか届かない
+    TEST_ASSERT(stats.posted >= 40 && stats.executed == stats.posted, "Subscriber keeps detecting updates");
+    TEST_ASSERT(state.received == stats.executed && state.next_expected == 51, "Latest update delivered");
+
+    can_shm_dispatcher_destroy(dispatcher);
+}
+
+int main(void) {
+    printf("Starting Callback Dispatch Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_dispatch_ordering();
+    test_dispatch_parallel();
+    test_dispatch_drop_policies();
+    test_dispatch_backpressure();
+    test_dispatch_subscribe();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
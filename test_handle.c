@@ -0,0 +1,190 @@
+#include "can_shm_api.h"
+#include "can_shm_linear_probing.h"
+#include "can_shm_queue.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define CHAIN_LENGTH 8
+#define BENCH_LOOPS 200000
+
+// 同じハッシュ位置になる次のID
+static uint32_t next_colliding_id(uint32_t base, uint32_t from) {
+    uint32_t id = from + 1;
+    while (can_id_hash(id) != can_id_hash(base)) {
+        id++;
+    }
+    return id;
+}
+
+// テスト専用のセグメント（並行して走る他のテストのセグメントには触れない）
+static char g_segment_path[256];
+
+// セグメントを破棄して空のテーブルで開き直す
+static CANShmResult recreate_segment(void) {
+    can_shm_cleanup();
+    unlink(g_segment_path);
+    CANShmInitOptions options = {.backing_path = g_segment_path};
+    return can_shm_init_ex(&options);
+}
+
+/**
+ * 解決とハンドル経由のSet/Get
+ */
+void test_resolve_and_access(void) {
+    uint8_t data[8] = {0x11, 0x22};
+    CANShmHandle handle;
+    CANData out;
+
+    TEST_ASSERT(can_shm_resolve(0x100, &handle) == CAN_SHM_SUCCESS && handle.index == can_id_hash(0x100),
+                "New ID resolves to its home bucket");
+    TEST_ASSERT(can_shm_get_h(&handle, &out) == CAN_SHM_ERROR_NOT_FOUND, "Get before set not found");
+    TEST_ASSERT(can_shm_set_h(&handle, 8, data) == CAN_SHM_SUCCESS, "Set by handle");
+    TEST_ASSERT(can_shm_get_h(&handle, &out) == CAN_SHM_SUCCESS && out.can_id == 0x100 && out.data[1] == 0x22,
+                "Get by handle");
+    TEST_ASSERT(can_shm_get(0x100, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x11, "Visible through can_shm_get");
+
+    // ハッシュ位置が使用中なら探査チェーン上の空きバケット
+    uint32_t other = next_colliding_id(0x100, 0x100);
+    CANShmHandle other_handle;
+    TEST_ASSERT(can_shm_resolve(other, &other_handle) == CAN_SHM_SUCCESS &&
+                other_handle.index == (can_id_hash(other) + 1) % MAX_CAN_ENTRIES,
+                "Colliding ID resolves along the probe chain");
+    CANQueueHandle queue;
+    can_shm_queue_subscribe(other, &queue);
+    can_shm_set_h(&other_handle, 8, data);
+    TEST_ASSERT(can_shm_get_linear_probing(other, &out) == CAN_SHM_SUCCESS && out.can_id == other,
+                "Placement matches linear probing");
+    uint32_t received = 0;
+    TEST_ASSERT(can_shm_queue_receive(&queue, &out, 1, 0, &received) == CAN_SHM_SUCCESS &&
+                received == 1 && out.can_id == other,
+                "Set by handle to a probed bucket reaches the ID's queue");
+    can_shm_queue_unsubscribe(&queue);
+
+    CANShmHandle bad = handle;
+    bad.index = MAX_CAN_ENTRIES;
+    TEST_ASSERT(can_shm_get_h(&bad, &out) == CAN_SHM_ERROR_INVALID_PARAM, "Out-of-range handle rejected");
+    TEST_ASSERT(can_shm_get_h(NULL, &out) == CAN_SHM_ERROR_INVALID_PARAM, "NULL handle rejected");
+    TEST_ASSERT(can_shm_resolve(0x20000000, &handle) == CAN_SHM_ERROR_INVALID_ID, "Invalid ID rejected");
+    TEST_ASSERT(can_shm_set_h(&handle, 65, data) == CAN_SHM_ERROR_INVALID_PARAM, "DLC over 64 rejected");
+}
+
+/**
+ * 古くなったハンドルの検出
+ */
+void test_stale_handles(void) {
+    uint8_t data[8] = {0x33};
+    CANData out;
+
+    // 未格納の2つのIDが同じ空きバケットに解決された場合、後から書いた方は再解決が必要
+    uint32_t first = 0x18AA0000;
+    uint32_t second = next_colliding_id(first, first);
+    CANShmHandle h1, h2;
+    can_shm_resolve(first, &h1);
+    can_shm_resolve(second, &h2);
+    TEST_ASSERT(h1.index == h2.index, "Both unclaimed IDs resolve to the same slot");
+    TEST_ASSERT(can_shm_set_h(&h1, 8, data) == CAN_SHM_SUCCESS, "First writer claims slot");
+    TEST_ASSERT(can_shm_set_h(&h2, 8, data) == CAN_SHM_ERROR_STALE, "Second writer sees stale handle");
+    TEST_ASSERT(can_shm_get_h(&h2, &out) == CAN_SHM_ERROR_STALE, "Get by stale handle reported");
+    TEST_ASSERT(can_shm_resolve(second, &h2) == CAN_SHM_SUCCESS && h2.index != h1.index &&
+                can_shm_set_h(&h2, 8, data) == CAN_SHM_SUCCESS, "Re-resolved handle usable");
+
+    // 削除で探査チェーンが変わると全ハンドルが無効
+    CANShmHandle keep;
+    can_shm_resolve(0x100, &keep);
+    can_shm_delete_linear_probing(first);
+    TEST_ASSERT(can_shm_get_h(&keep, &out) == CAN_SHM_ERROR_STALE, "Delete invalidates handles");
+    TEST_ASSERT(can_shm_set_h(&keep, 8, data) == CAN_SHM_ERROR_STALE, "Set by invalidated handle rejected");
+    can_shm_resolve(0x100, &keep);
+    TEST_ASSERT(can_shm_get_h(&keep, &out) == CAN_SHM_SUCCESS, "Handle usable after re-resolve");
+
+    // セグメント再作成
+    recreate_segment();
+    TEST_ASSERT(can_shm_get_h(&keep, &out) == CAN_SHM_ERROR_STALE, "Handle from previous segment rejected");
+}
+
+/**
+ * 探査チェーンの奥にあるIDのGet
+ */
+void test_deep_chain(void) {
+    uint8_t data[8] = {0};
+    uint32_t ids[CHAIN_LENGTH];
+    ids[0] = 0x18BB0000;
+    for (int i = 1; i < CHAIN_LENGTH; i++) {
+        ids[i] = next_colliding_id(ids[0], ids[i - 1]);
+    }
+    for (int i = 0; i < CHAIN_LENGTH; i++) {
+        can_shm_set_linear_probing(ids[i], 8, data);
+    }
+
+    uint32_t target = ids[CHAIN_LENGTH - 1];
+    CANShmHandle handle;
+    can_shm_resolve(target, &handle);
+    CANData out;
+
+    uint64_t start = can_shm_clock_monotonic_ns();
+    for (int i = 0; i < BENCH_LOOPS; i++) {
+        can_shm_get_linear_probing(target, &out);
+    }
+    double probing = (double)(can_shm_clock_monotonic_ns() - start) / BENCH_LOOPS;
+
+    int ok = 1;
+    start = can_shm_clock_monotonic_ns();
+    for (int i = 0; i < BENCH_LOOPS; i++) {
+        ok &= can_shm_get_h(&handle, &out) == CAN_SHM_SUCCESS;
+    }
+    double by_handle = (double)(can_shm_clock_monotonic_ns() - start) / BENCH_LOOPS;
+
+    printf("  ID at probe distance %d: %.1f ns/get (probing), %.1f ns/get (handle)\n",
+           CHAIN_LENGTH - 1, probing, by_handle);
+    TEST_ASSERT(ok && out.can_id == target, "Deep chain ID read by handle");
+}
+
+int main(void) {
+    printf("Starting Handle Tests...\n\n");
+
+    snprintf(g_segment_path, sizeof(g_segment_path), "/tmp/can_shm_test_handle.%d", (int)getpid());
+    if (recreate_segment() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_resolve_and_access();
+    test_stale_handles();
+    test_deep_chain();
+
+    can_shm_cleanup();
+    unlink(g_segment_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
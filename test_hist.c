@@ -0,0 +1,229 @@
+#include "can_shm_api.h"
+#include "can_shm_hist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+static CANLatencyHistogram g_hist;
+static CANSubscriberHistogram g_sub_hist;
+static uint32_t g_slot = CAN_SHM_HIST_MAX_SUBSCRIBERS;
+
+/**
+ * バケット番号と境界値
+ */
+void test_bucket_layout(void) {
+    int ok = 1;
+    for (uint64_t v = 0; v < 100000; v++) {
+        uint32_t index = can_shm_hist_index(v);
+        if (v < can_shm_hist_lower_bound(index) || v > can_shm_hist_upper_bound(index)) {
+            ok = 0;
+            break;
+        }
+    }
+    TEST_ASSERT(ok, "Values fall within their bucket bounds");
+
+    // 相対誤差はバケット下限の1/8以下
+    ok = 1;
+    for (uint32_t i = CAN_SHM_HIST_SUB_COUNT; i + 1 < CAN_SHM_HIST_BUCKETS; i++) {
+        uint64_t lower = can_shm_hist_lower_bound(i);
+        uint64_t width = can_shm_hist_upper_bound(i) - lower + 1;
+        if (width * CAN_SHM_HIST_SUB_COUNT > lower || can_shm_hist_index(lower) != i) {
+            ok = 0;
+            break;
+        }
+    }
+    TEST_ASSERT(ok, "Bucket width bounded by 1/8 of lower bound");
+    TEST_ASSERT(can_shm_hist_index(UINT64_MAX) == CAN_SHM_HIST_BUCKETS - 1, "Largest value in last bucket");
+}
+
+/**
+ * パーセンタイル計算
+ */
+void test_percentile(void) {
+    memset(&g_hist, 0, sizeof(g_hist));
+    TEST_ASSERT(can_shm_hist_percentile(&g_hist, 50.0) == 0, "Empty histogram percentile is 0");
+
+    for (uint64_t v = 1; v <= 1000; v++) {
+        can_shm_hist_record(&g_hist, v * 1000);
+    }
+    uint64_t p50 = can_shm_hist_percentile(&g_hist, 50.0);
+    uint64_t p99 = can_shm_hist_percentile(&g_hist, 99.0);
+    printf("  p50=%llu p99=%llu max=%llu\n", (unsigned long long)p50, (unsigned long long)p99,
+           (unsigned long long)g_hist.max);
+    TEST_ASSERT(g_hist.count == 1000 && g_hist.max == 1000000 && g_hist.sum == 500500000ULL,
+                "Count, sum and max");
+    TEST_ASSERT(p50 >= 500000 && p50 <= 500000 + 500000 / 8, "p50 within bucket precision");
+    TEST_ASSERT(p99 >= 990000 && p99 <= 1000000, "p99 within bucket precision");
+    TEST_ASSERT(can_shm_hist_percentile(&g_hist, 100.0) == 1000000, "p100 is max");
+}
+
+/**
+ * 有効化と記録
+ */
+void test_enable_and_record(void) {
+    uint8_t data[8] = {0};
+
+    TEST_ASSERT(can_shm_hist_set_enabled(0, 1u << CAN_SHM_HIST_KINDS) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Unknown kind rejected");
+    TEST_ASSERT(can_shm_hist_set_enabled(CAN_SHM_MAX_BUSES, 0) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Invalid bus rejected");
+
+    // 既定は無効
+    can_shm_set(0x18EF0001, 8, data);
+    can_shm_hist_snapshot(0, CAN_SHM_HIST_SET_DURATION, &g_hist);
+    TEST_ASSERT(g_hist.count == 0, "Disabled by default");
+
+    TEST_ASSERT(can_shm_hist_set_enabled(0, (1u << CAN_SHM_HIST_SET_DURATION) |
+                                            (1u << CAN_SHM_HIST_READ_RETRIES)) == CAN_SHM_SUCCESS,
+                "Enable set duration and read retries");
+    for (int i = 0; i < 100; i++) {
+        data[0] = (uint8_t)i;
+        can_shm_set(0x18EF0001, 8, data);
+    }
+    CANData out;
+    for (int i = 0; i < 50; i++) {
+        can_shm_get(0x18EF0001, &out);
+    }
+
+    TEST_ASSERT(can_shm_hist_snapshot(0, CAN_SHM_HIST_SET_DURATION, &g_hist) == CAN_SHM_SUCCESS &&
+                g_hist.count == 100 && g_hist.max > 0, "Set durations recorded");
+    printf("  set p50=%lluns p99=%lluns max=%lluns\n",
+           (unsigned long long)can_shm_hist_percentile(&g_hist, 50.0),
+           (unsigned long long)can_shm_hist_percentile(&g_hist, 99.0),
+           (unsigned long long)g_hist.max);
+    can_shm_hist_snapshot(0, CAN_SHM_HIST_READ_RETRIES, &g_hist);
+    TEST_ASSERT(g_hist.count == 50 && g_hist.buckets[0] == 50, "Uncontended reads record zero retries");
+
+    // 他のバスには記録されない
+    can_shm_bus_set(1, 0x18EF0001, 8, data);
+    can_shm_hist_snapshot(1, CAN_SHM_HIST_SET_DURATION, &g_hist);
+    TEST_ASSERT(g_hist.count == 0, "Histograms are per bus");
+
+    TEST_ASSERT(can_shm_hist_reset(0) == CAN_SHM_SUCCESS, "Reset");
+    can_shm_hist_snapshot(0, CAN_SHM_HIST_SET_DURATION, &g_hist);
+    TEST_ASSERT(g_hist.count == 0 && g_hist.max == 0 && g_hist.sum == 0, "Reset clears histograms");
+    can_shm_hist_set_enabled(0, 0);
+}
+
+static void count_callback(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    (void)data;
+    __atomic_add_fetch((int*)user_data, 1, __ATOMIC_RELEASE);
+}
+
+// 配信を1件ずつ確認してから次を更新（負荷時に更新がまとめて配信されないよう、待ちは1件1秒まで）
+static void* producer_thread(void* arg) {
+    int* received = (int*)arg;
+    uint8_t data[8] = {0};
+    for (int i = 1; i <= 5; i++) {
+        usleep(5000);
+        data[0] = (uint8_t)i;
+        can_shm_set(0x18EF0002, 8, data);
+        for (int wait = 0; wait < 1000 && __atomic_load_n(received, __ATOMIC_ACQUIRE) < i; wait++) {
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+// 購読中（スロット解放前）に購読者別ヒストグラムを取得
+static void snapshot_callback(uint32_t can_id, const CANData* data, void* user_data) {
+    count_callback(can_id, data, user_data);
+    if (*(int*)user_data == 5 && g_slot < CAN_SHM_HIST_MAX_SUBSCRIBERS) {
+        can_shm_hist_subscriber_snapshot(0, g_slot, &g_sub_hist);
+    }
+}
+
+static void* subscriber_thread(void* arg) {
+    can_shm_subscribe_ex(0x18EF0002, 5, 1000, NULL, snapshot_callback, arg);
+    return NULL;
+}
+
+/**
+ * 購読者別の配信遅延
+ */
+void test_delivery(void) {
+    can_shm_hist_set_enabled(0, 1u << CAN_SHM_HIST_DELIVERY);
+
+    int received = 0;
+    pthread_t subscriber, producer;
+    pthread_create(&subscriber, NULL, subscriber_thread, &received);
+
+    // 購読中はスロットが確保されている（購読の開始を待つ、負荷時の起動遅れを見込んで上限1秒）
+    for (int wait = 0; wait < 1000 && g_slot >= CAN_SHM_HIST_MAX_SUBSCRIBERS; wait++) {
+        usleep(1000);
+        for (uint32_t i = 0; i < CAN_SHM_HIST_MAX_SUBSCRIBERS; i++) {
+            if (can_shm_hist_subscriber_snapshot(0, i, &g_sub_hist) == CAN_SHM_SUCCESS) {
+                g_slot = i;
+                break;
+            }
+        }
+    }
+    TEST_ASSERT(g_slot < CAN_SHM_HIST_MAX_SUBSCRIBERS && g_sub_hist.can_id == 0x18EF0002 &&
+                g_sub_hist.owner_pid == (uint32_t)getpid(), "Subscriber slot acquired");
+
+    pthread_create(&producer, NULL, producer_thread, &received);
+    pthread_join(producer, NULL);
+    pthread_join(subscriber, NULL);
+
+    TEST_ASSERT(received == 5 && g_sub_hist.hist.count == 5, "Per-subscriber delivery delays recorded");
+    printf("  delivery p50=%lluns max=%lluns\n",
+           (unsigned long long)can_shm_hist_percentile(&g_sub_hist.hist, 50.0),
+           (unsigned long long)g_sub_hist.hist.max);
+    can_shm_hist_snapshot(0, CAN_SHM_HIST_DELIVERY, &g_hist);
+    TEST_ASSERT(g_hist.count == 5, "Aggregate delivery delays recorded");
+    TEST_ASSERT(g_slot < CAN_SHM_HIST_MAX_SUBSCRIBERS &&
+                can_shm_hist_subscriber_snapshot(0, g_slot, &g_sub_hist) == CAN_SHM_ERROR_NOT_FOUND,
+                "Slot released after subscription ends");
+
+    can_shm_hist_set_enabled(0, 0);
+    can_shm_hist_reset(0);
+}
+
+int main(void) {
+    printf("Starting Latency Histogram Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_bucket_layout();
+    test_percentile();
+    test_enable_and_record();
+    test_delivery();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,175 @@
+#include "can_shm_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+static CANIdStats g_stats[MAX_CAN_ENTRIES];
+
+// 指定IDの診断カウンタを検索
+static const CANIdStats* find_stats(uint32_t bus, uint32_t can_id) {
+    uint32_t count = 0;
+    if (can_shm_bus_get_id_stats(bus, g_stats, MAX_CAN_ENTRIES, &count) != CAN_SHM_SUCCESS) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (g_stats[i].can_id == can_id) {
+            return &g_stats[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 更新回数・最終更新時刻
+ */
+void test_update_counters(void) {
+    uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (int i = 0; i < 10; i++) {
+        data[0] = (uint8_t)i;
+        can_shm_set(0x18EE0001, 8, data);
+    }
+
+    CANData latest;
+    can_shm_get(0x18EE0001, &latest);
+    const CANIdStats* stats = find_stats(0, 0x18EE0001);
+    TEST_ASSERT(stats != NULL, "Stored ID listed");
+    TEST_ASSERT(stats != NULL && stats->updates == 10 && stats->change_sequence == 10, "Update count");
+    TEST_ASSERT(stats != NULL && stats->timestamp == latest.timestamp && stats->dlc == 8,
+                "Last update timestamp and DLC");
+    TEST_ASSERT(stats != NULL && stats->bucket == can_id_hash(0x18EE0001), "Bucket index");
+
+    uint32_t count = 0;
+    TEST_ASSERT(can_shm_bus_get_id_stats(0, g_stats, 0, &count) == CAN_SHM_SUCCESS && count == 0,
+                "Empty output array");
+    TEST_ASSERT(can_shm_bus_get_id_stats(CAN_SHM_MAX_BUSES, g_stats, 1, &count) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Invalid bus rejected");
+}
+
+static void count_callback(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    (void)data;
+    __atomic_add_fetch((int*)user_data, 1, __ATOMIC_RELEASE);
+}
+
+// 配信を1件ずつ確認してから次を更新（負荷時に更新がまとめて配信されないよう、待ちは1件1秒まで）
+static void* producer_thread(void* arg) {
+    int* received = (int*)arg;
+    uint8_t data[8] = {0};
+    for (int i = 1; i <= 5; i++) {
+        usleep(5000);
+        data[0] = (uint8_t)i;
+        can_shm_set(0x18EE0002, 8, data);
+        for (int wait = 0; wait < 1000 && __atomic_load_n(received, __ATOMIC_ACQUIRE) < i; wait++) {
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 購読者の起床回数
+ */
+void test_wakeup_counter(void) {
+    uint8_t data[8] = {0};
+    can_shm_set(0x18EE0002, 8, data);
+    uint32_t before = find_stats(0, 0x18EE0002)->wakeups;
+
+    int received = 0;
+    pthread_t producer;
+    pthread_create(&producer, NULL, producer_thread, &received);
+    can_shm_subscribe_ex(0x18EE0002, 5, 1000, NULL, count_callback, &received);
+    pthread_join(producer, NULL);
+
+    const CANIdStats* stats = find_stats(0, 0x18EE0002);
+    TEST_ASSERT(received == 5 && stats != NULL && stats->wakeups - before == 5, "Subscriber wakeups counted");
+}
+
+// 読み取りスレッド（書き込み中のバケットでリトライさせる）
+static void* reader_thread(void* arg) {
+    CANData data;
+    can_shm_get(*(uint32_t*)arg, &data);
+    return NULL;
+}
+
+/**
+ * seqlockリトライ回数（書き込み中の状態を再現）
+ */
+void test_retry_counter(void) {
+    uint32_t can_id = 0x18EE0003;
+    uint8_t data[8] = {0};
+    can_shm_set(can_id, 8, data);
+    uint32_t before = find_stats(0, can_id)->read_retries;
+
+    // シーケンスを奇数にして書き込み中を再現
+    CANBucket* bucket = &g_shm_ptr->buckets[can_id_hash(can_id)];
+    uint32_t seq = __atomic_load_n(&bucket->can_data.sequence, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&bucket->can_data.sequence, seq + 1, __ATOMIC_RELEASE);
+
+    pthread_t reader;
+    pthread_create(&reader, NULL, reader_thread, &can_id);
+    // 読み取りスレッドがリトライするまで待つ（負荷で起動が遅れる場合があるため上限1秒）
+    for (int i = 0; i < 1000 && __atomic_load_n(&bucket->read_retries, __ATOMIC_RELAXED) == before; i++) {
+        usleep(1000);
+    }
+    __atomic_store_n(&bucket->can_data.sequence, seq, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+
+    const CANIdStats* stats = find_stats(0, can_id);
+    printf("  retries while write in progress: %u\n", stats ? stats->read_retries - before : 0);
+    TEST_ASSERT(stats != NULL && stats->read_retries > before, "Seqlock retries counted");
+
+    // リトライのない読み取りは加算しない
+    before = stats->read_retries;
+    CANData out;
+    for (int i = 0; i < 1000; i++) {
+        can_shm_get(can_id, &out);
+    }
+    TEST_ASSERT(find_stats(0, can_id)->read_retries == before, "Uncontended reads do not count");
+}
+
+int main(void) {
+    printf("Starting Per-ID Stats Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_update_counters();
+    test_wakeup_counter();
+    test_retry_counter();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
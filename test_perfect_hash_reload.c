@@ -0,0 +1,287 @@
+#include "can_shm_api.h"
+#include "can_shm_perfect_hash.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define COMMON_IDS 64
+#define EXTRA_IDS 400
+#define NUM_PUBLISHES 40
+#define NUM_READERS 2
+
+// 全ての版に含まれるID
+static uint32_t common_id(uint32_t i) {
+    return 0x18FE0000 + i * 0x101;
+}
+
+/**
+ * 既定のIDセット
+ */
+void test_default_set(void) {
+    uint8_t data[8] = {0x11};
+    CANData out;
+    CANPerfectHashInfo info;
+
+    TEST_ASSERT(can_shm_perfect_hash_get_info(&info) == CAN_SHM_SUCCESS &&
+                info.version == 1 && info.num_ids == PERFECT_HASH_NUM_CAN_IDS, "Demo set published on first use");
+    TEST_ASSERT(can_shm_set_perfect_hash(0x100, 8, data) == CAN_SHM_SUCCESS, "Set demo ID");
+    TEST_ASSERT(can_shm_get_perfect_hash(0x100, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x11, "Get demo ID");
+    TEST_ASSERT(can_shm_get_perfect_hash(0x101, &out) == CAN_SHM_ERROR_NOT_FOUND, "Unset demo ID not found");
+    TEST_ASSERT(can_shm_set_perfect_hash(0x500, 8, data) == CAN_SHM_ERROR_INVALID_ID, "ID outside the set rejected");
+    TEST_ASSERT(can_shm_perfect_hash_get_info(NULL) == CAN_SHM_ERROR_INVALID_PARAM, "NULL info rejected");
+}
+
+/**
+ * 新しいIDセットの公開と値の引き継ぎ
+ */
+void test_publish_carries_values(void) {
+    uint8_t data[8] = {0x22, 0x33};
+    CANData before, out;
+    can_shm_set_perfect_hash(0x200, 8, data);
+    can_shm_get_perfect_hash(0x200, &before);
+
+    // 0x100を除き、0x500番台を追加
+    uint32_t ids[PERFECT_HASH_NUM_CAN_IDS - 1 + 16];
+    uint32_t count = 0;
+    for (int i = 1; i < PERFECT_HASH_NUM_CAN_IDS; i++) {
+        ids[count++] = DEMO_CAN_IDS[i];
+    }
+    for (uint32_t i = 0; i < 16; i++) {
+        ids[count++] = 0x500 + i;
+    }
+
+    uint64_t start = can_shm_clock_monotonic_ns();
+    TEST_ASSERT(can_shm_perfect_hash_publish(ids, count) == CAN_SHM_SUCCESS, "Publish new ID set");
+    printf("  publish of %u IDs: %.1f us\n", count, (can_shm_clock_monotonic_ns() - start) / 1000.0);
+
+    CANPerfectHashInfo info;
+    can_shm_perfect_hash_get_info(&info);
+    TEST_ASSERT(info.version == 2 && info.num_ids == count && info.stored == 1, "Version and stored count updated");
+    TEST_ASSERT(can_shm_get_perfect_hash(0x200, &out) == CAN_SHM_SUCCESS &&
+                out.data[1] == 0x33 && out.timestamp == before.timestamp, "Value carried over unchanged");
+    TEST_ASSERT(can_shm_get_perfect_hash(0x100, &out) == CAN_SHM_ERROR_INVALID_ID, "Removed ID rejected");
+    TEST_ASSERT(can_shm_get_perfect_hash(0x505, &out) == CAN_SHM_ERROR_NOT_FOUND, "Added ID starts empty");
+    TEST_ASSERT(can_shm_set_perfect_hash(0x505, 8, data) == CAN_SHM_SUCCESS &&
+                can_shm_get_perfect_hash(0x505, &out) == CAN_SHM_SUCCESS, "Added ID usable");
+    TEST_ASSERT(can_shm_delete_perfect_hash(0x505) == CAN_SHM_SUCCESS &&
+                can_shm_get_perfect_hash(0x505, &out) == CAN_SHM_ERROR_NOT_FOUND, "Delete in new set");
+}
+
+/**
+ * 公開の入力検証と最大サイズのセット
+ */
+void test_publish_limits(void) {
+    CANPerfectHashInfo before, after;
+    can_shm_perfect_hash_get_info(&before);
+
+    uint32_t dup[3] = {0x100, 0x200, 0x100};
+    uint32_t bad[2] = {0x100, 0x20000000};
+    TEST_ASSERT(can_shm_perfect_hash_publish(dup, 3) == CAN_SHM_ERROR_INVALID_PARAM, "Duplicate IDs rejected");
+    TEST_ASSERT(can_shm_perfect_hash_publish(bad, 2) == CAN_SHM_ERROR_INVALID_ID, "Invalid ID rejected");
+    TEST_ASSERT(can_shm_perfect_hash_publish(dup, 0) == CAN_SHM_ERROR_INVALID_PARAM, "Empty set rejected");
+    TEST_ASSERT(can_shm_perfect_hash_publish(NULL, 1) == CAN_SHM_ERROR_INVALID_PARAM, "NULL set rejected");
+    TEST_ASSERT(can_shm_perfect_hash_publish(dup, CAN_SHM_PHASH_MAX_IDS + 1) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Oversized set rejected");
+    can_shm_perfect_hash_get_info(&after);
+    TEST_ASSERT(after.version == before.version, "Failed publishes leave the set unchanged");
+
+    // 29bit IDの最大数セット
+    uint32_t* ids = malloc(CAN_SHM_PHASH_MAX_IDS * sizeof(uint32_t));
+    srand(1234);
+    for (uint32_t i = 0; i < CAN_SHM_PHASH_MAX_IDS; i++) {
+        ids[i] = 0x10000000 + i * 4099 + (uint32_t)(rand() % 7);
+    }
+    uint64_t start = can_shm_clock_monotonic_ns();
+    CANShmResult result = can_shm_perfect_hash_publish(ids, CAN_SHM_PHASH_MAX_IDS);
+    double publish_us = (can_shm_clock_monotonic_ns() - start) / 1000.0;
+    can_shm_perfect_hash_get_info(&after);
+    printf("  publish of %d IDs: %.1f us (%u slots, %u groups)\n",
+           CAN_SHM_PHASH_MAX_IDS, publish_us, after.num_slots, after.num_groups);
+    TEST_ASSERT(result == CAN_SHM_SUCCESS, "Largest set built");
+
+    uint8_t data[8];
+    int wrong = 0;
+    for (uint32_t i = 0; i < CAN_SHM_PHASH_MAX_IDS; i++) {
+        memcpy(data, &ids[i], sizeof(ids[i]));
+        can_shm_set_perfect_hash(ids[i], 8, data);
+    }
+    CANData out;
+    for (uint32_t i = 0; i < CAN_SHM_PHASH_MAX_IDS; i++) {
+        uint32_t stored = 0;
+        if (can_shm_get_perfect_hash(ids[i], &out) == CAN_SHM_SUCCESS) {
+            memcpy(&stored, out.data, sizeof(stored));
+        }
+        wrong += stored != ids[i];
+    }
+    can_shm_perfect_hash_get_info(&after);
+    TEST_ASSERT(wrong == 0 && after.stored == CAN_SHM_PHASH_MAX_IDS, "Every ID has its own slot");
+    free(ids);
+}
+
+typedef struct {
+    volatile int stop;
+    uint64_t reads;
+    uint64_t errors;
+} ReaderContext;
+
+typedef struct {
+    volatile int stop;
+    uint32_t last[COMMON_IDS];   // 最後に書いた値
+} WriterContext;
+
+static void* reader_thread(void* arg) {
+    ReaderContext* ctx = (ReaderContext*)arg;
+    CANData out;
+    for (uint32_t i = 0; !ctx->stop; i = (i + 1) % COMMON_IDS) {
+        uint32_t stored;
+        if (can_shm_get_perfect_hash(common_id(i), &out) != CAN_SHM_SUCCESS) {
+            ctx->errors++;
+        } else {
+            memcpy(&stored, out.data, sizeof(stored));
+            if (out.can_id != common_id(i) || stored != out.data[4] * 0x01010101u) {
+                ctx->errors++;
+            }
+        }
+        ctx->reads++;
+    }
+    return NULL;
+}
+
+static void* writer_thread(void* arg) {
+    WriterContext* ctx = (WriterContext*)arg;
+    uint8_t data[8] = {0};
+    for (uint32_t n = 1; !ctx->stop; n++) {
+        uint32_t i = n % COMMON_IDS;
+        uint8_t tag = (uint8_t)(n >> 6);
+        uint32_t value = tag * 0x01010101u;
+        memcpy(data, &value, sizeof(value));
+        data[4] = tag;
+        can_shm_set_perfect_hash(common_id(i), 8, data);
+        ctx->last[i] = value;
+    }
+    return NULL;
+}
+
+/**
+ * 読み取り・書き込み中の公開の繰り返し
+ */
+void test_concurrent_reload(void) {
+    uint32_t ids[COMMON_IDS + EXTRA_IDS];
+    for (uint32_t i = 0; i < COMMON_IDS; i++) {
+        ids[i] = common_id(i);
+    }
+    can_shm_perfect_hash_publish(ids, COMMON_IDS);
+    uint8_t zero[8] = {0};
+    for (uint32_t i = 0; i < COMMON_IDS; i++) {
+        can_shm_set_perfect_hash(common_id(i), 8, zero);
+    }
+
+    ReaderContext readers[NUM_READERS];
+    WriterContext writer;
+    pthread_t reader_threads[NUM_READERS], writer_thread_id;
+    memset(readers, 0, sizeof(readers));
+    memset(&writer, 0, sizeof(writer));
+    for (int r = 0; r < NUM_READERS; r++) {
+        pthread_create(&reader_threads[r], NULL, reader_thread, &readers[r]);
+    }
+    pthread_create(&writer_thread_id, NULL, writer_thread, &writer);
+
+    // 版ごとに追加IDの数を変える（スロット数・変位が変わる）
+    int failures = 0;
+    uint64_t max_ns = 0;
+    for (uint32_t p = 0; p < NUM_PUBLISHES; p++) {
+        uint32_t extra = (p * 37) % EXTRA_IDS;
+        for (uint32_t i = 0; i < extra; i++) {
+            ids[COMMON_IDS + i] = 0x0C000000 + p * 0x10000 + i;
+        }
+        uint64_t start = can_shm_clock_monotonic_ns();
+        failures += can_shm_perfect_hash_publish(ids, COMMON_IDS + extra) != CAN_SHM_SUCCESS;
+        uint64_t elapsed = can_shm_clock_monotonic_ns() - start;
+        if (elapsed > max_ns) {
+            max_ns = elapsed;
+        }
+        usleep(1000);
+    }
+
+    writer.stop = 1;
+    pthread_join(writer_thread_id, NULL);
+    uint64_t reads = 0, errors = 0;
+    for (int r = 0; r < NUM_READERS; r++) {
+        readers[r].stop = 1;
+        pthread_join(reader_threads[r], NULL);
+        reads += readers[r].reads;
+        errors += readers[r].errors;
+    }
+
+    printf("  %d publishes (max %.1f us), %llu reads, %llu errors\n", NUM_PUBLISHES, max_ns / 1000.0,
+           (unsigned long long)reads, (unsigned long long)errors);
+    TEST_ASSERT(failures == 0, "All publishes succeed");
+    TEST_ASSERT(errors == 0, "Readers never miss or see torn values across publishes");
+
+    int lost = 0;
+    CANData out;
+    for (uint32_t i = 0; i < COMMON_IDS; i++) {
+        uint32_t stored = 0;
+        if (can_shm_get_perfect_hash(common_id(i), &out) == CAN_SHM_SUCCESS) {
+            memcpy(&stored, out.data, sizeof(stored));
+        }
+        lost += stored != writer.last[i];
+    }
+    TEST_ASSERT(lost == 0, "No set lost across publishes");
+}
+
+int main(void) {
+    printf("Starting Perfect Hash Reload Tests...\n\n");
+
+    // テスト専用のセグメントで空のテーブルから始める（IDセットの公開は他のテストに見せない）
+    char segment_path[256];
+    snprintf(segment_path, sizeof(segment_path), "/tmp/can_shm_test_perfect_hash_reload.%d", (int)getpid());
+    unlink(segment_path);
+
+    CANShmInitOptions options = {.backing_path = segment_path};
+    if (can_shm_init_ex(&options) != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_default_set();
+    test_publish_carries_values();
+    test_publish_limits();
+    test_concurrent_reload();
+
+    can_shm_cleanup();
+    unlink(segment_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,166 @@
+#include "can_shm_api.h"
+#include "can_shm_linear_probing.h"
+#include "can_shm_presence.h"
+#include "can_shm_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define NUM_EXT_IDS 2000
+#define NUM_PROBES 100000
+
+// テスト専用のセグメント（並行して走る他のテストのセグメントには触れない）
+static char g_segment_path[256];
+
+static void remove_segments(void) {
+    char name[300];
+    unlink(g_segment_path);
+    for (uint32_t bus = 1; bus <= 2; bus++) {
+        snprintf(name, sizeof(name), "%s.bus%u", g_segment_path, bus);
+        unlink(name);
+    }
+}
+
+/**
+ * 11bit IDのビットマップ
+ */
+void test_standard_ids(void) {
+    uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    CANData out;
+
+    TEST_ASSERT(!can_shm_presence_maybe(g_shm_ptr, 0x123), "Unused standard ID absent");
+    can_shm_set(0x123, 8, data);
+    TEST_ASSERT(can_shm_presence_maybe(g_shm_ptr, 0x123), "Standard ID present after set");
+    TEST_ASSERT(!can_shm_presence_maybe(g_shm_ptr, 0x124), "Neighbouring ID still absent");
+    TEST_ASSERT(can_shm_get(0x123, &out) == CAN_SHM_SUCCESS && out.data[7] == 8, "Get of present ID");
+    TEST_ASSERT(can_shm_get(0x124, &out) == CAN_SHM_ERROR_NOT_FOUND, "Get of absent ID");
+
+    CANPresenceInfo info;
+    TEST_ASSERT(can_shm_presence_get_info(0, &info) == CAN_SHM_SUCCESS && info.std_ids == 1, "Info counts standard IDs");
+
+    // リニアプロービングの削除でビットを落とす
+    can_shm_set_linear_probing(0x456, 8, data);
+    TEST_ASSERT(can_shm_delete_linear_probing(0x456) == CAN_SHM_SUCCESS &&
+                !can_shm_presence_maybe(g_shm_ptr, 0x456), "Delete clears standard ID");
+}
+
+/**
+ * 29bit IDのBloomフィルタ（偽陰性なし・偽陽性率）
+ */
+void test_extended_ids(void) {
+    uint8_t data[8] = {0};
+    for (uint32_t i = 0; i < NUM_EXT_IDS; i++) {
+        can_shm_set_linear_probing(0x18000000 + i * 7, 8, data);
+    }
+
+    int missing = 0;
+    for (uint32_t i = 0; i < NUM_EXT_IDS; i++) {
+        if (!can_shm_presence_maybe(g_shm_ptr, 0x18000000 + i * 7)) {
+            missing++;
+        }
+    }
+    TEST_ASSERT(missing == 0, "No false negatives");
+
+    int false_positives = 0;
+    for (uint32_t i = 0; i < NUM_PROBES; i++) {
+        if (can_shm_presence_maybe(g_shm_ptr, 0x10000000 + i)) {
+            false_positives++;
+        }
+    }
+    CANPresenceInfo info;
+    can_shm_presence_get_info(0, &info);
+    double rate = (double)false_positives / NUM_PROBES;
+    printf("  %d IDs: %u/%u bits set, false positive rate %.3f%% (estimate %.3f%%)\n",
+           NUM_EXT_IDS, info.bloom_bits_set, info.bloom_bits_total, rate * 100.0,
+           info.bloom_false_positive_rate * 100.0);
+    TEST_ASSERT(rate < 0.02, "False positive rate below 2%");
+
+    TEST_ASSERT(can_shm_presence_get_info(CAN_SHM_MAX_BUSES, &info) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Invalid bus rejected");
+    TEST_ASSERT(can_shm_presence_get_info(0, NULL) == CAN_SHM_ERROR_INVALID_PARAM, "NULL info rejected");
+}
+
+/**
+ * 長い探査チェーンでの未登録IDの検索
+ */
+void test_probe_chain_miss(void) {
+    CANData out;
+    uint64_t start = can_shm_clock_monotonic_ns();
+    int not_found = 0;
+    for (uint32_t i = 0; i < NUM_PROBES; i++) {
+        if (can_shm_get_linear_probing(0x10000000 + i, &out) == CAN_SHM_ERROR_NOT_FOUND) {
+            not_found++;
+        }
+    }
+    double ns = (double)(can_shm_clock_monotonic_ns() - start) / NUM_PROBES;
+    printf("  linear probing miss: %.1f ns/lookup (%d IDs in table)\n", ns, NUM_EXT_IDS);
+    TEST_ASSERT(not_found == NUM_PROBES, "All unknown IDs reported as not found");
+
+    TEST_ASSERT(can_shm_get_linear_probing(0x18000000 + 7 * 10, &out) == CAN_SHM_SUCCESS,
+                "Known ID still found through probe chain");
+}
+
+/**
+ * バスごとに独立したフィルタ
+ */
+void test_per_bus(void) {
+    uint8_t data[8] = {0x42};
+    CANData out;
+    can_shm_bus_set(1, 0x1ABCDEF0, 8, data);
+    TEST_ASSERT(can_shm_bus_get(1, 0x1ABCDEF0, &out) == CAN_SHM_SUCCESS, "Bus 1 ID found");
+    TEST_ASSERT(can_shm_presence_maybe(can_shm_bus_segment(1), 0x1ABCDEF0), "Bus 1 filter updated");
+    TEST_ASSERT(can_shm_bus_get(2, 0x1ABCDEF0, &out) == CAN_SHM_ERROR_NOT_FOUND, "Bus 2 unaffected");
+}
+
+int main(void) {
+    printf("Starting Presence Filter Tests...\n\n");
+
+    // 空のテーブルから始める
+    snprintf(g_segment_path, sizeof(g_segment_path), "/tmp/can_shm_test_presence.%d", (int)getpid());
+    remove_segments();
+
+    CANShmInitOptions options = {.backing_path = g_segment_path};
+    if (can_shm_init_ex(&options) != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_standard_ids();
+    test_extended_ids();
+    test_probe_chain_miss();
+    test_per_bus();
+
+    can_shm_cleanup();
+    remove_segments();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,228 @@
+#include "can_shm_api.h"
+#include "can_shm_queue.h"
+#include "can_shm_linear_probing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+// 連番データの送信
+static void send_counter(uint32_t can_id, uint32_t counter) {
+    uint8_t data[8] = {0};
+    memcpy(data, &counter, sizeof(counter));
+    can_shm_set(can_id, 8, data);
+}
+
+static uint32_t frame_counter(const CANData* frame) {
+    uint32_t counter;
+    memcpy(&counter, frame->data, sizeof(counter));
+    return counter;
+}
+
+/**
+ * 順序どおりの全件受信と満杯時のドロップ
+ */
+void test_queue_lossless_and_overrun(void) {
+    CANQueueHandle handle;
+    TEST_ASSERT(can_shm_queue_subscribe(0x570, &handle) == CAN_SHM_SUCCESS, "Subscribe queue");
+
+    // キュー容量以内なら読み出しが遅れても全件届く
+    for (uint32_t i = 1; i <= 200; i++) {
+        send_counter(0x570, i);
+    }
+    CANData out[CAN_SHM_QUEUE_SIZE];
+    uint32_t count = 0;
+    TEST_ASSERT(can_shm_queue_receive(&handle, out, CAN_SHM_QUEUE_SIZE, 0, &count) == CAN_SHM_SUCCESS &&
+                count == 200, "All queued frames received");
+    int in_order = 1;
+    for (uint32_t i = 0; i < count; i++) {
+        if (out[i].can_id != 0x570 || frame_counter(&out[i]) != i + 1) {
+            in_order = 0;
+        }
+    }
+    TEST_ASSERT(in_order, "Frames received in order");
+
+    // 容量超過分は破棄されoverrunsに計上
+    for (uint32_t i = 1; i <= CAN_SHM_QUEUE_SIZE + 44; i++) {
+        send_counter(0x570, i);
+    }
+    uint64_t overruns = 0;
+    can_shm_queue_get_overruns(&handle, &overruns);
+    TEST_ASSERT(overruns == 44, "Overruns counted when queue full");
+
+    // 分割受信（リング終端での折り返しを含む）
+    uint32_t total = 0;
+    uint32_t expected = 1;
+    int sequential = 1;
+    while (can_shm_queue_receive(&handle, out, 100, 0, &count) == CAN_SHM_SUCCESS) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (frame_counter(&out[i]) != expected++) {
+                sequential = 0;
+            }
+        }
+        total += count;
+    }
+    TEST_ASSERT(total == CAN_SHM_QUEUE_SIZE && sequential, "Batch drain keeps oldest frames in order");
+    TEST_ASSERT(can_shm_queue_receive(&handle, out, 100, 20, &count) == CAN_SHM_ERROR_TIMEOUT &&
+                count == 0, "Empty queue times out");
+
+    TEST_ASSERT(can_shm_queue_unsubscribe(&handle) == CAN_SHM_SUCCESS, "Unsubscribe queue");
+    TEST_ASSERT(can_shm_queue_receive(&handle, out, 100, 0, &count) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Released handle rejected");
+}
+
+/**
+ * 複数購読者への配信とホームバケットを共有する別IDの分離
+ */
+void test_queue_fanout(void) {
+    // 0x580と同じバケットにハッシュされる別IDを探す
+    uint32_t other = 0x581;
+    while (can_id_hash(other) != can_id_hash(0x580)) {
+        other++;
+    }
+
+    CANQueueHandle a, b, c;
+    can_shm_queue_subscribe(0x580, &a);
+    can_shm_queue_subscribe(0x580, &b);
+    can_shm_queue_subscribe(other, &c);
+
+    for (uint32_t i = 1; i <= 10; i++) {
+        send_counter(0x580, i);
+    }
+    send_counter(other, 99);
+
+    CANData out[16];
+    uint32_t count_a = 0, count_b = 0, count_c = 0;
+    can_shm_queue_receive(&a, out, 16, 0, &count_a);
+    can_shm_queue_receive(&b, out, 16, 0, &count_b);
+    TEST_ASSERT(count_a == 10 && count_b == 10, "Every subscriber receives every update");
+    can_shm_queue_receive(&c, out, 16, 0, &count_c);
+    TEST_ASSERT(count_c == 1 && out[0].can_id == other && frame_counter(&out[0]) == 99,
+                "Subscriber on shared bucket receives only its own ID");
+
+    // リニアプロービングのSetもキューへ配信される
+    uint8_t data[8] = {7};
+    can_shm_set_linear_probing(other, 8, data);
+    TEST_ASSERT(can_shm_queue_receive(&c, out, 16, 0, &count_c) == CAN_SHM_SUCCESS && count_c == 1 &&
+                out[0].data[0] == 7, "Linear probing set delivered to queue");
+
+    can_shm_queue_unsubscribe(&a);
+    can_shm_queue_unsubscribe(&b);
+    can_shm_queue_unsubscribe(&c);
+}
+
+// 別スレッドでの送信（読み出し側と並行）
+#define STREAM_FRAMES 20000
+
+static void* producer_thread(void* arg) {
+    (void)arg;
+    for (uint32_t i = 1; i <= STREAM_FRAMES; i++) {
+        send_counter(0x590, i);
+    }
+    return NULL;
+}
+
+/**
+ * 送信と並行した受信（欠落は全てoverrunsに計上される）
+ */
+void test_queue_concurrent(void) {
+    CANQueueHandle handle;
+    can_shm_queue_subscribe(0x590, &handle);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer_thread, NULL);
+
+    CANData out[64];
+    uint32_t received = 0;
+    uint32_t last = 0;
+    int increasing = 1;
+    uint32_t count;
+    while (can_shm_queue_receive(&handle, out, 64, 200, &count) == CAN_SHM_SUCCESS) {
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t counter = frame_counter(&out[i]);
+            if (counter <= last) {
+                increasing = 0;
+            }
+            last = counter;
+        }
+        received += count;
+    }
+    pthread_join(thread, NULL);
+
+    uint64_t overruns = 0;
+    can_shm_queue_get_overruns(&handle, &overruns);
+    printf("  concurrent: %u received, %llu overruns\n", received, (unsigned long long)overruns);
+    TEST_ASSERT(increasing, "Concurrent frames received in order");
+    TEST_ASSERT(received + overruns == STREAM_FRAMES, "Every frame received or counted as overrun");
+
+    can_shm_queue_unsubscribe(&handle);
+}
+
+/**
+ * キュー数上限
+ */
+void test_queue_limit(void) {
+    CANQueueHandle handles[CAN_SHM_MAX_QUEUES];
+    uint32_t acquired = 0;
+    while (acquired < CAN_SHM_MAX_QUEUES &&
+           can_shm_queue_subscribe(0x5A0, &handles[acquired]) == CAN_SHM_SUCCESS) {
+        acquired++;
+    }
+    CANQueueHandle extra;
+    TEST_ASSERT(acquired == CAN_SHM_MAX_QUEUES &&
+                can_shm_queue_subscribe(0x5A0, &extra) == CAN_SHM_ERROR_NOT_FOUND,
+                "Subscribe fails when all queues in use");
+    for (uint32_t i = 0; i < acquired; i++) {
+        can_shm_queue_unsubscribe(&handles[i]);
+    }
+    TEST_ASSERT(g_shm_ptr->buckets[can_id_hash(0x5A0)].queue_mask == 0, "Queue mask cleared");
+    TEST_ASSERT(can_shm_queue_subscribe(CAN_ID_MAX + 1, &extra) == CAN_SHM_ERROR_INVALID_ID,
+                "Invalid CAN ID rejected");
+}
+
+int main(void) {
+    printf("Starting Subscriber Queue Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_queue_lossless_and_overrun();
+    test_queue_fanout();
+    test_queue_concurrent();
+    test_queue_limit();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
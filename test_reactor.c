@@ -0,0 +1,349 @@
+#include "can_shm_api.h"
+#include "can_shm_reactor.h"
+#include "can_shm_linear_probing.h"
+#include "can_shm_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define MANY_BASE_ID 0x18E00000u
+#define MANY_COUNT 2000
+#define UPDATE_STRIDE 100
+
+// 連番データの送信
+static void send_counter(uint32_t can_id, uint32_t counter) {
+    uint8_t data[8] = {0};
+    memcpy(data, &counter, sizeof(counter));
+    can_shm_set(can_id, 8, data);
+}
+
+// リニアプロービングでの連番データの送信
+static void send_counter_probing(uint32_t can_id, uint32_t counter) {
+    uint8_t data[8] = {0};
+    memcpy(data, &counter, sizeof(counter));
+    can_shm_set_linear_probing(can_id, 8, data);
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint32_t frame_counter(const CANData* frame) {
+    uint32_t counter;
+    memcpy(&counter, frame->data, sizeof(counter));
+    return counter;
+}
+
+// 購読ごとの受信記録
+typedef struct {
+    uint32_t can_id;
+    uint32_t calls;
+    uint32_t last_counter;
+    int mismatched;
+} Receiver;
+
+static void on_receive(uint32_t can_id, const CANData* data, void* user_data) {
+    Receiver* receiver = (Receiver*)user_data;
+    if (can_id != receiver->can_id || data->can_id != can_id) {
+        receiver->mismatched = 1;
+    }
+    receiver->calls++;
+    receiver->last_counter = frame_counter(data);
+}
+
+/**
+ * 1スレッドで多数の購読へ配信（更新のあった購読のみ走査）
+ */
+void test_reactor_many_subscriptions(void) {
+    static Receiver receivers[MANY_COUNT];
+    CANReactor* reactor = NULL;
+    TEST_ASSERT(can_shm_reactor_create(0, &reactor) == CAN_SHM_SUCCESS, "Create reactor");
+
+    // 事前に全IDを格納しておき、登録時に格納バケットを確定させる
+    int added = 1;
+    for (uint32_t i = 0; i < MANY_COUNT; i++) {
+        send_counter(MANY_BASE_ID + i, 0);
+        receivers[i].can_id = MANY_BASE_ID + i;
+        if (can_shm_reactor_add(reactor, MANY_BASE_ID + i, on_receive, &receivers[i]) != CAN_SHM_SUCCESS) {
+            added = 0;
+        }
+    }
+    TEST_ASSERT(added, "Add thousands of subscriptions");
+
+    uint32_t dispatched = 0;
+    TEST_ASSERT(can_shm_reactor_poll(reactor, 0, &dispatched) == CAN_SHM_ERROR_TIMEOUT && dispatched == 0,
+                "No dispatch before updates");
+
+    CANReactorStats before;
+    can_shm_reactor_get_stats(reactor, &before);
+
+    // 一部のIDのみ更新
+    for (uint32_t i = 0; i < MANY_COUNT; i += UPDATE_STRIDE) {
+        send_counter(MANY_BASE_ID + i, i + 1);
+    }
+    TEST_ASSERT(can_shm_reactor_poll(reactor, 100, &dispatched) == CAN_SHM_SUCCESS &&
+                dispatched == MANY_COUNT / UPDATE_STRIDE, "Only updated subscriptions dispatched");
+
+    int correct = 1;
+    for (uint32_t i = 0; i < MANY_COUNT; i++) {
+        uint32_t expected_calls = (i % UPDATE_STRIDE == 0) ? 1 : 0;
+        if (receivers[i].calls != expected_calls || receivers[i].mismatched ||
+            (expected_calls && receivers[i].last_counter != i + 1)) {
+            correct = 0;
+        }
+    }
+    TEST_ASSERT(correct, "Each callback received its own frame");
+
+    CANReactorStats stats;
+    can_shm_reactor_get_stats(reactor, &stats);
+    uint64_t entries_scanned = stats.entries_scanned - before.entries_scanned;
+    printf("  %d updates: groups_scanned=%llu entries_scanned=%llu of %d subscriptions\n",
+           MANY_COUNT / UPDATE_STRIDE, (unsigned long long)(stats.groups_scanned - before.groups_scanned),
+           (unsigned long long)entries_scanned, MANY_COUNT);
+    TEST_ASSERT(entries_scanned < MANY_COUNT / 2, "Dirty-group scan skips unchanged subscriptions");
+
+    can_shm_reactor_destroy(reactor);
+}
+
+/**
+ * 同一IDへの複数登録と削除
+ */
+void test_reactor_add_remove(void) {
+    CANReactor* reactor = NULL;
+    can_shm_reactor_create(0, &reactor);
+
+    Receiver first = {0x18E10000, 0, 0, 0};
+    Receiver second = {0x18E10000, 0, 0, 0};
+    can_shm_reactor_add(reactor, 0x18E10000, on_receive, &first);
+    can_shm_reactor_add(reactor, 0x18E10000, on_receive, &second);
+
+    send_counter(0x18E10000, 1);
+    uint32_t dispatched = 0;
+    can_shm_reactor_poll(reactor, 100, &dispatched);
+    TEST_ASSERT(dispatched == 2 && first.calls == 1 && second.calls == 1, "Multiple callbacks per ID");
+
+    TEST_ASSERT(can_shm_reactor_remove(reactor, 0x18E10000, on_receive, &first) == CAN_SHM_SUCCESS,
+                "Remove subscription");
+    TEST_ASSERT(can_shm_reactor_remove(reactor, 0x18E10000, on_receive, &first) == CAN_SHM_ERROR_NOT_FOUND,
+                "Remove unknown subscription");
+
+    send_counter(0x18E10000, 2);
+    can_shm_reactor_poll(reactor, 100, &dispatched);
+    TEST_ASSERT(dispatched == 1 && first.calls == 1 && second.calls == 2 && second.last_counter == 2,
+                "Removed callback not called");
+
+    // 削除済みエントリの再利用
+    Receiver third = {0x18E10000, 0, 0, 0};
+    can_shm_reactor_add(reactor, 0x18E10000, on_receive, &third);
+    send_counter(0x18E10000, 3);
+    can_shm_reactor_poll(reactor, 100, &dispatched);
+    TEST_ASSERT(dispatched == 2 && third.calls == 1 && third.last_counter == 3, "Re-added subscription called");
+
+    TEST_ASSERT(can_shm_reactor_add(reactor, CAN_ID_MAX + 1, on_receive, &third) == CAN_SHM_ERROR_INVALID_ID,
+                "Invalid CAN ID rejected");
+    can_shm_reactor_destroy(reactor);
+}
+
+/**
+ * 未格納のIDへの登録後、ホーム位置が衝突してリニアプロービングで移動した格納
+ */
+void test_reactor_add_before_store(void) {
+    // ホーム位置が同じで、どちらも未格納のIDの組を探す
+    // （MANY_BASE_ID の購読が埋めていない前半のバケットを使い、拡張領域に入らないようにする）
+    uint32_t first_id = 0, second_id = 0;
+    CANData current;
+    for (uint32_t a = 0x00100000; a < 0x00100000 + MAX_CAN_ENTRIES && second_id == 0; a++) {
+        if (can_shm_get_linear_probing(a, &current) != CAN_SHM_ERROR_NOT_FOUND) {
+            continue;
+        }
+        for (uint32_t b = a + 1; b < a + 64 * MAX_CAN_ENTRIES; b++) {
+            if (can_id_hash(b) == can_id_hash(a) && can_shm_get_linear_probing(b, &current) == CAN_SHM_ERROR_NOT_FOUND) {
+                first_id = a;
+                second_id = b;
+                break;
+            }
+        }
+    }
+    TEST_ASSERT(second_id != 0, "Colliding unstored IDs found");
+
+    CANExtInfo ext_before, ext_after;
+    can_shm_ext_get_info(&ext_before);
+
+    CANReactor* reactor = NULL;
+    can_shm_reactor_create(0, &reactor);
+    Receiver receiver = {second_id, 0, 0, 0};
+    TEST_ASSERT(can_shm_reactor_add(reactor, second_id, on_receive, &receiver) == CAN_SHM_SUCCESS,
+                "Add subscription before first store");
+
+    // 先に同じホーム位置の別IDが格納され、登録したIDは後続のバケットへ移る
+    send_counter_probing(first_id, 1);
+    uint32_t dispatched = 0;
+    can_shm_reactor_poll(reactor, 0, &dispatched);
+    TEST_ASSERT(dispatched == 0 && receiver.calls == 0, "Colliding ID not delivered");
+
+    send_counter_probing(second_id, 2);
+    can_shm_ext_get_info(&ext_after);
+    TEST_ASSERT(ext_after.entries == ext_before.entries, "Colliding IDs stored in main table");
+    can_shm_reactor_poll(reactor, 100, &dispatched);
+    TEST_ASSERT(dispatched == 1 && receiver.calls == 1 && receiver.last_counter == 2 &&
+                !receiver.mismatched, "First store after probing delivered");
+
+    send_counter_probing(second_id, 3);
+    send_counter_probing(first_id, 4);
+    can_shm_reactor_poll(reactor, 100, &dispatched);
+    TEST_ASSERT(receiver.calls == 2 && receiver.last_counter == 3 && !receiver.mismatched,
+                "Later updates delivered from probed bucket");
+
+    can_shm_delete_linear_probing(first_id);
+    can_shm_delete_linear_probing(second_id);
+    can_shm_reactor_destroy(reactor);
+}
+
+/**
+ * タイムアウト
+ */
+void test_reactor_timeout(void) {
+    CANReactor* reactor = NULL;
+    can_shm_reactor_create(0, &reactor);
+    Receiver receiver = {0x18E20000, 0, 0, 0};
+    can_shm_reactor_add(reactor, 0x18E20000, on_receive, &receiver);
+
+    uint64_t start = now_us();
+    CANShmResult result = can_shm_reactor_poll(reactor, 50, NULL);
+    uint64_t elapsed_us = now_us() - start;
+    TEST_ASSERT(result == CAN_SHM_ERROR_TIMEOUT && elapsed_us >= 45000, "Poll times out without updates");
+
+    can_shm_reactor_destroy(reactor);
+}
+
+// run() の停止用
+typedef struct {
+    CANReactor* reactor;
+    uint32_t calls;
+} StopContext;
+
+static void stop_after_three(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    (void)data;
+    StopContext* ctx = (StopContext*)user_data;
+    if (++ctx->calls == 3) {
+        can_shm_reactor_stop(ctx->reactor);
+    }
+}
+
+static void* producer_thread(void* arg) {
+    (void)arg;
+    for (uint32_t i = 1; i <= 3; i++) {
+        usleep(10000);
+        send_counter(0x18E30000, i);
+    }
+    return NULL;
+}
+
+/**
+ * 別スレッドの更新を run() で配信し、コールバック内から停止
+ */
+void test_reactor_run(void) {
+    StopContext ctx = {NULL, 0};
+    can_shm_reactor_create(0, &ctx.reactor);
+    can_shm_reactor_add(ctx.reactor, 0x18E30000, stop_after_three, &ctx);
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, producer_thread, NULL);
+    CANShmResult result = can_shm_reactor_run(ctx.reactor);
+    pthread_join(producer, NULL);
+
+    CANReactorStats stats;
+    can_shm_reactor_get_stats(ctx.reactor, &stats);
+    TEST_ASSERT(result == CAN_SHM_SUCCESS && ctx.calls == 3, "Run dispatches until stopped");
+    TEST_ASSERT(stats.wakeups >= 3, "Run wakes on update notification");
+    can_shm_reactor_destroy(ctx.reactor);
+}
+
+#define RACE_ID 0x18E40000u
+#define RACE_UPDATES 20000
+
+static void* race_writer(void* arg) {
+    (void)arg;
+    for (uint32_t i = 1; i <= RACE_UPDATES; i++) {
+        send_counter(RACE_ID, i);
+    }
+    return NULL;
+}
+
+/**
+ * 書き込みと並行したpollで最後の更新を取りこぼさない
+ */
+void test_reactor_concurrent_writer(void) {
+    CANReactor* reactor;
+    can_shm_reactor_create(0, &reactor);
+    Receiver receiver = {RACE_ID, 0, 0, 0};
+    can_shm_reactor_add(reactor, RACE_ID, on_receive, &receiver);
+
+    pthread_t writer;
+    pthread_create(&writer, NULL, race_writer, NULL);
+    uint64_t deadline = now_us() + 10000000ULL;
+    while (receiver.last_counter != RACE_UPDATES && now_us() < deadline) {
+        can_shm_reactor_poll(reactor, 100, NULL);
+    }
+    pthread_join(writer, NULL);
+
+    printf("  %u updates, %u callbacks, last counter %u\n",
+           RACE_UPDATES, receiver.calls, receiver.last_counter);
+    TEST_ASSERT(receiver.last_counter == RACE_UPDATES && !receiver.mismatched,
+                "Last update delivered while polling concurrently");
+    can_shm_reactor_destroy(reactor);
+}
+
+int main(void) {
+    printf("Starting Subscription Reactor Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_reactor_many_subscriptions();
+    test_reactor_add_remove();
+    test_reactor_add_before_store();
+    test_reactor_timeout();
+    test_reactor_run();
+    test_reactor_concurrent_writer();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,222 @@
+#include "can_shm_api.h"
+#include "can_shm_read_cache.h"
+#include "can_shm_linear_probing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define HOT_IDS 12
+#define BENCH_LOOPS 100000
+
+// テスト専用のセグメント（並行して走る他のテストのセグメントには触れない）
+static char g_segment_path[256];
+
+// セグメントを破棄して空のテーブルで開き直す
+static CANShmResult recreate_segment(void) {
+    can_shm_cleanup();
+    unlink(g_segment_path);
+    CANShmInitOptions options = {.backing_path = g_segment_path};
+    return can_shm_init_ex(&options);
+}
+
+/**
+ * ヒット・ミスと更新の検出
+ */
+void test_hit_and_update(void) {
+    uint8_t data[8] = {0x10};
+    CANData out;
+    CANReadCacheStats stats;
+
+    can_shm_read_cache_enable(1);
+    can_shm_read_cache_reset_stats();
+    can_shm_set(0x100, 8, data);
+
+    TEST_ASSERT(can_shm_get(0x100, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x10, "First get");
+    TEST_ASSERT(can_shm_get(0x100, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x10, "Repeated get");
+    can_shm_read_cache_get_stats(&stats);
+    TEST_ASSERT(stats.hits == 1 && stats.misses == 1, "Second get served from cache");
+
+    data[0] = 0x20;
+    can_shm_set(0x100, 8, data);
+    TEST_ASSERT(can_shm_get(0x100, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x20, "Update seen through cache");
+    can_shm_read_cache_get_stats(&stats);
+    TEST_ASSERT(stats.hits == 1 && stats.misses == 2, "Update counted as miss");
+
+    // 同じバケットを別IDが上書き
+    uint32_t other = 0x101;
+    while (can_id_hash(other) != can_id_hash(0x100)) {
+        other++;
+    }
+    can_shm_get(0x100, &out);
+    can_shm_set(other, 8, data);
+    TEST_ASSERT(can_shm_get(0x100, &out) == CAN_SHM_ERROR_NOT_FOUND, "Overwritten bucket not served from cache");
+
+    // 削除
+    can_shm_set(0x200, 8, data);
+    can_shm_get(0x200, &out);
+    can_shm_delete_linear_probing(0x200);
+    TEST_ASSERT(can_shm_get(0x200, &out) == CAN_SHM_ERROR_NOT_FOUND, "Deleted ID not served from cache");
+
+    // 無効化中は参照しない
+    can_shm_read_cache_enable(0);
+    can_shm_read_cache_reset_stats();
+    can_shm_set(0x300, 8, data);
+    can_shm_get(0x300, &out);
+    can_shm_get(0x300, &out);
+    can_shm_read_cache_get_stats(&stats);
+    TEST_ASSERT(stats.hits == 0 && stats.misses == 0, "Disabled cache untouched");
+
+    TEST_ASSERT(can_shm_read_cache_get_stats(NULL) == CAN_SHM_ERROR_INVALID_PARAM, "NULL stats rejected");
+}
+
+/**
+ * セグメント再作成後に古い値を返さない
+ */
+void test_remap(void) {
+    uint8_t data[8] = {0x01};
+    CANData out;
+    can_shm_read_cache_enable(1);
+    can_shm_set(0x400, 8, data);
+    can_shm_get(0x400, &out);
+
+    // 新しいセグメントでも同じシーケンス値になる
+    recreate_segment();
+    data[0] = 0x02;
+    can_shm_set(0x400, 8, data);
+    TEST_ASSERT(can_shm_get(0x400, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x02, "No stale value after remap");
+}
+
+typedef struct {
+    volatile int stop;
+} WriterContext;
+
+static void* writer_thread(void* arg) {
+    WriterContext* ctx = (WriterContext*)arg;
+    uint8_t data[8];
+    for (uint32_t i = 0; !ctx->stop; i++) {
+        memset(data, (int)(i & 0xFF), sizeof(data));
+        can_shm_set(0x500, 8, data);
+    }
+    return NULL;
+}
+
+/**
+ * 並行書き込み中の一貫性
+ */
+void test_concurrent_writer(void) {
+    uint8_t seed[8] = {0};
+    can_shm_set(0x500, 8, seed);
+
+    WriterContext ctx = {0};
+    pthread_t writer;
+    pthread_create(&writer, NULL, writer_thread, &ctx);
+
+    int torn = 0;
+    CANData out;
+    for (int i = 0; i < 200000; i++) {
+        can_shm_get(0x500, &out);
+        for (int b = 1; b < 8; b++) {
+            if (out.data[b] != out.data[0]) {
+                torn++;
+                break;
+            }
+        }
+    }
+    ctx.stop = 1;
+    pthread_join(writer, NULL);
+    TEST_ASSERT(torn == 0, "No torn reads through cache");
+}
+
+// スレッドのCPU時間（負荷時のプリエンプションで比較が逆転しないよう経過時間の代わりに使う）
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double bench_hot_gets(void) {
+    CANData out;
+    uint64_t start = thread_cpu_ns();
+    for (int loop = 0; loop < BENCH_LOOPS; loop++) {
+        for (uint32_t i = 0; i < HOT_IDS; i++) {
+            can_shm_get(0x600 + i, &out);
+        }
+    }
+    return (double)(thread_cpu_ns() - start) / (BENCH_LOOPS * HOT_IDS);
+}
+
+/**
+ * 少数IDの繰り返しGet
+ */
+void test_hot_loop(void) {
+    uint8_t data[8] = {0};
+    for (uint32_t i = 0; i < HOT_IDS; i++) {
+        can_shm_set(0x600 + i, 8, data);
+    }
+
+    can_shm_read_cache_enable(0);
+    double uncached = bench_hot_gets();
+    can_shm_read_cache_enable(1);
+    can_shm_read_cache_reset_stats();
+    double cached = bench_hot_gets();
+
+    CANReadCacheStats stats;
+    can_shm_read_cache_get_stats(&stats);
+    printf("  %d hot IDs: %.1f ns/get uncached, %.1f ns/get cached (hits %llu, misses %llu)\n",
+           HOT_IDS, uncached, cached, (unsigned long long)stats.hits, (unsigned long long)stats.misses);
+    TEST_ASSERT(stats.misses <= HOT_IDS * 2 && stats.hits + stats.misses == (uint64_t)BENCH_LOOPS * HOT_IDS,
+                "Hot IDs served from cache");
+    TEST_ASSERT(cached < uncached, "Cached gets faster");
+}
+
+int main(void) {
+    printf("Starting Read Cache Tests...\n\n");
+
+    snprintf(g_segment_path, sizeof(g_segment_path), "/tmp/can_shm_test_read_cache.%d", (int)getpid());
+    if (recreate_segment() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_hit_and_update();
+    test_remap();
+    test_concurrent_writer();
+    test_hot_loop();
+
+    can_shm_read_cache_enable(0);
+    can_shm_cleanup();
+    unlink(g_segment_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,284 @@
+#include "can_shm_api.h"
+#include "can_shm_journal.h"
+#include "can_shm_reclog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * ジャーナルへの記録と順序
+ */
+void test_journal_basic(void) {
+    uint8_t data[] = {0x10, 0x20, 0x30, 0x40};
+
+    // 未接続時はジャーナルに書き込まれない
+    uint64_t head_before = g_shm_ptr->journal.head;
+    can_shm_set(0x700, 4, data);
+    TEST_ASSERT(g_shm_ptr->journal.head == head_before, "Journal idle without recorder");
+
+    CANJournalCursor cursor;
+    TEST_ASSERT(can_shm_journal_attach(&cursor) == CAN_SHM_SUCCESS, "Journal attach");
+
+    for (int i = 0; i < 10; i++) {
+        data[0] = (uint8_t)i;
+        can_shm_set(0x700 + i, 4, data);
+    }
+
+    CANData out[32];
+    uint32_t n = can_shm_journal_read(&cursor, out, 32);
+    TEST_ASSERT(n == 10, "Journal read returns all updates");
+
+    int in_order = 1;
+    for (uint32_t i = 0; i < n; i++) {
+        if (out[i].can_id != 0x700 + i || out[i].data[0] != (uint8_t)i) {
+            in_order = 0;
+        }
+    }
+    TEST_ASSERT(in_order, "Journal preserves update order and payload");
+    TEST_ASSERT(can_shm_journal_read(&cursor, out, 32) == 0, "Journal drained");
+
+    // リング1周以上の遅れは欠落として数える
+    for (int i = 0; i < CAN_SHM_JOURNAL_SIZE + 100; i++) {
+        can_shm_set(0x710, 4, data);
+    }
+    uint32_t total = 0;
+    while ((n = can_shm_journal_read(&cursor, out, 32)) > 0) {
+        total += n;
+    }
+    TEST_ASSERT(cursor.dropped == 100, "Journal overrun counted as dropped");
+    TEST_ASSERT(total == CAN_SHM_JOURNAL_SIZE, "Journal keeps the latest ring contents");
+
+    can_shm_journal_detach();
+    head_before = g_shm_ptr->journal.head;
+    can_shm_set(0x700, 4, data);
+    TEST_ASSERT(g_shm_ptr->journal.head == head_before, "Journal idle after detach");
+}
+
+/**
+ * ローリングログファイルとインデックス
+ */
+void test_reclog_files(void) {
+    char dir[] = "/tmp/can_reclog_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        TEST_ASSERT(0, "Create temporary directory");
+        return;
+    }
+
+    // 約1100レコード/ファイル、2ファイル保持
+    const uint64_t file_size = 200 * 1024;
+    CANRecLogWriter writer;
+    TEST_ASSERT(can_shm_reclog_open(&writer, dir, "test", file_size, 2) == CAN_SHM_SUCCESS,
+                "Reclog open");
+    uint64_t capacity = writer.header->record_capacity;
+
+    const uint32_t TOTAL = 3000;
+    CANData batch[100];
+    memset(batch, 0, sizeof(batch));
+    for (uint32_t i = 0; i < TOTAL; i += 100) {
+        for (uint32_t k = 0; k < 100; k++) {
+            batch[k].timestamp = 1000 + (uint64_t)(i + k) * 10;
+            batch[k].can_id = 0x100 + ((i + k) % 5);
+            batch[k].dlc = 8;
+            batch[k].data[0] = (uint8_t)(i + k);
+        }
+        can_shm_reclog_append(&writer, batch, 100);
+    }
+    TEST_ASSERT(writer.total_records == TOTAL, "Reclog appended all records");
+    TEST_ASSERT(writer.files_rotated == (TOTAL - 1) / capacity, "Reclog rotated files");
+    uint32_t last_index = writer.file_index;
+    can_shm_reclog_close(&writer);
+
+    char path[512];
+    can_shm_reclog_path(path, sizeof(path), dir, "test", 0);
+    TEST_ASSERT(access(path, F_OK) != 0, "Oldest file removed beyond retention");
+
+    can_shm_reclog_path(path, sizeof(path), dir, "test", last_index);
+    CANRecLogReader reader;
+    TEST_ASSERT(can_shm_reclog_open_reader(&reader, path) == CAN_SHM_SUCCESS, "Reclog reader open");
+
+    uint64_t count = can_shm_reclog_record_count(&reader);
+    uint64_t first_global = (uint64_t)last_index * capacity;
+    TEST_ASSERT(count == TOTAL - first_global, "Reclog reader record count");
+    TEST_ASSERT(reader.header->finalized == 1, "Reclog file finalized");
+
+    // 時刻シーク：途中の時刻から該当レコードへ
+    uint64_t target_global = first_global + count / 2;
+    uint64_t target_ts = 1000 + target_global * 10;
+    uint64_t pos = can_shm_reclog_seek_time(&reader, target_ts - 5);
+    const CANRecLogRecord* rec = can_shm_reclog_record_at(&reader, pos);
+    TEST_ASSERT(rec != NULL && rec->timestamp == target_ts, "Reclog seek by time");
+    TEST_ASSERT(can_shm_reclog_seek_time(&reader, UINT64_MAX) == count,
+                "Reclog seek past end");
+
+    // IDインデックス
+    CANRecLogIdIndexEntry entry;
+    TEST_ASSERT(can_shm_reclog_lookup_id(&reader, 0x102, &entry) == CAN_SHM_SUCCESS,
+                "Reclog ID index lookup");
+    rec = can_shm_reclog_record_at(&reader, entry.first_index);
+    TEST_ASSERT(rec != NULL && rec->can_id == 0x102 && entry.count >= count / 5,
+                "Reclog ID index first record and count");
+    TEST_ASSERT(can_shm_reclog_lookup_id(&reader, 0x7FF, &entry) == CAN_SHM_ERROR_NOT_FOUND,
+                "Reclog ID index miss");
+
+    can_shm_reclog_close_reader(&reader);
+
+    // 後片付け
+    for (uint32_t i = 0; i <= last_index; i++) {
+        can_shm_reclog_path(path, sizeof(path), dir, "test", i);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+/**
+ * 再起動時の続きの番号からの記録（既存ファイルを上書きしない）
+ */
+void test_reclog_resume(void) {
+    char dir[] = "/tmp/can_reclog_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        TEST_ASSERT(0, "Create temporary directory");
+        return;
+    }
+
+    const uint64_t file_size = 200 * 1024;
+    CANData frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = 0x123;
+    frame.dlc = 8;
+
+    CANRecLogWriter writer;
+    TEST_ASSERT(can_shm_reclog_open(&writer, dir, "test", file_size, 0) == CAN_SHM_SUCCESS,
+                "Reclog first run open");
+    can_shm_reclog_append(&writer, &frame, 1);
+    can_shm_reclog_close(&writer);
+
+    TEST_ASSERT(can_shm_reclog_open(&writer, dir, "test", file_size, 0) == CAN_SHM_SUCCESS &&
+                writer.file_index == 1, "Reclog restart resumes after last file");
+    can_shm_reclog_close(&writer);
+
+    char path[512];
+    can_shm_reclog_path(path, sizeof(path), dir, "test", 0);
+    CANRecLogReader reader;
+    TEST_ASSERT(can_shm_reclog_open_reader(&reader, path) == CAN_SHM_SUCCESS &&
+                can_shm_reclog_record_count(&reader) == 1, "Reclog previous recording kept");
+    can_shm_reclog_close_reader(&reader);
+
+    // 別プレフィックスは番号を共有しない
+    TEST_ASSERT(can_shm_reclog_open(&writer, dir, "other", file_size, 0) == CAN_SHM_SUCCESS &&
+                writer.file_index == 0, "Reclog other prefix starts at 0");
+    can_shm_reclog_close(&writer);
+
+    for (uint32_t i = 0; i <= 1; i++) {
+        can_shm_reclog_path(path, sizeof(path), dir, "test", i);
+        unlink(path);
+    }
+    can_shm_reclog_path(path, sizeof(path), dir, "other", 0);
+    unlink(path);
+    rmdir(dir);
+}
+
+// レコーダ相当の読み出しスレッド
+static volatile int g_drain_stop = 0;
+
+static void* drain_thread(void* arg) {
+    CANJournalCursor* cursor = (CANJournalCursor*)arg;
+    CANData batch[512];
+    struct timespec poll = {0, 1000000};
+    while (!g_drain_stop) {
+        if (can_shm_journal_read(cursor, batch, 512) < 512) {
+            nanosleep(&poll, NULL);
+        }
+    }
+    return NULL;
+}
+
+static double measure_set_ns(int ops) {
+    uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    uint64_t start = get_timestamp_ns();
+    for (int i = 0; i < ops; i++) {
+        can_shm_set(0x720 + (i % 32), 8, data);
+    }
+    return (double)(get_timestamp_ns() - start) / ops;
+}
+
+/**
+ * レコーダ接続時のSetオーバーヘッド計測
+ */
+void test_recorder_overhead(void) {
+    const int OPS = 200000;
+
+    measure_set_ns(OPS / 10);  // ウォームアップ
+    double idle_ns = measure_set_ns(OPS);
+
+    CANJournalCursor cursor;
+    can_shm_journal_attach(&cursor);
+    pthread_t thread;
+    g_drain_stop = 0;
+    pthread_create(&thread, NULL, drain_thread, &cursor);
+
+    double attached_ns = measure_set_ns(OPS);
+
+    g_drain_stop = 1;
+    pthread_join(thread, NULL);
+    can_shm_journal_detach();
+
+    printf("Set latency: %.1f ns/op without recorder, %.1f ns/op with recorder (%+.1f ns)\n",
+           idle_ns, attached_ns, attached_ns - idle_ns);
+    TEST_ASSERT(idle_ns > 0 && attached_ns > 0, "Recorder overhead measured");
+}
+
+int main(void) {
+    printf("Starting Recorder Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_journal_basic();
+    test_reclog_files();
+    test_reclog_resume();
+    test_recorder_overhead();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
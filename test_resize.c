@@ -0,0 +1,371 @@
+#include "can_shm_api.h"
+#include "can_shm_linear_probing.h"
+#include "can_shm_ext.h"
+#include "can_shm_clock.h"
+#include "can_shm_queue.h"
+#include "can_shm_reactor.h"
+#include "can_shm_stale.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define FILL_IDS 6000
+#define EXTRA_IDS 20000
+#define NUM_READERS 3
+
+// テスト専用のセグメント（並行して走る他のテストのセグメントには触れない）
+static char g_segment_path[256];
+
+static CANShmResult open_segment(void) {
+    CANShmInitOptions options = {.backing_path = g_segment_path};
+    return can_shm_init_ex(&options);
+}
+
+static uint32_t test_id(uint32_t i) {
+    return 0x10000000 + i * 13;
+}
+
+// データ部にIDを埋め込む（読み取り側で取り違えを検出）
+static void fill_data(uint32_t can_id, uint8_t tag, uint8_t* data) {
+    memcpy(data, &can_id, sizeof(can_id));
+    data[4] = tag;
+    data[5] = data[6] = data[7] = 0xA5;
+}
+
+// スレッドのCPU時間（負荷時のプリエンプションを含めずにSet自体の処理時間を測る）
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int check_data(uint32_t can_id, const CANData* out) {
+    uint32_t stored;
+    memcpy(&stored, out->data, sizeof(stored));
+    return out->can_id == can_id && stored == can_id && out->dlc == 8;
+}
+
+/**
+ * メインテーブルを超える数のID
+ */
+void test_overflow_growth(void) {
+    uint8_t data[8];
+    int failures = 0;
+    uint64_t max_ns = 0;
+
+    for (uint32_t i = 0; i < FILL_IDS; i++) {
+        fill_data(test_id(i), 1, data);
+        uint64_t start = thread_cpu_ns();
+        if (can_shm_set_linear_probing(test_id(i), 8, data) != CAN_SHM_SUCCESS) {
+            failures++;
+        }
+        uint64_t elapsed = thread_cpu_ns() - start;
+        if (elapsed > max_ns) {
+            max_ns = elapsed;
+        }
+    }
+    TEST_ASSERT(failures == 0, "All sets beyond MAX_CAN_ENTRIES succeed");
+
+    int missing = 0;
+    CANData out;
+    for (uint32_t i = 0; i < FILL_IDS; i++) {
+        if (can_shm_get_linear_probing(test_id(i), &out) != CAN_SHM_SUCCESS || !check_data(test_id(i), &out)) {
+            missing++;
+        }
+    }
+    TEST_ASSERT(missing == 0, "All IDs readable");
+
+    CANExtInfo info;
+    TEST_ASSERT(can_shm_ext_get_info(&info) == CAN_SHM_SUCCESS, "Get extension info");
+    printf("  %d IDs: extension level %u (%u/%u buckets, %u IDs), max set CPU time %.1f us\n",
+           FILL_IDS, info.level, info.occupied, info.capacity, info.entries, max_ns / 1000.0);
+    TEST_ASSERT(info.level >= 2 && info.epoch >= 2, "Extension grew past the first level");
+    TEST_ASSERT(info.entries > 0 && info.occupied <= info.capacity / 2, "Load kept at or below one half");
+    TEST_ASSERT(max_ns < 20000000, "No set paused for the whole table");
+
+    CANData stored;
+    uint32_t in_ext = 0;
+    for (uint32_t i = 0; i < FILL_IDS && in_ext == 0; i++) {
+        if (can_shm_ext_get(test_id(i), &stored) == CAN_SHM_SUCCESS) {
+            in_ext = test_id(i);
+        }
+    }
+    CANShmHandle handle;
+    TEST_ASSERT(in_ext != 0 && can_shm_resolve(in_ext, &handle) == CAN_SHM_ERROR_NOT_FOUND,
+                "No handle for an ID in the extension table");
+    TEST_ASSERT(can_shm_ext_get_info(NULL) == CAN_SHM_ERROR_INVALID_PARAM, "NULL info rejected");
+}
+
+/**
+ * 拡張領域のIDの更新・削除
+ */
+void test_update_and_delete(void) {
+    uint8_t data[8];
+    CANData out;
+    uint32_t target = 0;
+    for (uint32_t i = 0; i < FILL_IDS && target == 0; i++) {
+        if (can_shm_ext_get(test_id(i), &out) == CAN_SHM_SUCCESS) {
+            target = test_id(i);
+        }
+    }
+
+    fill_data(target, 2, data);
+    can_shm_set_linear_probing(target, 8, data);
+    TEST_ASSERT(can_shm_get_linear_probing(target, &out) == CAN_SHM_SUCCESS && out.data[4] == 2,
+                "Update of extension ID visible");
+
+    CANExtInfo before, after;
+    can_shm_ext_get_info(&before);
+    TEST_ASSERT(can_shm_delete_linear_probing(target) == CAN_SHM_SUCCESS, "Delete extension ID");
+    can_shm_ext_get_info(&after);
+    TEST_ASSERT(can_shm_get_linear_probing(target, &out) == CAN_SHM_ERROR_NOT_FOUND &&
+                after.entries == before.entries - 1, "Deleted ID gone");
+
+    fill_data(target, 3, data);
+    can_shm_set_linear_probing(target, 8, data);
+    TEST_ASSERT(can_shm_get_linear_probing(target, &out) == CAN_SHM_SUCCESS && out.data[4] == 3,
+                "Re-set after delete");
+}
+
+static void count_delivery(uint32_t can_id, const CANData* data, void* user_data) {
+    CANData* last = (CANData*)user_data;
+    if (data->can_id == can_id) {
+        *last = *data;
+    }
+}
+
+/**
+ * 拡張領域のIDへの配信（購読キュー・リアクタ・停止監視）
+ */
+void test_ext_delivery(void) {
+    uint8_t data[8];
+    CANData out;
+    uint32_t target = 0;
+    for (uint32_t i = 0; i < FILL_IDS && target == 0; i++) {
+        if (can_shm_ext_get(test_id(i), &out) == CAN_SHM_SUCCESS) {
+            target = test_id(i);
+        }
+    }
+
+    CANQueueHandle queue;
+    CANReactor* reactor;
+    CANData delivered;
+    memset(&delivered, 0, sizeof(delivered));
+    can_shm_queue_subscribe(target, &queue);
+    can_shm_reactor_create(0, &reactor);
+    can_shm_reactor_add(reactor, target, count_delivery, &delivered);
+
+    fill_data(target, 4, data);
+    can_shm_set_linear_probing(target, 8, data);
+    uint32_t received = 0;
+    TEST_ASSERT(can_shm_queue_receive(&queue, &out, 1, 0, &received) == CAN_SHM_SUCCESS &&
+                received == 1 && out.can_id == target && out.data[4] == 4,
+                "Extension ID update reaches its queue");
+    can_shm_reactor_poll(reactor, 100, NULL);
+    TEST_ASSERT(delivered.can_id == target && delivered.data[4] == 4, "Extension ID update reaches the reactor");
+
+    // On-change：データ部が不変なら通知しない
+    can_shm_set_publish_mode(CAN_SHM_PUBLISH_ON_CHANGE);
+    can_shm_set_linear_probing(target, 8, data);
+    TEST_ASSERT(can_shm_queue_receive(&queue, &out, 1, 0, &received) == CAN_SHM_ERROR_TIMEOUT,
+                "Unchanged extension ID update suppressed");
+    can_shm_set_publish_mode(CAN_SHM_PUBLISH_ALWAYS);
+
+    can_shm_reactor_destroy(reactor);
+    can_shm_queue_unsubscribe(&queue);
+
+    // 停止監視は拡張領域の受信時刻を参照する（周期100ms、途絶判定300ms）
+    uint64_t t0 = can_shm_clock_monotonic_ns();
+    can_shm_stale_configure(1);
+    can_shm_stale_register(target, 100, 0);
+    usleep(50000);
+    can_shm_set_linear_probing(target, 8, data);
+    int stale = -1;
+    TEST_ASSERT(can_shm_stale_tick(t0 + 320000000ULL) == 0 &&
+                can_shm_stale_check(target, &stale) == CAN_SHM_SUCCESS && stale == 0,
+                "Extension ID received within the deadline is not stale");
+    can_shm_stale_unregister(target);
+}
+
+typedef struct {
+    volatile int stop;
+    uint64_t reads;
+    uint64_t misses;
+} ReaderContext;
+
+static void* reader_thread(void* arg) {
+    ReaderContext* ctx = (ReaderContext*)arg;
+    CANData out;
+    for (uint32_t i = 0; !ctx->stop; i = (i + 1) % FILL_IDS) {
+        if (can_shm_get_linear_probing(test_id(i), &out) != CAN_SHM_SUCCESS || !check_data(test_id(i), &out)) {
+            ctx->misses++;
+        }
+        ctx->reads++;
+    }
+    return NULL;
+}
+
+/**
+ * 拡張・移行中の読み取り
+ */
+void test_concurrent_readers(void) {
+    ReaderContext ctx[NUM_READERS];
+    pthread_t readers[NUM_READERS];
+    memset(ctx, 0, sizeof(ctx));
+    for (int r = 0; r < NUM_READERS; r++) {
+        pthread_create(&readers[r], NULL, reader_thread, &ctx[r]);
+    }
+
+    CANExtInfo before;
+    can_shm_ext_get_info(&before);
+    uint8_t data[8];
+    int failures = 0;
+    for (uint32_t i = FILL_IDS; i < FILL_IDS + EXTRA_IDS; i++) {
+        fill_data(test_id(i), 1, data);
+        if (can_shm_set_linear_probing(test_id(i), 8, data) != CAN_SHM_SUCCESS) {
+            failures++;
+        }
+    }
+
+    for (int r = 0; r < NUM_READERS; r++) {
+        ctx[r].stop = 1;
+        pthread_join(readers[r], NULL);
+    }
+
+    uint64_t reads = 0, misses = 0;
+    for (int r = 0; r < NUM_READERS; r++) {
+        reads += ctx[r].reads;
+        misses += ctx[r].misses;
+    }
+    CANExtInfo after;
+    can_shm_ext_get_info(&after);
+    printf("  %d more IDs: level %u -> %u, %llu reads during growth, %llu misses\n",
+           EXTRA_IDS, before.level, after.level, (unsigned long long)reads, (unsigned long long)misses);
+    TEST_ASSERT(failures == 0, "Sets during growth succeed");
+    TEST_ASSERT(after.level > before.level, "Extension grew while readers were active");
+    TEST_ASSERT(misses == 0, "Readers never miss during migration");
+
+    int missing = 0;
+    CANData out;
+    for (uint32_t i = 0; i < FILL_IDS + EXTRA_IDS; i++) {
+        if (can_shm_get_linear_probing(test_id(i), &out) != CAN_SHM_SUCCESS) {
+            missing++;
+        }
+    }
+    TEST_ASSERT(missing == 0, "All IDs readable after growth");
+}
+
+/**
+ * 配置の異なるテーブルは拡張領域を共有しない
+ */
+void test_separate_owners(void) {
+    char other[256];
+    snprintf(other, sizeof(other), "/tmp/can_shm_test_resize_other.%d", (int)getpid());
+    unlink(other);
+
+    can_shm_cleanup();
+    CANShmInitOptions options = {.backing_path = other};
+    TEST_ASSERT(can_shm_init_ex(&options) == CAN_SHM_SUCCESS, "Init table at another path");
+
+    // 同じIDを同じ数だけ格納し、同じ世代まで拡張させる
+    uint8_t data[8];
+    int failures = 0;
+    for (uint32_t i = 0; i < FILL_IDS; i++) {
+        fill_data(test_id(i), 9, data);
+        if (can_shm_set_linear_probing(test_id(i), 8, data) != CAN_SHM_SUCCESS) {
+            failures++;
+        }
+    }
+    CANExtInfo info;
+    can_shm_ext_get_info(&info);
+    TEST_ASSERT(failures == 0 && info.level >= 2, "Other table grew its own extension");
+
+    can_shm_ext_unlink();
+    can_shm_cleanup();
+    unlink(other);
+
+    open_segment();
+    int damaged = 0;
+    CANData out;
+    for (uint32_t i = 0; i < FILL_IDS; i++) {
+        if (can_shm_get_linear_probing(test_id(i), &out) != CAN_SHM_SUCCESS ||
+            !check_data(test_id(i), &out) || out.data[4] == 9) {
+            damaged++;
+        }
+    }
+    TEST_ASSERT(damaged == 0, "Extension of the first table untouched");
+}
+
+/**
+ * セグメント再作成で拡張領域も空になる
+ */
+void test_recreate(void) {
+    can_shm_ext_unlink();
+    can_shm_cleanup();
+    unlink(g_segment_path);
+    open_segment();
+
+    CANExtInfo info;
+    CANData out;
+    can_shm_ext_get_info(&info);
+    TEST_ASSERT(info.level == 0 && info.entries == 0, "Extension empty after recreate");
+    TEST_ASSERT(can_shm_get_linear_probing(test_id(FILL_IDS - 1), &out) == CAN_SHM_ERROR_NOT_FOUND,
+                "Old extension IDs not visible");
+}
+
+int main(void) {
+    printf("Starting Resize Tests...\n\n");
+
+    // 空のテーブルから始める
+    snprintf(g_segment_path, sizeof(g_segment_path), "/tmp/can_shm_test_resize.%d", (int)getpid());
+    unlink(g_segment_path);
+
+    if (open_segment() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_overflow_growth();
+    test_update_and_delete();
+    test_ext_delivery();
+    test_separate_owners();
+    test_concurrent_readers();
+    test_recreate();
+
+    can_shm_ext_unlink();
+    can_shm_cleanup();
+    unlink(g_segment_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,269 @@
+#include "can_shm_api.h"
+#include "can_shm_snapshot.h"
+#include "can_shm_clock.h"
+#include "can_shm_linear_probing.h"
+#include "can_shm_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define NUM_IDS 2000
+#define EXT_TEST_IDS (CAN_SHM_MAX_PROBE + 16)
+
+static char g_path[256];
+
+// テスト専用のセグメント（並行して走る他のテストのセグメントには触れない）
+static char g_segment_path[256];
+static char g_bus1_path[272];
+
+// セグメントを破棄して再作成（ホスト再起動・全プロセス終了の再現）
+static CANShmResult restart(const CANShmInitOptions* options) {
+    can_shm_cleanup();
+    unlink(g_segment_path);
+    CANShmInitOptions isolated = *options;
+    isolated.backing_path = g_segment_path;
+    return can_shm_init_ex(&isolated);
+}
+
+/**
+ * 保存と再起動後の復元
+ */
+void test_save_and_restore(void) {
+    uint8_t data[64];
+    for (uint32_t i = 0; i < NUM_IDS; i++) {
+        memset(data, (int)(i & 0xFF), sizeof(data));
+        can_shm_set(0x18000000 + i, (uint16_t)(i % 2 == 0 ? 8 : 64), data);
+    }
+    can_shm_set_publish_mode_id(0x18000000, CAN_SHM_PUBLISH_ON_CHANGE, 0xF0);
+
+    CANData before;
+    can_shm_get(0x18000001, &before);
+    usleep(20000);
+
+    uint32_t saved = 0;
+    TEST_ASSERT(can_shm_snapshot_save(0, g_path, &saved) == CAN_SHM_SUCCESS && saved == NUM_IDS,
+                "Snapshot saved");
+    uint64_t age_at_save = can_shm_clock_now_ns() - before.timestamp;
+
+    CANShmInitOptions options = {.snapshot_path = g_path};
+    uint64_t start = can_shm_clock_monotonic_ns();
+    TEST_ASSERT(restart(&options) == CAN_SHM_SUCCESS, "Init with snapshot");
+    double restore_ms = (double)(can_shm_clock_monotonic_ns() - start) / 1e6;
+    printf("  init + restore of %d IDs: %.2f ms\n", NUM_IDS, restore_ms);
+
+    int restored = 1;
+    CANData out;
+    for (uint32_t i = 0; i < NUM_IDS; i++) {
+        uint16_t dlc = (uint16_t)(i % 2 == 0 ? 8 : 64);
+        if (can_shm_get(0x18000000 + i, &out) != CAN_SHM_SUCCESS || out.dlc != dlc ||
+            out.data[0] != (uint8_t)(i & 0xFF) || out.data[dlc - 1] != (uint8_t)(i & 0xFF)) {
+            restored = 0;
+            break;
+        }
+    }
+    TEST_ASSERT(restored, "All values restored");
+
+    can_shm_get(0x18000001, &out);
+    uint64_t age = can_shm_clock_now_ns() - out.timestamp;
+    TEST_ASSERT(age >= age_at_save && age < age_at_save + 1000000000ULL, "Age carried across restart");
+
+    const CANBucket* bucket = &g_shm_ptr->buckets[can_id_hash(0x18000000)];
+    TEST_ASSERT(bucket->publish_mode == CAN_SHM_PUBLISH_ON_CHANGE && bucket->ignore_mask == 0xF0,
+                "Per-ID publish mode restored");
+}
+
+/**
+ * 受信済みの値は上書きしない
+ */
+void test_keeps_live_values(void) {
+    uint8_t fresh[8] = {0xEE};
+    can_shm_set(0x18000002, 8, fresh);
+
+    uint32_t loaded = 0;
+    TEST_ASSERT(can_shm_snapshot_load(0, g_path, &loaded) == CAN_SHM_SUCCESS && loaded == 0,
+                "Valid buckets are not reloaded");
+    CANData out;
+    can_shm_get(0x18000002, &out);
+    TEST_ASSERT(out.data[0] == 0xEE, "Live value kept");
+}
+
+/**
+ * 破損・存在しないファイル
+ */
+void test_invalid_files(void) {
+    TEST_ASSERT(can_shm_snapshot_load(0, "/nonexistent/can_shm.snap", NULL) == CAN_SHM_ERROR_NOT_FOUND,
+                "Missing file reported");
+
+    // 1byte書き換えてチェックサム不一致にする
+    char corrupt[300];
+    snprintf(corrupt, sizeof(corrupt), "%s.corrupt", g_path);
+    FILE* in = fopen(g_path, "rb");
+    FILE* out = fopen(corrupt, "wb");
+    int c, pos = 0;
+    while (in != NULL && out != NULL && (c = fgetc(in)) != EOF) {
+        fputc(pos++ == 200 ? c ^ 0x01 : c, out);
+    }
+    if (in) fclose(in);
+    if (out) fclose(out);
+
+    TEST_ASSERT(can_shm_snapshot_load(0, corrupt, NULL) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Corrupt snapshot rejected");
+    CANShmInitOptions options = {.snapshot_path = corrupt};
+    CANData data;
+    TEST_ASSERT(restart(&options) == CAN_SHM_SUCCESS &&
+                can_shm_get(0x18000001, &data) == CAN_SHM_ERROR_NOT_FOUND,
+                "Init continues with empty table on corrupt snapshot");
+    unlink(corrupt);
+
+    TEST_ASSERT(can_shm_snapshot_save(CAN_SHM_MAX_BUSES, g_path, NULL) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Invalid bus rejected");
+}
+
+/**
+ * 定期保存と終了時の保存
+ */
+void test_autosave(void) {
+    CANShmInitOptions options = {.snapshot_path = g_path, .snapshot_interval_ms = 20};
+    TEST_ASSERT(restart(&options) == CAN_SHM_SUCCESS, "Init with autosave");
+
+    uint8_t data[8] = {0x11};
+    can_shm_set(0x18FF0001, 8, data);
+    usleep(100000);
+
+    // 定期保存された内容は別バスに読み込んで確認
+    CANData out;
+    TEST_ASSERT(can_shm_snapshot_load(1, g_path, NULL) == CAN_SHM_SUCCESS &&
+                can_shm_bus_get(1, 0x18FF0001, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x11,
+                "Periodic snapshot written");
+
+    data[0] = 0x22;
+    can_shm_set(0x18FF0001, 8, data);
+    can_shm_cleanup();  // 停止時に最終値を保存
+
+    options.snapshot_interval_ms = 0;
+    restart(&options);
+    TEST_ASSERT(can_shm_get(0x18FF0001, &out) == CAN_SHM_SUCCESS && out.data[0] == 0x22,
+                "Final value saved on cleanup");
+}
+
+/**
+ * 拡張領域に格納されたIDの保存と復元
+ */
+void test_ext_ids(void) {
+    CANShmInitOptions options;
+    memset(&options, 0, sizeof(options));
+    restart(&options);
+
+    // 同じホーム位置のIDを探査範囲より多く格納し、あふれた分を拡張領域へ入れる
+    const uint32_t home = 100;
+    uint32_t ids[EXT_TEST_IDS];
+    uint32_t found = 0;
+    for (uint32_t id = 0x1C000000; found < EXT_TEST_IDS && id <= CAN_ID_MAX; id++) {
+        if (can_id_hash(id) == home) {
+            ids[found++] = id;
+        }
+    }
+    uint8_t data[8] = {0};
+    for (uint32_t i = 0; i < found; i++) {
+        data[0] = (uint8_t)i;
+        can_shm_set_linear_probing(ids[i], 8, data);
+    }
+    CANExtInfo info;
+    can_shm_ext_get_info(&info);
+    TEST_ASSERT(found == EXT_TEST_IDS && info.entries == EXT_TEST_IDS - CAN_SHM_MAX_PROBE,
+                "IDs beyond the probe range stored in extension table");
+
+    CANData before;
+    can_shm_get_linear_probing(ids[EXT_TEST_IDS - 1], &before);
+    uint32_t saved = 0;
+    TEST_ASSERT(can_shm_snapshot_save(0, g_path, &saved) == CAN_SHM_SUCCESS && saved == EXT_TEST_IDS,
+                "Extension IDs saved");
+    uint64_t age_at_save = can_shm_clock_now_ns() - before.timestamp;
+
+    can_shm_ext_unlink();
+    options.snapshot_path = g_path;
+    TEST_ASSERT(restart(&options) == CAN_SHM_SUCCESS, "Init with extension snapshot");
+
+    int restored = 1;
+    CANData out;
+    for (uint32_t i = 0; i < EXT_TEST_IDS; i++) {
+        if (can_shm_get_linear_probing(ids[i], &out) != CAN_SHM_SUCCESS || out.dlc != 8 ||
+            out.data[0] != (uint8_t)i) {
+            restored = 0;
+            break;
+        }
+    }
+    can_shm_ext_get_info(&info);
+    TEST_ASSERT(restored && info.entries == EXT_TEST_IDS - CAN_SHM_MAX_PROBE,
+                "Extension IDs restored");
+
+    can_shm_get_linear_probing(ids[EXT_TEST_IDS - 1], &out);
+    uint64_t age = can_shm_clock_now_ns() - out.timestamp;
+    TEST_ASSERT(age >= age_at_save && age < age_at_save + 1000000000ULL,
+                "Extension ID age carried across restart");
+
+    uint32_t loaded = 0;
+    TEST_ASSERT(can_shm_snapshot_load(0, g_path, &loaded) == CAN_SHM_SUCCESS && loaded == 0,
+                "Stored extension IDs are not reloaded");
+
+    can_shm_ext_unlink();
+}
+
+int main(void) {
+    printf("Starting Snapshot Tests...\n\n");
+
+    snprintf(g_path, sizeof(g_path), "/tmp/can_shm_test_snapshot.%d", (int)getpid());
+    snprintf(g_segment_path, sizeof(g_segment_path), "/tmp/can_shm_test_snapshot_seg.%d", (int)getpid());
+    snprintf(g_bus1_path, sizeof(g_bus1_path), "%s.bus1", g_segment_path);
+
+    // 空のテーブルから始める
+    unlink(g_bus1_path);
+    CANShmInitOptions options;
+    memset(&options, 0, sizeof(options));
+    if (restart(&options) != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_save_and_restore();
+    test_keeps_live_values();
+    test_invalid_files();
+    test_autosave();
+    test_ext_ids();
+
+    can_shm_cleanup();
+    unlink(g_path);
+    unlink(g_segment_path);
+    unlink(g_bus1_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,229 @@
+#include "can_shm_api.h"
+#include "can_shm_stale.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define MS(x) ((uint64_t)(x) * 1000000ULL)
+
+// タイムスタンプ取得（ナノ秒）
+static uint64_t get_timestamp_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 受信時刻を指定してSet
+static void set_at(uint32_t can_id, uint64_t timestamp) {
+    CANData frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = can_id;
+    frame.dlc = 1;
+    frame.timestamp = timestamp;
+    can_shm_set_batch_timestamped(&frame, 1, NULL);
+}
+
+static int is_stale(uint32_t can_id) {
+    int stale = -1;
+    can_shm_stale_check(can_id, &stale);
+    return stale;
+}
+
+/**
+ * 途絶検出と復帰（時刻はtick関数に明示的に与える）
+ */
+void test_stale_detection(void) {
+    can_shm_stale_configure(1);
+
+    uint64_t t0 = get_timestamp_ns();
+    set_at(0x610, t0);
+    set_at(0x620, t0);
+
+    // 0x610: 周期10ms → 30msで途絶, 0x620: 周期100ms → 300msで途絶
+    TEST_ASSERT(can_shm_stale_register(0x610, 10, 0) == CAN_SHM_SUCCESS, "Register 10ms ID");
+    TEST_ASSERT(can_shm_stale_register(0x620, 100, 0) == CAN_SHM_SUCCESS, "Register 100ms ID");
+    TEST_ASSERT(can_shm_stale_register(0x630, 0, 0) == CAN_SHM_ERROR_INVALID_PARAM,
+                "Register rejects zero cycle");
+
+    TEST_ASSERT(can_shm_stale_tick(t0 + MS(20)) == 0, "No timeout before deadline");
+    TEST_ASSERT(is_stale(0x610) == 0, "10ms ID fresh before deadline");
+
+    // 周期どおりに受信が続けば途絶しない
+    set_at(0x610, t0 + MS(25));
+    TEST_ASSERT(can_shm_stale_tick(t0 + MS(40)) == 0, "Periodic update keeps ID fresh");
+
+    TEST_ASSERT(can_shm_stale_tick(t0 + MS(60)) == 1, "Timeout detected after deadline");
+    TEST_ASSERT(is_stale(0x610) == 1, "10ms ID flagged stale");
+    TEST_ASSERT(is_stale(0x620) == 0, "100ms ID still fresh");
+    TEST_ASSERT(g_shm_ptr->stale_monitor.stale_now == 1, "Stale count tracked");
+
+    // 受信再開はcheckで即時に反映、監視側は次の満了で復帰イベント
+    set_at(0x610, t0 + MS(65));
+    TEST_ASSERT(is_stale(0x610) == 0, "Check reflects recovery immediately");
+    TEST_ASSERT(can_shm_stale_tick(t0 + MS(80)) == 1, "Recovery event emitted");
+
+    TEST_ASSERT(can_shm_stale_tick(t0 + MS(290)) == 1, "10ms ID times out again without updates");
+    
+    // 長周期IDは上位レベルのホイールを経由して満了する
+    TEST_ASSERT(is_stale(0x620) == 0, "Long-cycle ID not stale before 300ms");
+    can_shm_stale_tick(t0 + MS(310));
+    TEST_ASSERT(is_stale(0x620) == 1, "Long-cycle ID stale after 300ms");
+
+    TEST_ASSERT(can_shm_stale_unregister(0x620) == CAN_SHM_SUCCESS, "Unregister ID");
+    int stale;
+    TEST_ASSERT(can_shm_stale_check(0x620, &stale) == CAN_SHM_ERROR_NOT_FOUND,
+                "Unregistered ID not monitored");
+}
+
+/**
+ * IDリストファイルからの登録
+ */
+void test_stale_load_file(void) {
+    char path[] = "/tmp/can_stale_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        TEST_ASSERT(0, "Create temporary ID list");
+        return;
+    }
+    const char* text =
+        "# cycle list\n"
+        "0x640:10   # 10ms\n"
+        "0x641, 0x642:50\n"
+        "1603\n";
+    TEST_ASSERT(write(fd, text, strlen(text)) == (ssize_t)strlen(text), "Write temporary ID list");
+    close(fd);
+
+    can_shm_stale_configure(1);
+    uint32_t loaded = 0;
+    TEST_ASSERT(can_shm_stale_load_file(path, 20, 0, &loaded) == CAN_SHM_SUCCESS && loaded == 4,
+                "Load ID list with cycle times");
+
+    int idx_found = 0;
+    for (int i = 0; i < CAN_SHM_STALE_MAX_IDS; i++) {
+        const CANStaleEntry* e = &g_shm_ptr->stale_monitor.entries[i];
+        if (e->state == 1 && e->can_id == 0x642 && e->cycle_ms == 50 && e->timeout_ms == 150) {
+            idx_found = 1;
+        }
+    }
+    TEST_ASSERT(idx_found, "Cycle and timeout taken from list");
+
+    int stale;
+    TEST_ASSERT(can_shm_stale_check(0x643, &stale) == CAN_SHM_SUCCESS,
+                "Decimal ID registered with default cycle");
+    unlink(path);
+}
+
+// 途絶イベント購読スレッド
+typedef struct {
+    uint32_t can_id;
+    uint32_t kind;
+    CANShmResult result;
+} StaleSubscriber;
+
+static void stale_callback(const CANStaleEvent* event, void* user_data) {
+    StaleSubscriber* sub = (StaleSubscriber*)user_data;
+    sub->can_id = event->can_id;
+    sub->kind = event->kind;
+}
+
+static void* subscriber_thread(void* arg) {
+    StaleSubscriber* sub = (StaleSubscriber*)arg;
+    sub->result = can_shm_subscribe_stale(0x650, 1, 2000, stale_callback, sub);
+    return NULL;
+}
+
+/**
+ * 途絶イベントの購読（監視スレッド使用）
+ */
+void test_stale_subscribe(void) {
+    can_shm_stale_configure(1);
+    set_at(0x650, get_timestamp_ns());
+    can_shm_stale_register(0x650, 5, 0);
+
+    StaleSubscriber sub = {0, 0, CAN_SHM_ERROR_TIMEOUT};
+    pthread_t thread;
+    pthread_create(&thread, NULL, subscriber_thread, &sub);
+
+    TEST_ASSERT(can_shm_stale_monitor_start(0) == CAN_SHM_SUCCESS, "Monitor thread started");
+    pthread_join(thread, NULL);
+    can_shm_stale_monitor_stop();
+
+    TEST_ASSERT(sub.result == CAN_SHM_SUCCESS && sub.can_id == 0x650 &&
+                sub.kind == CAN_SHM_STALE_EVENT_TIMEOUT, "Timeout subscriber notified");
+}
+
+static double measure_tick_ns(uint32_t id_count) {
+    can_shm_stale_configure(1);
+    uint64_t t0 = get_timestamp_ns();
+    for (uint32_t i = 0; i < id_count; i++) {
+        set_at(0x700 + i, t0);
+        // 満了が重ならないよう周期を分散（1〜10秒）
+        can_shm_stale_register(0x700 + i, 1000 + (i % 9000), 0);
+    }
+
+    const uint32_t TICKS = 2000;
+    uint64_t start = get_timestamp_ns();
+    for (uint32_t k = 1; k <= TICKS; k++) {
+        can_shm_stale_tick(t0 + MS(k));
+    }
+    return (double)(get_timestamp_ns() - start) / TICKS;
+}
+
+/**
+ * tick処理コストが登録ID数に依存しないことの確認
+ */
+void test_stale_tick_cost(void) {
+    double small = measure_tick_ns(10);
+    double large = measure_tick_ns(1000);
+    printf("Tick cost: %.1f ns/tick with 10 IDs, %.1f ns/tick with 1000 IDs\n", small, large);
+    TEST_ASSERT(small > 0 && large > 0, "Tick cost measured");
+}
+
+int main(void) {
+    printf("Starting Stale Detection Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_stale_detection();
+    test_stale_load_file();
+    test_stale_subscribe();
+    test_stale_tick_cost();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}
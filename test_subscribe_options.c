@@ -0,0 +1,203 @@
+#define _GNU_SOURCE
+#include "can_shm_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+
+// テスト結果統計
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+// テストマクロ
+#define TEST_ASSERT(condition, message) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("PASS: %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("FAIL: %s\n", message); \
+    } \
+} while(0)
+
+#define PRODUCER_PERIOD_US 1000   // 1kHz送信
+#define PRODUCER_FRAMES 400
+
+// 購読スレッドの状態
+typedef struct {
+    uint32_t can_id;
+    CANSubscribeOptions options;
+    uint32_t received;
+    uint32_t counters[PRODUCER_FRAMES];   // 配信されたフレームのカウンタ値
+    long wakeups;                         // 購読スレッドの自発的コンテキストスイッチ数
+    CANShmResult result;
+} SubscriberState;
+
+static void subscribe_callback(uint32_t can_id, const CANData* data, void* user_data) {
+    (void)can_id;
+    SubscriberState* state = (SubscriberState*)user_data;
+    if (state->received < PRODUCER_FRAMES) {
+        uint32_t counter;
+        memcpy(&counter, data->data, sizeof(counter));
+        state->counters[state->received] = counter;
+    }
+    state->received++;
+}
+
+static void* subscriber_thread(void* arg) {
+    SubscriberState* state = (SubscriberState*)arg;
+    struct rusage before, after;
+    getrusage(RUSAGE_THREAD, &before);
+    // 送信終了後にタイムアウトで抜ける
+    state->result = can_shm_subscribe_ex(state->can_id, 0, 300, &state->options,
+                                         subscribe_callback, state);
+    getrusage(RUSAGE_THREAD, &after);
+    state->wakeups = after.ru_nvcsw - before.ru_nvcsw;
+    return NULL;
+}
+
+// 1kHzで連番データを送信
+static void run_producer(uint32_t can_id) {
+    uint8_t data[8] = {0};
+    struct timespec period = {0, PRODUCER_PERIOD_US * 1000L};
+    for (uint32_t i = 1; i <= PRODUCER_FRAMES; i++) {
+        memcpy(data, &i, sizeof(i));
+        can_shm_set(can_id, 8, data);
+        nanosleep(&period, NULL);
+    }
+}
+
+// 送信にかかった時間[ms]を返す
+static uint32_t run_case(SubscriberState* state, uint32_t can_id, CANSubscribeMode mode,
+                     uint32_t interval_ms, uint32_t every_n) {
+    memset(state, 0, sizeof(*state));
+    state->can_id = can_id;
+    state->options.mode = mode;
+    state->options.interval_ms = interval_ms;
+    state->options.every_n = every_n;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, subscriber_thread, state);
+    usleep(20000);  // 購読開始待ち
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    run_producer(can_id);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_join(thread, NULL);
+    return (uint32_t)((end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000);
+}
+
+/**
+ * 全更新の配信（futex待機）
+ */
+void test_subscribe_every(void) {
+    SubscriberState state;
+    run_case(&state, 0x560, CAN_SHM_SUBSCRIBE_EVERY, 0, 0);
+    printf("  every: %u callbacks, %ld wakeups\n", state.received, state.wakeups);
+    TEST_ASSERT(state.result == CAN_SHM_ERROR_TIMEOUT, "EVERY ends with timeout after producer stops");
+    TEST_ASSERT(state.received >= PRODUCER_FRAMES * 9 / 10, "EVERY delivers (almost) every update");
+}
+
+/**
+ * N回ごとの配信
+ */
+void test_subscribe_every_nth(void) {
+    SubscriberState state;
+    run_case(&state, 0x561, CAN_SHM_SUBSCRIBE_EVERY_NTH, 0, 10);
+    printf("  every 10th: %u callbacks, %ld wakeups\n", state.received, state.wakeups);
+    TEST_ASSERT(state.received >= PRODUCER_FRAMES / 10 - 2 && state.received <= PRODUCER_FRAMES / 10,
+                "EVERY_NTH delivers every 10th update");
+
+    int spaced = 1;
+    for (uint32_t i = 1; i < state.received && i < PRODUCER_FRAMES; i++) {
+        if (state.counters[i] - state.counters[i - 1] < 10) {
+            spaced = 0;
+        }
+    }
+    TEST_ASSERT(spaced, "EVERY_NTH deliveries at least N updates apart");
+    TEST_ASSERT(state.wakeups <= (long)state.received * 2 + 5, "EVERY_NTH not woken per update");
+}
+
+/**
+ * 最小間隔での配信
+ */
+void test_subscribe_min_interval(void) {
+    SubscriberState state;
+    uint32_t duration_ms = run_case(&state, 0x562, CAN_SHM_SUBSCRIBE_MIN_INTERVAL, 50, 0);
+    printf("  min interval 50ms: %u callbacks, %ld wakeups in %u ms\n",
+           state.received, state.wakeups, duration_ms);
+    TEST_ASSERT(state.received >= 4 && state.received <= duration_ms / 50 + 2,
+                "MIN_INTERVAL limits delivery rate");
+    TEST_ASSERT(state.wakeups <= (long)state.received * 3 + 5, "MIN_INTERVAL not woken per update");
+}
+
+/**
+ * 周期サンプリング
+ */
+void test_subscribe_sample(void) {
+    SubscriberState state;
+    uint32_t duration_ms = run_case(&state, 0x563, CAN_SHM_SUBSCRIBE_SAMPLE, 100, 0);
+    printf("  sample 100ms: %u callbacks, %ld wakeups in %u ms\n",
+           state.received, state.wakeups, duration_ms);
+    TEST_ASSERT(state.received >= 2 && state.received <= duration_ms / 100 + 2,
+                "SAMPLE delivers once per period");
+
+    int increasing = 1;
+    for (uint32_t i = 1; i < state.received && i < PRODUCER_FRAMES; i++) {
+        if (state.counters[i] <= state.counters[i - 1]) {
+            increasing = 0;
+        }
+    }
+    TEST_ASSERT(increasing, "SAMPLE delivers latest value");
+}
+
+/**
+ * パラメータ検証
+ */
+void test_subscribe_options_invalid(void) {
+    CANSubscribeOptions opt = {CAN_SHM_SUBSCRIBE_MIN_INTERVAL, 0, 0};
+    TEST_ASSERT(can_shm_subscribe_ex(0x564, 1, 10, &opt, subscribe_callback, NULL) ==
+                CAN_SHM_ERROR_INVALID_PARAM, "Zero interval rejected");
+    opt.mode = CAN_SHM_SUBSCRIBE_EVERY_NTH;
+    TEST_ASSERT(can_shm_subscribe_ex(0x564, 1, 10, &opt, subscribe_callback, NULL) ==
+                CAN_SHM_ERROR_INVALID_PARAM, "Zero N rejected");
+    SubscriberState state;
+    memset(&state, 0, sizeof(state));
+    TEST_ASSERT(can_shm_subscribe_ex(0x564, 1, 10, NULL, subscribe_callback, &state) ==
+                CAN_SHM_ERROR_TIMEOUT, "Timeout without updates");
+}
+
+int main(void) {
+    printf("Starting Subscribe Options Tests...\n\n");
+
+    if (can_shm_init() != CAN_SHM_SUCCESS) {
+        printf("Failed to initialize CAN shared memory system\n");
+        return 1;
+    }
+
+    test_subscribe_every();
+    test_subscribe_every_nth();
+    test_subscribe_min_interval();
+    test_subscribe_sample();
+    test_subscribe_options_invalid();
+
+    can_shm_cleanup();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+
+    if (tests_failed == 0) {
+        printf("All tests PASSED!\n");
+        return 0;
+    } else {
+        printf("Some tests FAILED!\n");
+        return 1;
+    }
+}